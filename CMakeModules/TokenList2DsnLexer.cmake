@@ -57,6 +57,11 @@
 #                  path as the token list file path, with a file name of *_lexer.h
 #
 # Use the max_lexer() CMake function from functions.cmake for invocation convenience.
+#
+# Besides the sorted keyword table, a perfect hash of the keywords is generated
+# (a "hash and displace" scheme on top of the 32 bit FNV-1a hash of the keywords),
+# so DSNLEXER can find a keyword with a single hash and a single string compare.
+# See KEYWORD_INDEX in dsnlexer.h for the lookup side.
 
 
 #message( STATUS "TokenList2DsnLexer.cmake" )    # indicate we are running
@@ -240,6 +245,11 @@ class ${LEXERCLASS} : public DSNLEXER
     static const KEYWORD  keywords[];
     static const unsigned keyword_count;
 
+    /// Auto generated perfect hash of the keywords:
+    static const unsigned      keyword_displacements[];
+    static const int           keyword_slots[];
+    static const KEYWORD_INDEX keyword_index;
+
 public:
     /**
      * Constructor ( const std::string&, const wxString& )
@@ -250,6 +260,7 @@ public:
     ${LEXERCLASS}( const std::string& aSExpression, const wxString& aSource = wxEmptyString ) :
         DSNLEXER( keywords, keyword_count, aSExpression, aSource )
     {
+        SetKeywordIndex( &keyword_index );
     }
 
     /**
@@ -264,6 +275,7 @@ public:
     ${LEXERCLASS}( FILE* aFile, const wxString& aFilename ) :
         DSNLEXER( keywords, keyword_count, aFile, aFilename )
     {
+        SetKeywordIndex( &keyword_index );
     }
 
     /**
@@ -280,6 +292,7 @@ public:
     ${LEXERCLASS}( LINE_READER* aLineReader ) :
         DSNLEXER( keywords, keyword_count, aLineReader )
     {
+        SetKeywordIndex( &keyword_index );
     }
 
     /**
@@ -385,3 +398,188 @@ const char* ${LEXERCLASS}::TokenName( T aTok )
 }
 "
 )
+
+
+#-----<perfect hash>-----------------------------------------------------------
+
+# FNV-1a 32 bit hash of each token, identical to the one computed by
+# DSNLEXER::findToken().  Tokens only hold [_0-9a-z], so the character codes
+# are found from their position in these strings.
+set( lowerCaseLetters "abcdefghijklmnopqrstuvwxyz" )
+
+# The 32 bit hashes are kept as two 16 bit halves, so that no intermediate value
+# of math() needs more than 31 bits: before CMake 3.13, math() computes with a
+# long, which only has 32 bits with MSVC.
+
+# hi:lo = ( hi:lo * 16777619 ) modulo 2^32, with 16777619 = 0x0100:0x0193
+macro( fnv_multiply hiVar loVar )
+    math( EXPR _fnvLow "${${loVar}} * 403" )
+    math( EXPR ${hiVar} "( ${${hiVar}} * 403 + ${${loVar}} * 256 + ( ${_fnvLow} >> 16 ) ) & 65535" )
+    math( EXPR ${loVar} "${_fnvLow} & 65535" )
+endmacro()
+
+# resultVar = hi:lo modulo divisor, for a divisor below 2^23
+macro( hash_modulo hi lo divisor resultVar )
+    math( EXPR ${resultVar} "${hi} % ${divisor}" )
+    math( EXPR ${resultVar} "( ${${resultVar}} * 256 ) % ${divisor}" )
+    math( EXPR ${resultVar} "( ${${resultVar}} * 256 + ${lo} ) % ${divisor}" )
+endmacro()
+
+set( keywordIndex 0 )
+
+foreach( token ${tokens} )
+    string( LENGTH "${token}" tokenLength )
+    math( EXPR lastChar "${tokenLength} - 1" )
+
+    # 2166136261 = 0x811C:0x9DC5
+    set( hashHi 33052 )
+    set( hashLo 40389 )
+
+    foreach( ii RANGE ${lastChar} )
+        string( SUBSTRING "${token}" ${ii} 1 cc )
+
+        if( cc STREQUAL "_" )
+            set( code 95 )
+        elseif( cc MATCHES "[0-9]" )
+            math( EXPR code "48 + ${cc}" )
+        else()
+            string( FIND "${lowerCaseLetters}" "${cc}" code )
+            math( EXPR code "97 + ${code}" )
+        endif()
+
+        math( EXPR hashLo "${hashLo} ^ ${code}" )
+        fnv_multiply( hashHi hashLo )
+    endforeach()
+
+    set( hashHi_${keywordIndex} ${hashHi} )
+    set( hashLo_${keywordIndex} ${hashLo} )
+    math( EXPR keywordIndex "${keywordIndex} + 1" )
+endforeach()
+
+# About 4 keywords per bucket, and a 80% load of the slot table.  The slot count
+# is odd, so that the slot of a keyword depends on all the bits of its hash.
+math( EXPR bucketCount "( ${tokensAfter} + 3 ) / 4" )
+math( EXPR slotCount "( ${tokensAfter} + ${tokensAfter} / 4 ) | 1" )
+
+if( bucketCount EQUAL 0 )
+    set( bucketCount 1 )
+endif()
+
+math( EXPR lastBucket "${bucketCount} - 1" )
+math( EXPR lastSlot "${slotCount} - 1" )
+
+foreach( bucket RANGE ${lastBucket} )
+    set( bucket_${bucket} "" )
+    set( displacement_${bucket} 0 )
+endforeach()
+
+foreach( slot RANGE ${lastSlot} )
+    set( slot_${slot} -1 )
+endforeach()
+
+set( maxBucketSize 0 )
+
+if( tokensAfter GREATER 0 )
+    math( EXPR lastKeyword "${tokensAfter} - 1" )
+
+    foreach( keyword RANGE ${lastKeyword} )
+        hash_modulo( ${hashHi_${keyword}} ${hashLo_${keyword}} ${bucketCount} bucket )
+        list( APPEND bucket_${bucket} ${keyword} )
+        list( LENGTH bucket_${bucket} bucketSize )
+
+        if( bucketSize GREATER maxBucketSize )
+            set( maxBucketSize ${bucketSize} )
+        endif()
+    endforeach()
+endif()
+
+# Place the biggest buckets first: for each bucket, find the smallest displacement
+# which sends all its keywords to free and distinct slots.
+set( bucketSize ${maxBucketSize} )
+
+while( bucketSize GREATER 0 )
+    foreach( bucket RANGE ${lastBucket} )
+        list( LENGTH bucket_${bucket} size )
+
+        if( size EQUAL bucketSize )
+            set( displacement 0 )
+            set( placed FALSE )
+
+            while( NOT placed )
+                if( displacement GREATER 100000 )
+                    message( FATAL_ERROR "${dsnErrorMsg} cannot build the keyword hash for ${inputFile}." )
+                endif()
+
+                set( slots "" )
+                set( placed TRUE )
+
+                foreach( keyword ${bucket_${bucket}} )
+                    math( EXPR slotHi "${hashHi_${keyword}} ^ ( ${displacement} >> 16 )" )
+                    math( EXPR slotLo "${hashLo_${keyword}} ^ ( ${displacement} & 65535 )" )
+                    fnv_multiply( slotHi slotLo )
+                    hash_modulo( ${slotHi} ${slotLo} ${slotCount} slot )
+                    list( FIND slots ${slot} found )
+
+                    if( NOT slot_${slot} EQUAL -1 OR NOT found EQUAL -1 )
+                        set( placed FALSE )
+                        break()
+                    endif()
+
+                    list( APPEND slots ${slot} )
+                endforeach()
+
+                if( NOT placed )
+                    math( EXPR displacement "${displacement} + 1" )
+                endif()
+            endwhile()
+
+            set( displacement_${bucket} ${displacement} )
+            set( ii 0 )
+
+            foreach( keyword ${bucket_${bucket}} )
+                list( GET slots ${ii} slot )
+                set( slot_${slot} ${keyword} )
+                math( EXPR ii "${ii} + 1" )
+            endforeach()
+        endif()
+    endforeach()
+
+    math( EXPR bucketSize "${bucketSize} - 1" )
+endwhile()
+
+file( APPEND "${outCppFile}"
+"
+
+const unsigned ${LEXERCLASS}::keyword_displacements[] = {
+" )
+
+foreach( bucket RANGE ${lastBucket} )
+    if( bucket EQUAL lastBucket )
+        file( APPEND "${outCppFile}" "    ${displacement_${bucket}}\n" )
+    else()
+        file( APPEND "${outCppFile}" "    ${displacement_${bucket}},\n" )
+    endif()
+endforeach()
+
+file( APPEND "${outCppFile}"
+"};
+
+const int ${LEXERCLASS}::keyword_slots[] = {
+" )
+
+foreach( slot RANGE ${lastSlot} )
+    if( slot EQUAL lastSlot )
+        file( APPEND "${outCppFile}" "    ${slot_${slot}}\n" )
+    else()
+        file( APPEND "${outCppFile}" "    ${slot_${slot}},\n" )
+    endif()
+endforeach()
+
+file( APPEND "${outCppFile}"
+"};
+
+const KEYWORD_INDEX ${LEXERCLASS}::keyword_index = {
+    ${bucketCount}, ${LEXERCLASS}::keyword_displacements,
+    ${slotCount}, ${LEXERCLASS}::keyword_slots
+};
+" )
@@ -44,6 +44,7 @@
 #include <base_struct.h>
 #include <common.h>
 #include <plot_common.h>
+#include <plot_printf.h>
 #include <macros.h>
 #include <class_base_screen.h>
 #include <drawtxt.h>
@@ -89,6 +90,8 @@ bool PLOTTER::OpenFile( const wxString& aFullFilename )
     if( outputFile == NULL )
         return false ;
 
+    SetPlotFileBuffer( outputFile );
+
     return true;
 }
 
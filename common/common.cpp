@@ -38,6 +38,7 @@
 #include <confirm.h>
 #include <base_units.h>
 #include <reporter.h>
+#include <ki_mutex.h>
 
 #include <wx/process.h>
 #include <wx/config.h>
@@ -257,8 +258,13 @@ int ProcessExecute( const wxString& aCommandLine, int aFlags, wxProcess *callbac
 }
 
 
+// Items can be created from worker threads (e.g. the GerbView file loaders)
+static MUTEX timeStampLock;
+
 time_t GetNewTimeStamp()
 {
+    MUTLOCK lock( timeStampLock );
+
     static time_t oldTimeStamp;
     time_t newTimeStamp;
 
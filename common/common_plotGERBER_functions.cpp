@@ -34,6 +34,7 @@
 #include <base_struct.h>
 #include <common.h>
 #include <plot_common.h>
+#include <plot_printf.h>
 #include <macros.h>
 #include <kicad_string.h>
 
@@ -45,6 +46,10 @@ GERBER_PLOTTER::GERBER_PLOTTER()
     workFile  = 0;
     finalFile = 0;
     currentAperture = apertures.end();
+    m_regionOpen = false;
+    m_regionGroup = false;
+    m_lastPosValid = false;
+    m_lastPosX = m_lastPosY = 0;
 
     // number of digits after the point (number of digits of the mantissa
     // Be carefull: the Gerber coordinates are stored in an integer
@@ -95,9 +100,20 @@ void GERBER_PLOTTER::SetGerberCoordinatesFormat( int aResolution, bool aUseInche
 
 void GERBER_PLOTTER::emitDcode( const DPOINT& pt, int dcode )
 {
+    int x = KiROUND( pt.x );
+    int y = KiROUND( pt.y );
+
+    // Coordinates are modal: the unchanged one is omitted
+    if( m_lastPosValid && x == m_lastPosX && y != m_lastPosY )
+        PlotPrintf( outputFile, "Y%dD%02d*\n", y, dcode );
+    else if( m_lastPosValid && y == m_lastPosY && x != m_lastPosX )
+        PlotPrintf( outputFile, "X%dD%02d*\n", x, dcode );
+    else
+        PlotPrintf( outputFile, "X%dY%dD%02d*\n", x, y, dcode );
 
-    fprintf( outputFile, "X%dY%dD%02d*\n",
-	    KiROUND( pt.x ), KiROUND( pt.y ), dcode );
+    m_lastPosValid = true;
+    m_lastPosX = x;
+    m_lastPosY = y;
 }
 
 
@@ -111,16 +127,23 @@ bool GERBER_PLOTTER::StartPlot()
     // note tmpfile() does not work under Vista and W7 in user mode
     m_workFilename = filename + wxT(".tmp");
     workFile   = wxFopen( m_workFilename, wxT( "wt" ));
+    SetPlotFileBuffer( workFile );
     outputFile = workFile;
     wxASSERT( outputFile );
 
     if( outputFile == NULL )
         return false;
 
+    m_regionOpen = false;
+    m_regionGroup = false;
+    m_regionOutlines.clear();
+    m_regionOutlineWidths.clear();
+    m_lastPosValid = false;
+
     for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
     {
         if( ! m_headerExtraLines[ii].IsEmpty() )
-            fprintf( outputFile, "%s\n", TO_UTF8( m_headerExtraLines[ii] ) );
+            PlotPrintf( outputFile, "%s\n", TO_UTF8( m_headerExtraLines[ii] ) );
     }
 
     // Set coordinate format to 3.6 or 4.5 absolute, leading zero omitted
@@ -129,17 +152,17 @@ bool GERBER_PLOTTER::StartPlot()
     // It is fixed here to 3 (inch) or 4 (mm), but is not actually used
     int leadingDigitCount = m_gerberUnitInch ? 3 : 4;
 
-    fprintf( outputFile, "%%FSLAX%d%dY%d%d*%%\n",
-             leadingDigitCount, m_gerberUnitFmt,
-             leadingDigitCount, m_gerberUnitFmt );
-    fprintf( outputFile,
-             "G04 Gerber Fmt %d.%d, Leading zero omitted, Abs format (unit %s)*\n",
-             leadingDigitCount, m_gerberUnitFmt,
-             m_gerberUnitInch ? "inch" : "mm" );
+    PlotPrintf( outputFile, "%%FSLAX%d%dY%d%d*%%\n",
+                leadingDigitCount, m_gerberUnitFmt,
+                leadingDigitCount, m_gerberUnitFmt );
+    PlotPrintf( outputFile,
+                "G04 Gerber Fmt %d.%d, Leading zero omitted, Abs format (unit %s)*\n",
+                leadingDigitCount, m_gerberUnitFmt,
+                m_gerberUnitInch ? "inch" : "mm" );
 
     wxString Title = creator + wxT( " " ) + GetBuildVersion();
-    fprintf( outputFile, "G04 Created by KiCad (%s) date %s*\n",
-             TO_UTF8( Title ), TO_UTF8( DateAndTime() ) );
+    PlotPrintf( outputFile, "G04 Created by KiCad (%s) date %s*\n",
+                TO_UTF8( Title ), TO_UTF8( DateAndTime() ) );
 
     /* Mass parameter: unit = INCHES/MM */
     if( m_gerberUnitInch )
@@ -164,6 +187,8 @@ bool GERBER_PLOTTER::EndPlot()
 
     wxASSERT( outputFile );
 
+    closeRegion();
+
     /* Outfile is actually a temporary file i.e. workFile */
     fputs( "M02*\n", outputFile );
     fflush( outputFile );
@@ -218,27 +243,22 @@ void GERBER_PLOTTER::SetCurrentLineWidth( int width )
 std::vector<APERTURE>::iterator GERBER_PLOTTER::getAperture( const wxSize&           size,
                                                              APERTURE::APERTURE_TYPE type )
 {
-    int last_D_code = 9;
-
     // Search an existing aperture
-    std::vector<APERTURE>::iterator tool = apertures.begin();
+    std::pair< int, std::pair<int, int> > key( type, std::make_pair( size.x, size.y ) );
+    std::map< std::pair< int, std::pair<int, int> >, int >::const_iterator it;
 
-    while( tool != apertures.end() )
-    {
-        last_D_code = tool->DCode;
-
-        if( (tool->Type == type) && (tool->Size == size) )
-            return tool;
+    it = m_apertureIndex.find( key );
 
-        tool++;
-    }
+    if( it != m_apertureIndex.end() )
+        return apertures.begin() + it->second;
 
     // Allocate a new aperture
     APERTURE new_tool;
     new_tool.Size  = size;
     new_tool.Type  = type;
-    new_tool.DCode = last_D_code + 1;
+    new_tool.DCode = apertures.empty() ? 10 : apertures.back().DCode + 1;
     apertures.push_back( new_tool );
+    m_apertureIndex[key] = apertures.size() - 1;
     return apertures.end() - 1;
 }
 
@@ -248,13 +268,16 @@ void GERBER_PLOTTER::selectAperture( const wxSize&           size,
 {
     wxASSERT( outputFile );
 
+    // Apertures cannot be selected inside a region
+    closeRegion();
+
     if( ( currentAperture == apertures.end() )
        || ( currentAperture->Type != type )
        || ( currentAperture->Size != size ) )
     {
         // Pick an existing aperture or create a new one
         currentAperture = getAperture( size, type );
-        fprintf( outputFile, "D%d*\n", currentAperture->DCode );
+        PlotPrintf( outputFile, "D%d*\n", currentAperture->DCode );
     }
 }
 
@@ -275,7 +298,9 @@ void GERBER_PLOTTER::writeApertureList()
         if(! m_gerberUnitInch )
             fscale *= 25.4;     // size in mm
 
-        char* text = cbuf + sprintf( cbuf, "%%ADD%d", tool->DCode );
+        int    len  = PlotSnprintf( cbuf, sizeof( cbuf ), "%%ADD%d", tool->DCode );
+        char*  text = cbuf + len;
+        size_t textSize = sizeof( cbuf ) - len;
 
         /* Please note: the Gerber specs for mass parameters say that
            exponential syntax is *not* allowed and the decimal point should
@@ -287,21 +312,21 @@ void GERBER_PLOTTER::writeApertureList()
         switch( tool->Type )
         {
         case APERTURE::Circle:
-            sprintf( text, "C,%#f*%%\n", tool->Size.x * fscale );
+            PlotSnprintf( text, textSize, "C,%#f*%%\n", tool->Size.x * fscale );
             break;
 
         case APERTURE::Rect:
-            sprintf( text, "R,%#fX%#f*%%\n",
+            PlotSnprintf( text, textSize, "R,%#fX%#f*%%\n",
 	             tool->Size.x * fscale,
                      tool->Size.y * fscale );
             break;
 
         case APERTURE::Plotting:
-            sprintf( text, "C,%#f*%%\n", tool->Size.x * fscale );
+            PlotSnprintf( text, textSize, "C,%#f*%%\n", tool->Size.x * fscale );
             break;
 
         case APERTURE::Oval:
-            sprintf( text, "O,%#fX%#f*%%\n",
+            PlotSnprintf( text, textSize, "O,%#fX%#f*%%\n",
 	            tool->Size.x * fscale,
 		    tool->Size.y * fscale );
             break;
@@ -317,6 +342,9 @@ void GERBER_PLOTTER::PenTo( const wxPoint& aPos, char plume )
     wxASSERT( outputFile );
     DPOINT pos_dev = userToDeviceCoordinates( aPos );
 
+    if( plume != 'Z' )
+        closeRegion();
+
     switch( plume )
     {
     case 'Z':
@@ -372,58 +400,118 @@ void GERBER_PLOTTER::Arc( const wxPoint& aCenter, double aStAngle, double aEndAn
     DPOINT devEnd = userToDeviceCoordinates( end );
     DPOINT devCenter = userToDeviceCoordinates( aCenter ) - userToDeviceCoordinates( start );
 
-    fprintf( outputFile, "G75*\n" ); // Multiquadrant mode
+    PlotPrintf( outputFile, "G75*\n" ); // Multiquadrant mode
 
     if( aStAngle < aEndAngle )
-        fprintf( outputFile, "G03" );
+           PlotPrintf( outputFile, "G03" );
     else
-        fprintf( outputFile, "G02" );
+        PlotPrintf( outputFile, "G02" );
+
+    PlotPrintf( outputFile, "X%dY%dI%dJ%dD01*\n",
+                KiROUND( devEnd.x ), KiROUND( devEnd.y ),
+                KiROUND( devCenter.x ), KiROUND( devCenter.y ) );
+    PlotPrintf( outputFile, "G01*\n" ); // Back to linear interp.
+
+    m_lastPosValid = true;
+    m_lastPosX = KiROUND( devEnd.x );
+    m_lastPosY = KiROUND( devEnd.y );
+}
+
+
+void GERBER_PLOTTER::BeginRegion()
+{
+    closeRegion();
+    m_regionGroup = true;
+}
+
+
+void GERBER_PLOTTER::EndRegion()
+{
+    m_regionGroup = false;
+    closeRegion();
+}
+
+
+void GERBER_PLOTTER::closeRegion()
+{
+    if( !m_regionOpen )
+        return;
+
+    fputs( "G37*\n", outputFile );
+    m_regionOpen = false;
+
+    // The outlines are plotted after the region, which is fine as long as the
+    // polarity does not change, because all the items are dark
+    for( unsigned ii = 0; ii < m_regionOutlines.size(); ii++ )
+        strokePolyline( m_regionOutlines[ii], m_regionOutlineWidths[ii], true );
 
-    fprintf( outputFile, "X%dY%dI%dJ%dD01*\n",
-             KiROUND( devEnd.x ), KiROUND( devEnd.y ),
-             KiROUND( devCenter.x ), KiROUND( devCenter.y ) );
-    fprintf( outputFile, "G01*\n" ); // Back to linear interp.
+    m_regionOutlines.clear();
+    m_regionOutlineWidths.clear();
+}
+
+
+void GERBER_PLOTTER::strokePolyline( const std::vector< wxPoint >& aCornerList, int aWidth,
+                                     bool aClose )
+{
+    SetCurrentLineWidth( aWidth );
+    MoveTo( aCornerList[0] );
+
+    for( unsigned ii = 1; ii < aCornerList.size(); ii++ )
+        LineTo( aCornerList[ii] );
+
+    if( aClose && ( aCornerList[aCornerList.size()-1] != aCornerList[0] ) )
+        LineTo( aCornerList[0] );
+
+    PenFinish();
 }
 
 
 void GERBER_PLOTTER:: PlotPoly( const std::vector< wxPoint >& aCornerList,
-                               FILL_T aFill, int aWidth )
+                                  FILL_T aFill, int aWidth )
 {
     if( aCornerList.size() <= 1 )
-        return;
+           return;
 
     // Gerber format does not know filled polygons with thick outline
     // Therefore, to plot a filled polygon with outline having a thickness,
     // one should plot outline as thick segments
 
-    SetCurrentLineWidth( aWidth );
-
     if( aFill )
     {
-        fputs( "G36*\n", outputFile );
+        // Each D02 starts a new contour of the current region.
+        // Only the polygons of a BeginRegion() group share a region.
+        if( !m_regionOpen )
+        {
+            fputs( "G36*\n", outputFile );
+            m_regionOpen = true;
+        }
 
-        MoveTo( aCornerList[0] );
+        emitDcode( userToDeviceCoordinates( aCornerList[0] ), 2 );
 
         for( unsigned ii = 1; ii < aCornerList.size(); ii++ )
-            LineTo( aCornerList[ii] );
+            emitDcode( userToDeviceCoordinates( aCornerList[ii] ), 1 );
 
-        FinishTo( aCornerList[0] );
-        fputs( "G37*\n", outputFile );
-    }
-
-    if( aWidth > 0 )
-    {
-        MoveTo( aCornerList[0] );
+        if( aCornerList[aCornerList.size()-1] != aCornerList[0] )
+            emitDcode( userToDeviceCoordinates( aCornerList[0] ), 1 );
 
-        for( unsigned ii = 1; ii < aCornerList.size(); ii++ )
-            LineTo( aCornerList[ii] );
+        penState = 'Z';
 
-        // Ensure the thick outline is closed for filled polygons
-        // (if not filled, could be only a polyline)
-        if( aFill && ( aCornerList[aCornerList.size()-1] != aCornerList[0] ) )
-            LineTo( aCornerList[0] );
+        if( aWidth > 0 )
+        {
+            m_regionOutlines.push_back( aCornerList );
+            m_regionOutlineWidths.push_back( aWidth );
+        }
 
-        PenFinish();
+        if( !m_regionGroup )
+            closeRegion();
+    }
+    else if( aWidth > 0 )
+    {
+        strokePolyline( aCornerList, aWidth, false );
+    }
+    else
+    {
+        SetCurrentLineWidth( aWidth );
     }
 }
 
@@ -588,8 +676,10 @@ void GERBER_PLOTTER::FlashPadTrapez( const wxPoint& aPadPos,  const wxPoint* aCo
 
 void GERBER_PLOTTER::SetLayerPolarity( bool aPositive )
 {
+    closeRegion();
+
     if( aPositive )
-        fprintf( outputFile, "%%LPD*%%\n" );
+        PlotPrintf( outputFile, "%%LPD*%%\n" );
     else
-        fprintf( outputFile, "%%LPC*%%\n" );
+        PlotPrintf( outputFile, "%%LPC*%%\n" );
 }
@@ -195,6 +195,7 @@
 #include <wxstruct.h>
 #include <base_struct.h>
 #include <plot_common.h>
+#include <plot_printf.h>
 #include <macros.h>
 #include <kicad_string.h>
 
@@ -234,7 +235,7 @@ void HPGL_PLOTTER::SetViewport( const wxPoint& aOffset, double aIusPerDecimil,
 bool HPGL_PLOTTER::StartPlot()
 {
     wxASSERT( outputFile );
-    fprintf( outputFile, "IN;VS%d;PU;PA;SP%d;\n", penSpeed, penNumber );
+    PlotPrintf( outputFile, "IN;VS%d;PU;PA;SP%d;\n", penSpeed, penNumber );
     return true;
 }
 
@@ -260,7 +261,7 @@ void HPGL_PLOTTER::Rect( const wxPoint& p1, const wxPoint& p2, FILL_T fill, int
     wxASSERT( outputFile );
     DPOINT p2dev = userToDeviceCoordinates( p2 );
     MoveTo( p1 );
-    fprintf( outputFile, "EA %.0f,%.0f;\n", p2dev.x, p2dev.y );
+    PlotPrintf( outputFile, "EA %.0f,%.0f;\n", p2dev.x, p2dev.y );
     PenFinish();
 }
 
@@ -277,7 +278,7 @@ void HPGL_PLOTTER::Circle( const wxPoint& centre, int diameter, FILL_T fill,
     if( radius > 0 )
     {
         MoveTo( centre );
-        fprintf( outputFile, "CI %g;\n", radius );
+        PlotPrintf( outputFile, "CI %g;\n", radius );
         PenFinish();
     }
 }
@@ -365,7 +366,7 @@ void HPGL_PLOTTER::PenTo( const wxPoint& pos, char plume )
     DPOINT pos_dev = userToDeviceCoordinates( pos );
 
     if( penLastpos != pos )
-        fprintf( outputFile, "PA %.0f,%.0f;\n", pos_dev.x, pos_dev.y );
+        PlotPrintf( outputFile, "PA %.0f,%.0f;\n", pos_dev.x, pos_dev.y );
 
     penLastpos = pos;
 }
@@ -436,12 +437,12 @@ void HPGL_PLOTTER::Arc( const wxPoint& centre, double StAngle, double EndAngle,
     cmap.y  = centre.y - KiROUND( sindecideg( radius, StAngle ) );
     DPOINT  cmap_dev = userToDeviceCoordinates( cmap );
 
-    fprintf( outputFile,
-             "PU;PA %.0f,%.0f;PD;AA %.0f,%.0f,",
-             cmap_dev.x, cmap_dev.y,
-             centre_dev.x, centre_dev.y );
-    fprintf( outputFile, "%.0f", angle );
-    fprintf( outputFile, ";PU;\n" );
+    PlotPrintf( outputFile,
+                "PU;PA %.0f,%.0f;PD;AA %.0f,%.0f,",
+                cmap_dev.x, cmap_dev.y,
+                centre_dev.x, centre_dev.y );
+    PlotPrintf( outputFile, "%.0f", angle );
+    PlotPrintf( outputFile, ";PU;\n" );
     PenFinish();
 }
 
@@ -500,8 +501,8 @@ void HPGL_PLOTTER::FlashPadCircle( const wxPoint& pos, int diametre,
 
     double rsize = userToDeviceSize( radius );
 
-    fprintf( outputFile, "PA %.0f,%.0f;CI %.0f;\n",
-             pos_dev.x, pos_dev.y, rsize );
+    PlotPrintf( outputFile, "PA %.0f,%.0f;CI %.0f;\n",
+                pos_dev.x, pos_dev.y, rsize );
 
     if( trace_mode == FILLED )        // Plot in filled mode.
     {
@@ -510,8 +511,8 @@ void HPGL_PLOTTER::FlashPadCircle( const wxPoint& pos, int diametre,
             while( (radius -= delta ) >= 0 )
             {
                 rsize = userToDeviceSize( radius );
-                fprintf( outputFile, "PA %.0f,%.0f;CI %.0f;\n",
-                         pos_dev.x, pos_dev.y, rsize );
+                PlotPrintf( outputFile, "PA %.0f,%.0f;CI %.0f;\n",
+                            pos_dev.x, pos_dev.y, rsize );
             }
         }
     }
@@ -34,10 +34,12 @@
 #include <base_struct.h>
 #include <common.h>
 #include <plot_common.h>
+#include <plot_printf.h>
 #include <macros.h>
 #include <kicad_string.h>
 #include <wx/zstream.h>
-#include <wx/mstream.h>
+#include <wx/wfstream.h>
+#include <wx/ffile.h>
 
 
 /*
@@ -58,6 +60,8 @@ bool PDF_PLOTTER::OpenFile( const wxString& aFullFilename )
     if( outputFile == NULL )
         return false ;
 
+    SetPlotFileBuffer( outputFile );
+
     return true;
 }
 
@@ -107,8 +111,8 @@ void PDF_PLOTTER::SetCurrentLineWidth( int width )
         pen_width = defaultPenWidth;
 
     if( pen_width != currentPenWidth )
-        fprintf( workFile, "%g w\n",
-                 userToDeviceSize( pen_width ) );
+        PlotPrintf( workFile, "%g w\n",
+                    userToDeviceSize( pen_width ) );
 
     currentPenWidth = pen_width;
 }
@@ -126,8 +130,8 @@ void PDF_PLOTTER::SetCurrentLineWidth( int width )
 void PDF_PLOTTER::emitSetRGBColor( double r, double g, double b )
 {
     wxASSERT( workFile );
-    fprintf( workFile, "%g %g %g rg %g %g %g RG\n",
-             r, g, b, r, g, b );
+    PlotPrintf( workFile, "%g %g %g rg %g %g %g RG\n",
+                r, g, b, r, g, b );
 }
 
 /**
@@ -137,8 +141,8 @@ void PDF_PLOTTER::SetDash( bool dashed )
 {
     wxASSERT( workFile );
     if( dashed )
-        fprintf( workFile, "[%d %d] 0 d\n",
-                 (int) GetDashMarkLenIU(), (int) GetDashGapLenIU() );
+        PlotPrintf( workFile, "[%d %d] 0 d\n",
+                    (int) GetDashMarkLenIU(), (int) GetDashGapLenIU() );
     else
         fputs( "[] 0 d\n", workFile );
 }
@@ -154,9 +158,9 @@ void PDF_PLOTTER::Rect( const wxPoint& p1, const wxPoint& p2, FILL_T fill, int w
     DPOINT p2_dev = userToDeviceCoordinates( p2 );
 
     SetCurrentLineWidth( width );
-    fprintf( workFile, "%g %g %g %g re %c\n", p1_dev.x, p1_dev.y,
-             p2_dev.x - p1_dev.x, p2_dev.y - p1_dev.y,
-             fill == NO_FILL ? 'S' : 'B' );
+    PlotPrintf( workFile, "%g %g %g %g re %c\n", p1_dev.x, p1_dev.y,
+                p2_dev.x - p1_dev.x, p2_dev.y - p1_dev.y,
+                fill == NO_FILL ? 'S' : 'B' );
 }
 
 
@@ -179,30 +183,30 @@ void PDF_PLOTTER::Circle( const wxPoint& pos, int diametre, FILL_T aFill, int wi
     double magic = radius * 0.551784; // You don't want to know where this come from
 
     // This is the convex hull for the bezier approximated circle
-    fprintf( workFile, "%g %g m "
-                       "%g %g %g %g %g %g c "
-                       "%g %g %g %g %g %g c "
-                       "%g %g %g %g %g %g c "
-                       "%g %g %g %g %g %g c %c\n",
-             pos_dev.x - radius, pos_dev.y,
-
-             pos_dev.x - radius, pos_dev.y + magic,
-             pos_dev.x - magic, pos_dev.y + radius,
-             pos_dev.x, pos_dev.y + radius,
-
-             pos_dev.x + magic, pos_dev.y + radius,
-             pos_dev.x + radius, pos_dev.y + magic,
-             pos_dev.x + radius, pos_dev.y,
-
-             pos_dev.x + radius, pos_dev.y - magic,
-             pos_dev.x + magic, pos_dev.y - radius,
-             pos_dev.x, pos_dev.y - radius,
-
-             pos_dev.x - magic, pos_dev.y - radius,
-             pos_dev.x - radius, pos_dev.y - magic,
-             pos_dev.x - radius, pos_dev.y,
-
-             aFill == NO_FILL ? 's' : 'b' );
+    PlotPrintf( workFile, "%g %g m "
+                          "%g %g %g %g %g %g c "
+                          "%g %g %g %g %g %g c "
+                          "%g %g %g %g %g %g c "
+                          "%g %g %g %g %g %g c %c\n",
+                pos_dev.x - radius, pos_dev.y,
+
+                pos_dev.x - radius, pos_dev.y + magic,
+                pos_dev.x - magic, pos_dev.y + radius,
+                pos_dev.x, pos_dev.y + radius,
+
+                pos_dev.x + magic, pos_dev.y + radius,
+                pos_dev.x + radius, pos_dev.y + magic,
+                pos_dev.x + radius, pos_dev.y,
+
+                pos_dev.x + radius, pos_dev.y - magic,
+                pos_dev.x + magic, pos_dev.y - radius,
+                pos_dev.x, pos_dev.y - radius,
+
+                pos_dev.x - magic, pos_dev.y - radius,
+                pos_dev.x - radius, pos_dev.y - magic,
+                pos_dev.x - radius, pos_dev.y,
+
+                aFill == NO_FILL ? 's' : 'b' );
 }
 
 
@@ -231,19 +235,19 @@ void PDF_PLOTTER::Arc( const wxPoint& centre, double StAngle, double EndAngle, i
     start.x = centre.x + KiROUND( cosdecideg( radius, -StAngle ) );
     start.y = centre.y + KiROUND( sindecideg( radius, -StAngle ) );
     DPOINT pos_dev = userToDeviceCoordinates( start );
-    fprintf( workFile, "%g %g m ", pos_dev.x, pos_dev.y );
+    PlotPrintf( workFile, "%g %g m ", pos_dev.x, pos_dev.y );
     for( int ii = StAngle + delta; ii < EndAngle; ii += delta )
     {
         end.x = centre.x + KiROUND( cosdecideg( radius, -ii ) );
         end.y = centre.y + KiROUND( sindecideg( radius, -ii ) );
         pos_dev = userToDeviceCoordinates( end );
-        fprintf( workFile, "%g %g l ", pos_dev.x, pos_dev.y );
+        PlotPrintf( workFile, "%g %g l ", pos_dev.x, pos_dev.y );
     }
 
     end.x = centre.x + KiROUND( cosdecideg( radius, -EndAngle ) );
     end.y = centre.y + KiROUND( sindecideg( radius, -EndAngle ) );
     pos_dev = userToDeviceCoordinates( end );
-    fprintf( workFile, "%g %g l ", pos_dev.x, pos_dev.y );
+    PlotPrintf( workFile, "%g %g l ", pos_dev.x, pos_dev.y );
 
     // The arc is drawn... if not filled we stroke it, otherwise we finish
     // closing the pie at the center
@@ -254,7 +258,7 @@ void PDF_PLOTTER::Arc( const wxPoint& centre, double StAngle, double EndAngle, i
     else
     {
         pos_dev = userToDeviceCoordinates( centre );
-        fprintf( workFile, "%g %g l b\n", pos_dev.x, pos_dev.y );
+        PlotPrintf( workFile, "%g %g l b\n", pos_dev.x, pos_dev.y );
     }
 }
 
@@ -272,16 +276,16 @@ void PDF_PLOTTER::PlotPoly( const std::vector< wxPoint >& aCornerList,
     SetCurrentLineWidth( aWidth );
 
     DPOINT pos = userToDeviceCoordinates( aCornerList[0] );
-    fprintf( workFile, "%g %g m\n", pos.x, pos.y );
+    PlotPrintf( workFile, "%g %g m\n", pos.x, pos.y );
 
     for( unsigned ii = 1; ii < aCornerList.size(); ii++ )
     {
         pos = userToDeviceCoordinates( aCornerList[ii] );
-        fprintf( workFile, "%g %g l\n", pos.x, pos.y );
+        PlotPrintf( workFile, "%g %g l\n", pos.x, pos.y );
     }
 
     // Close path and stroke(/fill)
-    fprintf( workFile, "%c\n", aFill == NO_FILL ? 'S' : 'b' );
+    PlotPrintf( workFile, "%c\n", aFill == NO_FILL ? 'S' : 'b' );
 }
 
 
@@ -303,9 +307,9 @@ void PDF_PLOTTER::PenTo( const wxPoint& pos, char plume )
     if( penState != plume || pos != penLastpos )
     {
         DPOINT pos_dev = userToDeviceCoordinates( pos );
-        fprintf( workFile, "%g %g %c\n",
-                 pos_dev.x, pos_dev.y,
-                 ( plume=='D' ) ? 'l' : 'm' );
+        PlotPrintf( workFile, "%g %g %c\n",
+                    pos_dev.x, pos_dev.y,
+                    ( plume=='D' ) ? 'l' : 'm' );
     }
     penState   = plume;
     penLastpos = pos;
@@ -340,22 +344,22 @@ void PDF_PLOTTER::PlotImage( const wxImage & aImage, const wxPoint& aPos,
        3) restore the CTM
        4) profit
      */
-    fprintf( workFile, "q %g 0 0 %g %g %g cm\n", // Step 1
-            userToDeviceSize( drawsize.x ),
-            userToDeviceSize( drawsize.y ),
-            dev_start.x, dev_start.y );
+    PlotPrintf( workFile, "q %g 0 0 %g %g %g cm\n", // Step 1
+               userToDeviceSize( drawsize.x ),
+               userToDeviceSize( drawsize.y ),
+               dev_start.x, dev_start.y );
 
     /* An inline image is a cross between a dictionary and a stream.
        A real ugly construct (compared with the elegance of the PDF
        format). Also it accepts some 'abbreviations', which is stupid
        since the content stream is usually compressed anyway... */
-    fprintf( workFile,
-             "BI\n"
-             "  /BPC 8\n"
-             "  /CS %s\n"
-             "  /W %d\n"
-             "  /H %d\n"
-             "ID\n", colorMode ? "/RGB" : "/G", pix_size.x, pix_size.y );
+    PlotPrintf( workFile,
+                "BI\n"
+                "  /BPC 8\n"
+                "  /CS %s\n"
+                "  /W %d\n"
+                "  /H %d\n"
+                "ID\n", colorMode ? "/RGB" : "/G", pix_size.x, pix_size.y );
 
     /* Here comes the stream (in binary!). I *could* have hex or ascii84
        encoded it, but who cares? I'll go through zlib anyway */
@@ -409,7 +413,7 @@ int PDF_PLOTTER::startPdfObject(int handle)
         handle = allocPdfObject();
 
     xrefTable[handle] = ftell( outputFile );
-    fprintf( outputFile, "%d 0 obj\n", handle );
+    PlotPrintf( outputFile, "%d 0 obj\n", handle );
     return handle;
 }
 
@@ -440,14 +444,15 @@ int PDF_PLOTTER::startPdfStream(int handle)
     // This is guaranteed to be handle+1 but needs to be allocated since
     // you could allocate more object during stream preparation
     streamLengthHandle = allocPdfObject();
-    fprintf( outputFile,
-             "<< /Length %d 0 R /Filter /FlateDecode >>\n" // Length is deferred
-             "stream\n", handle + 1 );
+    PlotPrintf( outputFile,
+                "<< /Length %d 0 R /Filter /FlateDecode >>\n" // Length is deferred
+                "stream\n", handle + 1 );
 
     // Open a temporary file to accumulate the stream
     workFilename = filename + wxT(".tmp");
     workFile = wxFopen( workFilename, wxT( "w+b" ));
     wxASSERT( workFile );
+    SetPlotFileBuffer( workFile );
     return handle;
 }
 
@@ -467,21 +472,13 @@ void PDF_PLOTTER::closePdfStream()
         return;
     }
 
-    // Rewind the file, read in the page stream and DEFLATE it
+    // Rewind the file, and DEFLATE the page stream by chunks straight into the output
+    // file: the stream is never held in memory.  A wxFFileOutputStream built from a FILE*
+    // closes it when destroyed, so it is built from a wxFFile which is detached afterwards.
     fseek( workFile, 0, SEEK_SET );
-    unsigned char *inbuf = new unsigned char[stream_len];
-
-    int rc = fread( inbuf, 1, stream_len, workFile );
-    wxASSERT( rc == stream_len );
-    (void) rc;
-
-    // We are done with the temporary file, junk it
-    fclose( workFile );
-    workFile = 0;
-    ::wxRemoveFile( workFilename );
 
-    // NULL means memos owns the memory, but provide a hint on optimum size needed.
-    wxMemoryOutputStream    memos( NULL, std::max( 2000l, stream_len ) ) ;
+    long    start = ftell( outputFile );
+    wxFFile outputFFile( outputFile );
 
     {
         /* Somewhat standard parameters to compress in DEFLATE. The PDF spec is
@@ -491,26 +488,31 @@ void PDF_PLOTTER::closePdfStream()
          *                    8, Z_DEFAULT_STRATEGY );
          */
 
-        wxZlibOutputStream      zos( memos, wxZ_BEST_COMPRESSION, wxZLIB_ZLIB );
-
-        zos.Write( inbuf, stream_len );
+        wxFFileOutputStream     fos( outputFFile );     // does not close outputFFile
+        wxZlibOutputStream      zos( fos, compressionLevel, wxZLIB_ZLIB );
+        std::vector<char>       inbuf( PLOT_FILE_BUFFER_SIZE );
+        size_t                  count;
 
-        delete[] inbuf;
+        while( ( count = fread( &inbuf[0], 1, inbuf.size(), workFile ) ) > 0 )
+            zos.Write( &inbuf[0], count );
 
     }   // flush the zip stream using zos destructor
 
-    wxStreamBuffer* sb = memos.GetOutputStreamBuffer();
+    outputFFile.Detach();       // outputFile stays open
 
-    unsigned out_count = sb->Tell();
+    unsigned out_count = ftell( outputFile ) - start;
 
-    fwrite( sb->GetBufferStart(), 1, out_count, outputFile );
+    // We are done with the temporary file, junk it
+    fclose( workFile );
+    workFile = 0;
+    ::wxRemoveFile( workFilename );
 
     fputs( "endstream\n", outputFile );
     closePdfObject();
 
     // Writing the deferred length as an indirect object
     startPdfObject( streamLengthHandle );
-    fprintf( outputFile, "%u\n", out_count );
+    PlotPrintf( outputFile, "%u\n", out_count );
     closePdfObject();
 }
 
@@ -534,10 +536,10 @@ void PDF_PLOTTER::StartPage()
        compressed later in closePdfStream */
 
     // Default graphic settings (coordinate system, default color and line style)
-    fprintf( workFile,
-             "%g 0 0 %g 0 0 cm 1 J 1 j 0 0 0 rg 0 0 0 RG %g w\n",
-             0.0072 * plotScaleAdjX, 0.0072 * plotScaleAdjY,
-             userToDeviceSize( defaultPenWidth ) );
+    PlotPrintf( workFile,
+                "%g 0 0 %g 0 0 cm 1 J 1 j 0 0 0 rg 0 0 0 RG %g w\n",
+                0.0072 * plotScaleAdjX, 0.0072 * plotScaleAdjY,
+                userToDeviceSize( defaultPenWidth ) );
 }
 
 /**
@@ -562,21 +564,21 @@ void PDF_PLOTTER::ClosePage()
     const double BIGPTsPERMIL = 0.072;
     wxSize psPaperSize = pageInfo.GetSizeMils();
 
-    fprintf( outputFile,
-             "<<\n"
-             "/Type /Page\n"
-             "/Parent %d 0 R\n"
-             "/Resources <<\n"
-             "    /ProcSet [/PDF /Text /ImageC /ImageB]\n"
-             "    /Font %d 0 R >>\n"
-             "/MediaBox [0 0 %d %d]\n"
-             "/Contents %d 0 R\n"
-             ">>\n",
-             pageTreeHandle,
-             fontResDictHandle,
-             int( ceil( psPaperSize.x * BIGPTsPERMIL ) ),
-             int( ceil( psPaperSize.y * BIGPTsPERMIL ) ),
-             pageStreamHandle );
+    PlotPrintf( outputFile,
+                "<<\n"
+                "/Type /Page\n"
+                "/Parent %d 0 R\n"
+                "/Resources <<\n"
+                "    /ProcSet [/PDF /Text /ImageC /ImageB]\n"
+                "    /Font %d 0 R >>\n"
+                "/MediaBox [0 0 %d %d]\n"
+                "/Contents %d 0 R\n"
+                ">>\n",
+                pageTreeHandle,
+                fontResDictHandle,
+                int( ceil( psPaperSize.x * BIGPTsPERMIL ) ),
+                int( ceil( psPaperSize.y * BIGPTsPERMIL ) ),
+                pageStreamHandle );
     closePdfObject();
 
     // Mark the page stream as idle
@@ -644,16 +646,16 @@ bool PDF_PLOTTER::EndPlot()
     for( int i = 0; i < 4; i++ )
     {
         fontdefs[i].font_handle = startPdfObject();
-        fprintf( outputFile,
-                 "<< /BaseFont %s\n"
-                 "   /Type /Font\n"
-                 "   /Subtype /Type1\n"
-
-                 /* Adobe is so Mac-based that the nearest thing to Latin1 is
-                    the Windows ANSI encoding! */
-                 "   /Encoding /WinAnsiEncoding\n"
-                 ">>\n",
-                 fontdefs[i].psname );
+        PlotPrintf( outputFile,
+                    "<< /BaseFont %s\n"
+                    "   /Type /Font\n"
+                    "   /Subtype /Type1\n"
+
+                    /* Adobe is so Mac-based that the nearest thing to Latin1 is
+                       the Windows ANSI encoding! */
+                    "   /Encoding /WinAnsiEncoding\n"
+                    ">>\n",
+                    fontdefs[i].psname );
         closePdfObject();
     }
 
@@ -662,8 +664,8 @@ bool PDF_PLOTTER::EndPlot()
     fputs( "<<\n", outputFile );
     for( int i = 0; i < 4; i++ )
     {
-        fprintf( outputFile, "    %s %d 0 R\n",
-                fontdefs[i].rsname, fontdefs[i].font_handle );
+        PlotPrintf( outputFile, "    %s %d 0 R\n",
+                   fontdefs[i].rsname, fontdefs[i].font_handle );
     }
     fputs( ">>\n", outputFile );
     closePdfObject();
@@ -677,12 +679,12 @@ bool PDF_PLOTTER::EndPlot()
            "/Kids [\n", outputFile );
 
     for( unsigned i = 0; i < pageHandles.size(); i++ )
-        fprintf( outputFile, "%d 0 R\n", pageHandles[i] );
+        PlotPrintf( outputFile, "%d 0 R\n", pageHandles[i] );
 
-    fprintf( outputFile,
-            "]\n"
-            "/Count %ld\n"
-             ">>\n", (long) pageHandles.size() );
+    PlotPrintf( outputFile,
+               "]\n"
+               "/Count %ld\n"
+                ">>\n", (long) pageHandles.size() );
     closePdfObject();
 
 
@@ -692,53 +694,53 @@ bool PDF_PLOTTER::EndPlot()
     time_t ltime = time( NULL );
     strftime( date_buf, 250, "D:%Y%m%d%H%M%S",
               localtime( &ltime ) );
-    fprintf( outputFile,
-             "<<\n"
-             "/Producer (KiCAD PDF)\n"
-             "/CreationDate (%s)\n"
-             "/Creator (%s)\n"
-             "/Title (%s)\n"
-             "/Trapped false\n",
-             date_buf,
-             TO_UTF8( creator ),
-             TO_UTF8( filename ) );
+    PlotPrintf( outputFile,
+                "<<\n"
+                "/Producer (KiCAD PDF)\n"
+                "/CreationDate (%s)\n"
+                "/Creator (%s)\n"
+                "/Title (%s)\n"
+                "/Trapped false\n",
+                date_buf,
+                TO_UTF8( creator ),
+                TO_UTF8( filename ) );
 
     fputs( ">>\n", outputFile );
     closePdfObject();
 
     // The catalog, at last
     int catalogHandle = startPdfObject();
-    fprintf( outputFile,
-             "<<\n"
-             "/Type /Catalog\n"
-             "/Pages %d 0 R\n"
-             "/Version /1.5\n"
-             "/PageMode /UseNone\n"
-             "/PageLayout /SinglePage\n"
-             ">>\n", pageTreeHandle );
+    PlotPrintf( outputFile,
+                "<<\n"
+                "/Type /Catalog\n"
+                "/Pages %d 0 R\n"
+                "/Version /1.5\n"
+                "/PageMode /UseNone\n"
+                "/PageLayout /SinglePage\n"
+                ">>\n", pageTreeHandle );
     closePdfObject();
 
     /* Emit the xref table (format is crucial to the byte, each entry must
        be 20 bytes long, and object zero must be done in that way). Also
        the offset must be kept along for the trailer */
     long xref_start = ftell( outputFile );
-    fprintf( outputFile,
-             "xref\n"
-             "0 %ld\n"
-             "0000000000 65535 f \n", (long) xrefTable.size() );
+    PlotPrintf( outputFile,
+                "xref\n"
+                "0 %ld\n"
+                "0000000000 65535 f \n", (long) xrefTable.size() );
     for( unsigned i = 1; i < xrefTable.size(); i++ )
     {
-        fprintf( outputFile, "%010ld 00000 n \n", xrefTable[i] );
+        PlotPrintf( outputFile, "%010ld 00000 n \n", xrefTable[i] );
     }
 
     // Done the xref, go for the trailer
-    fprintf( outputFile,
-             "trailer\n"
-             "<< /Size %lu /Root %d 0 R /Info %d 0 R >>\n"
-             "startxref\n"
-             "%ld\n" // The offset we saved before
-             "%%%%EOF\n",
-             (unsigned long) xrefTable.size(), catalogHandle, infoDictHandle, xref_start );
+    PlotPrintf( outputFile,
+                "trailer\n"
+                "<< /Size %lu /Root %d 0 R /Info %d 0 R >>\n"
+                "startxref\n"
+                "%ld\n" // The offset we saved before
+                "%%%%EOF\n",
+                (unsigned long) xrefTable.size(), catalogHandle, infoDictHandle, xref_start );
 
     fclose( outputFile );
     outputFile = NULL;
@@ -788,11 +790,11 @@ void PDF_PLOTTER::Text( const wxPoint&              aPos,
            for the trig part of the matrix to avoid %g going in exponential
            format (which is not supported)
            Rendermode 0 shows the text, rendermode 3 is invisible */
-        fprintf( workFile, "q %f %f %f %f %g %g cm BT %s %g Tf %d Tr %g Tz ",
-                ctm_a, ctm_b, ctm_c, ctm_d, ctm_e, ctm_f,
-                fontname, heightFactor,
-                (m_textMode == PLOTTEXTMODE_NATIVE) ? 0 : 3,
-                wideningFactor * 100 );
+        PlotPrintf( workFile, "q %f %f %f %f %g %g cm BT %s %g Tf %d Tr %g Tz ",
+                   ctm_a, ctm_b, ctm_c, ctm_d, ctm_e, ctm_f,
+                   fontname, heightFactor,
+                   (m_textMode == PLOTTEXTMODE_NATIVE) ? 0 : 3,
+                   wideningFactor * 100 );
 
         // The text must be escaped correctly
         fputsPostscriptString( workFile, aText );
@@ -813,8 +815,8 @@ void PDF_PLOTTER::Text( const wxPoint&              aPos,
                    is the right function to use here... */
                 DPOINT dev_from = userToDeviceSize( wxSize( pos_pairs[i], overbar_y ) );
                 DPOINT dev_to = userToDeviceSize( wxSize( pos_pairs[i + 1], overbar_y ) );
-                fprintf( workFile, "%g %g m %g %g l ",
-                        dev_from.x, dev_from.y, dev_to.x, dev_to.y );
+                PlotPrintf( workFile, "%g %g m %g %g l ",
+                           dev_from.x, dev_from.y, dev_to.x, dev_to.y );
             }
         }
 
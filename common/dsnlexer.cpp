@@ -54,22 +54,8 @@ void DSNLEXER::init()
 
     curOffset = 0;
 
-#if 1
-    if( keywordCount > 11 )
-    {
-        // resize the hashtable bucket count
-        keyword_hash.reserve( keywordCount );
-    }
-
-    // fill the specialized "C string" hashtable from keywords[]
-    const KEYWORD*  it  = keywords;
-    const KEYWORD*  end = it + keywordCount;
-
-    for( ; it < end; ++it )
-    {
-        keyword_hash[it->name] = it->token;
-    }
-#endif
+    // keyword_hash is only filled on first use, since the lexers generated by
+    // TokenList2DsnLexer.cmake provide a perfect hash of their keywords instead.
 }
 
 
@@ -81,7 +67,8 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordIndex( NULL )
 {
     FILE_LINE_READER* fileReader = new FILE_LINE_READER( aFile, aFilename );
     PushReader( fileReader );
@@ -97,7 +84,8 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordIndex( NULL )
 {
     STRING_LINE_READER* stringReader = new STRING_LINE_READER( aClipboardTxt, aSource.IsEmpty() ?
                                         wxString( FMT_CLIPBOARD ) : aSource );
@@ -114,7 +102,8 @@ DSNLEXER::DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
     limit( NULL ),
     reader( NULL ),
     keywords( aKeywordTable ),
-    keywordCount( aKeywordCount )
+    keywordCount( aKeywordCount ),
+    keywordIndex( NULL )
 {
     if( aLineReader )
         PushReader( aLineReader );
@@ -131,7 +120,8 @@ DSNLEXER::DSNLEXER( const std::string& aSExpression, const wxString& aSource ) :
     limit( NULL ),
     reader( NULL ),
     keywords( empty_keywords ),
-    keywordCount( 0 )
+    keywordCount( 0 ),
+    keywordIndex( NULL )
 {
     STRING_LINE_READER* stringReader = new STRING_LINE_READER( aSExpression, aSource.IsEmpty() ?
                                         wxString( FMT_CLIPBOARD ) : aSource );
@@ -260,6 +250,46 @@ int DSNLEXER::findToken( const std::string& tok )
 
 inline int DSNLEXER::findToken( const std::string& tok )
 {
+    if( keywordIndex )
+    {
+        // Same FNV-1a hash as the one computed by TokenList2DsnLexer.cmake
+        unsigned hash = 2166136261u;
+
+        for( std::string::const_iterator it = tok.begin(), end = tok.end();  it != end;  ++it )
+        {
+            hash ^= (unsigned char) *it;
+            hash *= 16777619;
+        }
+
+        unsigned displacement = keywordIndex->displacements[hash % keywordIndex->bucketCount];
+        unsigned slot = ( ( hash ^ displacement ) * 16777619u ) % keywordIndex->slotCount;
+        int      ndx  = keywordIndex->slots[slot];
+
+        // Any string falls in some slot: make sure it is the keyword stored there
+        if( ndx >= 0 && tok == keywords[ndx].name )
+            return keywords[ndx].token;
+
+        return DSN_SYMBOL;  // not a keyword, some arbitrary symbol.
+    }
+
+    if( keyword_hash.empty() && keywordCount )
+    {
+        if( keywordCount > 11 )
+        {
+            // resize the hashtable bucket count
+            keyword_hash.reserve( keywordCount );
+        }
+
+        // fill the specialized "C string" hashtable from keywords[]
+        const KEYWORD*  it  = keywords;
+        const KEYWORD*  end = it + keywordCount;
+
+        for( ; it < end; ++it )
+        {
+            keyword_hash[it->name] = it->token;
+        }
+    }
+
     KEYWORD_MAP::const_iterator it = keyword_hash.find( tok.c_str() );
     if( it != keyword_hash.end() )
         return it->second;
@@ -541,6 +571,56 @@ static bool isNumber( const char* cp, const char* limit )
 }
 
 
+bool DSNLEXER::ParseDecimal( const char* aText, double* aValue )
+{
+    // The powers of ten are exact in a double up to 1e22
+    static const double pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+        1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+    };
+
+    const char* cp = aText;
+    bool        negative = false;
+
+    if( *cp == '-' || *cp == '+' )
+        negative = *cp++ == '-';
+
+    // With at most 15 digits, the mantissa is an exact integer in a double,
+    // so the single division below is correctly rounded, like strtod().
+    double  mantissa = 0.0;
+    int     digitCount = 0;
+    int     fractionDigits = 0;
+
+    while( isDigit( *cp ) )
+    {
+        mantissa = mantissa * 10.0 + ( *cp++ - '0' );
+        ++digitCount;
+    }
+
+    if( *cp == '.' )
+    {
+        ++cp;
+
+        while( isDigit( *cp ) )
+        {
+            mantissa = mantissa * 10.0 + ( *cp++ - '0' );
+            ++digitCount;
+            ++fractionDigits;
+        }
+    }
+
+    if( *cp || digitCount == 0 || digitCount > 15 )
+        return false;
+
+    if( fractionDigits )
+        mantissa /= pow10[fractionDigits];
+
+    *aValue = negative ? -mantissa : mantissa;
+
+    return true;
+}
+
+
 int DSNLEXER::NextTok() throw( IO_ERROR )
 {
     const char*   cur  = next;
@@ -780,14 +860,14 @@ L_read:
         }
     }           // specctraMode
 
-    // non-quoted token, read it into curText.
-    curText.clear();
-
+    // non-quoted token, read it into curText in one copy.
     head = cur;
     while( head<limit && !isSep( *head ) )
-        curText += *head++;
+        ++head;
+
+    curText.assign( cur, head );
 
-    if( isNumber( curText.c_str(), curText.c_str() + curText.size() ) )
+    if( isNumber( cur, head ) )
     {
         curTok = DSN_NUMBER;
         goto exit;
@@ -812,6 +892,97 @@ exit:   // single point of exit, no returns elsewhere please.
 }
 
 
+void DSNLEXER::ReadListText( std::string& aText ) throw( IO_ERROR )
+{
+    wxASSERT( !specctraMode && prevTok == DSN_LEFT );
+
+    const char* cur = start + curOffset;
+    int         depth = 0;
+
+    // Find the opening parenthesis, which may be on a previous line
+    while( cur > start && isSpace( cur[-1] ) )
+        --cur;
+
+    if( cur > start && cur[-1] == '(' )
+    {
+        --cur;
+        aText.assign( cur - start, ' ' );
+    }
+    else
+    {
+        aText.assign( curOffset > 0 ? curOffset - 1 : 0, ' ' );
+        aText += '(';
+        cur = start + curOffset;
+        depth = 1;
+    }
+
+    const char* segment = cur;
+
+    for( ;; )
+    {
+        if( cur >= limit )
+        {
+            aText.append( segment, limit );
+
+            if( readLine() == 0 )
+            {
+                curTok = DSN_EOF;
+                curOffset = 0;
+                Expecting( DSN_RIGHT );
+            }
+
+            cur = segment = start;
+
+            while( cur < limit && isSpace( *cur ) )
+                ++cur;
+
+            // A comment line is copied as is, its parenthesis do not count
+            if( cur < limit && *cur == '#' )
+                cur = limit;
+
+            continue;
+        }
+
+        if( *cur == '(' )
+        {
+            ++depth;
+        }
+        else if( *cur == ')' )
+        {
+            if( --depth == 0 )
+                break;
+        }
+        else if( *cur == stringDelimiter )
+        {
+            const char* quote = cur;
+
+            for( ++cur; cur < limit && *cur != stringDelimiter; ++cur )
+            {
+                if( *cur == '\\' )
+                    ++cur;
+            }
+
+            if( cur >= limit )
+            {
+                curOffset = quote - start;
+                wxString errtxt( _( "Un-terminated delimited string" ) );
+                THROW_PARSE_ERROR( errtxt, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+            }
+        }
+
+        ++cur;
+    }
+
+    aText.append( segment, cur + 1 );
+
+    prevTok   = curTok;
+    curTok    = DSN_RIGHT;
+    curText   = ')';
+    curOffset = cur - start;
+    next      = cur + 1;
+}
+
+
 wxArrayString* DSNLEXER::ReadCommentLines() throw( IO_ERROR )
 {
     wxArrayString*  ret = 0;
@@ -27,6 +27,8 @@
  * @brief Implementation of base KiCad text object.
  */
 
+#include <boost/thread/tss.hpp>
+
 #include <eda_text.h>
 #include <drawtxt.h>
 #include <macros.h>
@@ -462,8 +464,14 @@ void EDA_TEXT::Format( OUTPUTFORMATTER* aFormatter, int aNestLevel, int aControl
 // Convert the text shape to a list of segment
 // each segment is stored as 2 wxPoints: its starting point and its ending point
 // we are using DrawGraphicText to create the segments.
-// and therefore a call-back function is needed
-static std::vector<wxPoint>* s_cornerBuffer;
+// and therefore a call-back function is needed.
+// Texts are converted by several plot threads at once, so each thread has its own buffer.
+// The buffer is owned by the caller of TransformTextShapeToSegmentList().
+static void keepCornerBuffer( std::vector<wxPoint>* aBuffer )
+{
+}
+
+static boost::thread_specific_ptr< std::vector<wxPoint> > s_cornerBuffer( keepCornerBuffer );
 
 // This is a call back function, used by DrawGraphicText to put each segment in buffer
 static void addTextSegmToBuffer( int x0, int y0, int xf, int yf )
@@ -479,7 +487,7 @@ void EDA_TEXT::TransformTextShapeToSegmentList( std::vector<wxPoint>& aCornerBuf
     if( IsMirrored() )
         size.x = -size.x;
 
-    s_cornerBuffer = &aCornerBuffer;
+    s_cornerBuffer.reset( &aCornerBuffer );
     EDA_COLOR_T color = BLACK;  // not actually used, but needed by DrawGraphicText
 
     if( IsMultilineAllowed() )
@@ -508,4 +516,6 @@ void EDA_TEXT::TransformTextShapeToSegmentList( std::vector<wxPoint>& aCornerBuf
                          GetThickness(), IsItalic(),
                          true, addTextSegmToBuffer );
     }
+
+    s_cornerBuffer.reset();
 }
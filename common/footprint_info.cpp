@@ -45,7 +45,13 @@
 #include <fp_lib_table.h>
 #include <fpid.h>
 #include <class_module.h>
-#include <boost/thread.hpp>
+#include <thread_pool.h>
+#include <boost/bind.hpp>
+#include <wx/filename.h>
+#include <wx/file.h>
+#include <wx/progdlg.h>
+#include <set>
+#include <algorithm>
 
 
 /*
@@ -115,13 +121,6 @@ void FOOTPRINT_INFO::load()
 }
 
 
-#define JOBZ                6       // no. libraries per worker thread.  It takes about
-                                    // a second to load a GITHUB library, so assigning
-                                    // this no. libraries to each thread should give a little
-                                    // over this no. seconds total time if the original delay
-                                    // were caused by latencies alone.
-                                    // (If https://github.com does not mind.)
-
 #define NTOLERABLE_ERRORS   4       // max errors before aborting, although threads
                                     // in progress will still pile on for a bit.  e.g. if 9 threads
                                     // expect 9 greater than this.
@@ -139,14 +138,7 @@ void FOOTPRINT_LIST::loader_job( const wxString* aNicknameList, int aJobZ )
 
         try
         {
-            wxArrayString fpnames = m_lib_table->FootprintEnumerate( nickname );
-
-            for( unsigned ni=0;  ni<fpnames.GetCount();  ++ni )
-            {
-                FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO( this, nickname, fpnames[ni] );
-
-                addItem( fpinfo );
-            }
+            loadLibrary( nickname );
         }
         catch( const PARSE_ERROR& pe )
         {
@@ -187,6 +179,324 @@ void FOOTPRINT_LIST::loader_job( const wxString* aNicknameList, int aJobZ )
 }
 
 
+void FOOTPRINT_LIST::loadLibrary( const wxString& aNickname )
+{
+    size_t  timestamp = m_lib_table->FootprintLibTimestamp( aNickname );
+    LIB_KEY key( aNickname, m_lib_table->FindRow( aNickname )->GetFullURI( true ) );
+
+    if( timestamp )
+    {
+        MUTLOCK lock( m_cache_lock );
+
+        LIB_CACHE::const_iterator it = m_cache.find( key );
+
+        if( it != m_cache.end() && it->second.timestamp == timestamp )
+        {
+            const std::vector<CACHED_FOOTPRINT>& footprints = it->second.footprints;
+
+            for( unsigned ni = 0;  ni < footprints.size();  ++ni )
+            {
+                const CACHED_FOOTPRINT& fp = footprints[ni];
+
+                addItem( new FOOTPRINT_INFO( this, aNickname, fp.name, fp.doc, fp.keywords,
+                                             fp.padCount ) );
+            }
+
+            return;
+        }
+    }
+
+    wxArrayString   fpnames = m_lib_table->FootprintEnumerate( aNickname );
+    CACHED_LIBRARY  library;
+    bool            cacheable = timestamp != 0;
+
+    library.timestamp = timestamp;
+
+    for( unsigned ni=0;  ni<fpnames.GetCount();  ++ni )
+    {
+        FOOTPRINT_INFO* fpinfo = new FOOTPRINT_INFO( this, aNickname, fpnames[ni] );
+
+        addItem( fpinfo );
+
+        // A footprint which could not be loaded is retried next time
+        if( !cacheable || !fpinfo->IsLoaded() )
+        {
+            cacheable = false;
+            continue;
+        }
+
+        CACHED_FOOTPRINT fp;
+
+        fp.name     = fpinfo->GetFootprintName();
+        fp.doc      = fpinfo->GetDoc();
+        fp.keywords = fpinfo->GetKeywords();
+        fp.padCount = fpinfo->GetPadCount();
+
+        library.footprints.push_back( fp );
+    }
+
+    if( cacheable )
+    {
+        MUTLOCK lock( m_cache_lock );
+
+        m_cache[key] = library;
+        m_cache_modified = true;
+    }
+}
+
+
+/*
+ * The footprint info cache file is a binary file, only meant to be read by the
+ * program which wrote it:
+ *
+ *  header      FP_INFO_CACHE_HEADER, followed by sizeof( size_t ) as a byte
+ *  count       number of libraries
+ *  libraries   nickname, full URI, timestamp, number of footprints, and for each
+ *              footprint its name, doc, keywords and pad count
+ *
+ * Strings are UTF8, preceded by their length.  Integers are little endian, 4 bytes
+ * long, except the timestamps which are sizeof( size_t ) bytes long.
+ */
+
+static const char FP_INFO_CACHE_HEADER[] = "KiCad footprint info cache 2\n";
+
+
+static wxString cacheFileName()
+{
+    return wxFileName( GetKicadConfigPath(), wxT( "fp-info-cache" ) ).GetFullPath();
+}
+
+
+static void writeInt( std::string& aOut, size_t aValue, unsigned aSize = 4 )
+{
+    for( unsigned i = 0; i < aSize; ++i )
+        aOut += (char) ( ( aValue >> ( 8 * i ) ) & 0xFF );
+}
+
+
+static void writeString( std::string& aOut, const wxString& aText )
+{
+    std::string utf8 = TO_UTF8( aText );
+
+    writeInt( aOut, utf8.size() );
+    aOut += utf8;
+}
+
+
+/**
+ * Struct CACHE_READER
+ * reads the fields of the footprint info cache file from its content, and remembers if
+ * the content was too short.
+ */
+struct CACHE_READER
+{
+    const char* m_next;
+    const char* m_end;
+    bool        m_ok;
+
+    CACHE_READER( const std::string& aContent ) :
+        m_next( aContent.data() ),
+        m_end( aContent.data() + aContent.size() ),
+        m_ok( true )
+    {
+    }
+
+    size_t ReadInt( unsigned aSize = 4 )
+    {
+        size_t value = 0;
+
+        if( m_end - m_next < (ptrdiff_t) aSize )
+        {
+            m_ok = false;
+            return 0;
+        }
+
+        for( unsigned i = 0; i < aSize; ++i )
+            value |= (size_t) (unsigned char) *m_next++ << ( 8 * i );
+
+        return value;
+    }
+
+    wxString ReadString()
+    {
+        size_t len = ReadInt();
+
+        if( !m_ok || m_end - m_next < (ptrdiff_t) len )
+        {
+            m_ok = false;
+            return wxEmptyString;
+        }
+
+        wxString text = wxString::FromUTF8( m_next, len );
+        m_next += len;
+
+        return text;
+    }
+};
+
+
+void FOOTPRINT_LIST::readCache()
+{
+    m_cache.clear();
+    m_cache_modified = false;
+
+    FILE* fp = wxFopen( cacheFileName(), wxT( "rb" ) );
+
+    if( !fp )
+        return;
+
+    // Read the whole file at once
+    std::string content;
+
+    if( fseek( fp, 0, SEEK_END ) == 0 )
+    {
+        long size = ftell( fp );
+
+        if( size > 0 )
+        {
+            content.resize( size );
+            rewind( fp );
+
+            if( fread( &content[0], 1, size, fp ) != (size_t) size )
+                content.clear();
+        }
+    }
+
+    fclose( fp );
+
+    std::string header( FP_INFO_CACHE_HEADER );
+
+    header += (char) sizeof( size_t );
+
+    if( content.compare( 0, header.size(), header ) != 0 )
+        return;
+
+    CACHE_READER    reader( content.substr( header.size() ) );
+    LIB_CACHE       cache;
+    unsigned        libCount = reader.ReadInt();
+
+    for( unsigned i = 0; i < libCount && reader.m_ok; ++i )
+    {
+        wxString        nickname = reader.ReadString();
+        wxString        uri = reader.ReadString();
+        CACHED_LIBRARY& library  = cache[LIB_KEY( nickname, uri )];
+
+        library.timestamp = reader.ReadInt( sizeof( size_t ) );
+
+        unsigned fpCount = reader.ReadInt();
+
+        for( unsigned ni = 0; ni < fpCount && reader.m_ok; ++ni )
+        {
+            CACHED_FOOTPRINT fp;
+
+            fp.name     = reader.ReadString();
+            fp.doc      = reader.ReadString();
+            fp.keywords = reader.ReadString();
+            fp.padCount = reader.ReadInt();
+
+            library.footprints.push_back( fp );
+        }
+    }
+
+    // Use nothing from a truncated file
+    if( reader.m_ok )
+        m_cache.swap( cache );
+}
+
+
+void FOOTPRINT_LIST::writeCache()
+{
+    std::string content( FP_INFO_CACHE_HEADER );
+
+    content += (char) sizeof( size_t );
+
+    writeInt( content, m_cache.size() );
+
+    for( LIB_CACHE::const_iterator it = m_cache.begin();  it != m_cache.end();  ++it )
+    {
+        const std::vector<CACHED_FOOTPRINT>& footprints = it->second.footprints;
+
+        writeString( content, it->first.first );
+        writeString( content, it->first.second );
+        writeInt( content, it->second.timestamp, sizeof( size_t ) );
+        writeInt( content, footprints.size() );
+
+        for( unsigned ni = 0;  ni < footprints.size();  ++ni )
+        {
+            writeString( content, footprints[ni].name );
+            writeString( content, footprints[ni].doc );
+            writeString( content, footprints[ni].keywords );
+            writeInt( content, footprints[ni].padCount );
+        }
+    }
+
+    // Write a uniquely named temporary file and rename it, so that other running
+    // instances never read a partially written cache, nor write the same temporary file.
+    wxString    fileName = cacheFileName();
+    wxFile      file;
+    wxString    tempFileName = wxFileName::CreateTempFileName( fileName, &file );
+
+    if( tempFileName.IsEmpty() )
+        return;
+
+    bool ok = file.Write( content.data(), content.size() ) == content.size();
+
+    ok = file.Close() && ok;
+
+    if( !ok || !wxRenameFile( tempFileName, fileName, true ) )
+        wxRemoveFile( tempFileName );
+
+    m_cache_modified = false;
+}
+
+
+void FOOTPRINT_LIST::pruneCache()
+{
+    std::vector< wxString > nicknames = m_lib_table->GetLogicalLibs();
+    std::set< LIB_KEY >     current;
+
+    for( unsigned i = 0; i < nicknames.size(); ++i )
+    {
+        try
+        {
+            const FP_LIB_TABLE::ROW* row = m_lib_table->FindRow( nicknames[i] );
+
+            current.insert( LIB_KEY( nicknames[i], row->GetFullURI( true ) ) );
+        }
+        catch( const IO_ERROR& )
+        {
+        }
+    }
+
+    for( LIB_CACHE::iterator it = m_cache.begin();  it != m_cache.end(); )
+    {
+        if( current.find( it->first ) == current.end() )
+        {
+            m_cache.erase( it++ );
+            m_cache_modified = true;
+        }
+        else
+            ++it;
+    }
+}
+
+
+bool FOOTPRINT_LIST::loader_progress( unsigned aDone, unsigned aTotal )
+{
+    if( m_progress_dialog && aTotal )
+    {
+        int         value = (int) ( (double) aDone * m_progress_dialog->GetRange() / aTotal );
+        wxString    msg = wxString::Format( _( "Reading footprint library %u of %u..." ),
+                                            std::min( aDone + 1, aTotal ), aTotal );
+
+        if( !m_progress_dialog->Update( value, msg ) )
+            return false;   // Cancelled by the user
+    }
+
+    return m_error_count < NTOLERABLE_ERRORS;
+}
+
+
 bool FOOTPRINT_LIST::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* aNickname )
 {
     bool retv = true;
@@ -198,6 +508,8 @@ bool FOOTPRINT_LIST::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* a
     m_errors.clear();
     m_list.clear();
 
+    readCache();
+
     if( aNickname )
         // single footprint
         loader_job( aNickname, 1 );
@@ -220,48 +532,15 @@ bool FOOTPRINT_LIST::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* a
         // none of them.
         LOCALE_IO   top_most_nesting;
 
-        // Something which will not invoke a thread copy constructor, one of many ways obviously:
-        typedef boost::ptr_vector< boost::thread >  MYTHREADS;
-
-        MYTHREADS threads;
+        // One task per library, so that the workers which are done with small libraries
+        // take the remaining ones while a big library is being loaded.
+        THREAD_POOL pool;
 
-        // Give each thread JOBZ nicknames to process.  The last portion of, or if the entire
-        // size() is small, I'll do myself.
-        for( unsigned i=0; i<nicknames.size();  )
-        {
-            if( m_error_count >= NTOLERABLE_ERRORS )
-            {
-                // abort the remaining nicknames.
-                retv = false;
-                break;
-            }
-
-            int jobz = JOBZ;
-
-            if( i + jobz >= nicknames.size() )
-            {
-                jobz = nicknames.size() - i;
+        for( unsigned i=0; i<nicknames.size(); ++i )
+            pool.Submit( boost::bind( &FOOTPRINT_LIST::loader_job, this, &nicknames[i], 1 ) );
 
-                // Only a little bit to do, I'll do it myself, on current thread.
-                loader_job( &nicknames[i], jobz );
-            }
-            else
-            {
-                // Delegate the job to a worker thread created here.
-                threads.push_back( new boost::thread( &FOOTPRINT_LIST::loader_job,
-                        this, &nicknames[i], jobz ) );
-            }
-
-            i += jobz;
-        }
-
-        // Wait for all the worker threads to complete, it does not matter in what order
-        // we wait for them as long as a full sweep is made.  Think of the great race,
-        // everyone must finish.
-        for( unsigned i=0;  i<threads.size();  ++i )
-        {
-            threads[i].join();
-        }
+        // Abort the remaining nicknames after too many errors.
+        retv = pool.Wait( boost::bind( &FOOTPRINT_LIST::loader_progress, this, _1, _2 ) );
 #else
         loader_job( &nicknames[0], nicknames.size() );
 #endif
@@ -269,6 +548,11 @@ bool FOOTPRINT_LIST::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* a
         m_list.sort();
     }
 
+    pruneCache();
+
+    if( m_cache_modified )
+        writeCache();
+
     // The result of this function can be a blend of successes and failures, whose
     // mix is given by the Count()s of the two lists.  The return value indicates whether
     // an abort occurred, even true does not necessarily mean full success, although
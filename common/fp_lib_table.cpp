@@ -151,6 +151,14 @@ wxArrayString FP_LIB_TABLE::FootprintEnumerate( const wxString& aNickname )
 }
 
 
+size_t FP_LIB_TABLE::FootprintLibTimestamp( const wxString& aNickname )
+{
+    const ROW* row = FindRow( aNickname );
+    wxASSERT( (PLUGIN*) row->plugin );
+    return row->plugin->FootprintLibTimestamp( row->GetFullURI( true ) );
+}
+
+
 MODULE* FP_LIB_TABLE::FootprintLoad( const wxString& aNickname, const wxString& aFootprintName )
 {
     const ROW* row = FindRow( aNickname );
@@ -0,0 +1,611 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file plot_printf.cpp
+ * @brief Locale independent printf() used by the plotters.
+ */
+
+#include <plot_printf.h>
+
+#include <algorithm>
+#include <assert.h>
+#include <ctype.h>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+
+/// Exact powers of 10 representable by a double
+static const double pow10Table[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/// Values below this limit are converted with 64 bits integers, without any rounding
+/// error other than the scaling by a power of 10.
+static const double maxExactInteger = 9007199254740992.0;     // 2^53
+
+
+/**
+ * Class OUTPUT
+ * accumulates the formatted text, and sends it either to a file or to a buffer.
+ */
+class OUTPUT
+{
+public:
+    OUTPUT( FILE* aFile ) :
+        m_file( aFile ), m_dest( NULL ), m_destSize( 0 ), m_count( 0 ), m_used( 0 )
+    {
+    }
+
+    OUTPUT( char* aDest, size_t aDestSize ) :
+        m_file( NULL ), m_dest( aDest ), m_destSize( aDestSize ), m_count( 0 ), m_used( 0 )
+    {
+    }
+
+    void Put( char aChar )
+    {
+        if( m_used == sizeof( m_buffer ) )
+            Flush();
+
+        m_buffer[m_used++] = aChar;
+    }
+
+    void Put( const char* aText, size_t aLength )
+    {
+        if( m_used + aLength > sizeof( m_buffer ) )
+        {
+            Flush();
+
+            if( aLength > sizeof( m_buffer ) )
+            {
+                write( aText, aLength );
+                return;
+            }
+        }
+
+        memcpy( m_buffer + m_used, aText, aLength );
+        m_used += aLength;
+    }
+
+    void Fill( char aChar, int aCount )
+    {
+        while( aCount-- > 0 )
+            Put( aChar );
+    }
+
+    /// Sends the buffered text, and terminates the destination string
+    int Flush()
+    {
+        write( m_buffer, m_used );
+        m_used = 0;
+
+        if( m_dest && m_destSize )
+            m_dest[ std::min( m_count, m_destSize - 1 ) ] = 0;
+
+        return (int) m_count;
+    }
+
+private:
+    void write( const char* aText, size_t aLength )
+    {
+        if( m_file )
+        {
+            fwrite( aText, 1, aLength, m_file );
+        }
+        else if( m_dest && m_count + 1 < m_destSize )
+        {
+            size_t len = std::min( aLength, m_destSize - 1 - m_count );
+            memcpy( m_dest + m_count, aText, len );
+        }
+
+        m_count += aLength;
+    }
+
+    FILE*   m_file;
+    char*   m_dest;
+    size_t  m_destSize;
+    size_t  m_count;            ///< count of chars written, or which would have been
+    size_t  m_used;
+    char    m_buffer[512];
+};
+
+
+/**
+ * Function formatUnsigned
+ * writes the digits of aValue, ending at aEnd (excluded).
+ * @return the count of digits, at least aMinDigits
+ */
+static int formatUnsigned( char* aEnd, uint64_t aValue, int aBase, bool aUpper,
+                           int aMinDigits = 1 )
+{
+    const char* digits = aUpper ? "0123456789ABCDEF" : "0123456789abcdef";
+    char* p = aEnd;
+
+    while( aValue )
+    {
+        *--p = digits[aValue % aBase];
+        aValue /= aBase;
+    }
+
+    while( aEnd - p < aMinDigits )
+        *--p = '0';
+
+    return aEnd - p;
+}
+
+
+/**
+ * Function scaleRound
+ * computes round( aValue * 10^aExponent ), or returns false if it cannot be done exactly
+ * enough with a double and a 64 bits integer.
+ * The rounding is done on the exact product, not on the rounded double product, and the
+ * ties are rounded to even, like the C library does.
+ */
+static bool scaleRound( double aValue, int aExponent, uint64_t* aResult )
+{
+    double scaled;
+    double error;       // sign of ( exact product - scaled )
+
+    if( aExponent >= 0 && aExponent <= 22 )
+    {
+        scaled = aValue * pow10Table[aExponent];
+        error = fma( aValue, pow10Table[aExponent], -scaled );
+    }
+    else if( aExponent < 0 && aExponent >= -22 )
+    {
+        scaled = aValue / pow10Table[-aExponent];
+        error = -fma( scaled, pow10Table[-aExponent], -aValue );
+    }
+    else
+    {
+        return false;
+    }
+
+    if( scaled >= maxExactInteger / 2 )
+        return false;
+
+    double integer = floor( scaled );
+    double fraction = scaled - integer;       // exact, as scaled < 2^52
+
+    uint64_t result = (uint64_t) integer;
+
+    if( fraction > 0.5 || ( fraction == 0.5 && ( error > 0 || ( error == 0 && ( result & 1 ) ) ) ) )
+        result++;
+
+    *aResult = result;
+    return true;
+}
+
+
+/**
+ * Function formatFixed
+ * writes the positive value aValue in the style of "%.<aPrecision>f".
+ * @return the count of chars written in aOut, or -1 if aValue is out of range
+ */
+static int formatFixed( char* aOut, double aValue, int aPrecision, bool aAlternate )
+{
+    uint64_t scaled;
+
+    if( aPrecision > 22 || !scaleRound( aValue, aPrecision, &scaled ) )
+        return -1;
+
+    char digits[32];
+    char* end = digits + sizeof( digits );
+    int count = formatUnsigned( end, scaled, 10, false, aPrecision + 1 );
+    const char* first = end - count;
+    int intDigits = count - aPrecision;
+    char* p = aOut;
+
+    memcpy( p, first, intDigits );
+    p += intDigits;
+
+    if( aPrecision > 0 || aAlternate )
+        *p++ = '.';
+
+    memcpy( p, first + intDigits, aPrecision );
+    p += aPrecision;
+
+    return p - aOut;
+}
+
+
+/**
+ * Function formatGeneral
+ * writes the positive value aValue in the style of "%.<aPrecision>g".
+ * @return the count of chars written in aOut, or -1 if aValue is out of range
+ */
+static int formatGeneral( char* aOut, double aValue, int aPrecision, bool aAlternate )
+{
+    if( aPrecision < 0 )
+        aPrecision = 6;
+    else if( aPrecision == 0 )
+        aPrecision = 1;
+
+    if( aPrecision > 17 )
+        return -1;
+
+    uint64_t scaled = 0;
+    int exponent = 0;
+
+    if( aValue != 0.0 )
+    {
+        exponent = (int) floor( log10( aValue ) );
+
+        if( !scaleRound( aValue, aPrecision - 1 - exponent, &scaled ) )
+            return -1;
+
+        // The rounding can carry to an other digit, and log10() can be slightly off
+        if( scaled >= (uint64_t) pow10Table[aPrecision] )
+        {
+            exponent++;
+
+            if( !scaleRound( aValue, aPrecision - 1 - exponent, &scaled ) )
+                return -1;
+        }
+        else if( scaled < (uint64_t) pow10Table[aPrecision - 1] )
+        {
+            exponent--;
+
+            if( !scaleRound( aValue, aPrecision - 1 - exponent, &scaled ) )
+                return -1;
+        }
+    }
+
+    char digits[32];
+    char* end = digits + sizeof( digits );
+    formatUnsigned( end, scaled, 10, false, aPrecision );
+    const char* first = end - aPrecision;
+
+    // Count of significant digits, without the trailing zeros
+    int significant = aPrecision;
+
+    if( !aAlternate )
+    {
+        while( significant > 1 && first[significant - 1] == '0' )
+            significant--;
+    }
+
+    char* p = aOut;
+
+    if( exponent < -4 || exponent >= aPrecision )
+    {
+        *p++ = first[0];
+
+        if( significant > 1 || aAlternate )
+            *p++ = '.';
+
+        memcpy( p, first + 1, significant - 1 );
+        p += significant - 1;
+
+        *p++ = 'e';
+        *p++ = exponent < 0 ? '-' : '+';
+
+        char expDigits[8];
+        int expCount = formatUnsigned( expDigits + sizeof( expDigits ),
+                                       exponent < 0 ? -exponent : exponent, 10, false, 2 );
+        memcpy( p, expDigits + sizeof( expDigits ) - expCount, expCount );
+        p += expCount;
+    }
+    else if( exponent >= 0 )
+    {
+        int intDigits = exponent + 1;
+
+        memcpy( p, first, intDigits );
+        p += intDigits;
+
+        if( significant > intDigits || aAlternate )
+            *p++ = '.';
+
+        if( significant > intDigits )
+        {
+            memcpy( p, first + intDigits, significant - intDigits );
+            p += significant - intDigits;
+        }
+    }
+    else
+    {
+        *p++ = '0';
+        *p++ = '.';
+
+        for( int ii = exponent + 1; ii < 0; ii++ )
+            *p++ = '0';
+
+        memcpy( p, first, significant );
+        p += significant;
+    }
+
+    return p - aOut;
+}
+
+
+/**
+ * Function formatDouble
+ * writes aValue (without sign) for the 'f', 'F', 'g', 'G', 'e' or 'E' conversion.
+ * @return the count of chars written in aOut (which must have 350 chars)
+ */
+static int formatDouble( char* aOut, double aValue, char aConversion, int aPrecision,
+                         bool aAlternate )
+{
+    bool upper = isupper( aConversion );
+
+    if( aValue != aValue )
+    {
+        strcpy( aOut, upper ? "NAN" : "nan" );
+        return 3;
+    }
+
+    if( aValue > DBL_MAX )
+    {
+        strcpy( aOut, upper ? "INF" : "inf" );
+        return 3;
+    }
+
+    int len = -1;
+
+    if( aConversion == 'f' || aConversion == 'F' )
+        len = formatFixed( aOut, aValue, aPrecision < 0 ? 6 : aPrecision, aAlternate );
+    else if( aConversion == 'g' )
+        len = formatGeneral( aOut, aValue, aPrecision, aAlternate );
+
+    if( len >= 0 )
+        return len;
+
+    // Out of the range of the fast conversion, or 'e', 'E', 'G': use the C library,
+    // and fix the decimal separator of the current locale
+    char fmt[8];
+    strcpy( fmt, aAlternate ? "%#.*f" : "%.*f" );
+    fmt[strlen( fmt ) - 1] = aConversion;
+
+    len = snprintf( aOut, 350, fmt, aPrecision < 0 ? 6 : aPrecision, aValue );
+    len = std::min( len, 349 );
+
+    for( int ii = 0; ii < len; ii++ )
+    {
+        if( aOut[ii] == ',' )
+            aOut[ii] = '.';
+    }
+
+    return len;
+}
+
+
+/**
+ * Function plotFormat
+ * is the formatting engine of PlotPrintf() and PlotSnprintf().
+ */
+static int plotFormat( OUTPUT& aOutput, const char* aFormat, va_list aArgs )
+{
+    const char* p = aFormat;
+
+    while( *p )
+    {
+        // Copy the plain text up to the next conversion
+        const char* start = p;
+
+        while( *p && *p != '%' )
+            p++;
+
+        if( p > start )
+            aOutput.Put( start, p - start );
+
+        if( !*p )
+            break;
+
+        const char* spec = p++;     // keep the conversion spec, for the unsupported ones
+
+        bool leftAlign = false;
+        bool zeroPad = false;
+        bool alternate = false;
+
+        for( ; ; p++ )
+        {
+            if( *p == '-' )
+                leftAlign = true;
+            else if( *p == '0' )
+                zeroPad = true;
+            else if( *p == '#' )
+                alternate = true;
+            else if( *p != '+' && *p != ' ' )
+                break;
+        }
+
+        int width = 0;
+
+        while( *p >= '0' && *p <= '9' )
+            width = width * 10 + *p++ - '0';
+
+        int precision = -1;
+
+        if( *p == '.' )
+        {
+            precision = 0;
+            p++;
+
+            while( *p >= '0' && *p <= '9' )
+                precision = precision * 10 + *p++ - '0';
+        }
+
+        bool isLong = false;
+
+        while( *p == 'l' || *p == 'h' )
+        {
+            isLong |= ( *p == 'l' );
+            p++;
+        }
+
+        char buffer[360];
+        char* end = buffer + sizeof( buffer );
+        const char* text = end;
+        int length = 0;
+        bool negative = false;
+        bool numeric = true;
+
+        switch( *p )
+        {
+        case 'd':
+        case 'i':
+        {
+            long value = isLong ? va_arg( aArgs, long ) : va_arg( aArgs, int );
+            uint64_t absValue = value < 0 ? -(uint64_t) value : value;
+
+            negative = value < 0;
+            length = formatUnsigned( end, absValue, 10, false, precision < 0 ? 1 : precision );
+            text = end - length;
+            break;
+        }
+
+        case 'u':
+        case 'x':
+        case 'X':
+        {
+            unsigned long value = isLong ? va_arg( aArgs, unsigned long )
+                                         : va_arg( aArgs, unsigned int );
+
+            length = formatUnsigned( end, value, *p == 'u' ? 10 : 16, *p == 'X',
+                                     precision < 0 ? 1 : precision );
+            text = end - length;
+            break;
+        }
+
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'e':
+        case 'E':
+        {
+            double value = va_arg( aArgs, double );
+
+            negative = value < 0 || ( value == 0.0 && 1.0 / value < 0 );
+            length = formatDouble( buffer, negative ? -value : value, *p, precision, alternate );
+            text = buffer;
+
+            // "nan" and "inf" are padded with spaces, like printf() does
+            numeric = value == value && fabs( value ) <= DBL_MAX;
+            break;
+        }
+
+        case 'c':
+            buffer[0] = (char) va_arg( aArgs, int );
+            text = buffer;
+            length = 1;
+            numeric = false;
+            break;
+
+        case 's':
+            text = va_arg( aArgs, const char* );
+
+            if( !text )
+                text = "(null)";
+
+            length = strlen( text );
+
+            if( precision >= 0 && precision < length )
+                length = precision;
+
+            numeric = false;
+            break;
+
+        case '%':
+            aOutput.Put( '%' );
+            p++;
+            continue;
+
+        default:
+            // Not supported: the argument of the conversion, if any, cannot be consumed,
+            // so the following conversions would use the wrong arguments.
+            assert( !"PlotPrintf(): unsupported conversion" );
+
+            // Write the conversion spec as it is
+            if( *p )
+                p++;
+
+            aOutput.Put( spec, p - spec );
+            continue;
+        }
+
+        p++;
+
+        int padding = width - length - ( negative ? 1 : 0 );
+
+        if( padding > 0 && !leftAlign && !( zeroPad && numeric ) )
+            aOutput.Fill( ' ', padding );
+
+        if( negative )
+            aOutput.Put( '-' );
+
+        if( padding > 0 && !leftAlign && zeroPad && numeric )
+            aOutput.Fill( '0', padding );
+
+        aOutput.Put( text, length );
+
+        if( padding > 0 && leftAlign )
+            aOutput.Fill( ' ', padding );
+    }
+
+    return aOutput.Flush();
+}
+
+
+int PlotVPrintf( FILE* aFile, const char* aFormat, va_list aArgs )
+{
+    OUTPUT output( aFile );
+
+    return plotFormat( output, aFormat, aArgs );
+}
+
+
+int PlotPrintf( FILE* aFile, const char* aFormat, ... )
+{
+    va_list args;
+
+    va_start( args, aFormat );
+    int ret = PlotVPrintf( aFile, aFormat, args );
+    va_end( args );
+
+    return ret;
+}
+
+
+int PlotSnprintf( char* aBuffer, size_t aSize, const char* aFormat, ... )
+{
+    OUTPUT  output( aBuffer, aSize );
+    va_list args;
+
+    va_start( args, aFormat );
+    int ret = plotFormat( output, aFormat, args );
+    va_end( args );
+
+    return ret;
+}
+
+
+void SetPlotFileBuffer( FILE* aFile )
+{
+    if( aFile )
+        setvbuf( aFile, NULL, _IOFBF, PLOT_FILE_BUFFER_SIZE );
+}
@@ -28,6 +28,13 @@
 
 #include <richio.h>
 
+#if defined( HAVE_MMAP )
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -264,14 +271,16 @@ char* FILE_LINE_READER::ReadLine() throw( IO_ERROR )
 }
 
 
-STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ) :
+STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                                        unsigned aStartingLineNumber ) :
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     lines( aString ),
     ndx( 0 )
 {
     // Clipboard text should be nice and _use multiple lines_ so that
     // we can report _line number_ oriented error messages when parsing.
-    source = aSource;
+    source  = aSource;
+    lineNum = aStartingLineNumber;
 }
 
 
@@ -362,6 +371,125 @@ char* INPUTSTREAM_LINE_READER::ReadLine() throw( IO_ERROR )
 }
 
 
+MAPPED_FILE_LINE_READER::MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber,
+            unsigned aMaxLineLength ) throw( IO_ERROR ) :
+    LINE_READER( aMaxLineLength ),
+    m_buffer( NULL ),
+    m_size( 0 ),
+    m_ndx( 0 ),
+    m_mapped( false )
+{
+    source  = aFileName;
+    lineNum = aStartingLineNumber;
+
+    wxString msg = wxString::Format(
+        _( "Unable to open filename '%s' for reading" ), aFileName.GetData() );
+
+#if defined( HAVE_MMAP )
+    int fd = open( aFileName.fn_str(), O_RDONLY );
+
+    if( fd < 0 )
+        THROW_IO_ERROR( msg );
+
+    struct stat st;
+
+    if( fstat( fd, &st ) != 0 )
+    {
+        close( fd );
+        THROW_IO_ERROR( msg );
+    }
+
+    m_size = st.st_size;
+
+    if( m_size )
+    {
+        void* addr = mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+        if( addr == MAP_FAILED )
+        {
+            close( fd );
+            THROW_IO_ERROR( msg );
+        }
+
+        madvise( addr, m_size, MADV_SEQUENTIAL );
+
+        m_buffer = (const char*) addr;
+        m_mapped = true;
+    }
+
+    // The mapping stays valid after the file is closed
+    close( fd );
+#else
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+        THROW_IO_ERROR( msg );
+
+    fseek( fp, 0, SEEK_END );
+    m_size = ftell( fp );
+    fseek( fp, 0, SEEK_SET );
+
+    if( m_size )
+    {
+        char* buffer = new char[m_size];
+
+        if( fread( buffer, 1, m_size, fp ) != m_size )
+        {
+            fclose( fp );
+            delete[] buffer;
+            THROW_IO_ERROR( msg );
+        }
+
+        m_buffer = buffer;
+    }
+
+    fclose( fp );
+#endif
+}
+
+
+MAPPED_FILE_LINE_READER::~MAPPED_FILE_LINE_READER()
+{
+#if defined( HAVE_MMAP )
+    if( m_mapped )
+        munmap( (void*) m_buffer, m_size );
+#else
+    delete[] m_buffer;
+#endif
+}
+
+
+char* MAPPED_FILE_LINE_READER::ReadLine() throw( IO_ERROR )
+{
+    // lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++lineNum;
+
+    const char* begin = m_buffer + m_ndx;
+    size_t      remaining = m_size - m_ndx;
+    const char* eol = remaining ? (const char*) memchr( begin, '\n', remaining ) : NULL;
+    size_t      len = eol ? eol - begin + 1 : remaining;
+
+    if( len >= maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    m_ndx += len;
+
+    if( len + 1 > capacity )
+    {
+        length = 0;             // nothing to keep when expanding
+        expandCapacity( len + 1 );
+    }
+
+    length = len;
+    memcpy( line, begin, length );
+    line[length] = 0;
+
+    return length ? line : NULL;
+}
+
+
 //-----<OUTPUTFORMATTER>----------------------------------------------------
 
 // factor out a common GetQuoteChar
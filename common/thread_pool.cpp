@@ -0,0 +1,304 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file thread_pool.cpp
+ */
+
+#include <algorithm>
+#include <boost/bind.hpp>
+
+#include <thread_pool.h>
+
+
+THREAD_POOL::THREAD_POOL( unsigned aThreadCount ) :
+    m_queued( 0 ),
+    m_unfinished( 0 ),
+    m_submitted( 0 ),
+    m_done( 0 ),
+    m_nextQueue( 0 ),
+    m_quit( false ),
+    m_cancelled( false )
+{
+    if( aThreadCount == 0 )
+        aThreadCount = std::max( 1u, boost::thread::hardware_concurrency() );
+
+    for( unsigned ii = 0; ii < aThreadCount; ++ii )
+        m_queues.push_back( new QUEUE );
+
+    // No task can be submitted before the constructor returns, so the workers
+    // do not look at m_threadIds while it is being filled.
+    for( unsigned ii = 0; ii < aThreadCount; ++ii )
+    {
+        boost::thread* thread = m_threads.create_thread(
+                boost::bind( &THREAD_POOL::worker, this, (int) ii ) );
+
+        m_threadIds.push_back( thread->get_id() );
+    }
+}
+
+
+THREAD_POOL::~THREAD_POOL()
+{
+    Cancel();
+
+    {
+        boost::mutex::scoped_lock lock( m_lock );
+        m_quit = true;
+    }
+
+    m_changed.notify_all();
+    m_threads.join_all();
+}
+
+
+void THREAD_POOL::Submit( const TASK& aTask )
+{
+    int index = currentWorker();
+
+    {
+        boost::mutex::scoped_lock lock( m_lock );
+
+        if( index < 0 )
+            index = m_nextQueue++ % m_queues.size();
+
+        {
+            boost::mutex::scoped_lock queueLock( m_queues[index].m_lock );
+            m_queues[index].m_tasks.push_back( aTask );
+        }
+
+        ++m_queued;
+        ++m_unfinished;
+        ++m_submitted;
+    }
+
+    m_changed.notify_all();
+}
+
+
+bool THREAD_POOL::Wait( const PROGRESS& aProgress )
+{
+    bool        helping  = aProgress.empty();
+    unsigned    reported = 0;
+    unsigned    done     = 0;
+    unsigned    total    = 0;
+
+    for( ;; )
+    {
+        TASK task;
+
+        if( helping && takeTask( -1, task ) )
+        {
+            runTask( task );
+            continue;
+        }
+
+        {
+            boost::mutex::scoped_lock lock( m_lock );
+
+            if( m_unfinished == 0 )
+                break;
+
+            // No task could be taken: the queued ones, if any, are being taken by the
+            // workers.  Each finished task wakes us up, so we never spin here.
+            m_changed.wait( lock );
+
+            done  = m_done;
+            total = m_submitted;
+        }
+
+        if( !helping && done != reported )
+        {
+            reported = done;
+
+            if( !aProgress( done, total ) )
+                Cancel();
+        }
+    }
+
+    boost::mutex::scoped_lock lock( m_lock );
+
+    if( !helping && m_done != reported )
+        aProgress( m_done, m_submitted );
+
+    bool completed = !m_cancelled;
+
+    m_cancelled = false;
+    m_submitted = 0;
+    m_done      = 0;
+
+    return completed;
+}
+
+
+void THREAD_POOL::Cancel()
+{
+    {
+        boost::mutex::scoped_lock lock( m_lock );
+        unsigned dropped = 0;
+
+        m_cancelled = true;
+
+        for( unsigned ii = 0; ii < m_queues.size(); ++ii )
+        {
+            boost::mutex::scoped_lock queueLock( m_queues[ii].m_lock );
+
+            dropped += m_queues[ii].m_tasks.size();
+            m_queues[ii].m_tasks.clear();
+        }
+
+        m_queued     -= dropped;
+        m_unfinished -= dropped;
+        m_done       += dropped;
+    }
+
+    m_changed.notify_all();
+}
+
+
+bool THREAD_POOL::IsCancelled()
+{
+    boost::mutex::scoped_lock lock( m_lock );
+    return m_cancelled;
+}
+
+
+unsigned THREAD_POOL::GetTaskCount()
+{
+    boost::mutex::scoped_lock lock( m_lock );
+    return m_submitted;
+}
+
+
+unsigned THREAD_POOL::GetDoneCount()
+{
+    boost::mutex::scoped_lock lock( m_lock );
+    return m_done;
+}
+
+
+void THREAD_POOL::worker( int aIndex )
+{
+    for( ;; )
+    {
+        {
+            boost::mutex::scoped_lock lock( m_lock );
+
+            while( m_queued == 0 && !m_quit )
+                m_changed.wait( lock );
+
+            if( m_quit )
+                return;
+        }
+
+        TASK task;
+
+        if( takeTask( aIndex, task ) )
+            runTask( task );
+    }
+}
+
+
+int THREAD_POOL::currentWorker() const
+{
+    boost::thread::id self = boost::this_thread::get_id();
+
+    for( unsigned ii = 0; ii < m_threadIds.size(); ++ii )
+    {
+        if( m_threadIds[ii] == self )
+            return ii;
+    }
+
+    return -1;
+}
+
+
+bool THREAD_POOL::takeTask( int aIndex, TASK& aTask )
+{
+    bool found = false;
+    int  count = m_queues.size();
+
+    // The newest task of our own queue is the most likely to use what is in our cache
+    if( aIndex >= 0 )
+    {
+        QUEUE& queue = m_queues[aIndex];
+        boost::mutex::scoped_lock queueLock( queue.m_lock );
+
+        if( !queue.m_tasks.empty() )
+        {
+            aTask = queue.m_tasks.back();
+            queue.m_tasks.pop_back();
+            found = true;
+        }
+    }
+
+    // Else steal the oldest task of another queue, which is likely to be the biggest one
+    for( int ii = 1; ii <= count && !found; ++ii )
+    {
+        int victim = ( std::max( aIndex, 0 ) + ii ) % count;
+
+        if( victim == aIndex )
+            continue;
+
+        QUEUE& queue = m_queues[victim];
+        boost::mutex::scoped_lock queueLock( queue.m_lock );
+
+        if( !queue.m_tasks.empty() )
+        {
+            aTask = queue.m_tasks.front();
+            queue.m_tasks.pop_front();
+            found = true;
+        }
+    }
+
+    if( found )
+    {
+        boost::mutex::scoped_lock lock( m_lock );
+        --m_queued;
+    }
+
+    return found;
+}
+
+
+void THREAD_POOL::runTask( const TASK& aTask )
+{
+    if( !IsCancelled() )
+    {
+        try
+        {
+            aTask();
+        }
+        catch( ... )
+        {
+        }
+    }
+
+    {
+        boost::mutex::scoped_lock lock( m_lock );
+        --m_unfinished;
+        ++m_done;
+    }
+
+    m_changed.notify_all();
+}
@@ -22,6 +22,7 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <map>
 #include <boost/foreach.hpp>
 
 #include <base_struct.h>
@@ -108,6 +109,51 @@ void VIEW::Add( VIEW_ITEM* aItem )
 }
 
 
+void VIEW::AddItems( const std::vector<VIEW_ITEM*>& aItems )
+{
+    std::map<int, std::vector<VIEW_ITEM*> > layerItems;
+    int layers[VIEW_MAX_LAYERS], layers_count;
+
+    for( unsigned j = 0; j < aItems.size(); ++j )
+    {
+        VIEW_ITEM* item = aItems[j];
+
+        item->ViewGetLayers( layers, layers_count );
+        item->saveLayers( layers, layers_count );
+
+        if( m_dynamic )
+            item->viewAssign( this );
+
+        for( int i = 0; i < layers_count; ++i )
+            layerItems[layers[i]].push_back( item );
+    }
+
+    for( std::map<int, std::vector<VIEW_ITEM*> >::const_iterator it = layerItems.begin();
+         it != layerItems.end(); ++it )
+    {
+        VIEW_LAYER& l = m_layers[it->first];
+
+        if( l.items->IsEmpty() )
+        {
+            l.items->BulkLoad( it->second );
+        }
+        else
+        {
+            for( unsigned j = 0; j < it->second.size(); ++j )
+                l.items->Insert( it->second[j] );
+        }
+
+        MarkTargetDirty( l.target );
+    }
+
+    // The layers and bounding boxes of the items are already indexed: a GEOMETRY or
+    // LAYERS update would remove and insert again each item, throwing away the packed
+    // trees.  The items are cached when they are drawn for the first time.
+    for( unsigned j = 0; j < aItems.size(); ++j )
+        aItems[j]->ViewUpdate( VIEW_ITEM::APPEARANCE | VIEW_ITEM::COLOR );
+}
+
+
 void VIEW::Remove( VIEW_ITEM* aItem )
 {
     if( m_dynamic )
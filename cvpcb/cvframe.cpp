@@ -27,6 +27,8 @@
  * @file cvframe.cpp
  */
 
+#include <wx/progdlg.h>
+
 #include <fctsys.h>
 #include <build_version.h>
 #include <kiway_express.h>
@@ -689,7 +691,14 @@ bool CVPCB_MAINFRAME::LoadFootprintFiles()
         return false;
     }
 
+    wxProgressDialog progressDialog( _( "Load Footprint Libraries" ),
+                                     _( "Reading footprint libraries..." ),
+                                     fptbl->GetLogicalLibs().size(), this,
+                                     wxPD_AUTO_HIDE | wxPD_CAN_ABORT | wxPD_APP_MODAL );
+
+    m_footprints.SetProgressDialog( &progressDialog );
     m_footprints.ReadFootprintFiles( fptbl );
+    m_footprints.SetProgressDialog( NULL );
 
     if( m_footprints.GetErrorCount() )
     {
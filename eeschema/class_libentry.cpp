@@ -84,6 +84,22 @@ LIB_ALIAS::LIB_ALIAS( const LIB_ALIAS& aAlias, LIB_PART* aRootPart ) :
 }
 
 
+LIB_PART* LIB_ALIAS::GetPart() const
+{
+    if( shared )
+        shared->ensureLoaded();
+
+    return shared;
+}
+
+
+int LIB_ALIAS::GetUnitCount() const
+{
+    // m_unitCount is read with the DEF line, before the deferred lines
+    return shared ? shared->GetUnitCount() : 1;
+}
+
+
 LIB_ALIAS::~LIB_ALIAS()
 {
     wxASSERT_MSG( shared, wxT( "~LIB_ALIAS() without a LIB_PART" ) );
@@ -213,6 +229,8 @@ LIB_PART::LIB_PART( LIB_PART& aPart, PART_LIB* aLibrary ) :
 {
     LIB_ITEM* newItem;
 
+    aPart.ensureLoaded();
+
     m_library             = aLibrary;
     m_name                = aPart.m_name;
     m_FootprintList       = aPart.m_FootprintList;
@@ -840,20 +858,18 @@ bool LIB_PART::Save( OUTPUTFORMATTER& aFormatter )
 }
 
 
-bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
+bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg, bool aDeferBody )
 {
     int      unused;
     char*    p;
     char*    componentName;
     char*    prefix = NULL;
     char*    line;
-
-    bool     result;
-    wxString Msg;
+    char*    saveptr;       // strtok_r() state: the libraries can be read by worker threads
 
     line = aLineReader.Line();
 
-    p = strtok( line, " \t\r\n" );
+    p = strtok_r( line, " \t\r\n", &saveptr );
 
     if( strcmp( p, "DEF" ) != 0 )
     {
@@ -866,17 +882,17 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
     char drawnum = 0;
     char drawname = 0;
 
-    if( ( componentName = strtok( NULL, " \t\n" ) ) == NULL  // Part name:
-        || ( prefix = strtok( NULL, " \t\n" ) ) == NULL      // Prefix name:
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // NumOfPins:
+    if( ( componentName = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL  // Part name:
+        || ( prefix = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL      // Prefix name:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL           // NumOfPins:
         || sscanf( p, "%d", &unused ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // TextInside:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL           // TextInside:
         || sscanf( p, "%d", &m_pinNameOffset ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // DrawNums:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL           // DrawNums:
         || sscanf( p, "%c", &drawnum ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // DrawNums:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL           // DrawNums:
         || sscanf( p, "%c", &drawname ) != 1
-        || ( p = strtok( NULL, " \t\n" ) ) == NULL           // m_unitCount:
+        || ( p = strtok_r( NULL, " \t\n", &saveptr ) ) == NULL           // m_unitCount:
         || sscanf( p, "%d", &m_unitCount ) != 1 )
     {
         aErrorMsg.Printf( wxT( "Wrong DEF format in line %d, skipped." ),
@@ -884,9 +900,9 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
 
         while( (line = aLineReader.ReadLine()) != NULL )
         {
-            p = strtok( line, " \t\n" );
+            p = strtok_r( line, " \t\n", &saveptr );
 
-            if( stricmp( p, "ENDDEF" ) == 0 )
+            if( p && stricmp( p, "ENDDEF" ) == 0 )
                 break;
         }
 
@@ -931,16 +947,68 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
     }
 
     // Copy optional infos
-    if( ( p = strtok( NULL, " \t\n" ) ) != NULL && *p == 'L' )
+    if( ( p = strtok_r( NULL, " \t\n", &saveptr ) ) != NULL && *p == 'L' )
         m_unitsLocked = true;
 
-    if( ( p = strtok( NULL, " \t\n" ) ) != NULL  && *p == 'P' )
+    if( ( p = strtok_r( NULL, " \t\n", &saveptr ) ) != NULL  && *p == 'P' )
         m_options = ENTRY_POWER;
 
+    return loadEntries( aLineReader, aErrorMsg, aDeferBody, true );
+}
+
+
+bool LIB_PART::loadEntries( LINE_READER& aLineReader, wxString& aErrorMsg, bool aDeferBody,
+                            bool aLoadAliases )
+{
+    char*    p;
+    char*    line;
+    char*    saveptr;
+    bool     inBlock = false;   // in a DRAW or $FPLIST block, when deferring the body
+    bool     result;
+    wxString Msg;
+
     // Read next lines, until "ENDDEF" is found
     while( ( line = aLineReader.ReadLine() ) != NULL )
     {
-        p = strtok( line, " \t\r\n" );
+        if( aDeferBody )
+        {
+            m_pendingBody += line;
+
+            if( m_pendingBody[ m_pendingBody.size() - 1 ] != '\n' )
+                m_pendingBody += '\n';
+        }
+
+        p = strtok_r( line, " \t\r\n", &saveptr );
+
+        if( p == NULL )         // an empty line
+            continue;
+
+        if( aDeferBody )
+        {
+            // Only the aliases are needed to list the part in its library.
+            if( inBlock )
+            {
+                if( strcmp( p, "ENDDRAW" ) == 0 || stricmp( p, "$ENDFPLIST" ) == 0 )
+                    inBlock = false;
+            }
+            else if( strcmp( p, "ENDDEF" ) == 0 )
+            {
+                return true;
+            }
+            else if( strcmp( p, "DRAW" ) == 0 || strncmp( p, "$FPLIST", 5 ) == 0 )
+            {
+                inBlock = true;
+            }
+            else if( strncmp( p, "ALIAS", 5 ) == 0 )
+            {
+                p = strtok_r( NULL, "\r\n", &saveptr );
+
+                if( !LoadAliases( p, aErrorMsg ) )
+                    return false;
+            }
+
+            continue;
+        }
 
         // This is the error flag ( if an error occurs, result = false)
         result = true;
@@ -958,8 +1026,10 @@ bool LIB_PART::Load( LINE_READER& aLineReader, wxString& aErrorMsg )
             result = LoadDrawEntries( aLineReader, Msg );
         else if( strncmp( p, "ALIAS", 5 ) == 0 )
         {
-            p = strtok( NULL, "\r\n" );
-            result = LoadAliases( p, aErrorMsg );
+            p = strtok_r( NULL, "\r\n", &saveptr );
+
+            if( aLoadAliases )
+                result = LoadAliases( p, aErrorMsg );
         }
         else if( strncmp( p, "$FPLIST", 5 ) == 0 )
             result = LoadFootprints( aLineReader, Msg );
@@ -987,6 +1057,28 @@ ok:
 }
 
 
+void LIB_PART::ensureLoaded()
+{
+    if( m_pendingBody.empty() )
+        return;
+
+    // Read only once, even if the description is broken.
+    std::string body;
+
+    body.swap( m_pendingBody );
+
+    STRING_LINE_READER reader( body, GetLibraryName() );
+    wxString           errorMsg;
+
+    if( !loadEntries( reader, errorMsg, false, false ) )
+    {
+        wxLogWarning( _( "Library '%s' component '%s' load error %s." ),
+                      GetChars( GetLibraryName() ), GetChars( m_name ),
+                      GetChars( errorMsg ) );
+    }
+}
+
+
 bool LIB_PART::LoadDrawEntries( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
     char* line;
@@ -1074,12 +1166,13 @@ bool LIB_PART::LoadDrawEntries( LINE_READER& aLineReader, wxString& aErrorMsg )
 
 bool LIB_PART::LoadAliases( char* aLine, wxString& aErrorMsg )
 {
-    char* text = strtok( aLine, " \t\r\n" );
+    char* saveptr;
+    char* text = strtok_r( aLine, " \t\r\n", &saveptr );
 
     while( text )
     {
         m_aliases.push_back( new LIB_ALIAS( FROM_UTF8( text ), this ) );
-        text = strtok( NULL, " \t\r\n" );
+        text = strtok_r( NULL, " \t\r\n", &saveptr );
     }
 
     return true;
@@ -1125,6 +1218,7 @@ bool LIB_PART::LoadFootprints( LINE_READER& aLineReader, wxString& aErrorMsg )
 {
     char* line;
     char* p;
+    char* saveptr;
 
     while( true )
     {
@@ -1134,7 +1228,7 @@ bool LIB_PART::LoadFootprints( LINE_READER& aLineReader, wxString& aErrorMsg )
             return false;
         }
 
-        p = strtok( line, " \t\r\n" );
+        p = strtok_r( line, " \t\r\n", &saveptr );
 
         if( stricmp( p, "$ENDFPLIST" ) == 0 )
             break;
@@ -1355,10 +1449,11 @@ bool LIB_PART::SaveDateAndTime( OUTPUTFORMATTER& aFormatter )
 bool LIB_PART::LoadDateAndTime( char* aLine )
 {
     int   year, mon, day, hour, min, sec;
+    char* saveptr;
 
     year = mon = day = hour = min = sec = 0;
-    strtok( aLine, " \r\t\n" );
-    strtok( NULL, " \r\t\n" );
+    strtok_r( aLine, " \r\t\n", &saveptr );
+    strtok_r( NULL, " \r\t\n", &saveptr );
 
     if( sscanf( aLine, "%d/%d/%d %d:%d:%d", &year, &mon, &day, &hour, &min, &sec ) != 6 )
         return false;
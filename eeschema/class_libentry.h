@@ -35,6 +35,7 @@
 #include <lib_field.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
+#include <string>
 #include <vector>
 
 class LINE_READER;
@@ -96,6 +97,7 @@ class LIB_ALIAS : public EDA_ITEM
     LIB_PART*       shared;
 
     friend class LIB_PART;
+    friend class PART_LIB;
 
 protected:
     wxString        name;
@@ -119,12 +121,17 @@ public:
      * gets the shared LIB_PART.
      *
      * @return LIB_PART* - the LIB_PART shared by
-     * this LIB_ALIAS with possibly other LIB_ALIASes.
+     * this LIB_ALIAS with possibly other LIB_ALIASes.  Its description is read from
+     * the library if it was not read yet, see LIB_PART::Load().
      */
-    LIB_PART* GetPart() const
-    {
-        return shared;
-    }
+    LIB_PART* GetPart() const;
+
+    /**
+     * Function GetUnitCount
+     * @return the number of units of the shared LIB_PART.  It is known from the DEF line,
+     * so unlike GetPart()->GetUnitCount(), this does not read the part description.
+     */
+    int GetUnitCount() const;
 
     const wxString GetLibraryName();
 
@@ -216,6 +223,8 @@ class LIB_PART : public EDA_ITEM
     LIB_ALIASES         m_aliases;          ///< List of alias object pointers associated with the
                                             ///< part.
     PART_LIB*           m_library;          ///< Library the part belongs to if any.
+    std::string         m_pendingBody;      ///< Lines of the part description not read yet,
+                                            ///< see ensureLoaded().
 
     static int  m_subpartIdSeparator;       ///< the separator char between
                                             ///< the subpart id and the reference
@@ -226,6 +235,26 @@ class LIB_PART : public EDA_ITEM
 private:
     void deleteAllFields();
 
+    /**
+     * Function loadEntries
+     * reads the lines of the part description following the DEF line, until ENDDEF.
+     *
+     * @param aReader A LINE_READER object to load the lines from.
+     * @param aErrorMsg - Description of error on load failure.
+     * @param aDeferBody - true to only read the aliases, and keep all the lines in
+     *                     m_pendingBody until the part is used.
+     * @param aLoadAliases - false to skip the ALIAS lines, when they were already read.
+     * @return True if the load was successful, false if there was an error.
+     */
+    bool loadEntries( LINE_READER& aReader, wxString& aErrorMsg, bool aDeferBody,
+                      bool aLoadAliases );
+
+    /**
+     * Function ensureLoaded
+     * reads the part description kept in m_pendingBody by a deferred Load(), if any.
+     */
+    void ensureLoaded();
+
     // LIB_PART()  { }     // not legal
 
 public:
@@ -343,9 +372,13 @@ public:
      *
      * @param aReader A LINE_READER object to load file from.
      * @param aErrorMsg - Description of error on load failure.
+     * @param aDeferBody - true to only read the DEF line and the aliases.  The rest of
+     *                     the description is read when the part is obtained through
+     *                     LIB_ALIAS::GetPart(), so a library lists its entries without
+     *                     parsing all of them.
      * @return True if the load was successful, false if there was an error.
      */
-    bool Load( LINE_READER& aReader, wxString& aErrorMsg );
+    bool Load( LINE_READER& aReader, wxString& aErrorMsg, bool aDeferBody = false );
     bool LoadField( LINE_READER& aReader, wxString& aErrorMsg );
     bool LoadDrawEntries( LINE_READER& aReader, wxString& aErrorMsg );
     bool LoadAliases( char* aLine, wxString& aErrorMsg );
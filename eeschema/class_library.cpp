@@ -43,8 +43,10 @@
 
 #include <general.h>
 #include <class_library.h>
+#include <thread_pool.h>
 
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
 
 #include <wx/tokenzr.h>
 #include <wx/regex.h>
@@ -81,7 +83,7 @@ PART_LIB::~PART_LIB()
     {
         wxLogTrace( traceSchLibMem, wxT( "Removing alias %s from library %s." ),
                     GetChars( it->second->GetName() ), GetChars( GetLogicalName() ) );
-        LIB_PART* part = it->second->GetPart();
+        LIB_PART* part = it->second->shared;   // not GetPart(): do not read the part now
         LIB_ALIAS* alias = it->second;
         delete alias;
 
@@ -121,7 +123,7 @@ void PART_LIB::GetEntryTypePowerNames( wxArrayString& aNames, bool aSort, bool a
     for( LIB_ALIAS_MAP::iterator it = m_amap.begin();  it!=m_amap.end();  it++ )
     {
         LIB_ALIAS* alias = it->second;
-        LIB_PART* root = alias->GetPart();
+        LIB_PART* root = alias->shared;     // IsPower() is known before the part is read
 
         if( !root || !root->IsPower() )
             continue;
@@ -269,7 +271,7 @@ bool PART_LIB::HasPowerParts()
     for( LIB_ALIAS_MAP::iterator it = m_amap.begin();  it!=m_amap.end();  it++ )
     {
         LIB_ALIAS* alias = it->second;
-        LIB_PART* root = alias->GetPart();
+        LIB_PART* root = alias->shared;     // IsPower() is known before the part is read
 
         if( root && root->IsPower() )
             return true;
@@ -567,7 +569,8 @@ bool PART_LIB::Load( wxString& aErrorMsg )
             // Read one DEF/ENDDEF part entry from library:
             LIB_PART* part = new LIB_PART( wxEmptyString, this );
 
-            if( part->Load( reader, msg ) )
+            // The part body is read when the part is used
+            if( part->Load( reader, msg, true ) )
             {
                 // Check for duplicate entry names and warn the user about
                 // the potential conflict.
@@ -622,14 +625,14 @@ void PART_LIB::LoadAliases( LIB_PART* aPart )
 
 bool PART_LIB::LoadHeader( LINE_READER& aLineReader )
 {
-    char* line, * text, * data;
+    char* line, * text, * data, * saveptr;
 
     while( aLineReader.ReadLine() )
     {
         line = (char*) aLineReader;
 
-        text = strtok( line, " \t\r\n" );
-        data = strtok( NULL, " \t\r\n" );
+        text = strtok_r( line, " \t\r\n", &saveptr );
+        data = strtok_r( NULL, " \t\r\n", &saveptr );
 
         if( stricmp( text, "TimeStamp" ) == 0 )
             timeStamp = atol( data );
@@ -645,7 +648,7 @@ bool PART_LIB::LoadHeader( LINE_READER& aLineReader )
 bool PART_LIB::LoadDocs( wxString& aErrorMsg )
 {
     int        lineNumber = 0;
-    char       line[8000], * name, * text;
+    char       line[8000], * name, * text, * saveptr;
     LIB_ALIAS* entry;
     FILE*      file;
     wxString   msg;
@@ -688,7 +691,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
         }
 
         // Read one $CMP/$ENDCMP part entry from library:
-        name = strtok( line + 5, "\n\r" );
+        name = strtok_r( line + 5, "\n\r", &saveptr );
 
         wxString cmpname = FROM_UTF8( name );
 
@@ -699,7 +702,7 @@ bool PART_LIB::LoadDocs( wxString& aErrorMsg )
             if( strncmp( line, "$ENDCMP", 7 ) == 0 )
                 break;
 
-            text = strtok( line + 2, "\n\r" );
+            text = strtok_r( line + 2, "\n\r", &saveptr );
 
             if( entry )
             {
@@ -810,23 +813,34 @@ PART_LIB* PART_LIB::LoadLibrary( const wxString& aFileName ) throw( IO_ERROR, bo
 
     wxString errorMsg;
 
-    if( !lib->Load( errorMsg ) )
+    if( !lib->LoadFiles( errorMsg ) )
         THROW_IO_ERROR( errorMsg );
 
-    if( USE_OLD_DOC_FILE_FORMAT( lib->versionMajor, lib->versionMinor ) )
+    PART_LIB* ret = lib.release();
+
+    return ret;
+}
+
+
+bool PART_LIB::LoadFiles( wxString& aErrorMsg )
+{
+    if( !Load( aErrorMsg ) )
+        return false;
+
+    if( USE_OLD_DOC_FILE_FORMAT( versionMajor, versionMinor ) )
     {
+        wxString errorMsg;
+
 #if 1
         // not fatal if error here.
-        lib->LoadDocs( errorMsg );
+        LoadDocs( errorMsg );
 #else
-        if( !lib->LoadDocs( errorMsg ) )
-            THROW_IO_ERROR( errorMsg );
+        if( !LoadDocs( aErrorMsg ) )
+            return false;
 #endif
     }
 
-    PART_LIB* ret = lib.release();
-
-    return ret;
+    return true;
 }
 
 
@@ -1108,6 +1122,51 @@ const wxString PART_LIBS::CacheName( const wxString& aFullProjectFilename )
 }
 
 
+/**
+ * Struct LIBRARY_LOAD
+ * is a library file read by a worker thread of PART_LIBS::LoadAllLibraries().
+ */
+struct LIBRARY_LOAD
+{
+    wxString    m_fileName;
+    bool        m_isCache;
+    PART_LIB*   m_lib;          ///< the loaded library, NULL if it failed to load
+    wxString    m_errorMsg;
+
+    LIBRARY_LOAD( const wxString& aFileName, bool aIsCache ) :
+        m_fileName( aFileName ),
+        m_isCache( aIsCache ),
+        m_lib( NULL )
+    {
+    }
+
+    ~LIBRARY_LOAD()
+    {
+        delete m_lib;
+    }
+};
+
+
+static void loadLibraryJob( LIBRARY_LOAD* aLoad )
+{
+    try
+    {
+        std::auto_ptr<PART_LIB> lib( new PART_LIB( LIBRARY_TYPE_EESCHEMA, aLoad->m_fileName ) );
+
+        if( lib->LoadFiles( aLoad->m_errorMsg ) )
+            aLoad->m_lib = lib.release();
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        aLoad->m_errorMsg = ioe.errorText;
+    }
+    catch( const std::exception& se )
+    {
+        aLoad->m_errorMsg = FROM_UTF8( se.what() );
+    }
+}
+
+
 void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::bad_pointer )
 {
     wxFileName      fn;
@@ -1129,6 +1188,11 @@ void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::ba
 
     wxASSERT( !size() );    // expect to load into "this" empty container.
 
+    // The library files, in the order of the list.  As AddLibrary() does, a library
+    // is not loaded twice.
+    boost::ptr_vector<LIBRARY_LOAD> loads;
+    wxArrayString                   load_names;
+
     for( unsigned i = 0; i < lib_names.GetCount();  ++i )
     {
         fn.Clear();
@@ -1155,45 +1219,70 @@ void PART_LIBS::LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::ba
             filename = fn.GetFullPath();
         }
 
-        try
-        {
-            AddLibrary( filename );
-        }
-        catch( const IO_ERROR& ioe )
-        {
-            wxString msg = wxString::Format( _(
-                    "Part library '%s' failed to load. Error:\n"
-                    "%s" ),
-                    GetChars( filename ),
-                    GetChars( ioe.errorText )
-                    );
+        wxString name = wxFileName( filename ).GetName();
 
-            THROW_IO_ERROR( msg );
-        }
+        if( FindLibrary( name ) || load_names.Index( name, false ) != wxNOT_FOUND )
+            continue;
+
+        load_names.Add( name );
+        loads.push_back( new LIBRARY_LOAD( filename, false ) );
     }
 
     // add the special cache library.
     wxString cache_name = CacheName( aProject->GetProjectFullName() );
-    PART_LIB* cache_lib;
 
     if( !!cache_name )
     {
-        try
-        {
-            cache_lib = AddLibrary( cache_name );
-            if( cache_lib )
-                cache_lib->SetCache();
-        }
-        catch( const IO_ERROR& ioe )
+        wxString name = wxFileName( cache_name ).GetName();
+
+        if( !FindLibrary( name ) && load_names.Index( name, false ) == wxNOT_FOUND )
+            loads.push_back( new LIBRARY_LOAD( cache_name, true ) );
+    }
+
+    // The libraries are independent, read them concurrently.
+    {
+        wxBusyCursor    ShowWait;
+        THREAD_POOL     pool;
+
+        for( unsigned i = 0; i < loads.size();  ++i )
+            pool.Submit( boost::bind( &loadLibraryJob, &loads[i] ) );
+
+        pool.Wait();
+    }
+
+    // Add them in order, stopping at the first one which failed to load.
+    for( unsigned i = 0; i < loads.size();  ++i )
+    {
+        LIBRARY_LOAD& load = loads[i];
+
+        if( !load.m_lib )
         {
-            wxString msg = wxString::Format( _(
-                    "Part library '%s' failed to load.\nError: %s" ),
-                    GetChars( cache_name ),
-                    GetChars( ioe.errorText )
-                    );
+            wxString msg;
+
+            if( load.m_isCache )
+                msg = wxString::Format( _(
+                        "Part library '%s' failed to load.\nError: %s" ),
+                        GetChars( load.m_fileName ),
+                        GetChars( load.m_errorMsg )
+                        );
+            else
+                msg = wxString::Format( _(
+                        "Part library '%s' failed to load. Error:\n"
+                        "%s" ),
+                        GetChars( load.m_fileName ),
+                        GetChars( load.m_errorMsg )
+                        );
 
             THROW_IO_ERROR( msg );
         }
+
+        PART_LIB* lib = load.m_lib;
+
+        load.m_lib = NULL;
+        push_back( lib );
+
+        if( load.m_isCache )
+            lib->SetCache();
     }
 
     // Print the libraries not found
@@ -235,7 +235,7 @@ public:
     /**
      * Function LoadAllLibraries
      * loads all of the project's libraries into this container, which should
-     * be cleared before calling it.
+     * be cleared before calling it.  The libraries are read concurrently.
      */
     void LoadAllLibraries( PROJECT* aProject ) throw( IO_ERROR, boost::bad_pointer );
 
@@ -391,6 +391,16 @@ public:
 
     bool LoadDocs( wxString& aErrorMsg );
 
+    /**
+     * Function LoadFiles
+     * loads the library file and, for the old library versions, its document file.
+     * It does not use the GUI, so the libraries can be loaded by worker threads.
+     *
+     * @param aErrorMsg - Error message if load fails.
+     * @return True if load was successful otherwise false.
+     */
+    bool LoadFiles( wxString& aErrorMsg );
+
 private:
     bool SaveHeader( OUTPUTFORMATTER& aFormatter );
 
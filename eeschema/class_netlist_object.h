@@ -38,6 +38,8 @@
 
 class NETLIST_OBJECT_LIST;
 class SCH_COMPONENT;
+struct NETLIST_SHEET_INDEX;
+struct NETLIST_LABEL_INDEX;
 
 
 /* Type of Net objects (wires, labels, pins...) */
@@ -276,6 +278,12 @@ class NETLIST_OBJECT_LIST : public NETLIST_OBJECTS
     int m_lastBusNetCode;   // Used in intermediate calculation:
                             // last net code created for bus members
 
+    // Union-find of the net codes (and bus net codes) merged while building the
+    // connections: the net code of an item is findNetCode( item->GetNet() ) until
+    // resolveNetCodes() stores the merged codes in the items.
+    std::vector<int> m_netCodeParent;
+    std::vector<int> m_busNetCodeParent;
+
 public:
     /**
      * Constructor.
@@ -385,16 +393,36 @@ private:
     /*
      * Propagate aNewNetCode to items having an internal netcode aOldNetCode
      * used to interconnect group of items already physically connected,
-     * when a new connection is found between aOldNetCode and aNewNetCode
+     * when a new connection is found between aOldNetCode and aNewNetCode.
+     * The items are not modified: the codes are merged in the union-find of the
+     * net codes, see findNetCode() and resolveNetCodes()
      */
     void propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus );
 
+    /*
+     * @return the current net code (or bus net code) of items having the
+     * internal net code aNetCode, i.e. after the propageNetCode() calls
+     */
+    int findNetCode( int aNetCode, bool aIsBus );
+
+    /*
+     * Give the net code (or bus net code) aNetCode to aItem, and to the items
+     * already connected to aItem
+     */
+    void mergeNetCode( NETLIST_OBJECT* aItem, int aNetCode, bool aIsBus );
+
+    /*
+     * Store the current net codes and bus net codes in the items,
+     * and clear the union-find of the net codes
+     */
+    void resolveNetCodes();
+
     /*
      * This function merges the net codes of groups of objects already connected
      * to labels (wires, bus, pins ... ) when 2 labels are equivalents
      * (i.e. group objects connected by labels)
      */
-    void labelConnect( NETLIST_OBJECT* aLabelRef );
+    void labelConnect( NETLIST_OBJECT* aLabelRef, const NETLIST_LABEL_INDEX& aIndex );
 
     /* Comparison function to sort by increasing Netcode the list of connected items
      */
@@ -414,18 +442,23 @@ private:
      * Propagate net codes from a parent sheet to an include sheet,
      * from a pin sheet connection
      */
-    void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel );
+    void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel, const NETLIST_LABEL_INDEX& aIndex );
 
-    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start );
+    /*
+     * Propagate the net code of aRef to the objects of its sheet having
+     * an end at one of the ends of aRef.
+     * aIndex holds the objects of the sheet of aRef
+     */
+    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, NETLIST_SHEET_INDEX& aIndex );
 
     /*
      * Search connections betweena junction and segments
      * Propagate the junction net code to objects connected by this junction.
      * The junction must have a valid net code
-     * The list of objects is expected sorted by sheets.
-     * Search is done from index aIdxStart to the last element of list
+     * aIndex holds the objects of the sheet of the junction
      */
-    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, int aIdxStart );
+    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus,
+                                NETLIST_SHEET_INDEX& aIndex );
 
     void connectBusLabels();
 
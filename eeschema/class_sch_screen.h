@@ -30,6 +30,8 @@
 #ifndef CLASS_SCREEN_H
 #define CLASS_SCREEN_H
 
+#include <map>
+
 #include <macros.h>
 #include <dlist.h>
 #include <sch_item_struct.h>
@@ -49,6 +51,8 @@ class SCH_SHEET_PIN;
 class SCH_LINE;
 class SCH_TEXT;
 class PLOTTER;
+class NETLIST_OBJECT_LIST;
+class SCH_SCREEN_INDEX;
 
 
 enum SCH_LINE_TEST_T
@@ -85,6 +89,69 @@ private:
     int     m_modification_sync;        ///< inequality with PART_LIBS::GetModificationHash()
                                         ///< will trigger ResolveAll().
 
+    /// The netlist items of the screen for each sheet path using it, keyed by
+    /// SCH_SHEET_PATH::Path(), see GetNetListItems().
+    std::map<wxString, NETLIST_OBJECT_LIST*> m_netListItems;
+
+    int     m_netListModificationCount;     ///< getNetListModificationCount() when
+                                            ///< m_netListItems was filled
+    int     m_netListLibsHash;              ///< PART_LIBS::GetModifyHash() when
+                                            ///< m_netListItems was filled
+    int     m_noNetListModificationCount;   ///< the part of GetModificationCount() due to
+                                            ///< items giving no netlist item (markers,
+                                            ///< notes, bitmaps) being added or removed
+
+    /// Deletes the netlist items kept by GetNetListItems().
+    void clearNetListItems();
+
+    /**
+     * Function getNetListModificationCount
+     * @return GetModificationCount() without the changes which cannot modify the netlist,
+     * so that placing or deleting the ERC markers does not discard m_netListItems.
+     */
+    int getNetListModificationCount() const
+    {
+        return GetModificationCount() - m_noNetListModificationCount;
+    }
+
+    /**
+     * Function itemChanged
+     * increments the modification count after aItem was added or removed.
+     */
+    void itemChanged( const SCH_ITEM* aItem );
+
+    /// The spatial index of m_drawList, see getIndex().
+    mutable SCH_SCREEN_INDEX* m_index;
+
+    mutable int m_indexModificationCount;   ///< GetModificationCount() when m_index was
+                                            ///< synchronized with m_drawList
+    mutable int m_indexLibsHash;            ///< PART_LIBS::GetModifyHash() when m_index
+                                            ///< was built
+
+    /**
+     * Function isIndexSynchronized
+     * @return true if m_index exists and matches the current items of the screen.
+     */
+    bool isIndexSynchronized() const;
+
+    /**
+     * Function getIndex
+     * returns the spatial index of the screen items, built again if the screen was
+     * modified in a way the index was not told about.
+     * @param aForceRebuild = true to build the index again anyway, because items can
+     *                        be moved without the screen being modified yet.
+     */
+    SCH_SCREEN_INDEX& getIndex( bool aForceRebuild = false ) const;
+
+    /**
+     * Function getItems
+     * fills \a aItems with the items which can be hit at \a aPosition with \a aAccuracy,
+     * in draw list order.  The list is a superset of the items actually hit, the callers
+     * test them.
+     */
+    void getItems( const wxPoint& aPosition, int aAccuracy,
+                   std::vector<SCH_ITEM*>& aItems ) const;
+
     /**
      * Function addConnectedItemsToBlock
      * add items connected at \a aPosition to the block pick list.
@@ -137,11 +204,7 @@ public:
      */
     SCH_ITEM* GetDrawItems() const                          { return m_drawList.begin(); }
 
-    void Append( SCH_ITEM* aItem )
-    {
-        m_drawList.Append( aItem );
-        --m_modification_sync;
-    }
+    void Append( SCH_ITEM* aItem );
 
     /**
      * Function Append
@@ -149,11 +212,7 @@ public:
      *
      * @param aList A reference to a #DLIST containing the #SCH_ITEM to add to the sheet.
      */
-    void Append( DLIST< SCH_ITEM >& aList )
-    {
-        m_drawList.Append( aList );
-        --m_modification_sync;
-    }
+    void Append( DLIST< SCH_ITEM >& aList );
 
     /**
      * Function GetCurItem
@@ -438,6 +497,21 @@ public:
      */
     void GetHierarchicalItems( EDA_ITEMS& aItems );
 
+    /**
+     * Function GetNetListItems
+     * adds to \a aNetListItems the netlist items of the screen for \a aSheetPath, i.e.
+     * copies of the items created by SCH_ITEM::GetNetListItem().
+     * <p>
+     * The items are kept from a call to the other, for each sheet path using the screen,
+     * and are created again only when the screen (see GetModificationCount()) or the
+     * libraries were modified.  Adding or removing markers, notes and bitmaps does not
+     * count as a modification here.
+     * </p>
+     * @param aNetListItems The netlist item list to fill.
+     * @param aSheetPath The sheet path of the screen.
+     */
+    void GetNetListItems( NETLIST_OBJECT_LIST& aNetListItems, SCH_SHEET_PATH* aSheetPath );
+
     /**
      * Function GetNode
      * returns all the items at \a aPosition that form a node.
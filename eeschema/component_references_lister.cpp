@@ -733,6 +733,9 @@ void SCH_REFERENCE::Annotate()
     m_RootCmp->SetRef( &m_SheetPath, FROM_UTF8( m_Ref.c_str() ) );
     m_RootCmp->SetUnit( m_Unit );
     m_RootCmp->SetUnitSelection( &m_SheetPath, m_Unit );
+
+    // The unit selection changes the pins of the component in the netlist
+    m_SheetPath.LastScreen()->IncModificationCount();
 }
 
 
@@ -196,9 +196,12 @@ void COMPONENT_TREE_SEARCH_CONTAINER::AddAliasList( const wxString& aNodeName,
                                                a, a->GetName(), display_info, search_text );
         m_nodes.push_back( alias_node );
 
-        if( a->GetPart()->IsMulti() )    // Add all units as sub-nodes.
+        // The unit count is known without reading the part
+        int unitCount = a->GetUnitCount();
+
+        if( unitCount > 1 )    // Add all units as sub-nodes.
         {
-            for( int u = 1; u <= a->GetPart()->GetUnitCount(); ++u )
+            for( int u = 1; u <= unitCount; ++u )
             {
                 wxString unitName = _("Unit");
                 unitName += wxT( " " ) + LIB_PART::SubReference( u, false );
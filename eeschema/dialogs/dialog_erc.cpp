@@ -47,6 +47,7 @@
 #include <dialog_erc.h>
 #include <erc.h>
 #include <id.h>
+#include <profile.h>
 
 
 bool DIALOG_ERC::m_writeErcFile = false;
@@ -440,6 +441,10 @@ void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
 
     m_writeErcFile = m_WriteResultOpt->GetValue();
 
+    // Time of each ERC phase, reported by wxLogDebug.
+    prof_counter annotateTime, cleanupTime, netlistTime, testTime, displayTime;
+    prof_start( &annotateTime );
+
     // Build the whole sheet list in hierarchy (sheet, not screen)
     SCH_SHEET_LIST sheets;
     sheets.AnnotatePowerSymbols( Prj().SchLibs() );
@@ -456,6 +461,9 @@ void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
         return;
     }
 
+    prof_end( &annotateTime );
+    prof_start( &cleanupTime );
+
     SCH_SCREENS screens;
 
     // Erase all previous DRC markers.
@@ -475,15 +483,27 @@ void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
      */
     TestDuplicateSheetNames( true );
 
+    prof_end( &cleanupTime );
+    prof_start( &netlistTime );
+
     std::auto_ptr<NETLIST_OBJECT_LIST> objectsConnectedList( m_parent->BuildNetListBase() );
 
     // Reset the connection type indicator
     objectsConnectedList->ResetConnectionsType();
 
+    prof_end( &netlistTime );
+    prof_start( &testTime );
+
     unsigned lastNet;
     unsigned nextNet = lastNet = 0;
     int MinConn    = NOC;
 
+    // The pins of the current net, by electrical type.
+    ERC_NET_PINS netPins( objectsConnectedList.get() );
+
+    if( objectsConnectedList->size() )
+        netPins.SetNet( 0 );
+
     for( unsigned net = 0; net < objectsConnectedList->size(); net++ )
     {
         if( objectsConnectedList->GetItemNet( lastNet ) !=
@@ -492,6 +512,7 @@ void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
             // New net found:
             MinConn    = NOC;
             nextNet   = net;
+            netPins.SetNet( net );
         }
 
         switch( objectsConnectedList->GetItemType( net ) )
@@ -524,7 +545,7 @@ void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
             // ERC problems when a noconnect symbol is connected to more than one pin.
             MinConn = NET_NC;
 
-            if( CountPinsInNet( objectsConnectedList.get(), nextNet ) > 1 )
+            if( netPins.GetPinCount() > 1 )
                 Diagnose( objectsConnectedList->GetItem( net ), NULL, MinConn, UNC );
 
             break;
@@ -532,13 +553,16 @@ void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
         case NET_PIN:
 
             // Look for ERC problems between pins:
-            TestOthersItems( objectsConnectedList.get(), net, nextNet, &MinConn );
+            TestOthersItems( objectsConnectedList.get(), net, netPins, &MinConn );
             break;
         }
 
         lastNet = net;
     }
 
+    prof_end( &testTime );
+    prof_start( &displayTime );
+
     // Displays global results:
     updateMarkerCounts( &screens );
 
@@ -548,6 +572,14 @@ void DIALOG_ERC::TestErc( wxArrayString* aMessagesList )
     // Display new markers:
     m_parent->GetCanvas()->Refresh();
 
+    prof_end( &displayTime );
+
+    wxLogDebug( wxT( "ERC: annotation %.1f ms, cleanup %.1f ms, netlist %.1f ms, "
+                     "tests %.1f ms (%u items), markers display %.1f ms" ),
+                annotateTime.msecs(), cleanupTime.msecs(), netlistTime.msecs(),
+                testTime.msecs(), (unsigned) objectsConnectedList->size(),
+                displayTime.msecs() );
+
     if( m_writeErcFile )
     {
         fn = g_RootSheet->GetScreen()->GetFileName();
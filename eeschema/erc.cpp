@@ -368,137 +368,197 @@ void Diagnose( NETLIST_OBJECT* aNetItemRef, NETLIST_OBJECT* aNetItemTst,
 }
 
 
-void TestOthersItems( NETLIST_OBJECT_LIST* aList,
-                      unsigned aNetItemRef, unsigned aNetStart,
-                      int* aMinConnexion )
+ERC_NET_PINS::ERC_NET_PINS( NETLIST_OBJECT_LIST* aList ) :
+    m_list( aList ),
+    m_pinCount( 0 ),
+    m_hasNoConnect( false ),
+    m_instancesBuilt( false )
 {
-    unsigned netItemTst = aNetStart;
-    int jj;
-    int erc = OK;
+    for( int ii = 0; ii < PIN_NMAX; ii++ )
+    {
+        m_count[ii] = 0;
+        m_next[ii] = 0;
+    }
+}
+
+
+void ERC_NET_PINS::SetNet( unsigned aNetStart )
+{
+    m_pinCount = 0;
+    m_hasNoConnect = false;
+
+    for( int ii = 0; ii < PIN_NMAX; ii++ )
+    {
+        m_count[ii] = 0;
+        m_next[ii] = 0;
+        m_pins[ii].clear();
+    }
+
+    int net = m_list->GetItemNet( aNetStart );
+
+    for( unsigned item = aNetStart; item < m_list->size(); item++ )
+    {
+        if( m_list->GetItemNet( item ) != net )    // End of net
+            break;
+
+        switch( m_list->GetItemType( item ) )
+        {
+        case NET_NOCONNECT:
+            m_hasNoConnect = true;
+            break;
+
+        case NET_PIN:
+        {
+            int type = m_list->GetItem( item )->m_ElectricalType;
+
+            m_pinCount++;
+            m_count[type]++;
+            m_pins[type].push_back( item );
+        }
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
 
-    /* Analysis of the table of connections. */
-    int ref_elect_type = aList->GetItem( aNetItemRef )->m_ElectricalType;
+int ERC_NET_PINS::GetMinConnexion( unsigned aNetItemRef ) const
+{
+    int ref_elect_type = m_list->GetItem( aNetItemRef )->m_ElectricalType;
     int local_minconn = NOC;
 
     if( ref_elect_type == PIN_NC )
         local_minconn = NPI;
 
-    /* Test pins connected to NetItemRef */
-    for( ; ; netItemTst++ )
+    if( m_hasNoConnect )
+        local_minconn = std::max( NET_NC, local_minconn );
+
+    // The pin itself does not count: only the other pins of the net do.
+    for( int type = 0; type < PIN_NMAX; type++ )
+    {
+        int count = m_count[type];
+
+        if( type == ref_elect_type )
+            count--;
+
+        if( count > 0 )
+            local_minconn = std::max( MinimalReq[ref_elect_type][type], local_minconn );
+    }
+
+    return local_minconn;
+}
+
+
+int ERC_NET_PINS::NextConflict( unsigned aNetItemRef )
+{
+    int ref_elect_type = m_list->GetItem( aNetItemRef )->m_ElectricalType;
+    int conflict = -1;
+
+    for( int type = 0; type < PIN_NMAX; type++ )
     {
-        if( aNetItemRef == netItemTst )
+        if( DiagErc[ref_elect_type][type] == OK )
             continue;
 
-        // We examine only a given net. We stop the search if the net changes
-        if( ( netItemTst >= aList->size() ) // End of list
-            || ( aList->GetItemNet( aNetItemRef ) !=
-                 aList->GetItemNet( netItemTst ) ) ) // End of net
-        {
-            /* End net code found: minimum connection test. */
-            if( ( *aMinConnexion < NET_NC ) && ( local_minconn < NET_NC ) )
-            {
-                /* Not connected or not driven pin. */
-                bool seterr = true;
+        const std::vector<unsigned>& pins = m_pins[type];
+        unsigned& next = m_next[type];
 
-                if( local_minconn == NOC &&
-                    aList->GetItemType( aNetItemRef ) == NET_PIN )
-                {
-                    /* This pin is not connected: for multiple part per
-                     * package, and duplicated pin,
-                     * search for an other instance of this pin
-                     * this will be flagged only if all instances of this pin
-                     * are not connected
-                     * TODO test also if instances connected are connected to
-                     * the same net
-                     */
-                    for( unsigned duplicate = 0; duplicate < aList->size(); duplicate++ )
-                    {
-                        if( aList->GetItemType( duplicate ) != NET_PIN )
-                            continue;
-
-                        if( duplicate == aNetItemRef )
-                            continue;
-
-                        if( aList->GetItem( aNetItemRef )->m_PinNum !=
-                            aList->GetItem( duplicate )->m_PinNum )
-                            continue;
-
-                        if( ( (SCH_COMPONENT*) aList->GetItem( aNetItemRef )->
-                             m_Link )->GetRef( &aList->GetItem( aNetItemRef )-> m_SheetPath ) !=
-                            ( (SCH_COMPONENT*) aList->GetItem( duplicate )->m_Link )
-                           ->GetRef( &aList->GetItem( duplicate )->m_SheetPath ) )
-                            continue;
-
-                        // Same component and same pin. Do dot create error for this pin
-                        // if the other pin is connected (i.e. if duplicate net has an other
-                        // item)
-                        if( (duplicate > 0)
-                          && ( aList->GetItemNet( duplicate ) ==
-                               aList->GetItemNet( duplicate - 1 ) ) )
-                            seterr = false;
-
-                        if( (duplicate < aList->size() - 1)
-                          && ( aList->GetItemNet( duplicate ) ==
-                               aList->GetItemNet( duplicate + 1 ) ) )
-                            seterr = false;
-                    }
-                }
+        while( next < pins.size() && pins[next] <= aNetItemRef )
+            next++;
 
-                if( seterr )
-                    Diagnose( aList->GetItem( aNetItemRef ), NULL, local_minconn, WAR );
+        if( next < pins.size() && ( conflict < 0 || pins[next] < (unsigned) conflict ) )
+            conflict = pins[next];
+    }
 
-                *aMinConnexion = DRV;   // inhibiting other messages of this
-                                       // type for the net.
-            }
-            return;
-        }
+    return conflict;
+}
+
+
+ERC_NET_PINS::PIN_KEY ERC_NET_PINS::pinKey( unsigned aIdx ) const
+{
+    NETLIST_OBJECT* pin = m_list->GetItem( aIdx );
+
+    return PIN_KEY( ( (SCH_COMPONENT*) pin->m_Link )->GetRef( &pin->m_SheetPath ),
+                    pin->m_PinNum );
+}
 
-        switch( aList->GetItemType( netItemTst ) )
+
+bool ERC_NET_PINS::IsInstanceConnected( unsigned aNetItemRef )
+{
+    if( !m_instancesBuilt )
+    {
+        for( unsigned item = 0; item < m_list->size(); item++ )
         {
-        case NET_ITEM_UNSPECIFIED:
-        case NET_SEGMENT:
-        case NET_BUS:
-        case NET_JUNCTION:
-        case NET_LABEL:
-        case NET_HIERLABEL:
-        case NET_BUSLABELMEMBER:
-        case NET_HIERBUSLABELMEMBER:
-        case NET_SHEETBUSLABELMEMBER:
-        case NET_SHEETLABEL:
-        case NET_GLOBLABEL:
-        case NET_GLOBBUSLABELMEMBER:
-        case NET_PINLABEL:
-            break;
+            if( m_list->GetItemType( item ) == NET_PIN )
+                m_instances[ pinKey( item ) ].push_back( item );
+        }
 
-        case NET_NOCONNECT:
-            local_minconn = std::max( NET_NC, local_minconn );
-            break;
+        m_instancesBuilt = true;
+    }
 
-        case NET_PIN:
-            jj = aList->GetItem( netItemTst )->m_ElectricalType;
-            local_minconn = std::max( MinimalReq[ref_elect_type][jj], local_minconn );
+    PIN_INSTANCES::const_iterator it = m_instances.find( pinKey( aNetItemRef ) );
 
-            if( netItemTst <= aNetItemRef )
-                break;
+    if( it == m_instances.end() )
+        return false;
 
-            if( erc == OK )
-            {
-                erc = DiagErc[ref_elect_type][jj];
+    const std::vector<unsigned>& instances = it->second;
 
-                if( erc != OK )
-                {
-                    if( aList->GetConnectionType( netItemTst ) == UNCONNECTED )
-                    {
-                        Diagnose( aList->GetItem( aNetItemRef ),
-                                  aList->GetItem( netItemTst ),
-                                  0, erc );
-                        aList->SetConnectionType( netItemTst, NOCONNECT_SYMBOL_PRESENT );
-                    }
-                }
-            }
+    for( unsigned ii = 0; ii < instances.size(); ii++ )
+    {
+        unsigned duplicate = instances[ii];
 
-            break;
-        }
+        if( duplicate == aNetItemRef )
+            continue;
+
+        // The other instance is connected if its net has an other item.
+        if( ( duplicate > 0 )
+          && ( m_list->GetItemNet( duplicate ) == m_list->GetItemNet( duplicate - 1 ) ) )
+            return true;
+
+        if( ( duplicate < m_list->size() - 1 )
+          && ( m_list->GetItemNet( duplicate ) == m_list->GetItemNet( duplicate + 1 ) ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+void TestOthersItems( NETLIST_OBJECT_LIST* aList, unsigned aNetItemRef,
+                      ERC_NET_PINS& aNetPins, int* aMinConnexion )
+{
+    NETLIST_OBJECT* netItemRef = aList->GetItem( aNetItemRef );
+
+    /* Only the first pin after aNetItemRef in conflict with it is tested: the others
+     * will be tested against it.
+     */
+    int netItemTst = aNetPins.NextConflict( aNetItemRef );
+
+    if( netItemTst >= 0 && aList->GetConnectionType( netItemTst ) == UNCONNECTED )
+    {
+        NETLIST_OBJECT* tst = aList->GetItem( netItemTst );
+
+        Diagnose( netItemRef, tst, 0,
+                  DiagErc[netItemRef->m_ElectricalType][tst->m_ElectricalType] );
+        aList->SetConnectionType( netItemTst, NOCONNECT_SYMBOL_PRESENT );
+    }
+
+    /* Minimum connection test. */
+    int local_minconn = aNetPins.GetMinConnexion( aNetItemRef );
+
+    if( ( *aMinConnexion < NET_NC ) && ( local_minconn < NET_NC ) )
+    {
+        /* Not connected or not driven pin.
+         * This pin is not connected: for multiple part per package, and duplicated
+         * pin, it is flagged only if all instances of this pin are not connected
+         * TODO test also if instances connected are connected to the same net
+         */
+        if( local_minconn != NOC || !aNetPins.IsInstanceConnected( aNetItemRef ) )
+            Diagnose( netItemRef, NULL, local_minconn, WAR );
+
+        *aMinConnexion = DRV;   // inhibiting other messages of this
+                                // type for the net.
     }
 }
 
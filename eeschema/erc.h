@@ -30,6 +30,10 @@
 #ifndef _ERC_H
 #define _ERC_H
 
+#include <vector>
+#include <map>
+
+#include <lib_pin.h>      // PIN_NMAX
 
 class EDA_DRAW_PANEL;
 class NETLIST_OBJECT;
@@ -83,18 +87,82 @@ extern bool WriteDiagnosticERC( const wxString& aFullFileName );
 extern void Diagnose( NETLIST_OBJECT* NetItemRef, NETLIST_OBJECT* NetItemTst,
                       int MinConnexion, int Diag );
 
+/**
+ * Class ERC_NET_PINS
+ * is the census of the pins of the net being tested, by electrical type, with an index
+ * of the pins of the whole list by component reference and pin number.  It lets
+ * TestOthersItems() look up the DiagErc and MinimalReq tables once per pair of pin types
+ * of the net instead of once per pair of pins, so big nets (power, ground) are tested
+ * in a time linear in their pin count.
+ */
+class ERC_NET_PINS
+{
+public:
+    ERC_NET_PINS( NETLIST_OBJECT_LIST* aList );
+
+    /**
+     * Function SetNet
+     * collects the pins of the net which starts at \a aNetStart in the list.
+     */
+    void SetNet( unsigned aNetStart );
+
+    /**
+     * Function GetPinCount
+     * @return the pin count of the current net.
+     */
+    int GetPinCount() const { return m_pinCount; }
+
+    /**
+     * Function GetMinConnexion
+     * @return the minimal connection (NOC, NOD, NET_NC, DRV or NPI) the current net
+     * gives to its pin \a aNetItemRef, from the other pins and no connect symbols of
+     * the net.
+     */
+    int GetMinConnexion( unsigned aNetItemRef ) const;
+
+    /**
+     * Function NextConflict
+     * @return the index of the first pin of the current net after \a aNetItemRef whose
+     * electrical type is not OK with the one of \a aNetItemRef in DiagErc, or -1.
+     * The pins of a net must be queried in increasing index order.
+     */
+    int NextConflict( unsigned aNetItemRef );
+
+    /**
+     * Function IsInstanceConnected
+     * @return true if an other instance of the pin \a aNetItemRef (same component
+     * reference and pin number, for multiple parts per package) is connected to an
+     * other item.
+     */
+    bool IsInstanceConnected( unsigned aNetItemRef );
+
+private:
+    typedef std::pair<wxString, long>                   PIN_KEY;
+    typedef std::map< PIN_KEY, std::vector<unsigned> >  PIN_INSTANCES;
+
+    PIN_KEY pinKey( unsigned aIdx ) const;
+
+    NETLIST_OBJECT_LIST*  m_list;
+    int                   m_pinCount;
+    bool                  m_hasNoConnect;
+    int                   m_count[PIN_NMAX];   ///< pin count of each type in the net
+    std::vector<unsigned> m_pins[PIN_NMAX];    ///< their indexes, in list order
+    unsigned              m_next[PIN_NMAX];    ///< first entry of m_pins not yet passed
+    PIN_INSTANCES         m_instances;         ///< pins by reference and number
+    bool                  m_instancesBuilt;    ///< m_instances is built on first use
+};
+
 /**
  * Perform ERC testing for electrical conflicts between \a NetItemRef and other items
  * (mainly pin) on the same net.
  * @param aList = a reference to the list of connected objects
  * @param aNetItemRef = index in list of the current object
- * @param aNetStart = index in list of net objects of the first item
+ * @param aNetPins = the census of the net of aNetItemRef
  * @param aMinConnexion = a pointer to a variable to store the minimal connection
  * found( NOD, DRV, NPI, NET_NC)
  */
-extern void TestOthersItems( NETLIST_OBJECT_LIST* aList,
-                             unsigned aNetItemRef, unsigned aNetStart,
-                             int* aMinConnexion );
+extern void TestOthersItems( NETLIST_OBJECT_LIST* aList, unsigned aNetItemRef,
+                             ERC_NET_PINS& aNetPins, int* aMinConnexion );
 
 /**
  * Counts number of pins connected on the same net.
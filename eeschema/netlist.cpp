@@ -44,7 +44,11 @@
 #include <sch_text.h>
 #include <sch_sheet.h>
 #include <algorithm>
+#include <map>
 #include <invoke_sch_dialog.h>
+#include <trigo.h>
+#include <hashtables.h>
+#include <geometry/rtree.h>
 #include <boost/foreach.hpp>
 
 #define IS_WIRE false
@@ -181,6 +185,166 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase()
 }
 
 
+typedef boost::unordered_map<wxPoint, NETLIST_OBJECTS, WXPOINT_HASH>   POINT_MAP;
+typedef RTree<NETLIST_OBJECT*, int, 2, float>                          SEGMENT_RTREE;
+typedef boost::unordered_map<wxString, NETLIST_OBJECTS, WXSTRING_HASH> LABEL_MAP;
+
+
+/**
+ * Struct NETLIST_SHEET_INDEX
+ * gives the items of a sheet which can be physically connected to a given point:
+ * the items having an end at this point, and the wires and buses passing by this point.
+ */
+struct NETLIST_SHEET_INDEX
+{
+    POINT_MAP       m_wireEnds;     // ends of the items connected point to point to wires
+    POINT_MAP       m_busEnds;      // ends of the items connected point to point to buses
+    SEGMENT_RTREE   m_wires;        // NET_SEGMENT items
+    SEGMENT_RTREE   m_buses;        // NET_BUS items
+
+    /**
+     * Function Build
+     * fills the index with the items aStart to aEnd - 1 of aList, all in the same sheet.
+     */
+    void Build( const NETLIST_OBJECT_LIST& aList, unsigned aStart, unsigned aEnd );
+
+private:
+    static void addEnds( POINT_MAP& aMap, NETLIST_OBJECT* aItem );
+    static void addSegment( SEGMENT_RTREE& aTree, NETLIST_OBJECT* aItem );
+};
+
+
+void NETLIST_SHEET_INDEX::addEnds( POINT_MAP& aMap, NETLIST_OBJECT* aItem )
+{
+    aMap[aItem->m_Start].push_back( aItem );
+
+    if( aItem->m_End != aItem->m_Start )
+        aMap[aItem->m_End].push_back( aItem );
+}
+
+
+void NETLIST_SHEET_INDEX::addSegment( SEGMENT_RTREE& aTree, NETLIST_OBJECT* aItem )
+{
+    const int mmin[2] = { std::min( aItem->m_Start.x, aItem->m_End.x ),
+                          std::min( aItem->m_Start.y, aItem->m_End.y ) };
+    const int mmax[2] = { std::max( aItem->m_Start.x, aItem->m_End.x ),
+                          std::max( aItem->m_Start.y, aItem->m_End.y ) };
+
+    aTree.Insert( mmin, mmax, aItem );
+}
+
+
+void NETLIST_SHEET_INDEX::Build( const NETLIST_OBJECT_LIST& aList, unsigned aStart,
+                                 unsigned aEnd )
+{
+    m_wireEnds.clear();
+    m_busEnds.clear();
+    m_wires.RemoveAll();
+    m_buses.RemoveAll();
+
+    for( unsigned ii = aStart; ii < aEnd; ii++ )
+    {
+        NETLIST_OBJECT* item = aList.GetItem( ii );
+
+        switch( item->m_Type )
+        {
+        case NET_SEGMENT:
+            addSegment( m_wires, item );
+            addEnds( m_wireEnds, item );
+            break;
+
+        case NET_PIN:
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+        case NET_SHEETLABEL:
+        case NET_PINLABEL:
+        case NET_NOCONNECT:
+            addEnds( m_wireEnds, item );
+            break;
+
+        case NET_JUNCTION:
+            addEnds( m_wireEnds, item );
+            addEnds( m_busEnds, item );
+            break;
+
+        case NET_BUS:
+            addSegment( m_buses, item );
+            addEnds( m_busEnds, item );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_SHEETBUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            addEnds( m_busEnds, item );
+            break;
+
+        case NET_ITEM_UNSPECIFIED:
+            break;
+        }
+    }
+}
+
+
+/**
+ * Struct NETLIST_LABEL_INDEX
+ * gives the label type items (see NETLIST_OBJECT::IsLabelType()) having a given name.
+ */
+struct NETLIST_LABEL_INDEX
+{
+    LABEL_MAP   m_labels;       // key: the label name, lower case
+
+    void Build( const NETLIST_OBJECT_LIST& aList )
+    {
+        m_labels.clear();
+
+        for( unsigned ii = 0; ii < aList.size(); ii++ )
+        {
+            NETLIST_OBJECT* item = aList.GetItem( ii );
+
+            if( item->IsLabelType() )
+                m_labels[item->m_Label.Lower()].push_back( item );
+        }
+    }
+
+    /// @return the labels named aName (case insensitive), or NULL if none.
+    const NETLIST_OBJECTS* Find( const wxString& aName ) const
+    {
+        LABEL_MAP::const_iterator it = m_labels.find( aName.Lower() );
+
+        return it == m_labels.end() ? NULL : &it->second;
+    }
+};
+
+
+/**
+ * Struct SEGMENT_COLLECTOR
+ * is the R-tree visitor of NETLIST_OBJECT_LIST::segmentToPointConnect(): it collects the
+ * segments of a sheet passing by a point.
+ */
+struct SEGMENT_COLLECTOR
+{
+    const NETLIST_OBJECT*   m_ref;
+    NETLIST_OBJECTS&        m_result;
+
+    SEGMENT_COLLECTOR( const NETLIST_OBJECT* aRef, NETLIST_OBJECTS& aResult ) :
+        m_ref( aRef ),
+        m_result( aResult )
+    {
+    }
+
+    bool operator()( NETLIST_OBJECT* aSegment )
+    {
+        if( aSegment->m_SheetPath == m_ref->m_SheetPath
+            && IsPointOnSegment( aSegment->m_Start, aSegment->m_End, m_ref->m_Start ) )
+            m_result.push_back( aSegment );
+
+        return true;
+    }
+};
+
+
 bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
 {
     SCH_SHEET_PATH* sheet;
@@ -189,10 +353,8 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     for( sheet = aSheets.GetFirst(); sheet != NULL;
          sheet = aSheets.GetNext() )
     {
-        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
-        {
-            item->GetNetListItem( *this, sheet );
-        }
+        // The items of the screens not modified since the last call are reused
+        sheet->LastScreen()->GetNetListItems( *this, sheet );
     }
 
     if( size() == 0 )
@@ -201,17 +363,26 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     // Sort objects by Sheet
     SortListbySheet();
 
-    sheet = &(GetItem( 0 )->m_SheetPath);
     m_lastNetCode = m_lastBusNetCode = 1;
+    m_netCodeParent.clear();
+    m_busNetCodeParent.clear();
 
-    for( unsigned ii = 0, istart = 0; ii < size(); ii++ )
+    // Physical connections are searched only between items of the same sheet, using an index
+    // of the items of the current sheet.
+    NETLIST_SHEET_INDEX sheetIndex;
+
+    for( unsigned ii = 0, sheetEnd = 0; ii < size(); ii++ )
     {
         NETLIST_OBJECT* net_item = GetItem( ii );
 
-        if( net_item->m_SheetPath != *sheet )   // Sheet change
+        if( ii == sheetEnd )   // Sheet change
         {
-            sheet  = &(net_item->m_SheetPath);
-            istart = ii;
+            sheet = &net_item->m_SheetPath;
+
+            while( sheetEnd < size() && GetItem( sheetEnd )->m_SheetPath.Cmp( *sheet ) == 0 )
+                sheetEnd++;
+
+            sheetIndex.Build( *this, ii, sheetEnd );
         }
 
         switch( net_item->m_Type )
@@ -235,7 +406,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastNetCode++;
             }
 
-            pointToPointConnect( net_item, IS_WIRE, istart );
+            pointToPointConnect( net_item, IS_WIRE, sheetIndex );
             break;
 
         case NET_JUNCTION:
@@ -246,7 +417,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( net_item, IS_WIRE, sheetIndex );
 
             // Control of the junction, on BUS.
             if( net_item->m_BusNetCode == 0 )
@@ -255,7 +426,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastBusNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( net_item, IS_BUS, sheetIndex );
             break;
 
         case NET_LABEL:
@@ -268,7 +439,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
+            segmentToPointConnect( net_item, IS_WIRE, sheetIndex );
             break;
 
         case NET_SHEETBUSLABELMEMBER:
@@ -283,7 +454,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastBusNetCode++;
             }
 
-            pointToPointConnect( net_item, IS_BUS, istart );
+            pointToPointConnect( net_item, IS_BUS, sheetIndex );
             break;
 
         case NET_BUSLABELMEMBER:
@@ -296,11 +467,14 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
                 m_lastBusNetCode++;
             }
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
+            segmentToPointConnect( net_item, IS_BUS, sheetIndex );
             break;
         }
     }
 
+    // The bus net codes are final now
+    resolveNetCodes();
+
 #if defined(NETLIST_DEBUG) && defined(DEBUG)
     std::cout << "\n\nafter sheet local\n\n";
     DumpNetTable();
@@ -309,6 +483,9 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     // Updating the Bus Labels Netcode connected by Bus
     connectBusLabels();
 
+    NETLIST_LABEL_INDEX labelIndex;
+    labelIndex.Build( *this );
+
     // Group objects by label.
     for( unsigned ii = 0; ii < size(); ii++ )
     {
@@ -327,7 +504,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
         case NET_PINLABEL:
         case NET_BUSLABELMEMBER:
         case NET_GLOBBUSLABELMEMBER:
-            labelConnect( GetItem( ii ) );
+            labelConnect( GetItem( ii ), labelIndex );
             break;
 
         case NET_SHEETBUSLABELMEMBER:
@@ -341,6 +518,7 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     }
 
 #if defined(NETLIST_DEBUG) && defined(DEBUG)
+    resolveNetCodes();
     std::cout << "\n\nafter sheet global\n\n";
     DumpNetTable();
 #endif
@@ -350,9 +528,11 @@ bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
     {
         if( GetItem( ii )->m_Type == NET_SHEETLABEL
             || GetItem( ii )->m_Type == NET_SHEETBUSLABELMEMBER )
-            sheetLabelConnect( GetItem( ii ) );
+            sheetLabelConnect( GetItem( ii ), labelIndex );
     }
 
+    resolveNetCodes();
+
     // Sort objects by NetCode
     SortListbyNetcode();
 
@@ -584,14 +764,22 @@ void NETLIST_OBJECT_LIST::findBestNetNameForEachNet()
 }
 
 
-void NETLIST_OBJECT_LIST::sheetLabelConnect( NETLIST_OBJECT* SheetLabel )
+void NETLIST_OBJECT_LIST::sheetLabelConnect( NETLIST_OBJECT* SheetLabel,
+                                             const NETLIST_LABEL_INDEX& aIndex )
 {
     if( SheetLabel->GetNet() == 0 )
         return;
 
-    for( unsigned ii = 0; ii < size(); ii++ )
+    const NETLIST_OBJECTS* labels = aIndex.Find( SheetLabel->m_Label );
+
+    if( !labels )
+        return;
+
+    int netCode = findNetCode( SheetLabel->GetNet(), IS_WIRE );
+
+    for( unsigned ii = 0; ii < labels->size(); ii++ )
     {
-        NETLIST_OBJECT* ObjetNet = GetItem( ii );
+        NETLIST_OBJECT* ObjetNet = (*labels)[ii];
 
         if( ObjetNet->m_SheetPath != SheetLabel->m_SheetPathInclude )
             continue;  //use SheetInclude, not the sheet!!
@@ -599,23 +787,19 @@ void NETLIST_OBJECT_LIST::sheetLabelConnect( NETLIST_OBJECT* SheetLabel )
         if( (ObjetNet->m_Type != NET_HIERLABEL ) && (ObjetNet->m_Type != NET_HIERBUSLABELMEMBER ) )
             continue;
 
-        if( ObjetNet->GetNet() == SheetLabel->GetNet() )
-            continue;  //already connected.
-
-        if( ObjetNet->m_Label.CmpNoCase( SheetLabel->m_Label ) != 0 )
-            continue;  //different names.
-
         // Propagate Netcode having all the objects of the same Netcode.
-        if( ObjetNet->GetNet() )
-            propageNetCode( ObjetNet->GetNet(), SheetLabel->GetNet(), IS_WIRE );
-        else
-            ObjetNet->SetNet( SheetLabel->GetNet() );
+        mergeNetCode( ObjetNet, netCode, IS_WIRE );
     }
 }
 
 
 void NETLIST_OBJECT_LIST::connectBusLabels()
 {
+    // The bus label members having the same bus net code and member number, in list order
+    typedef std::map< std::pair<int, int>, NETLIST_OBJECTS > BUS_MEMBER_MAP;
+
+    BUS_MEMBER_MAP busMembers;
+
     for( unsigned ii = 0; ii < size(); ii++ )
     {
         NETLIST_OBJECT* Label = GetItem( ii );
@@ -624,215 +808,186 @@ void NETLIST_OBJECT_LIST::connectBusLabels()
           || (Label->m_Type == NET_BUSLABELMEMBER)
           || (Label->m_Type == NET_HIERBUSLABELMEMBER) )
         {
-            if( Label->GetNet() == 0 )
-            {
-                Label->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+            busMembers[ std::make_pair( Label->m_BusNetCode, Label->m_Member ) ].push_back( Label );
+        }
+    }
 
-            for( unsigned jj = ii + 1; jj < size(); jj++ )
-            {
-                NETLIST_OBJECT* LabelInTst =  GetItem( jj );
-                if( (LabelInTst->m_Type == NET_SHEETBUSLABELMEMBER)
-                   || (LabelInTst->m_Type == NET_BUSLABELMEMBER)
-                   || (LabelInTst->m_Type == NET_HIERBUSLABELMEMBER) )
-                {
-                    if( LabelInTst->m_BusNetCode != Label->m_BusNetCode )
-                        continue;
+    // The first label of a group gives its net code to the others.  The groups are
+    // processed in the order of their first label, which is the order the net codes
+    // are merged in.
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* Label = GetItem( ii );
 
-                    if( LabelInTst->m_Member != Label->m_Member )
-                        continue;
+        if(  (Label->m_Type != NET_SHEETBUSLABELMEMBER)
+          && (Label->m_Type != NET_BUSLABELMEMBER)
+          && (Label->m_Type != NET_HIERBUSLABELMEMBER) )
+            continue;
 
-                    if( LabelInTst->GetNet() == 0 )
-                        LabelInTst->SetNet( Label->GetNet() );
-                    else
-                        propageNetCode( LabelInTst->GetNet(), Label->GetNet(), IS_WIRE );
-                }
-            }
+        const NETLIST_OBJECTS& group =
+                busMembers[ std::make_pair( Label->m_BusNetCode, Label->m_Member ) ];
+
+        if( group[0] != Label )
+            continue;   // already connected to the first label of its group
+
+        if( Label->GetNet() == 0 )
+        {
+            Label->SetNet( m_lastNetCode );
+            m_lastNetCode++;
         }
+
+        int netCode = findNetCode( Label->GetNet(), IS_WIRE );
+
+        for( unsigned jj = 1; jj < group.size(); jj++ )
+            mergeNetCode( group[jj], netCode, IS_WIRE );
     }
 }
 
 
-void NETLIST_OBJECT_LIST::propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus )
+int NETLIST_OBJECT_LIST::findNetCode( int aNetCode, bool aIsBus )
 {
-    if( aOldNetCode == aNewNetCode )
-        return;
+    std::vector<int>& parent = aIsBus ? m_busNetCodeParent : m_netCodeParent;
 
-    if( aIsBus == false )    // Propagate NetCode
-    {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
+    if( aNetCode >= (int) parent.size() )
+        return aNetCode;
 
-            if( object->GetNet() == aOldNetCode )
-                object->SetNet( aNewNetCode );
-        }
-    }
-    else               // Propagate BusNetCode
+    while( parent[aNetCode] != aNetCode )
     {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
-
-            if( object->m_BusNetCode == aOldNetCode )
-                object->m_BusNetCode = aNewNetCode;
-        }
+        parent[aNetCode] = parent[ parent[aNetCode] ];
+        aNetCode = parent[aNetCode];
     }
+
+    return aNetCode;
 }
 
 
-void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
-                                               int start )
+void NETLIST_OBJECT_LIST::propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus )
 {
-    int netCode;
+    aOldNetCode = findNetCode( aOldNetCode, aIsBus );
+    aNewNetCode = findNetCode( aNewNetCode, aIsBus );
 
-    if( aIsBus == false )    // Objects other than BUS and BUSLABELS
-    {
-        netCode = aRef->GetNet();
+    if( aOldNetCode == aNewNetCode )
+        return;
 
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
+    std::vector<int>& parent = aIsBus ? m_busNetCodeParent : m_netCodeParent;
+    int               needed = std::max( aOldNetCode, aNewNetCode ) + 1;
 
-            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
-                continue;
+    for( int code = parent.size(); code < needed; code++ )
+        parent.push_back( code );
 
-            switch( item->m_Type )
-            {
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_JUNCTION:
-            case NET_NOCONNECT:
-                if( aRef->m_Start == item->m_Start
-                    || aRef->m_Start == item->m_End
-                    || aRef->m_End   == item->m_Start
-                    || aRef->m_End   == item->m_End )
-                {
-                    if( item->GetNet() == 0 )
-                        item->SetNet( netCode );
-                    else
-                        propageNetCode( item->GetNet(), netCode, IS_WIRE );
-                }
-                break;
+    // aNewNetCode stays the root: it is the net code of the merged group
+    parent[aOldNetCode] = aNewNetCode;
+}
 
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_ITEM_UNSPECIFIED:
-                break;
-            }
-        }
+
+void NETLIST_OBJECT_LIST::mergeNetCode( NETLIST_OBJECT* aItem, int aNetCode, bool aIsBus )
+{
+    if( aIsBus == IS_WIRE )
+    {
+        if( aItem->GetNet() == 0 )
+            aItem->SetNet( aNetCode );
+        else
+            propageNetCode( aItem->GetNet(), aNetCode, IS_WIRE );
     }
-    else    // Object type BUS, BUSLABELS, and junctions.
+    else
     {
-        netCode = aRef->m_BusNetCode;
-
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
+        if( aItem->m_BusNetCode == 0 )
+            aItem->m_BusNetCode = aNetCode;
+        else
+            propageNetCode( aItem->m_BusNetCode, aNetCode, IS_BUS );
+    }
+}
 
-            if( item->m_SheetPath != aRef->m_SheetPath )
-                continue;
 
-            switch( item->m_Type )
-            {
-            case NET_ITEM_UNSPECIFIED:
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_NOCONNECT:
-                break;
+void NETLIST_OBJECT_LIST::resolveNetCodes()
+{
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* item = GetItem( ii );
 
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_JUNCTION:
-                if(  aRef->m_Start == item->m_Start
-                  || aRef->m_Start == item->m_End
-                  || aRef->m_End   == item->m_Start
-                  || aRef->m_End   == item->m_End )
-                {
-                    if( item->m_BusNetCode == 0 )
-                        item->m_BusNetCode = netCode;
-                    else
-                        propageNetCode( item->m_BusNetCode, netCode, IS_BUS );
-                }
-                break;
-            }
-        }
+        item->SetNet( findNetCode( item->GetNet(), IS_WIRE ) );
+        item->m_BusNetCode = findNetCode( item->m_BusNetCode, IS_BUS );
     }
+
+    m_netCodeParent.clear();
+    m_busNetCodeParent.clear();
 }
 
 
-void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
-                                                bool aIsBus, int aIdxStart )
+void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus,
+                                               NETLIST_SHEET_INDEX& aIndex )
 {
-    for( unsigned i = aIdxStart; i < size(); i++ )
+    // Objects other than BUS and BUSLABELS are in m_wireEnds,
+    // objects type BUS, BUSLABELS, and junctions are in m_busEnds
+    const POINT_MAP& ends = aIsBus ? aIndex.m_busEnds : aIndex.m_wireEnds;
+    int netCode = aIsBus ? findNetCode( aRef->m_BusNetCode, IS_BUS )
+                         : findNetCode( aRef->GetNet(), IS_WIRE );
+
+    for( int ii = 0; ii < 2; ii++ )
     {
-        NETLIST_OBJECT* segment = GetItem( i );
+        const wxPoint& pos = ii == 0 ? aRef->m_Start : aRef->m_End;
 
-        // if different sheets, obviously no physical connection between elements.
-        if( segment->m_SheetPath != aJonction->m_SheetPath )
+        if( ii == 1 && pos == aRef->m_Start )
+            break;
+
+        POINT_MAP::const_iterator it = ends.find( pos );
+
+        if( it == ends.end() )
             continue;
 
-        if( aIsBus == IS_WIRE )
-        {
-            if( segment->m_Type != NET_SEGMENT )
-                continue;
-        }
-        else
-        {
-            if( segment->m_Type != NET_BUS )
-                continue;
-        }
+        const NETLIST_OBJECTS& items = it->second;
 
-        if( IsPointOnSegment( segment->m_Start, segment->m_End, aJonction->m_Start ) )
+        for( unsigned jj = 0; jj < items.size(); jj++ )
         {
-            // Propagation Netcode has all the objects of the same Netcode.
-            if( aIsBus == IS_WIRE )
-            {
-                if( segment->GetNet() )
-                    propageNetCode( segment->GetNet(), aJonction->GetNet(), aIsBus );
-                else
-                    segment->SetNet( aJonction->GetNet() );
-            }
-            else
-            {
-                if( segment->m_BusNetCode )
-                    propageNetCode( segment->m_BusNetCode, aJonction->m_BusNetCode, aIsBus );
-                else
-                    segment->m_BusNetCode = aJonction->m_BusNetCode;
-            }
+            if( items[jj]->m_SheetPath == aRef->m_SheetPath )
+                mergeNetCode( items[jj], netCode, aIsBus );
         }
     }
 }
 
 
-void NETLIST_OBJECT_LIST::labelConnect( NETLIST_OBJECT* aLabelRef )
+void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus,
+                                                 NETLIST_SHEET_INDEX& aIndex )
+{
+    NETLIST_OBJECTS   segments;
+    SEGMENT_COLLECTOR collector( aJonction, segments );
+
+    const int pos[2] = { aJonction->m_Start.x, aJonction->m_Start.y };
+
+    if( aIsBus == IS_WIRE )
+        aIndex.m_wires.Search( pos, pos, collector );
+    else
+        aIndex.m_buses.Search( pos, pos, collector );
+
+    int netCode = aIsBus ? findNetCode( aJonction->m_BusNetCode, IS_BUS )
+                         : findNetCode( aJonction->GetNet(), IS_WIRE );
+
+    // Propagation Netcode has all the objects of the same Netcode.
+    for( unsigned ii = 0; ii < segments.size(); ii++ )
+        mergeNetCode( segments[ii], netCode, aIsBus );
+}
+
+
+void NETLIST_OBJECT_LIST::labelConnect( NETLIST_OBJECT* aLabelRef,
+                                        const NETLIST_LABEL_INDEX& aIndex )
 {
     if( aLabelRef->GetNet() == 0 )
         return;
 
-    for( unsigned i = 0; i < size(); i++ )
-    {
-        NETLIST_OBJECT* item = GetItem( i );
+    // NET_HIERLABEL are used to connect sheets.
+    // NET_LABEL are local to a sheet
+    // NET_GLOBLABEL are global.
+    // NET_PINLABEL is a kind of global label (generated by a power pin invisible)
+    const NETLIST_OBJECTS* labels = aIndex.Find( aLabelRef->m_Label );
 
-        if( item->GetNet() == aLabelRef->GetNet() )
-            continue;
+    if( !labels )
+        return;
+
+    int netCode = findNetCode( aLabelRef->GetNet(), IS_WIRE );
+
+    for( unsigned i = 0; i < labels->size(); i++ )
+    {
+        NETLIST_OBJECT* item = (*labels)[i];
 
         if( item->m_SheetPath != aLabelRef->m_SheetPath )
         {
@@ -847,20 +1002,7 @@ void NETLIST_OBJECT_LIST::labelConnect( NETLIST_OBJECT* aLabelRef )
                 continue;
         }
 
-        // NET_HIERLABEL are used to connect sheets.
-        // NET_LABEL are local to a sheet
-        // NET_GLOBLABEL are global.
-        // NET_PINLABEL is a kind of global label (generated by a power pin invisible)
-        if( item->IsLabelType() )
-        {
-            if( item->m_Label.CmpNoCase( aLabelRef->m_Label ) != 0 )
-                continue;
-
-            if( item->GetNet() )
-                propageNetCode( item->GetNet(), aLabelRef->GetNet(), IS_WIRE );
-            else
-                item->SetNet( aLabelRef->GetNet() );
-        }
+        mergeNetCode( item, netCode, IS_WIRE );
     }
 }
 
@@ -29,6 +29,7 @@
 #include <macros.h>
 
 #include <sch_sheet_path.h>
+#include <class_sch_screen.h>
 #include <transform.h>
 #include <sch_collectors.h>
 #include <sch_component.h>
@@ -468,8 +469,14 @@ bool SCH_FIND_COLLECTOR::ReplaceItem( SCH_SHEET_PATH* aSheetPath )
     bool replaced = item->Replace( m_findReplaceData, aSheetPath );
 
     if( replaced )
+    {
         SetForceSearch();
 
+        // The item is not always in the current screen: record the change of its screen
+        if( aSheetPath && aSheetPath->LastScreen() )
+            aSheetPath->LastScreen()->IncModificationCount();
+    }
+
     return replaced;
 }
 
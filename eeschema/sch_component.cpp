@@ -1487,6 +1487,32 @@ EDA_RECT SCH_COMPONENT::GetBodyBoundingBox() const
 }
 
 
+EDA_RECT SCH_COMPONENT::GetPartBoundingBox() const
+{
+    EDA_RECT    bBox;
+
+    if( PART_SPTR part = m_part.lock() )
+    {
+        bBox = part->GetBoundingBox( m_unit, m_convert );
+    }
+    else
+    {
+        bBox = dummy()->GetBoundingBox( m_unit, m_convert );
+    }
+
+    // Same Y axis reversal as in GetBodyBoundingBox()
+    wxPoint start = m_transform.TransformCoordinate( wxPoint( bBox.GetX(), -bBox.GetY() ) );
+    wxPoint end = m_transform.TransformCoordinate( wxPoint( bBox.GetRight(), -bBox.GetBottom() ) );
+
+    bBox.SetOrigin( start );
+    bBox.SetEnd( end );
+    bBox.Normalize();
+    bBox.Offset( m_Pos );
+
+    return bBox;
+}
+
+
 const EDA_RECT SCH_COMPONENT::GetBoundingBox() const
 {
     EDA_RECT bbox = GetBodyBoundingBox();
@@ -255,6 +255,13 @@ public:
 
     const EDA_RECT GetBoundingBox() const;    // Virtual
 
+    /**
+     * Function GetPartBoundingBox
+     * @return the bounding box of the part graphic items and pins, pin texts included,
+     *         in schematic coordinates.  The fields are not included.
+     */
+    EDA_RECT GetPartBoundingBox() const;
+
     //-----<Fields>-----------------------------------------------------------
 
     /**
@@ -53,7 +53,10 @@
 #include <sch_component.h>
 #include <sch_text.h>
 #include <lib_pin.h>
+#include <hashtables.h>
+#include <geometry/rtree.h>
 
+#include <algorithm>
 #include <boost/foreach.hpp>
 
 #define EESCHEMA_FILE_STAMP   "EESchema"
@@ -93,12 +96,278 @@ static GRID_TYPE SchematicGridList[] = {
 };
 
 
+/// Margin added around the item areas in SCH_SCREEN_INDEX, which covers the line widths
+/// and the small accuracies used to hit test the items.
+#define INDEX_MARGIN    50
+
+
+/**
+ * Class SCH_SCREEN_INDEX
+ * is the spatial index of the items of a SCH_SCREEN: an R-tree of the areas where the
+ * items can be hit, pins, fields and sheet pins included, and a hash of their connection
+ * points.
+ * <p>
+ * The queries give the items in draw list order, because the SCH_SCREEN searches return
+ * the first item found and must not depend on the index.
+ * </p>
+ */
+class SCH_SCREEN_INDEX
+{
+public:
+    SCH_SCREEN_INDEX() :
+        m_nextOrder( 0 )
+    {
+    }
+
+    void Clear();
+
+    /// Adds \a aItem after the items already indexed, in draw list order.
+    void Add( SCH_ITEM* aItem );
+
+    void Remove( SCH_ITEM* aItem );
+
+    /// Indexes \a aItem again after its geometry was changed, keeping its order.
+    void Update( SCH_ITEM* aItem );
+
+    /// Fills \a aItems with the items whose area intersects \a aArea.
+    void Query( const EDA_RECT& aArea, std::vector<SCH_ITEM*>& aItems );
+
+    /// Fills \a aItems with the items having a connection point at \a aPosition.
+    void QueryConnections( const wxPoint& aPosition, std::vector<SCH_ITEM*>& aItems ) const;
+
+    /// @return the indexed area of \a aItem, which must be indexed.
+    const EDA_RECT& GetArea( SCH_ITEM* aItem ) const;
+
+private:
+    struct ENTRY
+    {
+        EDA_RECT                m_area;
+        std::vector<wxPoint>    m_points;       // connection points
+        int                     m_order;        // rank in the draw list
+    };
+
+    typedef boost::unordered_map<SCH_ITEM*, ENTRY>                               ENTRY_MAP;
+    typedef boost::unordered_map<wxPoint, std::vector<SCH_ITEM*>, WXPOINT_HASH> POINT_MAP;
+    typedef RTree<SCH_ITEM*, int, 2, float>                                      ITEM_RTREE;
+
+    struct COLLECTOR
+    {
+        std::vector<SCH_ITEM*>& m_items;
+
+        COLLECTOR( std::vector<SCH_ITEM*>& aItems ) : m_items( aItems ) {}
+
+        bool operator()( SCH_ITEM* aItem )
+        {
+            m_items.push_back( aItem );
+            return true;
+        }
+    };
+
+    void insert( SCH_ITEM* aItem, ENTRY& aEntry );
+    void erase( SCH_ITEM* aItem, ENTRY& aEntry );
+    void sortByOrder( std::vector<SCH_ITEM*>& aItems ) const;
+
+    ENTRY_MAP   m_entries;
+    POINT_MAP   m_points;
+    ITEM_RTREE  m_tree;
+    int         m_nextOrder;
+};
+
+
+void SCH_SCREEN_INDEX::Clear()
+{
+    m_entries.clear();
+    m_points.clear();
+    m_tree.RemoveAll();
+    m_nextOrder = 0;
+}
+
+
+void SCH_SCREEN_INDEX::insert( SCH_ITEM* aItem, ENTRY& aEntry )
+{
+    EDA_RECT area = aItem->GetBoundingBox();
+
+    switch( aItem->Type() )
+    {
+    case SCH_COMPONENT_T:
+        // The pins and their texts are not in the component bounding box
+        area.Merge( ( (SCH_COMPONENT*) aItem )->GetPartBoundingBox() );
+        break;
+
+    case SCH_SHEET_T:
+        BOOST_FOREACH( SCH_SHEET_PIN& pin, ( (SCH_SHEET*) aItem )->GetPins() )
+            area.Merge( pin.GetBoundingBox() );
+        break;
+
+    default:
+        break;
+    }
+
+    std::vector< DANGLING_END_ITEM > endPoints;
+    aItem->GetEndPoints( endPoints );
+
+    aEntry.m_points.clear();
+
+    if( aItem->Type() == SCH_COMPONENT_T )
+    {
+        // SCH_COMPONENT::GetConnectionPoints() complains about the missing parts,
+        // the end points are the same pin positions.
+        for( unsigned ii = 0; ii < endPoints.size(); ii++ )
+            aEntry.m_points.push_back( endPoints[ii].GetPosition() );
+    }
+    else
+    {
+        aItem->GetConnectionPoints( aEntry.m_points );
+
+        for( unsigned ii = 0; ii < endPoints.size(); ii++ )
+            area.Merge( endPoints[ii].GetPosition() );
+    }
+
+    for( unsigned ii = 0; ii < aEntry.m_points.size(); ii++ )
+    {
+        area.Merge( aEntry.m_points[ii] );
+        m_points[ aEntry.m_points[ii] ].push_back( aItem );
+    }
+
+    area.Normalize();
+    area.Inflate( INDEX_MARGIN + aItem->GetPenSize() );
+    aEntry.m_area = area;
+
+    const int min[2] = { area.GetX(), area.GetY() };
+    const int max[2] = { area.GetRight(), area.GetBottom() };
+
+    m_tree.Insert( min, max, aItem );
+}
+
+
+void SCH_SCREEN_INDEX::erase( SCH_ITEM* aItem, ENTRY& aEntry )
+{
+    const int min[2] = { aEntry.m_area.GetX(), aEntry.m_area.GetY() };
+    const int max[2] = { aEntry.m_area.GetRight(), aEntry.m_area.GetBottom() };
+
+    m_tree.Remove( min, max, aItem );
+
+    for( unsigned ii = 0; ii < aEntry.m_points.size(); ii++ )
+    {
+        POINT_MAP::iterator it = m_points.find( aEntry.m_points[ii] );
+
+        if( it == m_points.end() )
+            continue;
+
+        std::vector<SCH_ITEM*>& items = it->second;
+        std::vector<SCH_ITEM*>::iterator found = std::find( items.begin(), items.end(), aItem );
+
+        if( found != items.end() )
+            items.erase( found );
+
+        if( items.empty() )
+            m_points.erase( it );
+    }
+}
+
+
+void SCH_SCREEN_INDEX::Add( SCH_ITEM* aItem )
+{
+    ENTRY& entry = m_entries[ aItem ];
+
+    entry.m_order = m_nextOrder++;
+    insert( aItem, entry );
+}
+
+
+void SCH_SCREEN_INDEX::Remove( SCH_ITEM* aItem )
+{
+    ENTRY_MAP::iterator it = m_entries.find( aItem );
+
+    if( it == m_entries.end() )
+        return;
+
+    erase( aItem, it->second );
+    m_entries.erase( it );
+}
+
+
+void SCH_SCREEN_INDEX::Update( SCH_ITEM* aItem )
+{
+    ENTRY_MAP::iterator it = m_entries.find( aItem );
+
+    wxCHECK_RET( it != m_entries.end(), wxT( "Item not indexed.  Bad programmer!" ) );
+
+    erase( aItem, it->second );
+    insert( aItem, it->second );
+}
+
+
+void SCH_SCREEN_INDEX::sortByOrder( std::vector<SCH_ITEM*>& aItems ) const
+{
+    std::vector< std::pair<int, SCH_ITEM*> > ordered;
+
+    ordered.reserve( aItems.size() );
+
+    for( unsigned ii = 0; ii < aItems.size(); ii++ )
+        ordered.push_back( std::make_pair( m_entries.find( aItems[ii] )->second.m_order,
+                                           aItems[ii] ) );
+
+    std::sort( ordered.begin(), ordered.end() );
+
+    for( unsigned ii = 0; ii < ordered.size(); ii++ )
+        aItems[ii] = ordered[ii].second;
+}
+
+
+void SCH_SCREEN_INDEX::Query( const EDA_RECT& aArea, std::vector<SCH_ITEM*>& aItems )
+{
+    EDA_RECT area = aArea;
+
+    area.Normalize();
+
+    const int min[2] = { area.GetX(), area.GetY() };
+    const int max[2] = { area.GetRight(), area.GetBottom() };
+
+    COLLECTOR collector( aItems );
+
+    aItems.clear();
+    m_tree.Search( min, max, collector );
+    sortByOrder( aItems );
+}
+
+
+void SCH_SCREEN_INDEX::QueryConnections( const wxPoint& aPosition,
+                                         std::vector<SCH_ITEM*>& aItems ) const
+{
+    aItems.clear();
+
+    POINT_MAP::const_iterator it = m_points.find( aPosition );
+
+    if( it == m_points.end() )
+        return;
+
+    aItems = it->second;
+
+    // An item can have several connection points at the same position
+    sortByOrder( aItems );
+    aItems.erase( std::unique( aItems.begin(), aItems.end() ), aItems.end() );
+}
+
+
+const EDA_RECT& SCH_SCREEN_INDEX::GetArea( SCH_ITEM* aItem ) const
+{
+    return m_entries.find( aItem )->second.m_area;
+}
+
+
 SCH_SCREEN::SCH_SCREEN( KIWAY* aKiway ) :
     BASE_SCREEN( SCH_SCREEN_T ),
     KIWAY_HOLDER( aKiway ),
     m_paper( wxT( "A4" ) )
 {
     m_modification_sync = 0;
+    m_netListModificationCount = 0;
+    m_netListLibsHash = 0;
+    m_noNetListModificationCount = 0;
+    m_index = NULL;
+    m_indexModificationCount = 0;
+    m_indexLibsHash = 0;
 
     SetZoom( 32 );
 
@@ -122,6 +391,8 @@ SCH_SCREEN::~SCH_SCREEN()
 {
     ClearUndoRedoList();
     FreeDrawList();
+    clearNetListItems();
+    delete m_index;
 }
 
 
@@ -153,12 +424,93 @@ void SCH_SCREEN::Clear()
 void SCH_SCREEN::FreeDrawList()
 {
     m_drawList.DeleteAll();
+    IncModificationCount();
+
+    if( m_index )
+    {
+        m_index->Clear();
+        m_indexModificationCount = GetModificationCount();
+    }
+}
+
+
+/**
+ * Function hasNetListItems
+ * @return false for the items whose SCH_ITEM::GetNetListItem() gives nothing.
+ */
+static bool hasNetListItems( const SCH_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case SCH_MARKER_T:
+    case SCH_BITMAP_T:
+        return false;
+
+    default:
+        // Notes: texts and graphic lines
+        return aItem->GetLayer() != LAYER_NOTES;
+    }
+}
+
+
+void SCH_SCREEN::itemChanged( const SCH_ITEM* aItem )
+{
+    IncModificationCount();
+
+    if( !hasNetListItems( aItem ) )
+        ++m_noNetListModificationCount;
+}
+
+
+void SCH_SCREEN::Append( SCH_ITEM* aItem )
+{
+    bool indexed = isIndexSynchronized();
+
+    m_drawList.Append( aItem );
+    --m_modification_sync;
+    itemChanged( aItem );
+
+    if( indexed )
+    {
+        m_index->Add( aItem );
+        m_indexModificationCount = GetModificationCount();
+    }
+}
+
+
+void SCH_SCREEN::Append( DLIST< SCH_ITEM >& aList )
+{
+    bool      indexed = isIndexSynchronized();
+    SCH_ITEM* last = m_drawList.GetLast();
+
+    m_drawList.Append( aList );
+    --m_modification_sync;
+    IncModificationCount();
+
+    if( indexed )
+    {
+        SCH_ITEM* item = last ? last->Next() : m_drawList.begin();
+
+        for( ; item; item = item->Next() )
+            m_index->Add( item );
+
+        m_indexModificationCount = GetModificationCount();
+    }
 }
 
 
 void SCH_SCREEN::Remove( SCH_ITEM* aItem )
 {
+    bool indexed = isIndexSynchronized();
+
     m_drawList.Remove( aItem );
+    itemChanged( aItem );
+
+    if( indexed )
+    {
+        m_index->Remove( aItem );
+        m_indexModificationCount = GetModificationCount();
+    }
 }
 
 
@@ -166,8 +518,14 @@ void SCH_SCREEN::DeleteItem( SCH_ITEM* aItem )
 {
     wxCHECK_RET( aItem, wxT( "Cannot delete invalid item from screen." ) );
 
+    bool indexed = isIndexSynchronized();
+
     SetModify();
 
+    // SetModify() incremented the modification count
+    if( !hasNetListItems( aItem ) )
+        ++m_noNetListModificationCount;
+
     if( aItem->Type() == SCH_SHEET_PIN_T )
     {
         // This structure is attached to a sheet, get the parent sheet object.
@@ -176,12 +534,62 @@ void SCH_SCREEN::DeleteItem( SCH_ITEM* aItem )
         wxCHECK_RET( sheet,
                      wxT( "Sheet label parent not properly set, bad programmer!" ) );
         sheet->RemovePin( sheetPin );
-        return;
+
+        if( indexed )
+            m_index->Update( sheet );
     }
     else
     {
+        if( indexed )
+            m_index->Remove( aItem );
+
         delete m_drawList.Remove( aItem );
     }
+
+    if( indexed )
+        m_indexModificationCount = GetModificationCount();
+}
+
+
+bool SCH_SCREEN::isIndexSynchronized() const
+{
+    return m_index && m_indexModificationCount == GetModificationCount();
+}
+
+
+SCH_SCREEN_INDEX& SCH_SCREEN::getIndex( bool aForceRebuild ) const
+{
+    // The component pins come from the library parts
+    int libsHash = Prj().SchLibs()->GetModifyHash();
+
+    if( !m_index )
+    {
+        m_index = new SCH_SCREEN_INDEX();
+        aForceRebuild = true;
+    }
+
+    if( aForceRebuild || !isIndexSynchronized() || m_indexLibsHash != libsHash )
+    {
+        m_index->Clear();
+
+        for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+            m_index->Add( item );
+
+        m_indexModificationCount = GetModificationCount();
+        m_indexLibsHash = libsHash;
+    }
+
+    return *m_index;
+}
+
+
+void SCH_SCREEN::getItems( const wxPoint& aPosition, int aAccuracy,
+                           std::vector<SCH_ITEM*>& aItems ) const
+{
+    EDA_RECT area( aPosition, wxSize( 0, 0 ) );
+
+    area.Inflate( aAccuracy );
+    getIndex().Query( area, aItems );
 }
 
 
@@ -203,8 +611,14 @@ bool SCH_SCREEN::CheckIfOnDrawList( SCH_ITEM* aItem )
 
 SCH_ITEM* SCH_SCREEN::GetItem( const wxPoint& aPosition, int aAccuracy, KICAD_T aType ) const
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> items;
+
+    getItems( aPosition, aAccuracy, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( item->HitTest( aPosition, aAccuracy ) && (aType == NOT_USED) )
             return item;
 
@@ -264,6 +678,8 @@ void SCH_SCREEN::ExtractWires( DLIST< SCH_ITEM >& aList, bool aCreateCopy )
             break;
         }
     }
+
+    IncModificationCount();
 }
 
 
@@ -290,6 +706,7 @@ void SCH_SCREEN::ReplaceWires( DLIST< SCH_ITEM >& aWireList )
     }
 
     m_drawList.Append( aWireList );
+    IncModificationCount();
 }
 
 
@@ -298,8 +715,22 @@ void SCH_SCREEN::MarkConnections( SCH_LINE* aSegment )
     wxCHECK_RET( (aSegment) && (aSegment->Type() == SCH_LINE_T),
                  wxT( "Invalid object pointer." ) );
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    // Only the junctions and lines having a connection point at an end of aSegment
+    // can be marked.
+    std::vector<SCH_ITEM*> items;
+    std::vector<SCH_ITEM*> endItems;
+
+    getIndex().QueryConnections( aSegment->GetStartPoint(), items );
+    getIndex().QueryConnections( aSegment->GetEndPoint(), endItems );
+
+    items.insert( items.end(), endItems.begin(), endItems.end() );
+    std::sort( items.begin(), items.end() );
+    items.erase( std::unique( items.begin(), items.end() ), items.end() );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( item->GetFlags() & CANDIDATE )
             continue;
 
@@ -428,6 +859,11 @@ bool SCH_SCREEN::SchematicCleanUp( EDA_DRAW_PANEL* aCanvas, wxDC* aDC )
 {
     SCH_ITEM* item, * testItem;
     bool      modified = false;
+    bool      merged;
+    std::vector<SCH_ITEM*> testItems;
+
+    // The items can have been moved without the screen being modified yet.
+    SCH_SCREEN_INDEX& index = getIndex( true );
 
     item = m_drawList.begin();
 
@@ -436,47 +872,46 @@ bool SCH_SCREEN::SchematicCleanUp( EDA_DRAW_PANEL* aCanvas, wxDC* aDC )
         if( ( item->Type() != SCH_LINE_T ) && ( item->Type() != SCH_JUNCTION_T ) )
             continue;
 
-        testItem = item->Next();
-
-        while( testItem )
+        // Only the items close to item can be merged with it.  The items before item
+        // in the list were already tested against it, unless item absorbed other items.
+        do
         {
-            if( ( item->Type() == SCH_LINE_T ) && ( testItem->Type() == SCH_LINE_T ) )
-            {
-                SCH_LINE* line = (SCH_LINE*) item;
+            merged = false;
+            index.Query( index.GetArea( item ), testItems );
 
-                if( line->MergeOverlap( (SCH_LINE*) testItem ) )
-                {
-                    // Keep the current flags, because the deleted segment can be flagged.
-                    item->SetFlags( testItem->GetFlags() );
-                    DeleteItem( testItem );
-                    testItem = m_drawList.begin();
-                    modified = true;
-                }
-                else
-                {
-                    testItem = testItem->Next();
-                }
-            }
-            else if ( ( ( item->Type() == SCH_JUNCTION_T ) && ( testItem->Type() == SCH_JUNCTION_T ) ) && ( testItem != item ) )
+            for( unsigned ii = 0; ii < testItems.size() && !merged; ii++ )
             {
-                if ( testItem->HitTest( item->GetPosition() ) )
+                testItem = testItems[ii];
+
+                if( testItem == item )
+                    continue;
+
+                if( ( item->Type() == SCH_LINE_T ) && ( testItem->Type() == SCH_LINE_T ) )
                 {
-                    // Keep the current flags, because the deleted segment can be flagged.
-                    item->SetFlags( testItem->GetFlags() );
-                    DeleteItem( testItem );
-                    testItem = m_drawList.begin();
-                    modified = true;
+                    SCH_LINE* line = (SCH_LINE*) item;
+
+                    if( line->MergeOverlap( (SCH_LINE*) testItem ) )
+                    {
+                        // Keep the current flags, because the deleted segment can be flagged.
+                        item->SetFlags( testItem->GetFlags() );
+                        DeleteItem( testItem );
+                        index.Update( item );
+                        merged = modified = true;
+                    }
                 }
-                else
+                else if( ( item->Type() == SCH_JUNCTION_T )
+                         && ( testItem->Type() == SCH_JUNCTION_T ) )
                 {
-                    testItem = testItem->Next();
+                    if( testItem->HitTest( item->GetPosition() ) )
+                    {
+                        // Keep the current flags, because the deleted segment can be flagged.
+                        item->SetFlags( testItem->GetFlags() );
+                        DeleteItem( testItem );
+                        merged = modified = true;
+                    }
                 }
             }
-            else
-            {
-                testItem = testItem->Next();
-            }
-        }
+        } while( merged );
     }
 
     TestDanglingEnds( aCanvas, aDC );
@@ -647,12 +1082,17 @@ void SCH_SCREEN::ClearDrawingState()
 LIB_PIN* SCH_SCREEN::GetPin( const wxPoint& aPosition, SCH_COMPONENT** aComponent,
                              bool aEndPointOnly ) const
 {
+    std::vector<SCH_ITEM*> items;
     SCH_ITEM*       item;
     SCH_COMPONENT*  component = NULL;
     LIB_PIN*        pin = NULL;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    getItems( aPosition, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        item = items[ii];
+
         if( item->Type() != SCH_COMPONENT_T )
             continue;
 
@@ -719,10 +1159,15 @@ SCH_SHEET* SCH_SCREEN::GetSheet( const wxString& aName )
 
 SCH_SHEET_PIN* SCH_SCREEN::GetSheetLabel( const wxPoint& aPosition )
 {
+    std::vector<SCH_ITEM*> items;
     SCH_SHEET_PIN* sheetPin = NULL;
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    getItems( aPosition, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( item->Type() != SCH_SHEET_T )
             continue;
 
@@ -739,11 +1184,17 @@ SCH_SHEET_PIN* SCH_SCREEN::GetSheetLabel( const wxPoint& aPosition )
 
 int SCH_SCREEN::CountConnectedItems( const wxPoint& aPos, bool aTestJunctions ) const
 {
+    std::vector<SCH_ITEM*> items;
     SCH_ITEM* item;
     int       count = 0;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    // The items connected at aPos have a connection point there
+    getIndex().QueryConnections( aPos, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        item = items[ii];
+
         if( item->Type() == SCH_JUNCTION_T  && !aTestJunctions )
             continue;
 
@@ -771,6 +1222,9 @@ void SCH_SCREEN::ClearAnnotation( SCH_SHEET_PATH* aSheetPath )
             component->ClearFlags();
         }
     }
+
+    // The units of multiple parts per package components can be changed
+    IncModificationCount();
 }
 
 
@@ -788,6 +1242,56 @@ void SCH_SCREEN::GetHierarchicalItems( EDA_ITEMS& aItems )
 }
 
 
+void SCH_SCREEN::GetNetListItems( NETLIST_OBJECT_LIST& aNetListItems,
+                                  SCH_SHEET_PATH* aSheetPath )
+{
+    int libsHash = Prj().SchLibs()->GetModifyHash();
+
+    // The pins of the items refer to the library parts
+    if( m_netListModificationCount != getNetListModificationCount()
+        || m_netListLibsHash != libsHash )
+    {
+        clearNetListItems();
+        m_netListModificationCount = getNetListModificationCount();
+        m_netListLibsHash = libsHash;
+    }
+
+    NETLIST_OBJECT_LIST*& items = m_netListItems[ aSheetPath->Path() ];
+
+    // The items store the sheets of the path: if a sheet of the path was replaced
+    // (deleted and restored by undo for instance), they must be created again.
+    if( items && !items->empty() && items->GetItem( 0 )->m_SheetPath != *aSheetPath )
+    {
+        delete items;
+        items = NULL;
+    }
+
+    if( !items )
+    {
+        items = new NETLIST_OBJECT_LIST();
+
+        for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+            item->GetNetListItem( *items, aSheetPath );
+    }
+
+    aNetListItems.reserve( aNetListItems.size() + items->size() );
+
+    for( unsigned ii = 0; ii < items->size(); ii++ )
+        aNetListItems.push_back( new NETLIST_OBJECT( *items->GetItem( ii ) ) );
+}
+
+
+void SCH_SCREEN::clearNetListItems()
+{
+    std::map<wxString, NETLIST_OBJECT_LIST*>::iterator it;
+
+    for( it = m_netListItems.begin(); it != m_netListItems.end(); ++it )
+        delete it->second;
+
+    m_netListItems.clear();
+}
+
+
 void SCH_SCREEN::SelectBlockItems()
 {
     PICKED_ITEMS_LIST* pickedlist = &m_BlockLocate.GetItems();
@@ -935,13 +1439,30 @@ bool SCH_SCREEN::TestDanglingEnds( EDA_DRAW_PANEL* aCanvas, wxDC* aDC )
 {
     SCH_ITEM* item;
     std::vector< DANGLING_END_ITEM > endPoints;
+    std::vector<SCH_ITEM*> nearItems;
     bool hasDanglingEnds = false;
 
+    // The items can have been moved without the screen being modified yet.
+    SCH_SCREEN_INDEX& index = getIndex( true );
+
+    // The end points of each item, by item
+    boost::unordered_map< SCH_ITEM*, std::vector< DANGLING_END_ITEM > > itemEndPoints;
+
     for( item = m_drawList.begin(); item; item = item->Next() )
-        item->GetEndPoints( endPoints );
+        item->GetEndPoints( itemEndPoints[ item ] );
 
     for( item = m_drawList.begin(); item; item = item->Next() )
     {
+        // An end can only be connected to the items close to it
+        index.Query( index.GetArea( item ), nearItems );
+        endPoints.clear();
+
+        for( unsigned ii = 0; ii < nearItems.size(); ii++ )
+        {
+            std::vector< DANGLING_END_ITEM >& ends = itemEndPoints[ nearItems[ii] ];
+            endPoints.insert( endPoints.end(), ends.begin(), ends.end() );
+        }
+
         if( item->IsDanglingStateChanged( endPoints ) && ( aCanvas ) && ( aDC ) )
         {
             item->Draw( aCanvas, aDC, wxPoint( 0, 0 ), g_XorMode );
@@ -961,9 +1482,14 @@ bool SCH_SCREEN::BreakSegment( const wxPoint& aPoint )
     SCH_LINE* segment;
     SCH_LINE* newSegment;
     bool brokenSegments = false;
+    std::vector<SCH_ITEM*> items;
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    getItems( aPoint, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( (item->Type() != SCH_LINE_T) || (item->GetLayer() == LAYER_NOTES) )
             continue;
 
@@ -977,10 +1503,13 @@ bool SCH_SCREEN::BreakSegment( const wxPoint& aPoint )
         newSegment->SetStartPoint( aPoint );
         segment->SetEndPoint( aPoint );
         m_drawList.Insert( newSegment, segment->Next() );
-        item = newSegment;
         brokenSegments = true;
     }
 
+    // The new segments are not at the end of the list
+    if( brokenSegments )
+        IncModificationCount();
+
     return brokenSegments;
 }
 
@@ -1016,8 +1545,14 @@ bool SCH_SCREEN::BreakSegmentsOnJunctions()
 
 int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> items;
+
+    getItems( aPosition, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( item->Type() == SCH_LINE_T && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
         {
@@ -1035,8 +1570,14 @@ int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 
 SCH_LINE* SCH_SCREEN::GetWireOrBus( const wxPoint& aPosition )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> items;
+
+    getItems( aPosition, 0, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( (item->Type() == SCH_LINE_T) && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
         {
@@ -1051,8 +1592,14 @@ SCH_LINE* SCH_SCREEN::GetWireOrBus( const wxPoint& aPosition )
 SCH_LINE* SCH_SCREEN::GetLine( const wxPoint& aPosition, int aAccuracy, int aLayer,
                                SCH_LINE_TEST_T aSearchType )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> items;
+
+    getItems( aPosition, aAccuracy, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         if( item->Type() != SCH_LINE_T )
             continue;
 
@@ -1084,8 +1631,14 @@ SCH_LINE* SCH_SCREEN::GetLine( const wxPoint& aPosition, int aAccuracy, int aLay
 
 SCH_TEXT* SCH_SCREEN::GetLabel( const wxPoint& aPosition, int aAccuracy )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    std::vector<SCH_ITEM*> items;
+
+    getItems( aPosition, aAccuracy, items );
+
+    for( unsigned ii = 0; ii < items.size(); ii++ )
     {
+        SCH_ITEM* item = items[ii];
+
         switch( item->Type() )
         {
         case SCH_LABEL_T:
@@ -56,7 +56,7 @@ EDA_RECT GBR_LAYOUT::ComputeBoundingBox()
     {
         GERBER_IMAGE *gerber = *it;
 
-        for (std::list<GERBER_DRAW_ITEM *>::iterator jt = gerber->m_Drawings.begin();
+        for (std::vector<GERBER_DRAW_ITEM *>::iterator jt = gerber->m_Drawings.begin();
              jt != gerber->m_Drawings.end(); ++jt)
         {
             GERBER_DRAW_ITEM* item = *jt;
@@ -145,6 +145,8 @@ void GBR_LAYOUT::Draw( EDA_DRAW_PANEL* aPanel,
 
     bool doBlit = false; // this flag requests an image transfer to actual screen when true.
 
+    std::vector<GERBER_DRAW_ITEM*> visibleItems;
+
     bool end = false;
 
     // Draw layers from bottom to top, and active layer last
@@ -252,7 +254,13 @@ void GBR_LAYOUT::Draw( EDA_DRAW_PANEL* aPanel,
 
         // Now we can draw the current layer to the bitmap buffer
         // When needed, the previous bitmap is already copied to the screen buffer.
-        for (std::list<GERBER_DRAW_ITEM*>::iterator it=gerber->m_Drawings.begin(); it != gerber->m_Drawings.end(); ++it)
+        // On screen, only the items inside the clip box are drawn.
+        if( aDisplayOptions.m_IsPrinting )
+            visibleItems = gerber->m_Drawings;
+        else
+            gerber->QueryItems( drawBox, visibleItems );
+
+        for (std::vector<GERBER_DRAW_ITEM*>::iterator it=visibleItems.begin(); it != visibleItems.end(); ++it)
         {
             GERBER_DRAW_ITEM* item = *it;
             GR_DRAWMODE drawMode = layerdrawMode;
@@ -330,6 +338,7 @@ void GBR_LAYOUT::DrawItemsDCodeID( EDA_DRAW_PANEL* aPanel,
     GRSetDrawMode( aDC, aDrawMode );
 
     EDA_RECT drawBox = *aPanel->GetClipBox();
+    std::vector<GERBER_DRAW_ITEM*> visibleItems;
 
     for (std::vector<GERBER_IMAGE*>::const_reverse_iterator git = m_Gerbers.rbegin() ; git != m_Gerbers.rend(); ++git)
     {
@@ -338,7 +347,9 @@ void GBR_LAYOUT::DrawItemsDCodeID( EDA_DRAW_PANEL* aPanel,
         if( !gerber->m_Visible )
             continue;
 
-        for (std::list<GERBER_DRAW_ITEM*>::iterator it=gerber->m_Drawings.begin(); it != gerber->m_Drawings.end(); ++it)
+        gerber->QueryItems( drawBox, visibleItems );
+
+        for (std::vector<GERBER_DRAW_ITEM*>::iterator it=visibleItems.begin(); it != visibleItems.end(); ++it)
         {
             GERBER_DRAW_ITEM* item = *it;
 
@@ -224,14 +224,67 @@ D_CODE* GERBER_DRAW_ITEM::GetDcodeDescr()
 
 const EDA_RECT GERBER_DRAW_ITEM::GetBoundingBox() const
 {
-    // return a rectangle which is (pos,dim) in nature.  therefore the +1
+    // Build the box in X,Y gerber axis, which is then converted to A,B axis
     EDA_RECT bbox( m_Start, wxSize( 1, 1 ) );
+    int      radius;
 
-    bbox.Inflate( m_Size.x / 2, m_Size.y / 2 );
+    switch( m_Shape )
+    {
+    case GBR_SEGMENT:
+    case GBR_POLYGON:
+        bbox.Merge( m_End );
+
+        for( unsigned ii = 0; ii < m_PolyCorners.size(); ii++ )
+            bbox.Merge( m_PolyCorners[ii] );
+
+        bbox.Inflate( m_Size.x / 2, m_Size.y / 2 );
+        break;
+
+    case GBR_CIRCLE:
+        radius = KiROUND( GetLineLength( m_Start, m_End ) ) + m_Size.x / 2;
+        bbox.Inflate( radius, radius );
+        break;
+
+    case GBR_ARC:
+        // The whole circle: good enough and always right
+        radius = KiROUND( GetLineLength( m_ArcCentre, m_Start ) ) + m_Size.x / 2;
+        bbox = EDA_RECT( m_ArcCentre, wxSize( 1, 1 ) );
+        bbox.Inflate( radius, radius );
+        break;
+
+    case GBR_SPOT_MACRO:
+    {
+        // The macro primitives can be anywhere around the flash position: their
+        // size is only an estimation
+        D_CODE* dcode = const_cast<GERBER_DRAW_ITEM*>( this )->GetDcodeDescr();
+        radius = std::max( m_Size.x, m_Size.y ) / 2;
+
+        if( dcode )
+            radius = std::max( radius, dcode->GetShapeDim( const_cast<GERBER_DRAW_ITEM*>( this ) ) );
+
+        bbox.Inflate( radius, radius );
+        break;
+    }
+
+    default:    // Other flashed items
+        radius = std::max( m_Size.x, m_Size.y ) / 2;
+        bbox.Inflate( radius, radius );
+        break;
+    }
+
+    // The A,B axis can be rotated or mirrored: use the 4 corners
+    wxPoint corners[4] =
+    {
+        bbox.GetOrigin(), bbox.GetEnd(),
+        wxPoint( bbox.GetX(), bbox.GetBottom() ), wxPoint( bbox.GetRight(), bbox.GetY() )
+    };
+
+    EDA_RECT abBox( GetABPosition( corners[0] ), wxSize( 0, 0 ) );
+
+    for( int ii = 1; ii < 4; ii++ )
+        abBox.Merge( GetABPosition( corners[ii] ) );
 
-    bbox.SetOrigin( GetABPosition( bbox.GetOrigin() ) );
-    bbox.SetEnd( GetABPosition( bbox.GetEnd() ) );
-    return bbox;
+    return abBox;
 }
 
 
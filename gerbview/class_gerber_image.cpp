@@ -37,6 +37,8 @@
 #include <class_gerber_image.h>
 #include <class_X2_gerber_attributes.h>
 
+#include <algorithm>
+
 
 /**
  * Function scaletoIU
@@ -88,6 +90,7 @@ void GERBER_LAYER::ResetDefaultValues()
 GERBER_IMAGE::GERBER_IMAGE( GERBVIEW_FRAME* aParent )
 {
     m_Parent = aParent;
+    m_indexedCount = 0;
 
     m_Selected_Tool = FIRST_DCODE;
     m_FileFunction = NULL;          // file function parameters
@@ -220,7 +223,7 @@ bool GERBER_IMAGE::HasNegativeItems()
         {
             m_hasNegativeItems = 0;
 
-            for (std::list<GERBER_DRAW_ITEM *>::iterator it = m_Drawings.begin();
+            for (std::vector<GERBER_DRAW_ITEM *>::iterator it = m_Drawings.begin();
                  it != m_Drawings.end(); ++it)
             {
                 GERBER_DRAW_ITEM* item = *it;
@@ -274,7 +277,7 @@ void GERBER_IMAGE::InitToolTable()
  */
 void GERBER_IMAGE::ReportMessage( const wxString aMessage )
 {
-    m_Parent->ReportMessage( aMessage );
+    m_messages.Add( aMessage );
 }
 
 
@@ -362,12 +365,104 @@ void GERBER_IMAGE::DisplayImageInfo( void )
 
 void GERBER_IMAGE::ClearDrawingItems( void )
 {
-    for (std::list<GERBER_DRAW_ITEM*>::iterator it = m_Drawings.begin() ; it != m_Drawings.end(); ++it)
+    for (std::vector<GERBER_DRAW_ITEM*>::iterator it = m_Drawings.begin() ; it != m_Drawings.end(); ++it)
     {
         delete (*it);
     }
 
     m_Drawings.clear();
+
+    m_itemIndex.RemoveAll();
+    m_unboundedItems.clear();
+    m_indexedCount = 0;
+}
+
+
+void GERBER_IMAGE::BuildSpatialIndex()
+{
+    std::vector<int> mmin, mmax, data;
+
+    mmin.reserve( 2 * m_Drawings.size() );
+    mmax.reserve( 2 * m_Drawings.size() );
+    data.reserve( m_Drawings.size() );
+    m_unboundedItems.clear();
+
+    for( unsigned ii = 0; ii < m_Drawings.size(); ii++ )
+    {
+        GERBER_DRAW_ITEM* item = m_Drawings[ii];
+
+        // The shape of aperture macros is not known exactly
+        if( item->m_Shape == GBR_SPOT_MACRO )
+        {
+            m_unboundedItems.push_back( ii );
+            continue;
+        }
+
+        EDA_RECT bbox = item->GetBoundingBox();
+        bbox.Normalize();
+
+        mmin.push_back( bbox.GetX() );
+        mmin.push_back( bbox.GetY() );
+        mmax.push_back( bbox.GetRight() );
+        mmax.push_back( bbox.GetBottom() );
+        data.push_back( ii );
+    }
+
+    if( data.empty() )
+        m_itemIndex.RemoveAll();
+    else
+        m_itemIndex.BulkLoad( data.size(), &mmin[0], &mmax[0], &data[0] );
+
+    m_indexedCount = m_Drawings.size();
+}
+
+
+/**
+ * Struct ITEM_COLLECTOR
+ * is the R-tree visitor of GERBER_IMAGE::QueryItems().
+ */
+struct ITEM_COLLECTOR
+{
+    std::vector<int>& m_result;
+
+    ITEM_COLLECTOR( std::vector<int>& aResult ) :
+        m_result( aResult )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_result.push_back( aIndex );
+        return true;
+    }
+};
+
+
+void GERBER_IMAGE::QueryItems( const EDA_RECT& aArea, std::vector<GERBER_DRAW_ITEM*>& aResult )
+{
+    aResult.clear();
+
+    if( m_indexedCount != m_Drawings.size() )
+        BuildSpatialIndex();
+
+    EDA_RECT area( aArea );
+    area.Normalize();
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    std::vector<int> found( m_unboundedItems );
+    ITEM_COLLECTOR   collector( found );
+
+    m_itemIndex.Search( mmin, mmax, collector );
+
+    // Keep the drawing order: it matters for negative items
+    std::sort( found.begin(), found.end() );
+
+    aResult.reserve( found.size() );
+
+    for( unsigned ii = 0; ii < found.size(); ii++ )
+        aResult.push_back( m_Drawings[found[ii]] );
 }
 
 
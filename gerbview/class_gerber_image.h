@@ -25,13 +25,14 @@
 #ifndef _CLASS_GERBER_H_
 #define _CLASS_GERBER_H_
 
-#include <list>
+#include <vector>
 #include <set>
 
 #include <dcode.h>
 #include <class_gerber_draw_item.h>
 #include <class_aperture_macro.h>
 #include <gerbview.h>
+#include <geometry/rtree.h>
 
 // An useful macro used when reading gerber files;
 #define IsNumber( x ) ( ( ( (x) >= '0' ) && ( (x) <='9' ) )   \
@@ -102,7 +103,7 @@ class GERBER_IMAGE
     GERBER_LAYER       m_GBRLayerParams; // hold params for the current gerber layer
 
 public:
-    std::list<GERBER_DRAW_ITEM*> m_Drawings;
+    std::vector<GERBER_DRAW_ITEM*> m_Drawings;
     EDA_COLOR_T         m_DrawColor;
     bool               m_InUse;                                 // true if this image is currently in use
                                                                 // (a file is loaded in it)
@@ -167,6 +168,15 @@ private:
                                                                 // 0 = no negative items found
                                                                 // 1 = have negative items found
 
+    typedef RTree<int, int, 2, float> ITEM_RTREE;
+
+    ITEM_RTREE         m_itemIndex;                             // R-tree of the m_Drawings indices
+    std::vector<int>   m_unboundedItems;                        // items not in the R-tree (macro
+                                                                // flashes), always candidates
+    unsigned           m_indexedCount;                          // count of items in the index
+                                                                // (items are only appended)
+    wxArrayString      m_messages;                              // errors of the last file load
+
 public:
     GERBER_IMAGE( GERBVIEW_FRAME* aParent );
     virtual ~GERBER_IMAGE();
@@ -206,7 +216,7 @@ public:
 
     /**
      * Function ReportMessage
-     * Add a message (a string) in message list
+     * Add a message (a string) in the message list of this image
      * for instance when reading a Gerber file
      * @param aMessage = the straing to add in list
      */
@@ -315,6 +325,40 @@ public:
     void DisplayImageInfo( void );
 
     void ClearDrawingItems( void );
+
+    /**
+     * Function LoadGerberFile
+     * reads a gerber file (RS274D, RS274X or RS274X2 format) into this image.
+     * It only uses the image itself, so several images can be loaded at the same
+     * time by different threads.  The errors are stored in the image messages list.
+     * The caller must switch to the C locale (LOCALE_IO), which is process wide.
+     * @param aFullFileName = the full file name
+     * @return bool - false if the file cannot be opened, errno gives the reason
+     */
+    bool LoadGerberFile( const wxString& aFullFileName );
+
+    /**
+     * Function GetMessages
+     * @return the errors and warnings found when loading the file
+     */
+    const wxArrayString& GetMessages() const
+    {
+        return m_messages;
+    }
+
+    /**
+     * Function BuildSpatialIndex
+     * (re)builds the R-tree of the bounding boxes of m_Drawings.
+     * QueryItems() calls it when items were added since the last build.
+     */
+    void BuildSpatialIndex();
+
+    /**
+     * Function QueryItems
+     * collects the items whose bounding box intersects aArea.
+     * @param aResult receives the items, in m_Drawings order (i.e. drawing order)
+     */
+    void QueryItems( const EDA_RECT& aArea, std::vector<GERBER_DRAW_ITEM*>& aResult );
 };
 
 #endif  // ifndef _CLASS_GERBER_H_
@@ -77,11 +77,11 @@
 
 // Default format for dimensions
 // number of digits in mantissa:
-static int fmtMantissaMM = 3;
-static int fmtMantissaInch = 4;
+static const int fmtMantissaMM = 3;
+static const int fmtMantissaInch = 4;
 // number of digits, integer part:
-static int fmtIntegerMM = 3;
-static int fmtIntegerInch = 2;
+static const int fmtIntegerMM = 3;
+static const int fmtIntegerInch = 2;
 
 extern int    ReadInt( char*& text, bool aSkipSeparator = true );
 extern double ReadDouble( char*& text, bool aSkipSeparator = true );
@@ -197,6 +197,9 @@ bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
 
     bool success = drill_Layer->Read_EXCELLON_File( file, aFullFileName );
 
+    for( unsigned ii = 0; ii < drill_Layer->GetMessages().GetCount(); ii++ )
+        ReportMessage( drill_Layer->GetMessages()[ii] );
+
     // Display errors list
     if( m_Messages.size() > 0 )
     {
@@ -216,6 +219,7 @@ bool EXCELLON_IMAGE::Read_EXCELLON_File( FILE * aFile,
     m_FileName = aFullFileName;
     m_Current_File = aFile;
 
+    // Excellon files are read one at a time, by the main thread
     LOCALE_IO toggleIo;
 
     // FILE_LINE_READER will close the file.
@@ -278,8 +282,7 @@ bool EXCELLON_IMAGE::Read_EXCELLON_File( FILE * aFile,
             {
                 wxString msg;
                 msg.Printf( wxT( "Unexpected symbol &lt;%c&gt;" ), *text );
-                if( GetParent() )
-                    GetParent()->ReportMessage( msg );
+                ReportMessage( msg );
             }
                 break;
             }   // End switch
@@ -294,6 +297,7 @@ bool EXCELLON_IMAGE::Read_EXCELLON_File( FILE * aFile,
     m_FileFunction = new X2_ATTRIBUTE_FILEFUNCTION( dummy );
 
     m_InUse = true;
+    BuildSpatialIndex();
 
     return true;
 }
@@ -228,7 +228,7 @@ bool GBR_TO_PCB_EXPORTER::ExportPcb( LAYER_NUM* aLayerLookUpTable, int aCopperLa
             continue;
 
         GERBER_IMAGE* gerber = *git;
-        for (std::list<GERBER_DRAW_ITEM*>::iterator it=gerber->m_Drawings.begin(); it != gerber->m_Drawings.end(); ++it)
+        for (std::vector<GERBER_DRAW_ITEM*>::iterator it=gerber->m_Drawings.begin(); it != gerber->m_Drawings.end(); ++it)
         {
             GERBER_DRAW_ITEM* item = *it;
             export_non_copper_item( item, pcb_layer_number );
@@ -246,7 +246,7 @@ bool GBR_TO_PCB_EXPORTER::ExportPcb( LAYER_NUM* aLayerLookUpTable, int aCopperLa
         }
 
         GERBER_IMAGE* gerber = *git;
-        for (std::list<GERBER_DRAW_ITEM*>::iterator it=gerber->m_Drawings.begin(); it != gerber->m_Drawings.end(); ++it)
+        for (std::vector<GERBER_DRAW_ITEM*>::iterator it=gerber->m_Drawings.begin(); it != gerber->m_Drawings.end(); ++it)
         {
             GERBER_DRAW_ITEM* item = *it;
             export_copper_item( item, pcb_layer_number );
@@ -26,6 +26,8 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <errno.h>
+
 #include <fctsys.h>
 #include <common.h>
 #include <class_drawpanel.h>
@@ -34,6 +36,26 @@
 #include <gerbview_id.h>
 #include <class_gerbview_layer_widget.h>
 #include <wildcards_and_files_ext.h>
+#include <class_gerber_image.h>
+#include <confirm.h>
+#include <thread_pool.h>
+
+#include <boost/bind.hpp>
+
+
+/**
+ * Function loadGerberFile
+ * is the job reading one gerber file, run by the thread pool of LoadGerberFiles().
+ * aError is set to the errno value if the file cannot be opened.
+ */
+static void loadGerberFile( GERBER_IMAGE* aGerber, const wxString& aFullFileName, int* aLoaded,
+                            int* aError )
+{
+    *aLoaded = aGerber->LoadGerberFile( aFullFileName );
+
+    if( !*aLoaded )
+        *aError = errno;
+}
 
 
 void GERBVIEW_FRAME::OnGbrFileHistory( wxCommandEvent& event )
@@ -160,8 +182,12 @@ bool GERBVIEW_FRAME::LoadGerberFiles( const wxString& aFullFileName )
         currentPath = filename.GetPath();
     }
 
-    // Read gerber files: each file is loaded on a new GerbView layer
-    int layer = getActiveLayer();
+    // Read gerber files: each file is loaded on a new GerbView layer.
+    // The files are parsed in parallel, the results are then reported in order.
+    std::vector<GERBER_IMAGE*> gerbers;
+    std::vector<wxString>      fullFileNames;
+    std::vector<int>           loaded( filenamesList.GetCount(), 0 );
+    std::vector<int>           errors( filenamesList.GetCount(), 0 );
 
     for( unsigned ii = 0; ii < filenamesList.GetCount(); ii++ )
     {
@@ -170,18 +196,52 @@ bool GERBVIEW_FRAME::LoadGerberFiles( const wxString& aFullFileName )
         if( !filename.IsAbsolute() )
             filename.SetPath( currentPath );
 
-        m_lastFileName = filename.GetFullPath();
+        GERBER_IMAGE* gerber = new GERBER_IMAGE( this );
+        GetGerberLayout()->AddGerber( gerber );
 
-        setActiveLayer( layer, false );
+        gerbers.push_back( gerber );
+        fullFileNames.push_back( filename.GetFullPath() );
+    }
+
+    {
+        wxBusyCursor dummy;
+
+        // The locale is process wide: switch it once for all the loading threads
+        LOCALE_IO    toggleIo;
+        THREAD_POOL  pool;
+
+        for( unsigned ii = 0; ii < gerbers.size(); ii++ )
+            pool.Submit( boost::bind( loadGerberFile, gerbers[ii], fullFileNames[ii],
+                                      &loaded[ii], &errors[ii] ) );
+
+        pool.Wait();
+    }
 
-        if( Read_GERBER_File( filename.GetFullPath(), filename.GetFullPath(), false ) )
+    for( unsigned ii = 0; ii < gerbers.size(); ii++ )
+    {
+        m_lastFileName = fullFileNames[ii];
+
+        if( !loaded[ii] )
         {
-            UpdateFileHistory( m_lastFileName );
+            wxString msg;
 
-            layer = GetGerberLayout()->GetGerbers().size()-1;
+            // No errno when the loading thread failed after opening the file
+            if( errors[ii] )
+                msg.Printf( _( "Unable to open file <%s>: %s" ), GetChars( m_lastFileName ),
+                            wxSysErrorMsg( errors[ii] ) );
+            else
+                msg.Printf( _( "Unable to read file <%s>" ), GetChars( m_lastFileName ) );
 
-            setActiveLayer( layer, false );
+            DisplayError( this, msg, 10 );
+            continue;
         }
+
+        ClearMessageList();
+        ReportGerberFileLoaded( gerbers[ii] );
+        UpdateFileHistory( m_lastFileName );
+
+        setActiveLayer( GetGerberLayout()->GetGerberIndexByLayer( gerbers[ii]->m_GraphicLayer ),
+                        false );
     }
 
     Zoom_Automatique( false );
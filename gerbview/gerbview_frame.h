@@ -47,6 +47,7 @@ class DCODE_SELECTION_BOX;
 class GERBER_LAYER_WIDGET;
 class GBR_LAYER_BOX_SELECTOR;
 class GERBER_DRAW_ITEM;
+class GERBER_IMAGE;
 
 
 /**
@@ -483,6 +484,14 @@ public:
                                           const wxString&   D_Code_FullFileName,
                                           bool              replace);
 
+    /**
+     * Function ReportGerberFileLoaded
+     * shows the errors found when loading aGerber, and warns about the files
+     * without D-Code definition.
+     * @return true
+     */
+    bool                ReportGerberFileLoaded( GERBER_IMAGE* aGerber );
+
     /**
      * function LoadDrllFiles
      * Load a drill (EXCELLON) file or many files.
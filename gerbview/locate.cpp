@@ -50,10 +50,16 @@ GERBER_DRAW_ITEM* GERBVIEW_FRAME::Locate( const wxPoint& aPosition )
 
     GERBER_DRAW_ITEM* gerb_item = NULL;
 
+    // Only the items whose bounding box contains the position can be hit
+    EDA_RECT refArea( ref, wxSize( 1, 1 ) );
+    std::vector<GERBER_DRAW_ITEM*> candidates;
+
     if(gerber != NULL)
     {
         // Search first on active layer
-        for (std::list<GERBER_DRAW_ITEM*>::iterator it=gerber->m_Drawings.begin(); it != gerber->m_Drawings.end(); ++it)
+        gerber->QueryItems( refArea, candidates );
+
+        for (std::vector<GERBER_DRAW_ITEM*>::iterator it=candidates.begin(); it != candidates.end(); ++it)
         {
             gerb_item = *it;
             if( gerb_item->GetLayer()!= layer )
@@ -69,10 +75,12 @@ GERBER_DRAW_ITEM* GERBVIEW_FRAME::Locate( const wxPoint& aPosition )
 
     if( !found ) // Search on all layers
     {
-        for( int layer = 0; layer < GetGerberLayout()->GetGerbers().size(); layer++ )
+        for( int layer = 0; !found && layer < (int)GetGerberLayout()->GetGerbers().size(); layer++ )
         {
             gerber = GetGerberLayout()->GetGerberByListIndex( layer );
-            for (std::list<GERBER_DRAW_ITEM*>::iterator it=gerber->m_Drawings.begin(); it != gerber->m_Drawings.end(); ++it)
+            gerber->QueryItems( refArea, candidates );
+
+            for (std::vector<GERBER_DRAW_ITEM*>::iterator it=candidates.begin(); it != candidates.end(); ++it)
             {
                 gerb_item = *it;
                 if( gerb_item->HitTest( ref ) )
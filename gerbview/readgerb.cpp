@@ -38,13 +38,7 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName,
                                         const wxString& D_Code_FullFileName,
                                         bool replace )
 {
-    int      G_command = 0;        // command number for G commands like G04
-    int      D_commande = 0;       // command number for D commands like D02
-
-    char     line[GERBER_BUFZ];
-
     wxString msg;
-    char*    text;
     int layer;         // current layer used in GerbView
     GERBER_IMAGE* gerber = NULL;
 
@@ -71,38 +65,87 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName,
 
     ClearMessageList( );
 
-    /* Set the gerber scale: */
-    gerber->ResetDefaultValues();
+    wxString path = wxPathOnly( GERBER_FullFileName );
+    if( path != wxEmptyString )
+        wxSetWorkingDirectory( path );
 
     /* Read the gerber file */
-    gerber->m_Current_File = wxFopen( GERBER_FullFileName, wxT( "rt" ) );
-    if( gerber->m_Current_File == 0 )
+    LOCALE_IO toggleIo;
+
+    if( !gerber->LoadGerberFile( GERBER_FullFileName ) )
     {
         msg.Printf( _( "File <%s> not found" ), GetChars( GERBER_FullFileName ) );
         DisplayError( this, msg, 10 );
         return false;
     }
 
-    gerber->m_FileName = GERBER_FullFileName;
+    return ReportGerberFileLoaded( gerber );
+}
 
-    wxString path = wxPathOnly( GERBER_FullFileName );
-    if( path != wxEmptyString )
-        wxSetWorkingDirectory( path );
 
-    LOCALE_IO toggleIo;
+bool GERBVIEW_FRAME::ReportGerberFileLoaded( GERBER_IMAGE* aGerber )
+{
+    wxString msg;
+
+    for( unsigned ii = 0; ii < aGerber->GetMessages().GetCount(); ii++ )
+        ReportMessage( aGerber->GetMessages()[ii] );
+
+    // Display errors list
+    if( m_Messages.size() > 0 )
+    {
+        HTML_MESSAGE_BOX dlg( this, _("Errors") );
+        dlg.ListSet(m_Messages);
+        dlg.ShowModal();
+    }
+
+    /* if the gerber file is only a RS274D file
+     * (i.e. without any aperture information), wran the user:
+     */
+    if( !aGerber->m_Has_DCode )
+    {
+        msg = _("Warning: this file has no D-Code definition\n"
+                "It is perhaps an old RS274D file\n"
+                "Therefore the size of items is undefined");
+        wxMessageBox( msg );
+    }
+
+    return true;
+}
+
+
+bool GERBER_IMAGE::LoadGerberFile( const wxString& aFullFileName )
+{
+    int      G_command = 0;        // command number for G commands like G04
+    int      D_commande = 0;       // command number for D commands like D02
+
+    char     line[GERBER_BUFZ];
+
+    wxString msg;
+    char*    text;
+
+    /* Set the gerber scale: */
+    ResetDefaultValues();
+    m_messages.Clear();
+
+    /* Read the gerber file */
+    m_Current_File = wxFopen( aFullFileName, wxT( "rt" ) );
+
+    if( m_Current_File == 0 )
+        return false;
+
+    m_FileName = aFullFileName;
 
     while( true )
     {
-        if( fgets( line, sizeof(line), gerber->m_Current_File ) == NULL )
+        if( fgets( line, sizeof(line), m_Current_File ) == NULL )
         {
-            if( gerber->m_FilesPtr == 0 )
+            if( m_FilesPtr == 0 )
                 break;
 
-            fclose( gerber->m_Current_File );
+            fclose( m_Current_File );
 
-            gerber->m_FilesPtr--;
-            gerber->m_Current_File =
-                gerber->m_FilesList[gerber->m_FilesPtr];
+            m_FilesPtr--;
+            m_Current_File = m_FilesList[m_FilesPtr];
 
             continue;
         }
@@ -120,57 +163,55 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName,
                 break;
 
             case '*':       // End command
-                gerber->m_CommandState = END_BLOCK;
+                m_CommandState = END_BLOCK;
                 text++;
                 break;
 
             case 'M':       // End file
-                gerber->m_CommandState = CMD_IDLE;
+                m_CommandState = CMD_IDLE;
                 while( *text )
                     text++;
                 break;
 
             case 'G':    /* Line type Gxx : command */
-                G_command = gerber->GCodeNumber( text );
-                gerber->Execute_G_Command( text, G_command );
+                G_command = GCodeNumber( text );
+                Execute_G_Command( text, G_command );
                 break;
 
             case 'D':       /* Line type Dxx : Tool selection (xx > 0) or
                              * command if xx = 0..9 */
-                D_commande = gerber->DCodeNumber( text );
-                gerber->Execute_DCODE_Command( text, D_commande );
+                D_commande = DCodeNumber( text );
+                Execute_DCODE_Command( text, D_commande );
                 break;
 
             case 'X':
             case 'Y':                   /* Move or draw command */
-                gerber->m_CurrentPos = gerber->ReadXYCoord( text );
+                m_CurrentPos = ReadXYCoord( text );
                 if( *text == '*' )      // command like X12550Y19250*
                 {
-                    gerber->Execute_DCODE_Command( text,
-                                                   gerber->m_Last_Pen_Command );
+                    Execute_DCODE_Command( text, m_Last_Pen_Command );
                 }
                 break;
 
             case 'I':
             case 'J':       /* Auxiliary Move command */
-                gerber->m_IJPos = gerber->ReadIJCoord( text );
+                m_IJPos = ReadIJCoord( text );
                 if( *text == '*' )      // command like X35142Y15945J504*
                 {
-                    gerber->Execute_DCODE_Command( text,
-                                                   gerber->m_Last_Pen_Command );
+                    Execute_DCODE_Command( text, m_Last_Pen_Command );
                 }
                 break;
 
             case '%':
-                if( gerber->m_CommandState != ENTER_RS274X_CMD )
+                if( m_CommandState != ENTER_RS274X_CMD )
                 {
-                    gerber->m_CommandState = ENTER_RS274X_CMD;
-                    gerber->ReadRS274XCommand( line, text );
+                    m_CommandState = ENTER_RS274X_CMD;
+                    ReadRS274XCommand( line, text );
                 }
                 else        //Error
                 {
                     ReportMessage( wxT("Expected RS274X Command")  );
-                    gerber->m_CommandState = CMD_IDLE;
+                    m_CommandState = CMD_IDLE;
                     text++;
                 }
                 break;
@@ -184,28 +225,12 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName,
         }
     }
 
-    fclose( gerber->m_Current_File );
-
-    gerber->m_InUse = true;
+    fclose( m_Current_File );
 
-    // Display errors list
-    if( m_Messages.size() > 0 )
-    {
-        HTML_MESSAGE_BOX dlg( this, _("Errors") );
-        dlg.ListSet(m_Messages);
-        dlg.ShowModal();
-    }
+    m_InUse = true;
 
-    /* if the gerber file is only a RS274D file
-     * (i.e. without any aperture information), wran the user:
-     */
-    if( !gerber->m_Has_DCode )
-    {
-        msg = _("Warning: this file has no D-Code definition\n"
-                "It is perhaps an old RS274D file\n"
-                "Therefore the size of items is undefined");
-        wxMessageBox( msg );
-    }
+    // Build the spatial index now: this is done by the loading thread
+    BuildSpatialIndex();
 
     return true;
 }
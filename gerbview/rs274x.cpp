@@ -30,6 +30,7 @@
 #include <common.h>
 #include <macros.h>
 #include <base_units.h>
+#include <wx/filename.h>
 
 #include <gerbview.h>
 #include <class_gerber_image.h>
@@ -604,7 +605,17 @@ bool GERBER_IMAGE::ExecuteRS274XCommand( int       command,
         strtok( line, "*%%\n\r" );
         m_FilesList[m_FilesPtr] = m_Current_File;
 
-        m_Current_File = fopen( line, "rt" );
+        {
+            // A relative name is relative to the including file, not to the
+            // current working directory (files can be loaded by other threads)
+            wxFileName includeName( FROM_UTF8( line ) );
+
+            if( includeName.IsRelative() )
+                includeName.MakeAbsolute( wxPathOnly( m_FileName ) );
+
+            m_Current_File = wxFopen( includeName.GetFullPath(), wxT( "rt" ) );
+        }
+
         if( m_Current_File == 0 )
         {
             msg.Printf( wxT( "include file <%s> not found." ), line );
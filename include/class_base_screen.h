@@ -78,6 +78,7 @@ class BASE_SCREEN : public EDA_ITEM
 private:
     GRIDS       m_grids;            ///< List of valid grid sizes.
     bool        m_FlagModified;     ///< Indicates current drawing has been modified.
+    int         m_modificationCount;    ///< Changed on each modification of the drawing.
     bool        m_FlagSave;         ///< Indicates automatic file save.
     EDA_ITEM*   m_CurrentItem;      ///< Currently selected object
     GRID_TYPE   m_Grid;             ///< Current grid selection.
@@ -321,13 +322,27 @@ public:
         }
     }
 
-    void SetModify()        { m_FlagModified = true; }
+    void SetModify()        { m_FlagModified = true; ++m_modificationCount; }
     void ClrModify()        { m_FlagModified = false; }
     void SetSave()          { m_FlagSave = true; }
     void ClrSave()          { m_FlagSave = false; }
     bool IsModify() const   { return m_FlagModified; }
     bool IsSave() const     { return m_FlagSave; }
 
+    /**
+     * Function GetModificationCount
+     * @return a value which changes each time the drawing is modified, either by SetModify()
+     * or by IncModificationCount().  It is used to know if data computed from the drawing
+     * is still valid.
+     */
+    int GetModificationCount() const    { return m_modificationCount; }
+
+    /**
+     * Function IncModificationCount
+     * records a change of the drawing, without setting the modified flag.
+     */
+    void IncModificationCount()         { ++m_modificationCount; }
+
 
     //----<zoom stuff>---------------------------------------------------------
 
@@ -30,11 +30,17 @@
 #define CLASS_PCB_SCREEN_H_
 
 
+#include <map>
+
 #include <class_base_screen.h>
 #include <class_board_item.h>
 
 
 class UNDO_REDO_CONTAINER;
+class MSG_PANEL_ITEM;
+
+/// Default memory budget of the undo and redo lists, in MB (0 = unlimited)
+#define DEFAULT_UNDO_MEMORY_BUDGET_MB   512
 
 
 /* Handle info to display a board */
@@ -84,8 +90,23 @@ public:
     /* full undo redo management : */
 
     // use BASE_SCREEN::ClearUndoRedoList()
-    // use BASE_SCREEN::PushCommandToUndoList( PICKED_ITEMS_LIST* aItem )
-    // use BASE_SCREEN::PushCommandToRedoList( PICKED_ITEMS_LIST* aItem )
+
+    /**
+     * Function PushCommandToUndoList
+     * add a command to undo in undo list, and delete the very old commands when
+     * either the max count of undo commands or the undo memory budget is reached
+     */
+    void PushCommandToUndoList( PICKED_ITEMS_LIST* aItem );
+
+    /**
+     * Function PushCommandToRedoList
+     * add a command to redo in redo list, and delete the very old commands when
+     * either the max count of redo commands or the undo memory budget is reached
+     */
+    void PushCommandToRedoList( PICKED_ITEMS_LIST* aItem );
+
+    PICKED_ITEMS_LIST* PopCommandFromUndoList();
+    PICKED_ITEMS_LIST* PopCommandFromRedoList();
 
     /**
      * Function ClearUndoORRedoList
@@ -100,6 +121,51 @@ public:
      * So this function can be called to remove old commands
      */
     void ClearUndoORRedoList( UNDO_REDO_CONTAINER& aList, int aItemCount = -1 );
+
+    /**
+     * Function SetUndoMemoryBudget
+     * sets the max memory (in bytes) the undo and redo lists can use together.
+     * The oldest commands are deleted when this budget is exceeded, but the last
+     * command is always kept.
+     * @param aBytes = the budget, 0 for no limit
+     */
+    void SetUndoMemoryBudget( size_t aBytes ) { m_undoMemoryBudget = aBytes; }
+
+    size_t GetUndoMemoryBudget() const { return m_undoMemoryBudget; }
+
+    /**
+     * Function GetUndoMemoryUsage
+     * @return the estimated memory used by the item copies stored in the undo list
+     */
+    size_t GetUndoMemoryUsage() const { return m_undoMemory; }
+
+    /**
+     * Function GetRedoMemoryUsage
+     * @return the estimated memory used by the item copies stored in the redo list
+     */
+    size_t GetRedoMemoryUsage() const { return m_redoMemory; }
+
+    /**
+     * Function GetUndoMemoryInfo
+     * appends the undo/redo memory statistics to a message panel item list
+     * @param aList = the list to fill
+     */
+    void GetUndoMemoryInfo( std::vector<MSG_PANEL_ITEM>& aList ) const;
+
+private:
+    /**
+     * Function trimUndoORRedoList
+     * deletes the oldest commands of aList until the undo memory budget is met
+     * or only one command is left
+     */
+    void trimUndoORRedoList( UNDO_REDO_CONTAINER& aList );
+
+    size_t  m_undoMemoryBudget;     ///< max memory used by undo + redo lists, 0 = no limit
+    size_t  m_undoMemory;           ///< estimated memory used by the undo list
+    size_t  m_redoMemory;           ///< estimated memory used by the redo list
+
+    ///> Memory accounted for each stored command, so it can be released exactly
+    std::map<const PICKED_ITEMS_LIST*, size_t> m_commandMemory;
 };
 
 #endif  // CLASS_PCB_SCREEN_H_
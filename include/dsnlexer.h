@@ -42,6 +42,22 @@ struct KEYWORD
     const char* name;       ///< unique keyword.
     int         token;      ///< a zero based index into an array of KEYWORDs
 };
+
+
+/**
+ * Struct KEYWORD_INDEX
+ * is a perfect hash of a KEYWORD table, generated by TokenList2DsnLexer.cmake.
+ * The bucket of a keyword is given by its FNV-1a hash modulo bucketCount, and
+ * the displacement of this bucket gives the slot of the keyword in slots[].
+ * A slot holds the index of its keyword in the KEYWORD table, or -1 if free.
+ */
+struct KEYWORD_INDEX
+{
+    unsigned        bucketCount;
+    const unsigned* displacements;  ///< bucketCount values
+    unsigned        slotCount;
+    const int*      slots;          ///< slotCount values
+};
 #endif
 
 // something like this macro can be used to help initialize a KEYWORD table.
@@ -110,7 +126,8 @@ protected:
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
-    KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable
+    const KEYWORD_INDEX* keywordIndex;          ///< perfect hash of keywords, if any
+    KEYWORD_MAP         keyword_hash;           ///< used when there is no keywordIndex
 
     void init();
 
@@ -144,6 +161,16 @@ protected:
      */
     int findToken( const std::string& aToken );
 
+    /**
+     * Function SetKeywordIndex
+     * gives the perfect hash of the keywords table, used by findToken() instead
+     * of the hashtable built at run time.
+     */
+    void SetKeywordIndex( const KEYWORD_INDEX* aIndex )
+    {
+        keywordIndex = aIndex;
+    }
+
     bool isStringTerminator( char cc )
     {
         if( !space_in_quoted_tokens && cc==' ' )
@@ -389,6 +416,24 @@ public:
      */
     wxArrayString* ReadCommentLines() throw( IO_ERROR );
 
+    /**
+     * Function ReadListText
+     * copies the text of the current list into aText without tokenizing it, so that it
+     * can be parsed later, possibly by another lexer.  Must be called when CurTok() is
+     * the first token of the list, just after its DSN_LEFT.  Upon return CurTok() is the
+     * DSN_RIGHT closing the list.
+     *
+     * aText starts with the opening parenthesis, preceded by blanks which keep the
+     * original column numbers, and ends with the closing parenthesis.  The original
+     * line breaks are kept, so a reader starting at line CurLineNumber() - 1 (as
+     * obtained before the call) reports the original line numbers.
+     *
+     * Only for the KiCad syntax, not the specctraMode one.
+     *
+     * @throw IO_ERROR if the list is not closed or contains an unterminated string.
+     */
+    void ReadListText( std::string& aText ) throw( IO_ERROR );
+
     /**
      * Function IsSymbol
      * tests a token to see if it is a symbol.  This means it cannot be a
@@ -397,6 +442,20 @@ public:
      */
     static bool IsSymbol( int aTok );
 
+    /**
+     * Function ParseDecimal
+     * converts the usual numbers of s-expression files, i.e. an optional sign followed
+     * by at most 15 digits with an optional decimal point, without calling strtod().
+     * The result is exactly the one of strtod() in the C locale, but does not depend
+     * on the current locale.
+     *
+     * @param aText is the nul terminated text to convert.
+     * @param aValue receives the converted value.
+     * @return bool - false if @a aText is not such a number (an exponent, too many
+     *  digits, not a number at all) and must be converted by strtod().
+     */
+    static bool ParseDecimal( const char* aText, double* aValue );
+
     /**
      * Function Expecting
      * throws an IO_ERROR exception with an input file specific error message.
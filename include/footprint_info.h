@@ -30,6 +30,8 @@
 #define FOOTPRINT_INFO_H_
 
 
+#include <map>
+#include <vector>
 #include <boost/ptr_container/ptr_vector.hpp>
 #include <boost/foreach.hpp>
 
@@ -43,6 +45,7 @@
 class FP_LIB_TABLE;
 class FOOTPRINT_LIST;
 class wxTopLevelWindow;
+class wxProgressDialog;
 
 
 /*
@@ -75,6 +78,27 @@ public:
 #endif
     }
 
+    /**
+     * Constructor
+     * for a footprint whose doc, keywords and pad count are already known, for instance
+     * from the footprint info cache.  The footprint is not loaded.
+     */
+    FOOTPRINT_INFO( FOOTPRINT_LIST* aOwner, const wxString& aNickname, const wxString& aFootprintName,
+                    const wxString& aDoc, const wxString& aKeywords, int aPadCount ) :
+        m_owner( aOwner ),
+        m_loaded( true ),
+        m_nickname( aNickname ),
+        m_fpname( aFootprintName ),
+        m_num( 0 ),
+        m_pad_count( aPadCount ),
+        m_doc( aDoc ),
+        m_keywords( aKeywords )
+    {
+    }
+
+    /// @return true if the doc, keywords and pad count are known.
+    bool IsLoaded() const                               { return m_loaded; }
+
     const wxString& GetDoc()
     {
         ensure_loaded();
@@ -165,6 +189,60 @@ class FOOTPRINT_LIST
     MUTEX   m_errors_lock;
     MUTEX   m_list_lock;
 
+    /// What the footprint info cache file keeps about a footprint
+    struct CACHED_FOOTPRINT
+    {
+        wxString    name;
+        wxString    doc;
+        wxString    keywords;
+        int         padCount;
+    };
+
+    /// What the footprint info cache file keeps about a library
+    struct CACHED_LIBRARY
+    {
+        size_t                          timestamp;  ///< see PLUGIN::FootprintLibTimestamp()
+        std::vector<CACHED_FOOTPRINT>   footprints;
+    };
+
+    /// A library of the cache: its nickname and its full URI
+    typedef std::pair< wxString, wxString >             LIB_KEY;
+    typedef std::map< LIB_KEY, CACHED_LIBRARY >         LIB_CACHE;
+
+    LIB_CACHE   m_cache;                ///< the cached libraries, by nickname and URI
+    bool        m_cache_modified;
+    MUTEX       m_cache_lock;
+
+    wxProgressDialog* m_progress_dialog;    ///< no ownership
+
+    /**
+     * Function loadLibrary
+     * adds the footprints of the library @a aNickname to m_list, from the footprint
+     * info cache if the library did not change since it was cached, else from the
+     * library itself, and then updates the cache.
+     */
+    void loadLibrary( const wxString& aNickname );
+
+    /**
+     * Function readCache
+     * fills m_cache from the footprint info cache file, if there is a valid one.
+     */
+    void readCache();
+
+    /**
+     * Function writeCache
+     * saves m_cache in the footprint info cache file.  Failures are silently ignored,
+     * the cache is only an optimization.
+     */
+    void writeCache();
+
+    /**
+     * Function pruneCache
+     * removes from m_cache the libraries which are no longer in m_lib_table, or whose
+     * nickname now designates an other URI.
+     */
+    void pruneCache();
+
     /**
      * Function loader_job
      * loads footprints from @a aNicknameList and calls AddItem() on to help fill
@@ -175,6 +253,16 @@ class FOOTPRINT_LIST
      */
     void loader_job( const wxString* aNicknameList, int aJobZ );
 
+    /**
+     * Function loader_progress
+     * is the progress reporter of the loader jobs.  It is called by the thread calling
+     * ReadFootprintFiles(), which waits for the jobs, never by the worker threads, so it
+     * can update the progress dialog, if any, with @a aDone of @a aTotal libraries read.
+     * @return false to cancel the remaining jobs, after too many errors or when the
+     *  user cancels the progress dialog.
+     */
+    bool loader_progress( unsigned aDone, unsigned aTotal );
+
     void addItem( FOOTPRINT_INFO* aItem )
     {
         // m_list is not thread safe, and this function is called from
@@ -189,7 +277,9 @@ public:
 
     FOOTPRINT_LIST() :
         m_lib_table( 0 ),
-        m_error_count( 0 )
+        m_error_count( 0 ),
+        m_cache_modified( false ),
+        m_progress_dialog( NULL )
     {
     }
 
@@ -227,10 +317,21 @@ public:
 
     const IO_ERROR* GetError( unsigned aIdx ) const     { return &m_errors[aIdx]; }
 
+    /**
+     * Function SetProgressDialog
+     * sets a dialog to display the progress of ReadFootprintFiles() when it reads all
+     * the libraries, and to let the user cancel it.  Its whole range is used.
+     */
+    void SetProgressDialog( wxProgressDialog* aDialog ) { m_progress_dialog = aDialog; }
+
     /**
      * Function ReadFootprintFiles
      * reads all the footprints provided by the combination of aTable and aNickname.
      *
+     * The names, docs, keywords and pad counts of the footprints are kept in the
+     * footprint info cache file of the user configuration directory, so the libraries
+     * which did not change since the last call do not need to be read again.
+     *
      * @param aTable defines all the libraries.
      * @param aNickname is the library to read from, or if NULL means read all
      *         footprints from all known libraries in aTable.
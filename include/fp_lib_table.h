@@ -383,6 +383,16 @@ public:
      */
     wxArrayString FootprintEnumerate( const wxString& aNickname );
 
+    /**
+     * Function FootprintLibTimestamp
+     * returns a value which changes whenever the library given by @a aNickname
+     * is modified, or 0 if its PLUGIN cannot tell.
+     *
+     * @param aNickname is a locator for the "library", it is a "name"
+     *     in FP_LIB_TABLE::ROW
+     */
+    size_t FootprintLibTimestamp( const wxString& aNickname );
+
     /**
      * Function FootprintLoad
      * loads a footprint having @a aFootprintName from the library given by @a aNickname.
@@ -29,6 +29,8 @@
 #include <math.h>
 #include <assert.h>
 #include <stdlib.h>
+#include <vector>
+#include <algorithm>
 
 #define ASSERT assert    // RTree uses ASSERT( condition )
 #ifndef rMin
@@ -167,6 +169,22 @@ public:
     /// Remove all entries from tree
     void    RemoveAll();
 
+    /// Replace the content of the tree by a_count entries, packed with the Sort-Tile-Recursive
+    /// algorithm: nodes are full and overlap little, so the tree is faster to build and to search
+    /// than with Insert().  The nodes are allocated in a single block.  The tree can then be
+    /// modified with Insert() and Remove() as usual.
+    /// \param a_count Number of entries
+    /// \param a_min Min of the bounding rects, NUMDIMS values per entry
+    /// \param a_max Max of the bounding rects, NUMDIMS values per entry
+    /// \param a_data Data of the entries
+    void    BulkLoad( int                a_count,
+                      const ELEMTYPE*    a_min,
+                      const ELEMTYPE*    a_max,
+                      const DATATYPE*    a_data );
+
+    /// Tell if the tree has no entries
+    bool    IsEmpty() const { return m_root->m_count == 0; }
+
     /// Count the data elements in this container.  This is slow as no internal counter is maintained.
     int     Count();
 
@@ -437,11 +455,11 @@ protected:
     void            InitNode( Node* a_node );
     void            InitRect( Rect* a_rect );
     bool            InsertRectRec( Rect*            a_rect,
-                                   const DATATYPE&  a_id,
+                                   Node*            a_child,
                                    Node*            a_node,
                                    Node**           a_newNode,
                                    int              a_level );
-    bool            InsertRect( Rect* a_rect, const DATATYPE& a_id, Node** a_root, int a_level );
+    bool            InsertRect( Rect* a_rect, Node* a_child, Node** a_root, int a_level );
     Rect            NodeCover( Node* a_node );
     bool            AddBranch( Branch* a_branch, Node* a_node, Node** a_newNode );
     void            DisconnectBranch( Node* a_node, int a_index );
@@ -514,6 +532,23 @@ protected:
 
     void    RemoveAllRec( Node* a_node );
     void    Reset();
+
+    /// Orders branches for BulkLoad(), so that each run of MAXNODES branches makes a tile
+    void    SortTiles( Branch* a_first, Branch* a_last, int a_axis );
+
+    /// Compares the centers of two branches along an axis
+    struct BranchCenterLess
+    {
+        int m_axis;
+
+        BranchCenterLess( int a_axis ) : m_axis( a_axis ) {}
+
+        bool operator()( const Branch& a_a, const Branch& a_b ) const
+        {
+            return (ELEMTYPEREAL) a_a.m_rect.m_min[m_axis] + (ELEMTYPEREAL) a_a.m_rect.m_max[m_axis] <
+                   (ELEMTYPEREAL) a_b.m_rect.m_min[m_axis] + (ELEMTYPEREAL) a_b.m_rect.m_max[m_axis];
+        }
+    };
     void    CountRec( Node* a_node, int& a_count );
 
     bool    SaveRec( Node* a_node, RTFileStream& a_stream );
@@ -521,6 +556,8 @@ protected:
 
     Node*           m_root;                         ///< Root of tree
     ELEMTYPEREAL    m_unitSphereVolume;             ///< Unit sphere constant for required number of dimensions
+    Node*           m_arena;                        ///< Nodes allocated at once by BulkLoad()
+    int             m_arenaSize;                    ///< Number of nodes in m_arena
 };
 
 
@@ -627,6 +664,9 @@ RTREE_TEMPLATE RTREE_QUAL::RTree()
         0.082146f, 0.046622f, 0.025807f,    // Dimension  18,19,20
     };
 
+    m_arena     = NULL;
+    m_arenaSize = 0;
+
     m_root = AllocNode();
     m_root->m_level     = 0;
     m_unitSphereVolume  = (ELEMTYPEREAL) UNIT_SPHERE_VOLUMES[NUMDIMS];
@@ -661,7 +701,8 @@ void RTREE_QUAL::Insert( const ELEMTYPE     a_min[NUMDIMS],
         rect.m_max[axis]    = a_max[axis];
     }
 
-    InsertRect( &rect, a_dataId, &m_root, 0 );
+    // Child field of leaves contains id of data record
+    InsertRect( &rect, (Node*) a_dataId, &m_root, 0 );
 }
 
 
@@ -1010,6 +1051,126 @@ void RTREE_QUAL::Reset()
     // Just reset memory pools.  We are not using complex types
     // EXAMPLE
 #endif    // RTREE_DONT_USE_MEMPOOLS
+
+    // The nodes of the arena were skipped by FreeNode()
+    delete[] m_arena;
+    m_arena     = NULL;
+    m_arenaSize = 0;
+}
+
+
+RTREE_TEMPLATE
+void RTREE_QUAL::BulkLoad( int              a_count,
+                           const ELEMTYPE*  a_min,
+                           const ELEMTYPE*  a_max,
+                           const DATATYPE*  a_data )
+{
+    Reset();
+
+    if( a_count <= 0 )
+    {
+        m_root = AllocNode();
+        m_root->m_level = 0;
+        return;
+    }
+
+    // Each level has one node per MAXNODES branches of the level below
+    int nodeCount = 0;
+
+    for( int count = a_count; ; )
+    {
+        count = ( count + MAXNODES - 1 ) / MAXNODES;
+        nodeCount += count;
+
+        if( count == 1 )
+            break;
+    }
+
+    m_arena     = new Node[nodeCount];
+    m_arenaSize = nodeCount;
+
+    std::vector<Branch> branches( a_count );
+    std::vector<Branch> parents;
+    int                 nextNode = 0;
+
+    for( int index = 0; index < a_count; ++index )
+    {
+        for( int axis = 0; axis < NUMDIMS; ++axis )
+        {
+            branches[index].m_rect.m_min[axis] = a_min[index * NUMDIMS + axis];
+            branches[index].m_rect.m_max[axis] = a_max[index * NUMDIMS + axis];
+        }
+
+        // Set the whole union, as InsertRect() does: RemoveRect() compares m_child, so
+        // the bytes of a data narrower than a pointer must be set as well
+        branches[index].m_child = (Node*) a_data[index];
+    }
+
+    for( int level = 0; ; ++level )
+    {
+        int count = branches.size();
+        int nodes = ( count + MAXNODES - 1 ) / MAXNODES;
+
+        SortTiles( &branches[0], &branches[0] + count, 0 );
+        parents.clear();
+
+        for( int first = 0; first < count; )
+        {
+            int size = rMin( count - first, (int) MAXNODES );
+
+            // Share the last two runs if the last one is too small
+            if( count - first > MAXNODES && count - first - MAXNODES < MINNODES )
+                size = ( count - first + 1 ) / 2;
+
+            Node* node = &m_arena[nextNode++];
+
+            InitNode( node );
+            node->m_level = level;
+
+            for( int index = 0; index < size; ++index )
+                node->m_branch[node->m_count++] = branches[first + index];
+
+            Branch parent;
+            parent.m_rect  = NodeCover( node );
+            parent.m_child = node;
+            parents.push_back( parent );
+
+            first += size;
+        }
+
+        ASSERT( (int) parents.size() == nodes );
+
+        if( nodes == 1 )
+        {
+            m_root = parents[0].m_child;
+            break;
+        }
+
+        branches.swap( parents );
+    }
+
+    ASSERT( nextNode == nodeCount );
+}
+
+
+RTREE_TEMPLATE
+void RTREE_QUAL::SortTiles( Branch* a_first, Branch* a_last, int a_axis )
+{
+    int count = a_last - a_first;
+
+    std::sort( a_first, a_last, BranchCenterLess( a_axis ) );
+
+    if( a_axis == NUMDIMS - 1 || count <= MAXNODES )
+        return;
+
+    // Cut the branches in slabs along this axis, holding the same number of nodes, and
+    // order each slab along the next axes
+    int nodes    = ( count + MAXNODES - 1 ) / MAXNODES;
+    int slabs    = (int) ceil( pow( (double) nodes, 1.0 / ( NUMDIMS - a_axis ) ) );
+    int slabSize = ( ( nodes + slabs - 1 ) / slabs ) * MAXNODES;
+
+    for( int first = 0; first < count; first += slabSize )
+        SortTiles( a_first + first, a_first + rMin( first + slabSize, count ), a_axis + 1 );
 }
 
 
@@ -1051,6 +1212,10 @@ void RTREE_QUAL::FreeNode( Node* a_node )
 {
     ASSERT( a_node );
 
+    // Nodes created by BulkLoad() are freed all at once by Reset()
+    if( a_node >= m_arena && a_node < m_arena + m_arenaSize )
+        return;
+
 #ifdef RTREE_DONT_USE_MEMPOOLS
     delete a_node;
 #else       // RTREE_DONT_USE_MEMPOOLS
@@ -1111,7 +1276,7 @@ void RTREE_QUAL::InitRect( Rect* a_rect )
 // level to insert; e.g. a data rectangle goes in at level = 0.
 RTREE_TEMPLATE
 bool RTREE_QUAL::InsertRectRec( Rect*           a_rect,
-                                const DATATYPE& a_id,
+                                Node*           a_child,
                                 Node*           a_node,
                                 Node**          a_newNode,
                                 int             a_level )
@@ -1128,7 +1293,7 @@ bool RTREE_QUAL::InsertRectRec( Rect*           a_rect,
     {
         index = PickBranch( a_rect, a_node );
 
-        if( !InsertRectRec( a_rect, a_id, a_node->m_branch[index].m_child, &otherNode, a_level ) )
+        if( !InsertRectRec( a_rect, a_child, a_node->m_branch[index].m_child, &otherNode, a_level ) )
         {
             // Child was not split
             a_node->m_branch[index].m_rect =
@@ -1146,8 +1311,7 @@ bool RTREE_QUAL::InsertRectRec( Rect*           a_rect,
     else if( a_node->m_level == a_level ) // Have reached level for insertion. Add rect, split if necessary
     {
         branch.m_rect   = *a_rect;
-        branch.m_child  = (Node*) a_id;
-        // Child field of leaves contains id of data record
+        branch.m_child  = a_child;
         return AddBranch( &branch, a_node, a_newNode );
     }
     else
@@ -1164,10 +1328,12 @@ bool RTREE_QUAL::InsertRectRec( Rect*           a_rect,
 // returns 1 if root was split, 0 if it was not.
 // The level argument specifies the number of steps up from the leaf
 // level to insert; e.g. a data rectangle goes in at level = 0.
+// a_child is the child node, or the data id of a leaf branch cast to a Node*, so
+// that the branches of internal nodes can be inserted again without truncation.
 // InsertRect2 does the recursion.
 //
 RTREE_TEMPLATE
-bool RTREE_QUAL::InsertRect( Rect* a_rect, const DATATYPE& a_id, Node** a_root, int a_level )
+bool RTREE_QUAL::InsertRect( Rect* a_rect, Node* a_child, Node** a_root, int a_level )
 {
     ASSERT( a_rect && a_root );
     ASSERT( a_level >= 0 && a_level <= (*a_root)->m_level );
@@ -1184,7 +1350,7 @@ bool RTREE_QUAL::InsertRect( Rect* a_rect, const DATATYPE& a_id, Node** a_root,
     Node*   newNode;
     Branch  branch;
 
-    if( InsertRectRec( a_rect, a_id, *a_root, &newNode, a_level ) ) // Root split
+    if( InsertRectRec( a_rect, a_child, *a_root, &newNode, a_level ) ) // Root split
     {
         newRoot = AllocNode();                                      // Grow tree taller and new root
         newRoot->m_level    = (*a_root)->m_level + 1;
@@ -1684,7 +1850,7 @@ bool RTREE_QUAL::RemoveRect( Rect* a_rect, const DATATYPE& a_id, Node** a_root )
             for( int index = 0; index < tempNode->m_count; ++index )
             {
                 InsertRect( &(tempNode->m_branch[index].m_rect),
-                            tempNode->m_branch[index].m_data,
+                            tempNode->m_branch[index].m_child,
                             a_root,
                             tempNode->m_level );
             }
@@ -51,6 +51,7 @@ typedef std::unordered_map< std::string, EDA_RECT >     RECT_MAP;
 #define BOOST_DETAIL_TEST_FORCE_CONTAINER_FWD
 
 #include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
 
 // see http://www.boost.org/doc/libs/1_49_0/doc/html/boost/unordered_map.html
 
@@ -116,6 +117,21 @@ struct WXSTRING_HASH : std::unary_function<wxString, std::size_t>
 };
 
 
+/// Hash function for wxPoint, to find the items having a point at a given position
+struct WXPOINT_HASH : std::unary_function<wxPoint, std::size_t>
+{
+    std::size_t operator()( const wxPoint& aPoint ) const
+    {
+        std::size_t seed = 0;
+
+        boost::hash_combine( seed, aPoint.x );
+        boost::hash_combine( seed, aPoint.y );
+
+        return seed;
+    }
+};
+
+
 /**
  * Type KEYWORD_MAP
  * is a hashtable made of a const char* and an int.  Note that use of this
@@ -33,6 +33,7 @@
 #define PLOT_COMMON_H_
 
 #include <vector>
+#include <map>
 #include <math/box2.h>
 #include <drawtxt.h>
 #include <class_page_info.h>
@@ -348,6 +349,26 @@ public:
         // NOP for most plotters. Only for Gerber plotter
     }
 
+    /**
+     * Function BeginRegion
+     * starts a group of non overlapping filled polygons (typically the fractured
+     * polygons of a zone) which can be plotted as a single filled region,
+     * until EndRegion() is called.
+     */
+    virtual void BeginRegion()
+    {
+        // NOP for most plotters. Only for Gerber plotter
+    }
+
+    /**
+     * Function EndRegion
+     * ends the group of filled polygons started by BeginRegion().
+     */
+    virtual void EndRegion()
+    {
+        // NOP for most plotters. Only for Gerber plotter
+    }
+
 protected:
     // These are marker subcomponents
     /**
@@ -699,6 +720,7 @@ public:
         // Avoid non initialized variables:
         pageStreamHandle = streamLengthHandle = fontResDictHandle = 0;
         pageTreeHandle = 0;
+        compressionLevel = 9;   // wxZ_BEST_COMPRESSION
     }
 
     virtual PlotFormat GetPlotterType() const
@@ -706,6 +728,16 @@ public:
         return PLOT_FORMAT_PDF;
     }
 
+    /**
+     * Function SetCompressionLevel
+     * sets the zlib level (0 = none to 9 = best) used for the page content streams.
+     * Lower levels are much faster on large boards, for a slightly bigger file.
+     */
+    void SetCompressionLevel( int aLevel )
+    {
+        compressionLevel = aLevel;
+    }
+
     static wxString GetDefaultFileExtension()
     {
         return wxString( wxT( "pdf" ) );
@@ -775,6 +807,7 @@ protected:
     int streamLengthHandle;      /// Handle to the deferred stream length
     wxString workFilename;
     FILE* workFile;  	         /// Temporary file to costruct the stream before zipping
+    int compressionLevel;        /// zlib level of the content streams
     std::vector<long> xrefTable; /// The PDF xref offset table
 };
 
@@ -922,7 +955,9 @@ public:
 
     /**
      * Gerber polygon: they can (and *should*) be filled with the
-     * appropriate G36/G37 sequence
+     * appropriate G36/G37 sequence.  Between BeginRegion() and EndRegion(),
+     * consecutive filled polygons share the same region, and their thick
+     * outlines are plotted when it is closed.
      */
     virtual void PlotPoly( const std::vector< wxPoint >& aCornerList,
                            FILL_T aFill, int aWidth = USE_DEFAULT_LINE_WIDTH );
@@ -960,6 +995,9 @@ public:
      */
     virtual void SetLayerPolarity( bool aPositive );
 
+    virtual void BeginRegion();
+    virtual void EndRegion();
+
     /**
      * Function SetGerberCoordinatesFormat
      * selection of Gerber units and resolution (number of digits in mantissa)
@@ -985,6 +1023,22 @@ protected:
     std::vector<APERTURE>::iterator
     getAperture( const wxSize& size, APERTURE::APERTURE_TYPE type );
 
+    /**
+     * Function closeRegion
+     * ends the current G36/G37 region, if any, and strokes the outlines of the
+     * filled polygons it contains.
+     * Between BeginRegion() and EndRegion(), consecutive filled polygons are written
+     * as contours of a single region, so it must be closed before any other output.
+     */
+    void closeRegion();
+
+    /**
+     * Function strokePolyline
+     * plots aCornerList as thick segments of width aWidth.
+     * @param aClose = true to close the outline
+     */
+    void strokePolyline( const std::vector< wxPoint >& aCornerList, int aWidth, bool aClose );
+
     FILE* workFile;
     FILE* finalFile;
     wxString m_workFilename;
@@ -997,6 +1051,18 @@ protected:
     std::vector<APERTURE>           apertures;
     std::vector<APERTURE>::iterator currentAperture;
 
+    /// Index in apertures of each aperture, by type and size
+    std::map< std::pair< int, std::pair<int, int> >, int > m_apertureIndex;
+
+    bool     m_regionOpen;      // true inside a G36/G37 region
+    bool     m_regionGroup;     // true between BeginRegion() and EndRegion()
+    std::vector< std::vector< wxPoint > > m_regionOutlines;     // outlines of the
+    std::vector< int >                    m_regionOutlineWidths;// region polygons
+
+    bool     m_lastPosValid;    // false when the current position is unknown
+    int      m_lastPosX;        // current position, in Gerber units,
+    int      m_lastPosY;        // to omit the unchanged coordinates
+
     bool     m_gerberUnitInch;  // true if the gerber units are inches, false for mm
     int      m_gerberUnitFmt;   // number of digits in mantissa.
                                 // usually 6 in Inches and 5 or 6  in mm
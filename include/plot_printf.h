@@ -0,0 +1,90 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file plot_printf.h
+ * @brief Locale independent printf() used by the plotters.
+ */
+
+#ifndef PLOT_PRINTF_H_
+#define PLOT_PRINTF_H_
+
+#include <stdio.h>
+#include <stdarg.h>
+
+
+/// Size of the stdio buffer of the plot files
+#define PLOT_FILE_BUFFER_SIZE   ( 256 * 1024 )
+
+
+/**
+ * Function PlotPrintf
+ * is a replacement of fprintf() for the plot files.  Numbers are always written
+ * with a '.' as decimal separator, whatever the current locale is, and without the
+ * cost of the locale handling of the C library.
+ *
+ * Only the conversions used by the plotters are supported: d, i, u, x, X, c, s, f, F,
+ * g, G, e, E and %, with the flags '-', '0' and '#', a width, a precision and the 'l'
+ * length modifier.  The floating point conversions give the same result as printf();
+ * 'f' and 'g' are converted without the C library when possible.  Other conversions
+ * assert: their argument is not consumed, so they are written as they are and the
+ * following conversions are wrong.
+ *
+ * @param aFile is the file to write to.
+ * @param aFormat is a printf() style format string.
+ * @return int - the count of bytes written.
+ */
+int
+#if defined(__GNUG__)
+    __attribute__ ((format (printf, 2, 3)))
+#endif
+    PlotPrintf( FILE* aFile, const char* aFormat, ... );
+
+
+/**
+ * Function PlotSnprintf
+ * is the snprintf() equivalent of PlotPrintf().
+ * @return int - the count of bytes written, not including the terminating nul.
+ */
+int
+#if defined(__GNUG__)
+    __attribute__ ((format (printf, 3, 4)))
+#endif
+    PlotSnprintf( char* aBuffer, size_t aSize, const char* aFormat, ... );
+
+
+/**
+ * Function PlotVPrintf
+ * is the vfprintf() equivalent of PlotPrintf().
+ */
+int PlotVPrintf( FILE* aFile, const char* aFormat, va_list aArgs );
+
+
+/**
+ * Function SetPlotFileBuffer
+ * gives a large stdio buffer to a plot file just opened (before any I/O on it),
+ * so the plotters, which write a lot of small pieces, do less system calls.
+ */
+void SetPlotFileBuffer( FILE* aFile );
+
+#endif  // PLOT_PRINTF_H_
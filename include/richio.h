@@ -380,6 +380,56 @@ public:
 };
 
 
+/**
+ * Class MAPPED_FILE_LINE_READER
+ * is a LINE_READER that maps a whole file in memory, read only, and copies each line
+ * into the line buffer with a single memcpy(), instead of reading it character by
+ * character from a FILE.  The mapping itself is never written, so its pages stay
+ * shared with the page cache.
+ *
+ * Where mmap() is not available the file is read in a single buffer instead.
+ * Unlike FILE_LINE_READER, the file is read in binary mode, so the lines may end
+ * with "\r\n".
+ */
+class MAPPED_FILE_LINE_READER : public LINE_READER
+{
+protected:
+    const char* m_buffer;       ///< the whole file
+    size_t      m_size;         ///< no. bytes in m_buffer
+    size_t      m_ndx;          ///< offset of the next line in m_buffer
+    bool        m_mapped;       ///< true if m_buffer is a mapping, false if allocated
+
+public:
+
+    /**
+     * Constructor MAPPED_FILE_LINE_READER
+     * opens and maps @a aFileName.
+     *
+     * @param aFileName is the name of the file to read, also used for error reporting.
+     * @param aStartingLineNumber is the initial line number to report on error.
+     * @param aMaxLineLength is the maximum allowed line length.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or read.
+     */
+    MAPPED_FILE_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX ) throw( IO_ERROR );
+
+    ~MAPPED_FILE_LINE_READER();
+
+    char* ReadLine() throw( IO_ERROR );   // see LINE_READER::ReadLine() description
+
+    /**
+     * Function FileSize
+     * returns the size in bytes of the file being read.
+     */
+    size_t FileSize() const
+    {
+        return m_size;
+    }
+};
+
+
 /**
  * Class STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -401,8 +451,12 @@ public:
      *
      * @param aSource describes the source of aString for error reporting purposes
      *  can be anything meaninful, such as wxT( "clipboard" ).
+     *
+     * @param aStartingLineNumber is the line number of the line before the first
+     *  line of aString, when aString is a part of aSource.
      */
-    STRING_LINE_READER( const std::string& aString, const wxString& aSource );
+    STRING_LINE_READER( const std::string& aString, const wxString& aSource,
+                        unsigned aStartingLineNumber = 0 );
 
     /**
      * Constructor STRING_LINE_READER( const STRING_LINE_READER& )
@@ -0,0 +1,142 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file thread_pool.h
+ * @brief A pool of worker threads running tasks, with work stealing.
+ */
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <deque>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+
+/**
+ * Class THREAD_POOL
+ * runs tasks on a fixed set of worker threads.
+ *
+ * Each worker has its own queue of tasks.  A worker runs the tasks of its queue, newest
+ * first, and when its queue is empty it steals the oldest task of another queue.  Tasks
+ * submitted by a task go to the queue of the worker running it, so a task can split its
+ * work into smaller tasks, which are run by the idle workers.  Tasks submitted by other
+ * threads are spread over the queues.
+ *
+ * Tasks must not throw: exceptions escaping a task are caught and ignored.
+ */
+class THREAD_POOL
+{
+public:
+    typedef boost::function<void ()>                            TASK;
+
+    /**
+     * A progress reporter, called with the number of finished tasks and the number of
+     * submitted tasks.  It returns false to cancel the remaining tasks.
+     */
+    typedef boost::function<bool ( unsigned aDone, unsigned aTotal )> PROGRESS;
+
+    /**
+     * Constructor
+     * @param aThreadCount is the number of worker threads, or 0 for as many as there
+     *  are hardware threads.
+     */
+    THREAD_POOL( unsigned aThreadCount = 0 );
+
+    /**
+     * Destructor
+     * cancels the queued tasks and waits for the running ones.
+     */
+    ~THREAD_POOL();
+
+    unsigned GetThreadCount() const         { return m_threads.size(); }
+
+    /**
+     * Function Submit
+     * queues aTask, to be run by one of the workers.  Can be called by the tasks.
+     */
+    void Submit( const TASK& aTask );
+
+    /**
+     * Function Wait
+     * waits until all the submitted tasks are finished or cancelled.  Without a progress
+     * reporter the calling thread also runs tasks while waiting.  Must not be called by
+     * the tasks.
+     *
+     * @param aProgress is called by the thread calling Wait(), never by the workers, each
+     *  time some tasks are finished.
+     * @return bool - false if the tasks were cancelled.  The pool can then be used again.
+     */
+    bool Wait( const PROGRESS& aProgress = PROGRESS() );
+
+    /**
+     * Function Cancel
+     * discards the queued tasks.  The running tasks can test IsCancelled() to stop early.
+     */
+    void Cancel();
+
+    bool IsCancelled();
+
+    /// @return the number of tasks submitted since the last Wait().
+    unsigned GetTaskCount();
+
+    /// @return the number of tasks finished since the last Wait().
+    unsigned GetDoneCount();
+
+private:
+    struct QUEUE
+    {
+        boost::mutex        m_lock;
+        std::deque<TASK>    m_tasks;
+    };
+
+    void worker( int aIndex );
+
+    /// @return the index of the queue of the calling worker, or -1 for other threads.
+    int currentWorker() const;
+
+    /// Takes a task from queue aIndex, or steals one from the other queues.
+    bool takeTask( int aIndex, TASK& aTask );
+
+    void runTask( const TASK& aTask );
+
+    boost::ptr_vector<QUEUE>        m_queues;
+    std::vector<boost::thread::id>  m_threadIds;
+    boost::thread_group             m_threads;
+
+    boost::mutex                    m_lock;         ///< guards the counters below
+    boost::condition_variable       m_changed;      ///< a task was queued or finished
+    unsigned                        m_queued;       ///< tasks in the queues
+    unsigned                        m_unfinished;   ///< tasks queued or running
+    unsigned                        m_submitted;
+    unsigned                        m_done;
+    unsigned                        m_nextQueue;    ///< for the tasks of other threads
+    bool                            m_quit;
+    bool                            m_cancelled;
+};
+
+#endif  // THREAD_POOL_H_
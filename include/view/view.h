@@ -112,11 +112,14 @@ public:
      */
     void CopySettings( const VIEW* aOtherView );
 
-    /*
-     *  Convenience wrappers for adding multiple items
-     *  template <class T> void AddItems( const T& aItems );
-     *  template <class T> void RemoveItems( const T& aItems );
+    /**
+     * Function AddItems()
+     * Adds a set of VIEW_ITEMs to the view. The spatial index of the layers which are empty
+     * is built at once, so this is much faster than adding the items one by one when loading
+     * a whole document.
+     * @param aItems: items to be added. No ownership is given
      */
+    void AddItems( const std::vector<VIEW_ITEM*>& aItems );
 
     /**
      * Function SetGAL()
@@ -25,6 +25,7 @@
 #ifndef __VIEW_RTREE_H
 #define __VIEW_RTREE_H
 
+#include <vector>
 #include <math/box2.h>
 
 #include <geometry/rtree.h>
@@ -55,6 +56,32 @@ public:
         VIEW_RTREE_BASE::Insert( mmin, mmax, aItem );
     }
 
+    /**
+     * Function BulkLoad()
+     * Replaces the content of the tree by aItems. The tree is packed at once, which is much
+     * faster than inserting the items one by one, and gives a tree that is faster to query.
+     */
+    void BulkLoad( const std::vector<VIEW_ITEM*>& aItems )
+    {
+        std::vector<int> mmin( aItems.size() * 2 );
+        std::vector<int> mmax( aItems.size() * 2 );
+
+        for( unsigned i = 0; i < aItems.size(); ++i )
+        {
+            const BOX2I& bbox = aItems[i]->ViewBBox();
+
+            mmin[2 * i]     = bbox.GetX();
+            mmin[2 * i + 1] = bbox.GetY();
+            mmax[2 * i]     = bbox.GetRight();
+            mmax[2 * i + 1] = bbox.GetBottom();
+        }
+
+        if( aItems.empty() )
+            VIEW_RTREE_BASE::RemoveAll();
+        else
+            VIEW_RTREE_BASE::BulkLoad( aItems.size(), &mmin[0], &mmax[0], &aItems[0] );
+    }
+
     /**
      * Function Remove()
      * Removes an item from the tree. Removal is done by comparing pointers, attepmting to remove a copy
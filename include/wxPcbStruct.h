@@ -222,6 +222,7 @@ public:
 
     bool m_show_microwave_tools;
     bool m_show_layer_manager_tools;
+    int  m_undoMemoryBudget;                ///< undo/redo memory budget in MB, 0 = no limit
 
     virtual ~PCB_EDIT_FRAME();
 
@@ -1400,6 +1401,7 @@ public:
      * @param aActiveWindow = the current active window, if a progress bar is shown
      *                      = NULL to do not display a progress bar
      * @param aVerbose = true to show error messages
+     * @return 1 if a zone could not be filled, 0 otherwise
      */
     int Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose = true );
 
@@ -568,6 +568,9 @@ void PCB_BASE_FRAME::UpdateMsgPanel()
             GetGalCanvas()->GetMsgPanelInfo( items );
         else
             m_Pcb->GetMsgPanelInfo( items );
+
+        if( IsType( FRAME_PCB ) )
+            GetScreen()->GetUndoMemoryInfo( items );
     }
 
     SetMsgPanel( items );
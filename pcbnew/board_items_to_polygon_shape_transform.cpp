@@ -31,6 +31,7 @@
  * Used to fill zones areas and in 3D viewer
  */
 #include <vector>
+#include <boost/thread/tss.hpp>
 
 #include <fctsys.h>
 #include <drawtxt.h>
@@ -50,16 +51,30 @@
 // These variables are parameters used in addTextSegmToPoly.
 // But addTextSegmToPoly is a call-back function,
 // so we cannot send them as arguments.
-static int s_textWidth;
-static int s_textCircle2SegmentCount;
-static SHAPE_POLY_SET* s_cornerBuffer;
+// Layers are converted by several plot threads at once, so each thread
+// has its own set of parameters.
+struct TSEGM_2_POLY_PRMS
+{
+    int             m_textWidth;
+    int             m_textCircle2SegmentCount;
+    SHAPE_POLY_SET* m_cornerBuffer;
+};
+
+// The parameters are locals of the converting function: nothing to delete
+static void keepTextSegmParams( TSEGM_2_POLY_PRMS* aParams )
+{
+}
+
+static boost::thread_specific_ptr<TSEGM_2_POLY_PRMS> s_textSegmParams( keepTextSegmParams );
 
 // This is a call back function, used by DrawGraphicText to draw the 3D text shape:
 static void addTextSegmToPoly( int x0, int y0, int xf, int yf )
 {
-    TransformRoundedEndsSegmentToPolygon( *s_cornerBuffer,
+    TSEGM_2_POLY_PRMS* prms = s_textSegmParams.get();
+
+    TransformRoundedEndsSegmentToPolygon( *prms->m_cornerBuffer,
                                            wxPoint( x0, y0), wxPoint( xf, yf ),
-                                           s_textCircle2SegmentCount, s_textWidth );
+                                           prms->m_textCircle2SegmentCount, prms->m_textWidth );
 }
 
 
@@ -248,18 +263,21 @@ void MODULE::TransformGraphicShapesWithClearanceToPolygonSet(
     if( Value().GetLayer() == aLayer && Value().IsVisible() )
         texts.push_back( &Value() );
 
-    s_cornerBuffer = &aCornerBuffer;
+    TSEGM_2_POLY_PRMS prms;
+    prms.m_cornerBuffer = &aCornerBuffer;
 
     // To allow optimization of circles approximated by segments,
     // aCircleToSegmentsCountForTexts, when not 0, is used.
     // if 0 (default value) the aCircleToSegmentsCount is used
-    s_textCircle2SegmentCount = aCircleToSegmentsCountForTexts ?
-                                aCircleToSegmentsCountForTexts : aCircleToSegmentsCount;
+    prms.m_textCircle2SegmentCount = aCircleToSegmentsCountForTexts ?
+                                     aCircleToSegmentsCountForTexts : aCircleToSegmentsCount;
+
+    s_textSegmParams.reset( &prms );
 
     for( unsigned ii = 0; ii < texts.size(); ii++ )
     {
         TEXTE_MODULE *textmod = texts[ii];
-        s_textWidth  = textmod->GetThickness() + ( 2 * aInflateValue );
+        prms.m_textWidth  = textmod->GetThickness() + ( 2 * aInflateValue );
         wxSize size = textmod->GetSize();
 
         if( textmod->IsMirrored() )
@@ -272,6 +290,7 @@ void MODULE::TransformGraphicShapesWithClearanceToPolygonSet(
                          true, addTextSegmToPoly );
     }
 
+    s_textSegmParams.reset();
 }
 
  /* Function TransformSolidAreasShapesToPolygonSet
@@ -374,9 +393,12 @@ void TEXTE_PCB::TransformShapeWithClearanceToPolygonSet(
     if( IsMirrored() )
         size.x = -size.x;
 
-    s_cornerBuffer = &aCornerBuffer;
-    s_textWidth  = GetThickness() + ( 2 * aClearanceValue );
-    s_textCircle2SegmentCount = aCircleToSegmentsCount;
+    TSEGM_2_POLY_PRMS prms;
+    prms.m_cornerBuffer = &aCornerBuffer;
+    prms.m_textWidth  = GetThickness() + ( 2 * aClearanceValue );
+    prms.m_textCircle2SegmentCount = aCircleToSegmentsCount;
+    s_textSegmParams.reset( &prms );
+
     EDA_COLOR_T color = BLACK;  // not actually used, but needed by DrawGraphicText
 
     if( IsMultilineAllowed() )
@@ -405,6 +427,8 @@ void TEXTE_PCB::TransformShapeWithClearanceToPolygonSet(
                          GetThickness(), IsItalic(),
                          true, addTextSegmToPoly );
     }
+
+    s_textSegmParams.reset();
 }
 
 
@@ -28,11 +28,13 @@
 #include <class_drawpanel.h>
 #include <class_draw_panel_gal.h>
 #include <macros.h>
+#include <msgpanel.h>
 
 #include <pcbnew.h>
 #include <wxPcbStruct.h>
 
 #include <class_board.h>
+#include <connectivity_graph.h>
 #include <class_track.h>
 #include <class_drawsegment.h>
 #include <class_pcb_text.h>
@@ -41,8 +43,10 @@
 #include <class_dimension.h>
 #include <class_zone.h>
 #include <class_edge_mod.h>
+#include <3d_struct.h>
 
 #include <ratsnest_data.h>
+#include <drc_online_state.h>
 
 #include <tools/selection_tool.h>
 #include <tool/tool_manager.h>
@@ -98,7 +102,138 @@
  *      mirror (Y) and flip list of items (undo/redo is made by mirror or flip items)
  *      so they are handled specifically.
  *
+ *   Reference and value fields of a footprint are persistent objects, so a change of
+ *   one of them only stores a copy of the field, not a copy of the whole footprint.
+ *
+ *   The memory used by the stored copies is estimated when a command is pushed, and
+ *   the oldest commands are deleted when the PCB_SCREEN undo memory budget is exceeded.
+ *
+ */
+
+
+/**
+ * Function isModuleField
+ * @return true if aItem is the reference or the value of a footprint.
+ * These texts are never deleted or recreated by the footprint (MODULE::Copy() copies
+ * them in place), so their undo copy can be stored alone.
  */
+static bool isModuleField( const BOARD_ITEM* aItem )
+{
+    if( aItem->Type() != PCB_MODULE_TEXT_T )
+        return false;
+
+    return static_cast<const TEXTE_MODULE*>( aItem )->GetType() != TEXTE_MODULE::TEXT_is_DIVERS;
+}
+
+
+/**
+ * Function itemMemorySize
+ * estimates the memory used by an item and the sub items it owns
+ */
+static size_t itemMemorySize( const BOARD_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+        size_t size = sizeof( MODULE );
+
+        size += itemMemorySize( &module->Reference() );
+        size += itemMemorySize( &module->Value() );
+
+        for( const D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            size += sizeof( D_PAD );
+
+        for( const BOARD_ITEM* item = module->GraphicalItems(); item; item = item->Next() )
+            size += itemMemorySize( item );
+
+        size += module->Models().GetCount() * sizeof( S3D_MASTER );
+
+        return size;
+    }
+
+    case PCB_MODULE_TEXT_T:
+        return sizeof( TEXTE_MODULE ) +
+               static_cast<const TEXTE_MODULE*>( aItem )->GetText().Len() * sizeof( wxChar );
+
+    case PCB_MODULE_EDGE_T:
+        return sizeof( EDGE_MODULE );
+
+    case PCB_PAD_T:
+        return sizeof( D_PAD );
+
+    case PCB_ZONE_AREA_T:
+    {
+        const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( aItem );
+
+        return sizeof( ZONE_CONTAINER ) + sizeof( CPolyLine ) +
+               zone->Outline()->GetCornersCount() * sizeof( CPolyPt ) +
+               zone->GetFilledPolysList().TotalVertices() * sizeof( VECTOR2I ) +
+               zone->FillSegments().size() * sizeof( SEGMENT );
+    }
+
+    case PCB_LINE_T:
+        return sizeof( DRAWSEGMENT ) +
+               static_cast<const DRAWSEGMENT*>( aItem )->GetBezierPoints().size() * sizeof( wxPoint );
+
+    case PCB_TEXT_T:
+        return sizeof( TEXTE_PCB ) +
+               static_cast<const TEXTE_PCB*>( aItem )->GetText().Len() * sizeof( wxChar );
+
+    case PCB_TRACE_T:
+    case PCB_ZONE_T:
+        return sizeof( TRACK );
+
+    case PCB_VIA_T:
+        return sizeof( VIA );
+
+    case PCB_TARGET_T:
+        return sizeof( PCB_TARGET );
+
+    case PCB_DIMENSION_T:
+        return sizeof( DIMENSION );
+
+    default:
+        return sizeof( BOARD_ITEM );
+    }
+}
+
+
+/**
+ * Function commandMemorySize
+ * estimates the memory owned by an undo/redo command, i.e. the pickers and the items
+ * which are deleted with the command (copies of changed items and deleted items)
+ */
+static size_t commandMemorySize( const PICKED_ITEMS_LIST& aList )
+{
+    size_t size = sizeof( PICKED_ITEMS_LIST ) + aList.GetCount() * sizeof( ITEM_PICKER );
+
+    for( unsigned ii = 0; ii < aList.GetCount(); ii++ )
+    {
+        const BOARD_ITEM* owned = NULL;
+
+        switch( aList.GetPickedItemStatus( ii ) )
+        {
+        case UR_CHANGED:
+            owned = (const BOARD_ITEM*) aList.GetPickedItemLink( ii );
+            break;
+
+        case UR_DELETED:
+        case UR_MODEDIT:
+            owned = (const BOARD_ITEM*) aList.GetPickedItem( ii );
+            break;
+
+        default:
+            break;
+        }
+
+        if( owned )
+            size += itemMemorySize( owned );
+    }
+
+    return size;
+}
 
 
 /**
@@ -115,6 +250,8 @@
  * @param aPcb = board to test
  * @param aItem = item to find
  *              = NULL to build the list of existing items
+ * The reference and value fields of the footprints are in the list too, so aItem is
+ * never dereferenced: it may have been deleted
  */
 static bool TestForExistingItem( BOARD* aPcb, BOARD_ITEM* aItem )
 {
@@ -130,9 +267,9 @@ static bool TestForExistingItem( BOARD* aPcb, BOARD_ITEM* aItem )
         for( item = aPcb->m_Track; item != NULL; item = item->Next() )
             icnt++;
 
-        // Count modules:
+        // Count modules, with their reference and value:
         for( item = aPcb->m_Modules; item != NULL; item = item->Next() )
-            icnt++;
+            icnt += 3;
 
         // Count drawings
         for( item = aPcb->m_Drawings; item != NULL; item = item->Next() )
@@ -154,9 +291,13 @@ static bool TestForExistingItem( BOARD* aPcb, BOARD_ITEM* aItem )
         for( item = aPcb->m_Track; item != NULL; item = item->Next() )
             itemsList.push_back( item );
 
-        // Append modules:
-        for( item = aPcb->m_Modules; item != NULL; item = item->Next() )
-            itemsList.push_back( item );
+        // Append modules, and their reference and value fields:
+        for( MODULE* module = aPcb->m_Modules; module != NULL; module = module->Next() )
+        {
+            itemsList.push_back( module );
+            itemsList.push_back( &module->Reference() );
+            itemsList.push_back( &module->Value() );
+        }
 
         // Append drawings
         for( item = aPcb->m_Drawings; item != NULL; item = item->Next() )
@@ -180,6 +321,34 @@ static bool TestForExistingItem( BOARD* aPcb, BOARD_ITEM* aItem )
 }
 
 
+/**
+ * Function notifyConnectivity
+ * tells the connectivity graph of aBoard about an item saved in the undo list.
+ * New and deleted items may have been put in or taken from the board lists without
+ * BOARD::Add() or BOARD::Remove(); the other items are about to be modified, and are
+ * put back in the graph by CONNECTIVITY_GRAPH::UpdateModified() once the command is done.
+ */
+static void notifyConnectivity( BOARD* aBoard, BOARD_ITEM* aItem, UNDO_REDO_T aStatus )
+{
+    CONNECTIVITY_GRAPH* connectivity = aBoard->GetConnectivity();
+
+    switch( aStatus )
+    {
+    case UR_NEW:
+        connectivity->Add( aItem );
+        break;
+
+    case UR_DELETED:
+        connectivity->Remove( aItem );
+        break;
+
+    default:
+        connectivity->MarkModified( aItem );
+        break;
+    }
+}
+
+
 void BOARD_ITEM::SwapData( BOARD_ITEM* aImage )
 {
     if( aImage == NULL )
@@ -215,6 +384,16 @@ void BOARD_ITEM::SwapData( BOARD_ITEM* aImage )
     }
         break;
 
+    case PCB_MODULE_TEXT_T:
+    {
+        // Only footprint fields are stored alone, see SaveCopyInUndoList()
+        TEXTE_MODULE* tmp = (TEXTE_MODULE*) aImage->Clone();
+        ( (TEXTE_MODULE*) aImage )->Copy( (TEXTE_MODULE*) this );
+        ( (TEXTE_MODULE*) this )->Copy( tmp );
+        delete tmp;
+    }
+        break;
+
     case PCB_LINE_T:
         std::swap( *((DRAWSEGMENT*)this), *((DRAWSEGMENT*)aImage) );
         break;
@@ -306,17 +485,26 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
     if( aItem == NULL )     // Nothing to save
         return;
 
-    // For texts belonging to modules, we need to save state of the parent module
+    // For texts belonging to modules, we need to save state of the parent module,
+    // excepted for the reference and value fields which can be saved alone
     if( aItem->Type() == PCB_MODULE_TEXT_T )
     {
-        aItem = aItem->GetParent();
-        wxASSERT( aItem->Type() == PCB_MODULE_T );
         aCommandType = UR_CHANGED;
 
-        if( aItem == NULL )
-            return;
+        if( !isModuleField( aItem ) )
+        {
+            aItem = aItem->GetParent();
+            wxASSERT( aItem->Type() == PCB_MODULE_T );
+
+            if( aItem == NULL )
+                return;
+        }
     }
 
+    // The item is about to be modified: the online DRC will have to test it again
+    GetBoard()->GetDrcState()->MarkDirty( aItem );
+    notifyConnectivity( GetBoard(), aItem, aCommandType );
+
     PICKED_ITEMS_LIST* commandToUndo = new PICKED_ITEMS_LIST();
 
     commandToUndo->m_TransformPoint = aTransformPoint;
@@ -387,8 +575,10 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
     {
         BOARD_ITEM* item    = (BOARD_ITEM*) commandToUndo->GetPickedItem( ii );
 
-        // For texts belonging to modules, we need to save state of the parent module
-        if( item->Type() == PCB_MODULE_TEXT_T  || item->Type() == PCB_PAD_T )
+        // For texts belonging to modules, we need to save state of the parent module,
+        // excepted for the reference and value fields which can be saved alone
+        if( ( item->Type() == PCB_MODULE_TEXT_T && !isModuleField( item ) )
+                || item->Type() == PCB_PAD_T )
         {
             item = item->GetParent();
             wxASSERT( item->Type() == PCB_MODULE_T );
@@ -399,6 +589,10 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
             commandToUndo->SetPickedItem( item, ii );
             commandToUndo->SetPickedItemStatus( UR_CHANGED, ii );
         }
+        else if( isModuleField( item ) )
+        {
+            commandToUndo->SetPickedItemStatus( UR_CHANGED, ii );
+        }
 
         UNDO_REDO_T command = commandToUndo->GetPickedItemStatus( ii );
 
@@ -442,6 +636,15 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
         }
     }
 
+    // The items are about to be modified: the online DRC will have to test them again
+    GetBoard()->GetDrcState()->MarkDirty( *commandToUndo );
+
+    for( unsigned ii = 0; ii < commandToUndo->GetCount(); ii++ )
+    {
+        notifyConnectivity( GetBoard(), (BOARD_ITEM*) commandToUndo->GetPickedItem( ii ),
+                            commandToUndo->GetPickedItemStatus( ii ) );
+    }
+
     if( commandToUndo->GetCount() )
     {
         /* Save the copy in undo list */
@@ -465,6 +668,7 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
     bool        reBuild_ratsnest = false;
     KIGFX::VIEW* view = GetGalCanvas()->GetView();
     RN_DATA* ratsnest = GetBoard()->GetRatsnest();
+    CONNECTIVITY_GRAPH* connectivity = GetBoard()->GetConnectivity();
 
     // Undo in the reverse order of list creation: (this can allow stacked changes
     // like the same item can be changes and deleted in the same complex command
@@ -504,6 +708,10 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
             }
         }
 
+        // The item exists (deleted items are owned by the undo list): it can be given
+        // to the online DRC before being restored
+        GetBoard()->GetDrcState()->MarkDirty( *aList, ii );
+
         item->ClearFlags();
 
         // see if we must rebuild ratsnets and pointers lists
@@ -535,6 +743,7 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
             }
             view->Remove( item );
             ratsnest->Remove( item );
+            connectivity->Remove( item );
 
             item->SwapData( image );
 
@@ -547,6 +756,7 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
             }
             view->Add( item );
             ratsnest->Add( item );
+            connectivity->Add( item );
 
             item->ClearFlags( SELECTED );
             item->ViewUpdate( KIGFX::VIEW_ITEM::LAYERS );
@@ -586,6 +796,7 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
             item->Move( aRedoCommand ? aList->m_TransformPoint : -aList->m_TransformPoint );
             item->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
             ratsnest->Update( item );
+            connectivity->Update( item );
             break;
 
         case UR_ROTATED:
@@ -593,6 +804,7 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
                           aRedoCommand ? m_rotationAngle : -m_rotationAngle );
             item->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
             ratsnest->Update( item );
+            connectivity->Update( item );
             break;
 
         case UR_ROTATED_CLOCKWISE:
@@ -600,12 +812,14 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
                           aRedoCommand ? -m_rotationAngle : m_rotationAngle );
             item->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
             ratsnest->Update( item );
+            connectivity->Update( item );
             break;
 
         case UR_FLIPPED:
             item->Flip( aList->m_TransformPoint );
             item->ViewUpdate( KIGFX::VIEW_ITEM::LAYERS );
             ratsnest->Update( item );
+            connectivity->Update( item );
             break;
 
         default:
@@ -705,7 +919,97 @@ void PCB_SCREEN::ClearUndoORRedoList( UNDO_REDO_CONTAINER& aList, int aItemCount
         PICKED_ITEMS_LIST* curr_cmd = aList.m_CommandsList[0];
         aList.m_CommandsList.erase( aList.m_CommandsList.begin() );
 
+        size_t& memory = ( &aList == &m_UndoList ) ? m_undoMemory : m_redoMemory;
+        std::map<const PICKED_ITEMS_LIST*, size_t>::iterator it = m_commandMemory.find( curr_cmd );
+
+        if( it != m_commandMemory.end() )
+        {
+            memory -= std::min( memory, it->second );
+            m_commandMemory.erase( it );
+        }
+
         curr_cmd->ClearListAndDeleteItems();
         delete curr_cmd;    // Delete command
     }
 }
+
+
+void PCB_SCREEN::PushCommandToUndoList( PICKED_ITEMS_LIST* aNewitem )
+{
+    size_t size = commandMemorySize( *aNewitem );
+
+    m_commandMemory[aNewitem] = size;
+    m_undoMemory += size;
+
+    BASE_SCREEN::PushCommandToUndoList( aNewitem );
+    trimUndoORRedoList( m_UndoList );
+}
+
+
+void PCB_SCREEN::PushCommandToRedoList( PICKED_ITEMS_LIST* aNewitem )
+{
+    size_t size = commandMemorySize( *aNewitem );
+
+    m_commandMemory[aNewitem] = size;
+    m_redoMemory += size;
+
+    BASE_SCREEN::PushCommandToRedoList( aNewitem );
+    trimUndoORRedoList( m_RedoList );
+}
+
+
+PICKED_ITEMS_LIST* PCB_SCREEN::PopCommandFromUndoList()
+{
+    PICKED_ITEMS_LIST* cmd = BASE_SCREEN::PopCommandFromUndoList();
+    std::map<const PICKED_ITEMS_LIST*, size_t>::iterator it = m_commandMemory.find( cmd );
+
+    if( it != m_commandMemory.end() )
+    {
+        m_undoMemory -= std::min( m_undoMemory, it->second );
+        m_commandMemory.erase( it );
+    }
+
+    return cmd;
+}
+
+
+PICKED_ITEMS_LIST* PCB_SCREEN::PopCommandFromRedoList()
+{
+    PICKED_ITEMS_LIST* cmd = BASE_SCREEN::PopCommandFromRedoList();
+    std::map<const PICKED_ITEMS_LIST*, size_t>::iterator it = m_commandMemory.find( cmd );
+
+    if( it != m_commandMemory.end() )
+    {
+        m_redoMemory -= std::min( m_redoMemory, it->second );
+        m_commandMemory.erase( it );
+    }
+
+    return cmd;
+}
+
+
+void PCB_SCREEN::trimUndoORRedoList( UNDO_REDO_CONTAINER& aList )
+{
+    if( m_undoMemoryBudget == 0 )
+        return;
+
+    // Always keep the last command, even if it alone exceeds the budget
+    while( m_undoMemory + m_redoMemory > m_undoMemoryBudget && aList.m_CommandsList.size() > 1 )
+        ClearUndoORRedoList( aList, 1 );
+}
+
+
+void PCB_SCREEN::GetUndoMemoryInfo( std::vector<MSG_PANEL_ITEM>& aList ) const
+{
+    wxString txt;
+
+    txt.Printf( wxT( "%d / %d" ), GetUndoCommandCount(), GetRedoCommandCount() );
+    aList.push_back( MSG_PANEL_ITEM( _( "Undo/Redo" ), txt, BROWN ) );
+
+    txt.Printf( wxT( "%.1f MB" ), ( m_undoMemory + m_redoMemory ) / ( 1024.0 * 1024.0 ) );
+
+    if( m_undoMemoryBudget )
+        txt += wxString::Format( wxT( " / %.0f MB" ), m_undoMemoryBudget / ( 1024.0 * 1024.0 ) );
+
+    aList.push_back( MSG_PANEL_ITEM( _( "Undo Memory" ), txt, BROWN ) );
+}
@@ -43,6 +43,8 @@
 #include <base_units.h>
 #include <ratsnest_data.h>
 #include <ratsnest_viewitem.h>
+#include <drc_online_state.h>
+#include <connectivity_graph.h>
 #include <worksheet_viewitem.h>
 
 #include <pcbnew.h>
@@ -107,6 +109,10 @@ BOARD::BOARD() :
 
     // Initialize ratsnest
     m_ratsnest = new RN_DATA( this );
+
+    m_drcState = new DRC_ONLINE_STATE();
+
+    m_connectivity = new CONNECTIVITY_GRAPH( this );
 }
 
 
@@ -126,6 +132,9 @@ BOARD::~BOARD()
     DeleteMARKERs();
     DeleteZONEOutlines();
 
+    delete m_drcState;
+    delete m_connectivity;
+
     delete m_CurrentZoneContour;
     m_CurrentZoneContour = NULL;
 }
@@ -749,6 +758,7 @@ void BOARD::Add( BOARD_ITEM* aBoardItem, int aControl )
     }
 
     m_ratsnest->Add( aBoardItem );
+    m_connectivity->Add( aBoardItem );
 }
 
 
@@ -771,6 +781,8 @@ BOARD_ITEM* BOARD::Remove( BOARD_ITEM* aBoardItem )
             }
         }
 
+        m_drcState->ForgetMarker( (MARKER_PCB*) aBoardItem );
+
         break;
 
     case PCB_ZONE_AREA_T:    // this one uses a vector
@@ -813,6 +825,7 @@ BOARD_ITEM* BOARD::Remove( BOARD_ITEM* aBoardItem )
     }
 
     m_ratsnest->Remove( aBoardItem );
+    m_connectivity->Remove( aBoardItem );
 
     return aBoardItem;
 }
@@ -825,6 +838,9 @@ void BOARD::DeleteMARKERs()
         delete m_markers[i];
 
     m_markers.clear();
+
+    // Without its markers, the board must be fully tested again
+    m_drcState->Reset();
 }
 
 
@@ -57,6 +57,8 @@ class MSG_PANEL_ITEM;
 class NETLIST;
 class REPORTER;
 class RN_DATA;
+class DRC_ONLINE_STATE;
+class CONNECTIVITY_GRAPH;
 class SHAPE_POLY_SET;
 
 // non-owning container of item candidates when searching for items on the same track.
@@ -191,6 +193,8 @@ private:
     EDA_RECT                m_BoundingBox;
     NETINFO_LIST            m_NetInfo;              ///< net info list (name, design constraints ..
     RN_DATA*                m_ratsnest;
+    DRC_ONLINE_STATE*       m_drcState;             ///< items to re-test by the online DRC
+    CONNECTIVITY_GRAPH*     m_connectivity;         ///< clusters of connected copper items
 
     BOARD_DESIGN_SETTINGS   m_designSettings;
     ZONE_SETTINGS           m_zoneSettings;
@@ -314,6 +318,27 @@ public:
         return m_ratsnest;
     }
 
+    /**
+     * Function GetDrcState()
+     * returns the items modified since the last DRC run, and the markers created for
+     * each item, used to re-test only the modified parts of the board.
+     */
+    DRC_ONLINE_STATE* GetDrcState() const
+    {
+        return m_drcState;
+    }
+
+    /**
+     * Function GetConnectivity()
+     * returns the clusters of copper items connected together, net by net.  They are
+     * updated incrementally, so CONNECTIVITY_GRAPH::Synchronize() only recomputes the nets
+     * modified since the last query.
+     */
+    CONNECTIVITY_GRAPH* GetConnectivity() const
+    {
+        return m_connectivity;
+    }
+
     /**
      * Function DeleteMARKERs
      * deletes ALL MARKERS from the board.
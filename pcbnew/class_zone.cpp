@@ -55,6 +55,8 @@ ZONE_CONTAINER::ZONE_CONTAINER( BOARD* aBoard ) :
 {
     m_CornerSelection = -1;
     m_IsFilled = false;                         // fill status : true when the zone is filled
+    m_fillInputsHash = 0;
+    m_filledPolysRevision = 0;
     m_FillMode = 0;                             // How to fill areas: 0 = use filled polygons, != 0 fill with segments
     m_priority = 0;
     m_smoothedPoly = NULL;
@@ -82,6 +84,8 @@ ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone ) :
     // For corner moving, corner index to drag, or -1 if no selection
     m_CornerSelection = -1;
     m_IsFilled = aZone.m_IsFilled;
+    m_fillInputsHash = aZone.m_fillInputsHash;
+    m_filledPolysRevision = 0;
     m_ZoneClearance = aZone.m_ZoneClearance;     // clearance value
     m_ZoneMinThickness = aZone.m_ZoneMinThickness;
     m_FillMode = aZone.m_FillMode;               // Filling mode (segments/polygons)
@@ -118,6 +122,19 @@ EDA_ITEM* ZONE_CONTAINER::Clone() const
 }
 
 
+unsigned ZONE_CONTAINER::GetFilledPolysRevision() const
+{
+    static unsigned lastRevision = 0;
+
+    // Numbered lazily, so the filled areas built in parallel by the zone filler
+    // get their revision in the (main) thread reading it.
+    if( m_filledPolysRevision == 0 )
+        m_filledPolysRevision = ++lastRevision;
+
+    return m_filledPolysRevision;
+}
+
+
 bool ZONE_CONTAINER::UnFill()
 {
     bool change = ( !m_FilledPolysList.IsEmpty() ) ||
@@ -126,6 +143,8 @@ bool ZONE_CONTAINER::UnFill()
     m_FilledPolysList.RemoveAllContours();
     m_FillSegmList.clear();
     m_IsFilled = false;
+    m_fillInputsHash = 0;
+    m_filledPolysRevision = 0;
 
     return change;
 }
@@ -664,6 +683,7 @@ void ZONE_CONTAINER::Move( const wxPoint& offset )
     m_Poly->Hatch();
 
     m_FilledPolysList.Move( VECTOR2I( offset.x, offset.y ) );
+    m_filledPolysRevision = 0;
 
     for( unsigned ic = 0; ic < m_FillSegmList.size(); ic++ )
     {
@@ -713,6 +733,8 @@ void ZONE_CONTAINER::Rotate( const wxPoint& centre, double angle )
     for( SHAPE_POLY_SET::ITERATOR ic = m_FilledPolysList.Iterate(); ic; ++ic )
         RotatePoint( &ic->x, &ic->y, centre.x, centre.y, angle );
 
+    m_filledPolysRevision = 0;
+
     for( unsigned ic = 0; ic < m_FillSegmList.size(); ic++ )
     {
         RotatePoint( &m_FillSegmList[ic].m_Start, centre, angle );
@@ -744,6 +766,8 @@ void ZONE_CONTAINER::Mirror( const wxPoint& mirror_ref )
         ic->y = py + mirror_ref.y;
     }
 
+    m_filledPolysRevision = 0;
+
     for( unsigned ic = 0; ic < m_FillSegmList.size(); ic++ )
     {
         MIRROR( m_FillSegmList[ic].m_Start.y, mirror_ref.y );
@@ -774,6 +798,7 @@ void ZONE_CONTAINER::Copy( ZONE_CONTAINER* src )
     m_Poly->m_HatchLines = src->m_Poly->m_HatchLines;   // Copy vector <CSegment>
     m_FilledPolysList.RemoveAllContours();
     m_FilledPolysList.Append( src->m_FilledPolysList );
+    m_filledPolysRevision = 0;
     m_FillSegmList.clear();
     m_FillSegmList = src->m_FillSegmList;
 }
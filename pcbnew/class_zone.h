@@ -193,6 +193,21 @@ public:
     bool IsFilled() const { return m_IsFilled; }
     void SetIsFilled( bool isFilled ) { m_IsFilled = isFilled; }
 
+    /**
+     * Function GetFillInputsHash
+     * @return the value of BuildFillInputsHash() when the current filled areas were
+     * built, or 0 if it is not known.
+     */
+    size_t GetFillInputsHash() const { return m_fillInputsHash; }
+    void SetFillInputsHash( size_t aHash ) { m_fillInputsHash = aHash; }
+
+    /**
+     * Function GetFilledPolysRevision
+     * @return a number identifying the current filled areas: it changes each time they are
+     * modified, so it can stand for their content in a signature.  Not thread safe.
+     */
+    unsigned GetFilledPolysRevision() const;
+
     int GetZoneClearance() const { return m_ZoneClearance; }
     void SetZoneClearance( int aZoneClearance ) { m_ZoneClearance = aZoneClearance; }
 
@@ -285,6 +300,30 @@ public:
      */
     bool BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer = NULL );
 
+    /**
+     * Function CreateSmoothedPoly
+     * builds the corner-smoothed version of m_Poly, according to the corner smoothing
+     * settings of the zone.
+     * The zone is not modified, so this function can be used on other zones while several
+     * zones are filled in parallel.
+     * @return CPolyLine* - a new polygon, owned by the caller.
+     */
+    CPolyLine* CreateSmoothedPoly() const;
+
+    /**
+     * Function BuildFillInputsHash
+     * computes a hash of everything the filled areas of the zone depend on: the zone
+     * outline and settings, and the board items near the zone (pads, tracks, graphic
+     * items and the outlines of the other zones).
+     * If the hash did not change since the last fill, filling the zone again would give
+     * the same filled areas.
+     * The zone and the board are not modified, so this function can be called for
+     * several zones in parallel.
+     * @param aPcb = the board of the zone
+     * @return the hash, never 0.
+     */
+    size_t BuildFillInputsHash( BOARD* aPcb ) const;
+
     /**
      * Function AddClearanceAreasPolygonsToPolysList
      * Add non copper areas polygons (pads and tracks with clearance)
@@ -466,6 +505,8 @@ public:
     void ClearFilledPolysList()
     {
         m_FilledPolysList.RemoveAllContours();
+        m_fillInputsHash = 0;
+        m_filledPolysRevision = 0;
     }
 
    /**
@@ -485,6 +526,7 @@ public:
     void AddFilledPolysList( SHAPE_POLY_SET& aPolysList )
     {
         m_FilledPolysList = aPolysList;
+        m_filledPolysRevision = 0;
     }
 
     /**
@@ -514,6 +556,7 @@ public:
     void AddFilledPolygon( SHAPE_POLY_SET& aPolygon )
     {
         m_FilledPolysList.Append( aPolygon );
+        m_filledPolysRevision = 0;
     }
 
     void AddFillSegments( std::vector< SEGMENT >& aSegments )
@@ -583,6 +626,12 @@ private:
     /** True when a zone was filled, false after deleting the filled areas. */
     bool                  m_IsFilled;
 
+    /// Hash of the fill inputs when the zone was filled, 0 if unknown.
+    size_t                m_fillInputsHash;
+
+    /// Revision of m_FilledPolysList, 0 when it was modified and needs a new one.
+    mutable unsigned      m_filledPolysRevision;
+
     ///< Width of the gap in thermal reliefs.
     int                   m_ThermalReliefGap;
 
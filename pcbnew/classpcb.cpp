@@ -164,7 +164,10 @@ static GRID_TYPE pcbGridList[] =
 
 
 PCB_SCREEN::PCB_SCREEN( const wxSize& aPageSizeIU ) :
-    BASE_SCREEN( SCREEN_T )
+    BASE_SCREEN( SCREEN_T ),
+    m_undoMemoryBudget( size_t( DEFAULT_UNDO_MEMORY_BUDGET_MB ) << 20 ),
+    m_undoMemory( 0 ),
+    m_redoMemory( 0 )
 {
     // D(wxSize displayz = wxGetDisplaySize();)
     // D(printf( "displayz x:%d y:%d lastZoomFactor: %.16g\n", displayz.x, displayz.y, pcbZoomList[DIM(pcbZoomList)-1] );)
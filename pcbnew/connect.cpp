@@ -37,9 +37,8 @@
 
 // Helper classes to handle connection points
 #include <connect.h>
-
-extern void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb );
-extern void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb, int aNetcode );
+#include <class_module.h>
+#include <connectivity_graph.h>
 
 // Local functions
 static void RebuildTrackChain( BOARD* pcb );
@@ -721,62 +720,45 @@ void CONNECTIONS::Propagate_SubNets()
     }
 }
 
-/*
- * Test all connections of the board,
- * and update subnet variable of pads and tracks
- * TestForActiveLinksInRatsnest must be called after this function
- * to update active/inactive ratsnest items status
+/**
+ * Function setSubNets
+ * copies the cluster identifiers of the connectivity graph to the subnet
+ * of pads and tracks of aNetCode, or of all nets if aNetCode < 0
  */
-void PCB_BASE_FRAME::TestConnections()
+static void setSubNets( BOARD* aPcb, int aNetCode )
 {
-    // Clear the cluster identifier for all pads
-    for( unsigned i = 0;  i< m_Pcb->GetPadCount();  ++i )
-    {
-        D_PAD* pad = m_Pcb->GetPad(i);
-
-        pad->SetZoneSubNet( 0 );
-        pad->SetSubNet( 0 );
-    }
+    CONNECTIVITY_GRAPH* connectivity = aPcb->GetConnectivity();
 
-    m_Pcb->Test_Connections_To_Copper_Areas();
-
-    // Test existing connections net by net
-    // note some nets can have no tracks, and pads intersecting
-    // so Build_CurrNet_SubNets_Connections must be called for each net
-    CONNECTIONS connections( m_Pcb );
-
-    int last_net_tested = 0;
-    int current_net_code = 0;
-
-    for( TRACK* track = m_Pcb->m_Track; track; )
+    for( MODULE* module = aPcb->m_Modules; module; module = module->Next() )
     {
-        // At this point, track is the first track of a given net
-        current_net_code = track->GetNetCode();
-
-        // Get last track of the current net
-        TRACK* lastTrack = track->GetEndNetCode( current_net_code );
-
-        if( current_net_code > 0 )  // do not spend time if net code = 0 ( dummy net )
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
         {
-            // Test all previous nets having no tracks
-            for( int net = last_net_tested+1; net < current_net_code; net++ )
-                connections.Build_CurrNet_SubNets_Connections( NULL, NULL, net );
-
-            connections.Build_CurrNet_SubNets_Connections( track, lastTrack, current_net_code );
-            last_net_tested = current_net_code;
+            if( aNetCode < 0 || pad->GetNetCode() == aNetCode )
+                pad->SetSubNet( connectivity->GetClusterId( pad ) );
         }
+    }
 
-        track = lastTrack->Next();    // this is now the first track of the next net
+    for( TRACK* track = aPcb->m_Track; track; track = track->Next() )
+    {
+        if( aNetCode < 0 || track->GetNetCode() == aNetCode )
+            track->SetSubNet( connectivity->GetClusterId( track ) );
     }
+}
 
-    // Test last nets without tracks, if any
-    int netsCount = m_Pcb->GetNetCount();
-    for( int net = last_net_tested+1; net < netsCount; net++ )
-        connections.Build_CurrNet_SubNets_Connections( NULL, NULL, net );
 
-    Merge_SubNets_Connected_By_CopperAreas( m_Pcb );
+/*
+ * Test all connections of the board,
+ * and update subnet variable of pads and tracks
+ * TestForActiveLinksInRatsnest must be called after this function
+ * to update active/inactive ratsnest items status
+ */
+void PCB_BASE_FRAME::TestConnections()
+{
+    // The connectivity graph only recomputes the nets modified since the last call,
+    // and already merges the clusters connected by copper areas
+    m_Pcb->Test_Connections_To_Copper_Areas();
 
-    return;
+    setSubNets( m_Pcb, -1 );
 }
 
 
@@ -789,36 +771,9 @@ void PCB_BASE_FRAME::TestNetConnection( wxDC* aDC, int aNetCode )
     if( (m_Pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
         Compile_Ratsnest( aDC, true );
 
-    // Clear the cluster identifier (subnet) of pads for this net
-    // Pads are grouped by netcode (and in netname alphabetic order)
-    for( unsigned i = 0; i < m_Pcb->GetPadCount(); ++i )
-    {
-        D_PAD* pad = m_Pcb->GetPad(i);
-
-        if( m_Pcb->GetPad(i)->GetNetCode() == aNetCode )
-            pad->SetSubNet( 0 );
-    }
-
     m_Pcb->Test_Connections_To_Copper_Areas( aNetCode );
 
-    // Search for the first and the last segment relative to the given net code
-    if( m_Pcb->m_Track )
-    {
-        CONNECTIONS connections( m_Pcb );
-
-        TRACK* lastTrack = NULL;
-        TRACK* firstTrack = m_Pcb->m_Track.GetFirst()->GetStartNetCode( aNetCode );
-
-        if( firstTrack )
-            lastTrack = firstTrack->GetEndNetCode( aNetCode );
-
-        if( firstTrack && lastTrack ) // i.e. if there are segments
-        {
-            connections.Build_CurrNet_SubNets_Connections( firstTrack, lastTrack, aNetCode );
-        }
-    }
-
-    Merge_SubNets_Connected_By_CopperAreas( m_Pcb, aNetCode );
+    setSubNets( m_Pcb, aNetCode );
 
     // rebuild the active ratsnest for this net
     DrawGeneralRatsnest( aDC, aNetCode );
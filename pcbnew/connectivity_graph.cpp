@@ -0,0 +1,807 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file connectivity_graph.cpp
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <geometry/rtree.h>
+
+#include <connectivity_graph.h>
+
+
+/// Above this number of items added to a net, the net is rebuilt rather than updated
+static const unsigned MAX_INCREMENTAL_ADDS = 8;
+
+
+/**
+ * Struct NODE_COLLECTOR
+ * is the RTree visitor used to gather the nodes found by a query.
+ */
+struct NODE_COLLECTOR
+{
+    std::vector<int>& m_result;
+
+    NODE_COLLECTOR( std::vector<int>& aResult ) :
+        m_result( aResult )
+    {
+    }
+
+    bool operator()( int aIndex )
+    {
+        m_result.push_back( aIndex );
+        return true;
+    }
+};
+
+
+static void hashPoint( size_t& aSeed, const wxPoint& aPoint )
+{
+    boost::hash_combine( aSeed, aPoint.x );
+    boost::hash_combine( aSeed, aPoint.y );
+}
+
+
+static bool pointsConnected( const wxPoint& aPoint, const wxPoint& aOther, int aMaxDist )
+{
+    int64_t dx = aPoint.x - aOther.x;
+    int64_t dy = aPoint.y - aOther.y;
+
+    return dx * dx + dy * dy <= (int64_t) aMaxDist * aMaxDist;
+}
+
+
+/**
+ * Function anchors
+ * gives the points of a pad, track or via that connect it to a zone.
+ * @return the number of points (1 or 2).
+ */
+static int anchors( const BOARD_CONNECTED_ITEM* aItem, wxPoint aPoints[2] )
+{
+    if( aItem->Type() == PCB_PAD_T )
+    {
+        // Zones are connected to the center of the pad shape (see thermal reliefs)
+        aPoints[0] = static_cast<const D_PAD*>( aItem )->ShapePos();
+        return 1;
+    }
+
+    const TRACK* track = static_cast<const TRACK*>( aItem );
+
+    aPoints[0] = track->GetStart();
+
+    if( track->Type() == PCB_VIA_T || track->GetStart() == track->GetEnd() )
+        return 1;
+
+    aPoints[1] = track->GetEnd();
+    return 2;
+}
+
+
+/**
+ * Function itemBoundingBox
+ * @return the area of a pad, track or via that may touch a connected item.
+ */
+static EDA_RECT itemBoundingBox( const BOARD_CONNECTED_ITEM* aItem )
+{
+    EDA_RECT bbox;
+
+    if( aItem->Type() == PCB_PAD_T )
+    {
+        // The pad shape may be offset from the pad position
+        const D_PAD* pad = static_cast<const D_PAD*>( aItem );
+
+        bbox = EDA_RECT( pad->ShapePos(), wxSize( 0, 0 ) );
+        bbox.Inflate( pad->GetBoundingRadius() + 1 );
+        bbox.Merge( pad->GetPosition() );
+    }
+    else
+    {
+        const TRACK* track = static_cast<const TRACK*>( aItem );
+
+        bbox = EDA_RECT( track->GetStart(), wxSize( 0, 0 ) );
+
+        if( track->Type() != PCB_VIA_T )
+            bbox.Merge( track->GetEnd() );
+
+        bbox.Inflate( ( track->GetWidth() + 1 ) / 2 );
+    }
+
+    return bbox;
+}
+
+
+CONNECTIVITY_GRAPH::CONNECTIVITY_GRAPH( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_syncPass( 0 )
+{
+}
+
+
+void CONNECTIVITY_GRAPH::Add( BOARD_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+        for( D_PAD* pad = static_cast<MODULE*>( aItem )->Pads(); pad; pad = pad->Next() )
+            syncItem( pad );
+
+        break;
+
+    case PCB_PAD_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+    case PCB_ZONE_AREA_T:
+        syncItem( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+void CONNECTIVITY_GRAPH::Remove( BOARD_ITEM* aItem )
+{
+    m_modified.erase( aItem );
+
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+        for( D_PAD* pad = static_cast<MODULE*>( aItem )->Pads(); pad; pad = pad->Next() )
+            removeItem( pad );
+
+        break;
+
+    case PCB_PAD_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+    case PCB_ZONE_AREA_T:
+        removeItem( static_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
+        break;
+
+    default:
+        break;
+    }
+}
+
+
+void CONNECTIVITY_GRAPH::Update( BOARD_ITEM* aItem )
+{
+    // Add() compares the item with the recorded one, and updates it if it has changed
+    Add( aItem );
+}
+
+
+void CONNECTIVITY_GRAPH::MarkModified( BOARD_ITEM* aItem )
+{
+    // Taking the item out now also forgets the pads a module may lose in the edit
+    Remove( aItem );
+    m_modified.insert( aItem );
+}
+
+
+void CONNECTIVITY_GRAPH::UpdateModified()
+{
+    if( m_modified.empty() )
+        return;
+
+    for( boost::unordered_set<BOARD_ITEM*>::const_iterator it = m_modified.begin();
+         it != m_modified.end(); ++it )
+    {
+        Add( *it );
+    }
+
+    m_modified.clear();
+}
+
+
+void CONNECTIVITY_GRAPH::Synchronize()
+{
+    ++m_syncPass;
+
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            syncItem( pad );
+    }
+
+    for( TRACK* track = m_board->m_Track; track; track = track->Next() )
+        syncItem( track );
+
+    for( int ii = 0; ii < m_board->GetAreaCount(); ++ii )
+        syncItem( m_board->GetArea( ii ) );
+
+    // The items not found are no longer on the board, and may have been deleted
+    std::vector<const BOARD_CONNECTED_ITEM*> removed;
+
+    for( ITEM_MAP::const_iterator it = m_itemStates.begin(); it != m_itemStates.end(); ++it )
+    {
+        if( it->second.m_seen != m_syncPass )
+            removed.push_back( it->first );
+    }
+
+    for( unsigned ii = 0; ii < removed.size(); ++ii )
+        removeItem( removed[ii] );
+}
+
+
+int CONNECTIVITY_GRAPH::GetClusterId( const BOARD_CONNECTED_ITEM* aItem )
+{
+    NET* net;
+    int  node = findNode( aItem, &net );
+
+    return node < 0 ? 0 : net->m_clusterIds[node];
+}
+
+
+int CONNECTIVITY_GRAPH::GetClusterCount( int aNetCode )
+{
+    UpdateModified();
+
+    if( aNetCode <= 0 || aNetCode >= (int) m_nets.size() )
+        return 0;
+
+    updateNet( aNetCode );
+
+    return m_nets[aNetCode].m_clusterCount;
+}
+
+
+bool CONNECTIVITY_GRAPH::IsConnectedToZone( const BOARD_CONNECTED_ITEM* aItem )
+{
+    NET* net;
+    int  node = findNode( aItem, &net );
+
+    if( node < 0 )
+        return false;
+
+    int id = net->m_clusterIds[node];
+
+    return id > 0 && net->m_zoneClusters[id];
+}
+
+
+bool CONNECTIVITY_GRAPH::AreConnected( const BOARD_CONNECTED_ITEM* aItem,
+                                       const BOARD_CONNECTED_ITEM* aOther )
+{
+    NET* net;
+    NET* otherNet;
+    int  node = findNode( aItem, &net );
+    int  other = findNode( aOther, &otherNet );
+
+    if( node < 0 || other < 0 || net != otherNet )
+        return false;
+
+    return findRoot( *net, node ) == findRoot( *net, other );
+}
+
+
+void CONNECTIVITY_GRAPH::syncItem( BOARD_CONNECTED_ITEM* aItem )
+{
+    ITEM_MAP::iterator it = m_itemStates.find( aItem );
+
+    if( !isTracked( aItem ) )
+    {
+        if( it != m_itemStates.end() )
+            removeItem( aItem );
+
+        return;
+    }
+
+    if( it == m_itemStates.end() )
+    {
+        addItem( aItem );
+        return;
+    }
+
+    ITEM_STATE& state = it->second;
+
+    state.m_seen = m_syncPass;
+
+    if( state.m_netCode != aItem->GetNetCode() || state.m_signature != signature( aItem ) )
+    {
+        removeItem( aItem );
+        addItem( aItem );
+    }
+}
+
+
+void CONNECTIVITY_GRAPH::addItem( BOARD_CONNECTED_ITEM* aItem )
+{
+    NET&       net = getNet( aItem->GetNetCode() );
+    ITEM_STATE state;
+
+    state.m_netCode   = aItem->GetNetCode();
+    state.m_signature = signature( aItem );
+    state.m_node      = -1;
+    state.m_seen      = m_syncPass;
+
+    m_itemStates[aItem] = state;
+    net.m_items.insert( aItem );
+    net.m_clustersValid = false;
+
+    // Zones have several nodes, and are rarely added: the net is rebuilt for them
+    if( aItem->Type() == PCB_ZONE_AREA_T )
+    {
+        net.m_dirty = true;
+        net.m_pending.clear();
+    }
+    else if( !net.m_dirty )
+    {
+        net.m_pending.push_back( aItem );
+    }
+}
+
+
+void CONNECTIVITY_GRAPH::removeItem( const BOARD_CONNECTED_ITEM* aItem )
+{
+    ITEM_MAP::iterator it = m_itemStates.find( aItem );
+
+    if( it == m_itemStates.end() )
+        return;
+
+    NET& net = m_nets[it->second.m_netCode];
+
+    // Union-find cannot split a cluster: the net is rebuilt when it is next queried
+    net.m_items.erase( const_cast<BOARD_CONNECTED_ITEM*>( aItem ) );
+    net.m_pending.clear();
+    net.m_dirty = true;
+    net.m_clustersValid = false;
+
+    m_itemStates.erase( it );
+}
+
+
+CONNECTIVITY_GRAPH::NET& CONNECTIVITY_GRAPH::getNet( int aNetCode )
+{
+    if( aNetCode >= (int) m_nets.size() )
+        m_nets.resize( aNetCode + 1 );
+
+    return m_nets[aNetCode];
+}
+
+
+void CONNECTIVITY_GRAPH::updateNet( int aNetCode )
+{
+    NET& net = m_nets[aNetCode];
+
+    if( net.m_dirty || net.m_pending.size() > MAX_INCREMENTAL_ADDS )
+    {
+        rebuildNet( net );
+    }
+    else
+    {
+        for( unsigned ii = 0; ii < net.m_pending.size(); ++ii )
+            addNodes( net, net.m_pending[ii] );
+    }
+
+    net.m_pending.clear();
+    net.m_dirty = false;
+
+    if( !net.m_clustersValid )
+        computeClusters( net );
+}
+
+
+void CONNECTIVITY_GRAPH::rebuildNet( NET& aNet )
+{
+    aNet.m_nodes.clear();
+
+    for( boost::unordered_set<BOARD_CONNECTED_ITEM*>::const_iterator it = aNet.m_items.begin();
+         it != aNet.m_items.end(); ++it )
+    {
+        BOARD_CONNECTED_ITEM* item = *it;
+        ITEM_STATE&           state = m_itemStates[item];
+
+        state.m_node = -1;
+
+        if( item->Type() == PCB_ZONE_AREA_T )
+        {
+            const SHAPE_POLY_SET& polys = static_cast<ZONE_CONTAINER*>( item )->GetFilledPolysList();
+
+            for( int outline = 0; outline < polys.OutlineCount(); ++outline )
+            {
+                const BOX2I bbox = polys.COutline( outline ).BBox();
+                NODE        node;
+
+                node.m_item    = item;
+                node.m_outline = outline;
+                node.m_bbox    = EDA_RECT( wxPoint( bbox.GetX(), bbox.GetY() ),
+                                           wxSize( bbox.GetWidth(), bbox.GetHeight() ) );
+
+                if( outline == 0 )
+                    state.m_node = aNet.m_nodes.size();
+
+                aNet.m_nodes.push_back( node );
+            }
+        }
+        else
+        {
+            NODE node;
+
+            node.m_item    = item;
+            node.m_outline = -1;
+            node.m_bbox    = itemBoundingBox( item );
+
+            state.m_node = aNet.m_nodes.size();
+            aNet.m_nodes.push_back( node );
+        }
+    }
+
+    int count = aNet.m_nodes.size();
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        aNet.m_nodes[ii].m_parent = ii;
+        aNet.m_nodes[ii].m_rank   = 0;
+    }
+
+    // Index the nodes at once, and look for the neighbours of each node
+    std::vector<int> mmin( count * 2 );
+    std::vector<int> mmax( count * 2 );
+    std::vector<int> indices( count );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        const EDA_RECT& bbox = aNet.m_nodes[ii].m_bbox;
+
+        mmin[2 * ii]     = bbox.GetX();
+        mmin[2 * ii + 1] = bbox.GetY();
+        mmax[2 * ii]     = bbox.GetRight();
+        mmax[2 * ii + 1] = bbox.GetBottom();
+        indices[ii]      = ii;
+    }
+
+    RTree<int, int, 2, float> tree;
+    std::vector<int>          candidates;
+    NODE_COLLECTOR            collector( candidates );
+
+    if( count > 0 )
+        tree.BulkLoad( count, &mmin[0], &mmax[0], &indices[0] );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        candidates.clear();
+        tree.Search( &mmin[2 * ii], &mmax[2 * ii], collector );
+
+        for( unsigned jj = 0; jj < candidates.size(); ++jj )
+        {
+            int other = candidates[jj];
+
+            // Each pair is found twice
+            if( other <= ii )
+                continue;
+
+            if( nodesConnected( aNet.m_nodes[ii], aNet.m_nodes[other] ) )
+                unite( aNet, ii, other );
+        }
+    }
+
+    aNet.m_clustersValid = false;
+}
+
+
+void CONNECTIVITY_GRAPH::addNodes( NET& aNet, BOARD_CONNECTED_ITEM* aItem )
+{
+    int  first = aNet.m_nodes.size();
+    NODE node;
+
+    node.m_item    = aItem;
+    node.m_outline = -1;
+    node.m_bbox    = itemBoundingBox( aItem );
+    node.m_parent  = first;
+    node.m_rank    = 0;
+
+    aNet.m_nodes.push_back( node );
+    m_itemStates[aItem].m_node = first;
+
+    for( int ii = 0; ii < first; ++ii )
+    {
+        if( aNet.m_nodes[ii].m_bbox.Intersects( node.m_bbox )
+            && nodesConnected( aNet.m_nodes[ii], node ) )
+        {
+            unite( aNet, ii, first );
+        }
+    }
+}
+
+
+void CONNECTIVITY_GRAPH::computeClusters( NET& aNet )
+{
+    int count = aNet.m_nodes.size();
+
+    std::vector<int>  sizes( count, 0 );
+    std::vector<int>  rootIds( count, 0 );
+    std::vector<bool> hasPad( count, false );
+    std::vector<bool> hasZone( count, false );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        int root = findRoot( aNet, ii );
+
+        ++sizes[root];
+
+        if( aNet.m_nodes[ii].m_outline >= 0 )
+            hasZone[root] = true;
+        else if( aNet.m_nodes[ii].m_item->Type() == PCB_PAD_T )
+            hasPad[root] = true;
+    }
+
+    aNet.m_clusterIds.assign( count, 0 );
+    aNet.m_zoneClusters.assign( 1, false );
+    aNet.m_clusterCount = 0;
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        int root = findRoot( aNet, ii );
+
+        if( root == ii && hasPad[root] )
+            ++aNet.m_clusterCount;
+
+        // Items connected to nothing have no cluster
+        if( sizes[root] < 2 )
+            continue;
+
+        if( rootIds[root] == 0 )
+        {
+            rootIds[root] = aNet.m_zoneClusters.size();
+            aNet.m_zoneClusters.push_back( hasZone[root] );
+        }
+
+        aNet.m_clusterIds[ii] = rootIds[root];
+    }
+
+    aNet.m_clustersValid = true;
+}
+
+
+int CONNECTIVITY_GRAPH::findRoot( NET& aNet, int aNode )
+{
+    int root = aNode;
+
+    while( aNet.m_nodes[root].m_parent != root )
+        root = aNet.m_nodes[root].m_parent;
+
+    // Path compression
+    while( aNet.m_nodes[aNode].m_parent != root )
+    {
+        int next = aNet.m_nodes[aNode].m_parent;
+        aNet.m_nodes[aNode].m_parent = root;
+        aNode = next;
+    }
+
+    return root;
+}
+
+
+void CONNECTIVITY_GRAPH::unite( NET& aNet, int aNode, int aOther )
+{
+    int root = findRoot( aNet, aNode );
+    int otherRoot = findRoot( aNet, aOther );
+
+    if( root == otherRoot )
+        return;
+
+    if( aNet.m_nodes[root].m_rank < aNet.m_nodes[otherRoot].m_rank )
+        std::swap( root, otherRoot );
+
+    aNet.m_nodes[otherRoot].m_parent = root;
+
+    if( aNet.m_nodes[root].m_rank == aNet.m_nodes[otherRoot].m_rank )
+        ++aNet.m_nodes[root].m_rank;
+}
+
+
+int CONNECTIVITY_GRAPH::findNode( const BOARD_CONNECTED_ITEM* aItem, NET** aNet )
+{
+    UpdateModified();
+
+    ITEM_MAP::iterator it = m_itemStates.find( aItem );
+
+    if( it == m_itemStates.end() )
+        return -1;
+
+    updateNet( it->second.m_netCode );
+    *aNet = &m_nets[it->second.m_netCode];
+
+    return it->second.m_node;
+}
+
+
+bool CONNECTIVITY_GRAPH::isTracked( const BOARD_CONNECTED_ITEM* aItem )
+{
+    if( aItem->GetNetCode() <= 0 )
+        return false;
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+        return true;
+
+    case PCB_ZONE_AREA_T:
+        return static_cast<const ZONE_CONTAINER*>( aItem )->IsOnCopperLayer();
+
+    default:
+        return false;
+    }
+}
+
+
+size_t CONNECTIVITY_GRAPH::signature( const BOARD_CONNECTED_ITEM* aItem )
+{
+    size_t seed = 0;
+
+    boost::hash_combine( seed, aItem->GetNetCode() );
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( aItem );
+
+        hashPoint( seed, pad->GetPosition() );
+        hashPoint( seed, pad->ShapePos() );
+        hashPoint( seed, wxPoint( pad->GetSize().x, pad->GetSize().y ) );
+        hashPoint( seed, wxPoint( pad->GetDelta().x, pad->GetDelta().y ) );
+        boost::hash_combine( seed, pad->GetOrientation() );
+        boost::hash_combine( seed, (int) pad->GetShape() );
+
+        for( LSEQ seq = pad->GetLayerSet().Seq(); seq; ++seq )
+            boost::hash_combine( seed, (int) *seq );
+
+        break;
+    }
+
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+    {
+        const TRACK* track = static_cast<const TRACK*>( aItem );
+
+        hashPoint( seed, track->GetStart() );
+        hashPoint( seed, track->GetEnd() );
+        boost::hash_combine( seed, track->GetWidth() );
+
+        for( LSEQ seq = track->GetLayerSet().Seq(); seq; ++seq )
+            boost::hash_combine( seed, (int) *seq );
+
+        break;
+    }
+
+    case PCB_ZONE_AREA_T:
+    {
+        const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( aItem );
+
+        // The revision stands for the filled areas, hashing their vertices would make
+        // each Synchronize() as slow as a full rebuild on boards with large pours.
+        boost::hash_combine( seed, (int) zone->GetLayer() );
+        boost::hash_combine( seed, zone->GetFilledPolysRevision() );
+
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    return seed;
+}
+
+
+bool CONNECTIVITY_GRAPH::nodesConnected( const NODE& aNode, const NODE& aOther )
+{
+    const NODE* zoneNode = NULL;
+    const NODE* itemNode = NULL;
+
+    if( aNode.m_outline >= 0 )
+    {
+        zoneNode = &aNode;
+        itemNode = &aOther;
+    }
+    else if( aOther.m_outline >= 0 )
+    {
+        zoneNode = &aOther;
+        itemNode = &aNode;
+    }
+
+    if( zoneNode )
+    {
+        // Zones are only connected together through other items
+        if( itemNode->m_outline >= 0 )
+            return false;
+
+        const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( zoneNode->m_item );
+
+        if( !itemNode->m_item->IsOnLayer( zone->GetLayer() ) )
+            return false;
+
+        wxPoint points[2];
+        int     count = anchors( itemNode->m_item, points );
+
+        for( int ii = 0; ii < count; ++ii )
+        {
+            if( zone->GetFilledPolysList().Contains( VECTOR2I( points[ii].x, points[ii].y ),
+                                                     zoneNode->m_outline ) )
+                return true;
+        }
+
+        return false;
+    }
+
+    const BOARD_CONNECTED_ITEM* item = aNode.m_item;
+    const BOARD_CONNECTED_ITEM* other = aOther.m_item;
+
+    if( !( item->GetLayerSet() & other->GetLayerSet() ).any() )
+        return false;
+
+    if( item->Type() != PCB_PAD_T && other->Type() == PCB_PAD_T )
+        std::swap( item, other );
+
+    if( item->Type() == PCB_PAD_T )
+    {
+        const D_PAD* pad = static_cast<const D_PAD*>( item );
+
+        if( other->Type() == PCB_PAD_T )
+        {
+            // Intersecting pads
+            const D_PAD* otherPad = static_cast<const D_PAD*>( other );
+
+            return pad->HitTest( otherPad->GetPosition() ) || otherPad->HitTest( pad->GetPosition() );
+        }
+
+        // A track end inside the pad
+        const TRACK* track = static_cast<const TRACK*>( other );
+
+        return pad->HitTest( track->GetStart() )
+            || ( track->Type() != PCB_VIA_T && pad->HitTest( track->GetEnd() ) );
+    }
+
+    // Track ends closer than half the width of one of the tracks
+    const TRACK* track = static_cast<const TRACK*>( item );
+    const TRACK* otherTrack = static_cast<const TRACK*>( other );
+    int          maxDist = std::max( track->GetWidth(), otherTrack->GetWidth() ) / 2;
+    wxPoint      points[2], otherPoints[2];
+    int          count = anchors( track, points );
+    int          otherCount = anchors( otherTrack, otherPoints );
+
+    for( int ii = 0; ii < count; ++ii )
+    {
+        for( int jj = 0; jj < otherCount; ++jj )
+        {
+            if( pointsConnected( points[ii], otherPoints[jj], maxDist ) )
+                return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,209 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file connectivity_graph.h
+ * @brief Clusters of connected copper items, updated incrementally with the board.
+ */
+
+#ifndef CONNECTIVITY_GRAPH_H
+#define CONNECTIVITY_GRAPH_H
+
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include <class_eda_rect.h>
+
+class BOARD;
+class BOARD_ITEM;
+class BOARD_CONNECTED_ITEM;
+
+
+/**
+ * Class CONNECTIVITY_GRAPH
+ * groups the pads, tracks, vias and filled zones of each net of a BOARD into clusters of
+ * items connected by copper, using the same rules as the CONNECTIONS class:
+ * - a track end connects to the track ends closer than half the track width,
+ * - a track end inside a pad connects to the pad, and intersecting pads are connected,
+ * - an item having an anchor (pad shape position, via, track end) inside a filled area of a
+ *   zone is connected to this filled area.  Each filled area of a zone is a separate node.
+ *
+ * Clusters are kept per net in a union-find structure.  Adding an item to a net only unites
+ * the item with the clusters it touches; removing or modifying an item rebuilds the clusters
+ * of its net only, the next time the net is queried.
+ *
+ * The BOARD reports the items added and removed by BOARD::Add() and BOARD::Remove().  Items
+ * modified in place are reported by the undo/redo code: the edit commands give them to
+ * MarkModified() when they are saved in the undo list, and they are put back in the graph
+ * with their new geometry by the next query.  Undo and redo use Remove(), Add() and Update().
+ * Edits made without any notification (board loading by the import plugins, netlist
+ * reading) are found by Synchronize(), which compares the geometry of all the board items
+ * with the one recorded when they were added.
+ * Item pointers recorded for a removed item are never dereferenced.
+ */
+class CONNECTIVITY_GRAPH
+{
+public:
+    CONNECTIVITY_GRAPH( BOARD* aBoard );
+
+    /**
+     * Function Add
+     * records a connected item, or the pads of a module.  Other items are ignored.
+     */
+    void Add( BOARD_ITEM* aItem );
+
+    /**
+     * Function Remove
+     * forgets a connected item, or the pads of a module.
+     */
+    void Remove( BOARD_ITEM* aItem );
+
+    /**
+     * Function Update
+     * must be called when an item was modified (moved, resized, net changed, zone refilled).
+     */
+    void Update( BOARD_ITEM* aItem );
+
+    /**
+     * Function MarkModified
+     * must be called when aItem is modified in place: it is taken out of the graph until
+     * UpdateModified() is called, explicitly or by the next query, so the graph must not be
+     * queried while the edit is in progress.  The item must not be deleted in between,
+     * unless it is removed by Remove().
+     */
+    void MarkModified( BOARD_ITEM* aItem );
+
+    /**
+     * Function UpdateModified
+     * puts back in the graph the items given to MarkModified(), with their new geometry.
+     * Only the nets of these items are recomputed.
+     */
+    void UpdateModified();
+
+    /**
+     * Function Synchronize
+     * compares the graph with the board items, and updates the graph for the items added,
+     * removed or modified without notification.  Only the nets of these items are
+     * recomputed, but every item of the board is visited.
+     */
+    void Synchronize();
+
+    /**
+     * Function GetClusterId
+     * @return the identifier (1 to n, unique inside the net) of the cluster holding aItem,
+     * or 0 if aItem is not connected to any other item of its net, or unknown.
+     * The identifier of a zone is the one of its first filled area.
+     */
+    int GetClusterId( const BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function GetClusterCount
+     * @return the number of clusters of aNetCode holding at least one pad, i.e. 1 when all
+     * the pads of the net are connected.
+     */
+    int GetClusterCount( int aNetCode );
+
+    /**
+     * Function IsConnectedToZone
+     * @return true if aItem is connected to a filled area of a zone of its net, directly
+     * or through other items.
+     */
+    bool IsConnectedToZone( const BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function AreConnected
+     * @return true if aItem and aOther belong to the same net and are connected by copper.
+     */
+    bool AreConnected( const BOARD_CONNECTED_ITEM* aItem, const BOARD_CONNECTED_ITEM* aOther );
+
+private:
+    /// A pad, track, via, or filled area of a zone
+    struct NODE
+    {
+        BOARD_CONNECTED_ITEM*   m_item;
+        int                     m_outline;      ///< filled area index for zones, else -1
+        EDA_RECT                m_bbox;
+        int                     m_parent;       ///< union-find parent node
+        int                     m_rank;
+    };
+
+    struct NET
+    {
+        NET() : m_dirty( false ), m_clustersValid( true ), m_clusterCount( 0 ) {}
+
+        boost::unordered_set<BOARD_CONNECTED_ITEM*> m_items;
+        std::vector<BOARD_CONNECTED_ITEM*>          m_pending;  ///< added since the last update
+        std::vector<NODE>                           m_nodes;
+        std::vector<int>                            m_clusterIds;   ///< per node
+        std::vector<bool>                           m_zoneClusters; ///< per cluster id
+        bool                                        m_dirty;    ///< nodes must be rebuilt
+        bool                                        m_clustersValid;
+        int                                         m_clusterCount;
+    };
+
+    struct ITEM_STATE
+    {
+        int         m_netCode;
+        size_t      m_signature;    ///< geometry when the item was recorded
+        int         m_node;         ///< first node of the item, -1 if not built yet
+        unsigned    m_seen;         ///< last Synchronize() pass finding the item
+    };
+
+    typedef boost::unordered_map<const BOARD_CONNECTED_ITEM*, ITEM_STATE> ITEM_MAP;
+
+    void addItem( BOARD_CONNECTED_ITEM* aItem );
+    void removeItem( const BOARD_CONNECTED_ITEM* aItem );
+    void syncItem( BOARD_CONNECTED_ITEM* aItem );
+
+    NET& getNet( int aNetCode );
+
+    /// Brings the clusters of aNetCode up to date.
+    void updateNet( int aNetCode );
+
+    /// Recreates the nodes of a net and unites all of them.
+    void rebuildNet( NET& aNet );
+
+    /// Adds the node of a pad, track or via to a net, and unites it with the connected nodes.
+    void addNodes( NET& aNet, BOARD_CONNECTED_ITEM* aItem );
+
+    void computeClusters( NET& aNet );
+
+    int findRoot( NET& aNet, int aNode );
+    void unite( NET& aNet, int aNode, int aOther );
+
+    /// @return the node of aItem, -1 if unknown.  The net of the item is brought up to date.
+    int findNode( const BOARD_CONNECTED_ITEM* aItem, NET** aNet );
+
+    static bool isTracked( const BOARD_CONNECTED_ITEM* aItem );
+    static size_t signature( const BOARD_CONNECTED_ITEM* aItem );
+    static bool nodesConnected( const NODE& aNode, const NODE& aOther );
+
+    BOARD*              m_board;
+    ITEM_MAP            m_itemStates;
+    boost::unordered_set<BOARD_ITEM*> m_modified;    ///< see MarkModified()
+    std::vector<NET>    m_nets;
+    unsigned            m_syncPass;
+};
+
+#endif  // CONNECTIVITY_GRAPH_H
@@ -183,7 +183,10 @@ void DialogEditModuleText::OnOkClick( wxCommandEvent& event )
 {
     wxString msg;
 
-    if( m_module )
+    // The board editor saves only the edited text when it is a footprint field
+    if( m_module && m_parent->IsType( FRAME_PCB ) )
+        m_parent->SaveCopyInUndoList( m_currentText, UR_CHANGED );
+    else if( m_module )
         m_parent->SaveCopyInUndoList( m_module, UR_CHANGED );
 
 #ifndef USE_WX_OVERLAY
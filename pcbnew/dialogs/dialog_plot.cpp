@@ -39,6 +39,7 @@
 #include <wx/ffile.h>
 #include <dialog_plot.h>
 #include <wx_html_report_panel.h>
+#include <plotcontroller.h>
 
 DIALOG_PLOT::DIALOG_PLOT( PCB_EDIT_FRAME* aParent ) :
     DIALOG_PLOT_BASE( aParent ), m_parent( aParent ),
@@ -762,8 +763,6 @@ void DIALOG_PLOT::Plot( wxCommandEvent& event )
     if( m_PSFineAdjustWidthOpt->IsEnabled() )
         m_plotOpts.SetWidthAdjust( m_PSWidthAdjust );
 
-    wxString file_ext( GetDefaultPlotExtension( m_plotOpts.GetFormat() ) );
-
     // Test for a reasonable scale value
     // XXX could this actually happen? isn't it constrained in the apply
     // function?
@@ -780,46 +779,11 @@ void DIALOG_PLOT::Plot( wxCommandEvent& event )
 
     wxBusyCursor dummy;
 
-    for( LSEQ seq = m_plotOpts.GetLayerSelection().UIOrder();  seq;  ++seq )
-    {
-        LAYER_ID layer = *seq;
-
-        // Pick the basename from the board file
-        wxFileName fn( boardFilename );
-
-        // Use Gerber Extensions based on layer number
-        // (See http://en.wikipedia.org/wiki/Gerber_File)
-        if( m_plotOpts.GetFormat() == PLOT_FORMAT_GERBER && m_useGerberExtensions->GetValue() )
-            file_ext = GetGerberExtension( layer );
-
-        // Create file name (from the English layer name for non copper layers).
-        BuildPlotFileName( &fn, outputDir.GetPath(),
-                           m_board->GetStandardLayerName( layer ),
-                           file_ext );
-
-        LOCALE_IO toggle;
-
-        BOARD*      board = m_parent->GetBoard();
-        PLOTTER*    plotter = StartPlotBoard( board, &m_plotOpts, layer, fn.GetFullPath(), wxEmptyString );
+    // All the selected layers are plotted at once, see PLOT_CONTROLLER::PlotLayers()
+    PLOT_CONTROLLER plotController( m_parent->GetBoard() );
 
-        // Print diags in messages box:
-        wxString msg;
-
-        if( plotter )
-        {
-            PlotOneBoardLayer( board, plotter, layer, m_plotOpts );
-            plotter->EndPlot();
-            delete plotter;
-
-            msg.Printf( _( "Plot file '%s' created." ), GetChars( fn.GetFullPath() ) );
-            reporter.Report( msg, REPORTER::RPT_ACTION );
-        }
-        else
-        {
-            msg.Printf( _( "Unable to create file '%s'." ), GetChars( fn.GetFullPath() ) );
-            reporter.Report( msg, REPORTER::RPT_ERROR );
-        }
-    }
+    plotController.GetPlotOptions() = m_plotOpts;
+    plotController.PlotLayers( m_plotOpts.GetLayerSelection(), false, &reporter );
 
     // If no layer selected, we have nothing plotted.
     // Prompt user if it happens because he could think there is a bug in Pcbnew.
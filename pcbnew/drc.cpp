@@ -28,6 +28,10 @@
  * @file drc.cpp
  */
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 #include <fctsys.h>
 #include <wxPcbStruct.h>
 #include <trigo.h>
@@ -45,6 +49,8 @@
 
 #include <pcbnew.h>
 #include <drc_stuff.h>
+#include <drc_spatial_index.h>
+#include <drc_online_state.h>
 
 #include <dialog_drc.h>
 #include <wx/progdlg.h>
@@ -99,6 +105,9 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     m_pcb = aPcbWindow->GetBoard();
     m_ui  = 0;
 
+    m_onlineIndex = NULL;
+    m_onlineIndexBoard = NULL;
+
     // establish initial values for everything:
     m_doPad2PadTest     = true;     // enable pad to pad clearance tests
     m_doUnconnectedTest = true;     // enable unconnected tests
@@ -128,6 +137,8 @@ DRC::~DRC()
     // maybe someday look at pointainer.h  <- google for "pointainer.h"
     for( unsigned i = 0; i<m_unconnected.size();  ++i )
         delete m_unconnected[i];
+
+    delete m_onlineIndex;
 }
 
 
@@ -275,6 +286,11 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 
     testTexts();
 
+    // The markers now describe the whole board: from now on, edits can be
+    // tested incrementally by RunIncrementalTests()
+    m_pcb->GetDrcState()->ClearDirty();
+    m_pcb->GetDrcState()->Enable( true );
+
     // update the m_ui listboxes
     updatePointers();
 
@@ -287,6 +303,197 @@ void DRC::RunTests( wxTextCtrl* aMessages )
 }
 
 
+void DRC::RunIncrementalTests()
+{
+    m_pcb = m_mainWindow->GetBoard();
+
+    DRC_ONLINE_STATE* state = m_pcb->GetDrcState();
+
+    if( !state->IsEnabled() || !state->HasDirtyItems() )
+        return;
+
+    // The index of the last full run only needs the modified items to be moved
+    if( !m_onlineIndex || m_onlineIndexBoard != m_pcb )
+    {
+        delete m_onlineIndex;
+        m_onlineIndex = new DRC_SPATIAL_INDEX;
+        m_onlineIndex->Build( m_pcb );
+        m_onlineIndexBoard = m_pcb;
+    }
+    else
+    {
+        m_onlineIndex->Update( m_pcb, *state );
+    }
+
+    const DRC_SPATIAL_INDEX&   index = *m_onlineIndex;
+    const std::vector<TRACK*>& tracks = index.Tracks();
+    const std::vector<D_PAD*>& pads = index.Pads();
+
+    // Areas covered by the modified items before the edit (recorded by the state),
+    // and after the edit (for the items still on the board)
+    std::vector<EDA_RECT>        areas = state->GetDirtyAreas();
+    std::vector<ZONE_CONTAINER*> dirtyZones;
+
+    for( unsigned ii = 0; ii < tracks.size(); ++ii )
+    {
+        if( state->IsDirty( tracks[ii] ) )
+            areas.push_back( DRC_SPATIAL_INDEX::TrackBoundingBox( tracks[ii] ) );
+    }
+
+    for( unsigned ii = 0; ii < pads.size(); ++ii )
+    {
+        if( state->IsDirty( pads[ii] ) || state->IsDirty( pads[ii]->GetParent() ) )
+            areas.push_back( DRC_SPATIAL_INDEX::PadBoundingBox( pads[ii] ) );
+    }
+
+    for( int ii = 0; ii < m_pcb->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = m_pcb->GetArea( ii );
+
+        if( state->IsDirty( zone ) )
+        {
+            areas.push_back( zone->GetBoundingBox() );
+            dirtyZones.push_back( zone );
+        }
+    }
+
+    // An item having a clearance problem with a modified item is closer than the biggest
+    // clearance to one of these areas, and its first reported error may have changed.
+    // Items further away keep their markers.
+    std::vector<char> retestTrack( tracks.size(), 0 );
+    std::vector<char> retestPad( pads.size(), 0 );
+    std::vector<int>  found;
+
+    for( unsigned ii = 0; ii < areas.size(); ++ii )
+    {
+        EDA_RECT area = areas[ii];
+        area.Inflate( index.GetMaxClearance() + 1 );
+
+        index.QueryTracks( area, LSET::AllCuMask(), found );
+
+        for( unsigned jj = 0; jj < found.size(); ++jj )
+            retestTrack[found[jj]] = 1;
+
+        index.QueryPads( area, LSET::AllCuMask(), found );
+
+        for( unsigned jj = 0; jj < found.size(); ++jj )
+            retestPad[found[jj]] = 1;
+    }
+
+    // Remove the markers of the modified items and of the items to test again
+    std::vector<MARKER_PCB*> oldMarkers;
+    std::vector<int>         refs;
+
+    state->TakeDirtyMarkers( oldMarkers );
+
+    for( unsigned ii = 0; ii < tracks.size(); ++ii )
+    {
+        if( retestTrack[ii] )
+        {
+            state->TakeMarkers( tracks[ii], oldMarkers );
+            refs.push_back( ii );
+        }
+    }
+
+    for( unsigned ii = 0; ii < pads.size(); ++ii )
+    {
+        if( retestPad[ii] )
+            state->TakeMarkers( pads[ii], oldMarkers );
+    }
+
+    for( unsigned ii = 0; ii < dirtyZones.size(); ++ii )
+        state->TakeMarkers( dirtyZones[ii], oldMarkers );
+
+    for( unsigned ii = 0; ii < oldMarkers.size(); ++ii )
+    {
+        m_mainWindow->GetGalCanvas()->GetView()->Remove( oldMarkers[ii] );
+        m_pcb->Remove( oldMarkers[ii] );
+        delete oldMarkers[ii];
+    }
+
+    // Track and via clearances
+    std::vector<MARKER_PCB*> markers;
+
+    testIndexedTracks( index, refs, 0, refs.size(), markers );
+
+    for( unsigned ii = 0; ii < refs.size(); ++ii )
+    {
+        if( markers[ii] )
+            addMarkerToPcb( markers[ii], tracks[refs[ii]] );
+    }
+
+    // Tracks and vias inside keepout areas
+    if( m_doKeepoutTest )
+    {
+        for( unsigned ii = 0; ii < refs.size(); ++ii )
+        {
+            TRACK* track = tracks[refs[ii]];
+
+            if( !doTrackKeepoutDrc( track ) )
+            {
+                addMarkerToPcb( m_currentMarker, track );
+                m_currentMarker = 0;
+            }
+        }
+    }
+
+    // Pad clearances.  Like for tracks, each pair is tested from the first pad
+    // in the board pad list only.
+    if( m_doPad2PadTest )
+    {
+        std::vector<D_PAD*> candidates;
+
+        for( unsigned ii = 0; ii < pads.size(); ++ii )
+        {
+            if( !retestPad[ii] )
+                continue;
+
+            D_PAD*   pad = pads[ii];
+            EDA_RECT area = DRC_SPATIAL_INDEX::PadBoundingBox( pad );
+            area.Inflate( index.GetMaxClearance() + 1 );
+
+            // A hole is tested against the pads of all copper layers
+            index.QueryPads( area, pad->GetDrillSize().x ? LSET::AllCuMask() : pad->GetLayerSet(),
+                             found );
+
+            candidates.clear();
+
+            for( unsigned jj = 0; jj < found.size(); ++jj )
+            {
+                if( found[jj] > (int) ii )
+                    candidates.push_back( pads[found[jj]] );
+            }
+
+            if( candidates.empty() )
+                continue;
+
+            if( !doPadToPadsDrc( pad, &candidates[0], &candidates[0] + candidates.size(),
+                                 INT_MAX ) )
+            {
+                addMarkerToPcb( m_currentMarker, pad );
+                m_currentMarker = 0;
+            }
+        }
+    }
+
+    // Zone outlines, for the modified zones only
+    for( unsigned ii = 0; ii < dirtyZones.size(); ++ii )
+    {
+        int markerCount = m_pcb->GetMARKERCount();
+
+        m_pcb->Test_Drc_Areas_Outlines_To_Areas_Outlines( dirtyZones[ii], true );
+
+        for( int jj = markerCount; jj < m_pcb->GetMARKERCount(); ++jj )
+            state->AddMarker( dirtyZones[ii], m_pcb->GetMARKER( jj ) );
+    }
+
+    state->ClearDirty();
+
+    // update the m_ui listboxes
+    updatePointers();
+}
+
+
 void DRC::ListUnconnectedPads()
 {
     testUnconnected();
@@ -450,6 +657,7 @@ void DRC::testPad2Pad()
         D_PAD* pad = sortedPads[i];
 
         // GetBoundingRadius() is the radius of the minimum sized circle fully containing the pad
+        // (this also initializes the cached value, before the pads are shared between threads)
         int radius = pad->GetBoundingRadius();
         if( radius > max_size )
             max_size = radius;
@@ -457,21 +665,43 @@ void DRC::testPad2Pad()
 
     // Test the pads
     D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
+    int     padCount = sortedPads.size();
 
-    for( unsigned i = 0; i< sortedPads.size(); ++i )
-    {
-        D_PAD* pad = sortedPads[i];
+    // Markers are stored by reference pad, and added to the board in the pad list order,
+    // so the result does not depend on the thread scheduling
+    std::vector<MARKER_PCB*> markers( padCount, (MARKER_PCB*) NULL );
+    int i;
 
-        int    x_limit = max_size + pad->GetClearance() +
-                         pad->GetBoundingRadius() + pad->GetPosition().x;
+#ifdef USE_OPENMP
+    #pragma omp parallel private(i)
+#endif
+    {
+        // The tests store intermediate results in DRC members, so each thread needs its own
+        DRC worker( m_mainWindow );
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic, 16)
+#endif
+        for( i = 0; i < padCount; ++i )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            D_PAD* pad = sortedPads[i];
+
+            int    x_limit = max_size + pad->GetClearance() +
+                             pad->GetBoundingRadius() + pad->GetPosition().x;
+
+            if( !worker.doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+            {
+                wxASSERT( worker.m_currentMarker );
+                markers[i] = worker.m_currentMarker;
+                worker.m_currentMarker = 0;
+            }
         }
+    }  /* end of parallel section */
+
+    for( i = 0; i < padCount; ++i )
+    {
+        if( markers[i] )
+            addMarkerToPcb( markers[i], sortedPads[i] );
     }
 }
 
@@ -481,10 +711,17 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
     wxProgressDialog * progressDialog = NULL;
     const int delta = 500;  // This is the number of tests between 2 calls to the
                             // progress bar
-    int count = 0;
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
-        count++;
 
+    // Each segment is tested only against the pads and segments found near it,
+    // on its own copper layers.  The index is kept for the online DRC.
+    if( !m_onlineIndex )
+        m_onlineIndex = new DRC_SPATIAL_INDEX;
+
+    DRC_SPATIAL_INDEX& index = *m_onlineIndex;
+    index.Build( m_pcb );
+    m_onlineIndexBoard = m_pcb;
+
+    int count = index.Tracks().size();
     int deltamax = count/delta;
 
     if( aShowProgressBar && deltamax > 3 )
@@ -496,34 +733,41 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
         progressDialog->Update( 0, wxEmptyString );
     }
 
-    int ii = 0;
-    count = 0;
+    std::vector<int> refs( count );
+
+    for( int ii = 0; ii < count; ++ii )
+        refs[ii] = ii;
 
-    for( TRACK* segm = m_pcb->m_Track; segm && segm->Next(); segm = segm->Next() )
+    std::vector<MARKER_PCB*> markers;
+    int step = 0;
+
+    // Segments are tested by batches of delta items, in parallel inside a batch.
+    // The progress bar is updated (and the abort request checked) between batches.
+    for( int first = 0; first < count; first += delta )
     {
-        if ( ii++ > delta )
-        {
-            ii = 0;
-            count++;
+        int last = std::min( first + delta, count );
 
-            if( progressDialog )
-            {
-                if( !progressDialog->Update( count, wxEmptyString ) )
-                    break;  // Aborted by user
-#ifdef __WXMAC__
-                // Work around a dialog z-order issue on OS X
-                if( count == deltamax )
-                    aActiveWindow->Raise();
-#endif
-            }
+        testIndexedTracks( index, refs, first, last, markers );
+
+        // Markers are added to the board in the track list order,
+        // so the result does not depend on the thread scheduling
+        for( int ii = first; ii < last; ++ii )
+        {
+            if( markers[ii - first] )
+                addMarkerToPcb( markers[ii - first], index.Tracks()[ii] );
         }
 
-        if( !doTrackDrc( segm, segm->Next(), true ) )
+        if( progressDialog && last < count )
         {
-            wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
-            m_currentMarker = 0;
+            step++;
+
+            if( !progressDialog->Update( step, wxEmptyString ) )
+                break;  // Aborted by user
+#ifdef __WXMAC__
+            // Work around a dialog z-order issue on OS X
+            if( step == deltamax )
+                aActiveWindow->Raise();
+#endif
         }
     }
 
@@ -532,6 +776,51 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
 }
 
 
+void DRC::testIndexedTracks( const DRC_SPATIAL_INDEX& aIndex, const std::vector<int>& aRefs,
+                             int aFirst, int aLast, std::vector<MARKER_PCB*>& aMarkers )
+{
+    aMarkers.assign( aLast - aFirst, (MARKER_PCB*) NULL );
+
+    int ii;
+
+#ifdef USE_OPENMP
+    #pragma omp parallel private(ii)
+#endif
+    {
+        // The tests store intermediate results in DRC members, so each thread needs its own
+        DRC              worker( m_mainWindow );
+        MODULE           dummymodule( m_pcb );    // Creates a dummy parent
+        D_PAD            dummypad( &dummymodule );
+        std::vector<int> candidates;
+
+        dummypad.SetLayerSet( LSET::AllCuMask() );     // Ensure the hole is on all layers
+
+#ifdef USE_OPENMP
+        #pragma omp for schedule(dynamic, 16)
+#endif
+        for( ii = aFirst; ii < aLast; ++ii )
+        {
+            if( !worker.doIndexedTrackDrc( aIndex, aRefs[ii], dummypad, candidates ) )
+            {
+                wxASSERT( worker.m_currentMarker );
+                aMarkers[ii - aFirst] = worker.m_currentMarker;
+                worker.m_currentMarker = 0;
+            }
+        }
+    }  /* end of parallel section */
+}
+
+
+void DRC::addMarkerToPcb( MARKER_PCB* aMarker, const BOARD_ITEM* aOwner )
+{
+    m_pcb->Add( aMarker );
+    m_mainWindow->GetGalCanvas()->GetView()->Add( aMarker );
+
+    if( aOwner )
+        m_pcb->GetDrcState()->AddMarker( aOwner, aMarker );
+}
+
+
 void DRC::testUnconnected()
 {
     if( (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
@@ -539,6 +828,13 @@ void DRC::testUnconnected()
         wxClientDC dc( m_mainWindow->GetCanvas() );
         m_mainWindow->Compile_Ratsnest( &dc, true );
     }
+    else
+    {
+        // The ratsnest links are up to date, but not the connections made by the last
+        // edits: the connectivity graph only recomputes the modified nets
+        m_mainWindow->TestConnections();
+        m_mainWindow->TestForActiveLinksInRatsnest( 0 );
+    }
 
     if( m_pcb->GetRatsnestsCount() == 0 )
         return;
@@ -632,8 +928,7 @@ void DRC::testKeepoutAreas()
                 {
                     m_currentMarker = fillMarker( segm, NULL,
                                                   DRCE_TRACK_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker, segm );
                     m_currentMarker = 0;
                 }
             }
@@ -649,8 +944,7 @@ void DRC::testKeepoutAreas()
                 {
                     m_currentMarker = fillMarker( segm, NULL,
                                                   DRCE_VIA_INSIDE_KEEPOUT, m_currentMarker );
-                    m_pcb->Add( m_currentMarker );
-                    m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+                    addMarkerToPcb( m_currentMarker, segm );
                     m_currentMarker = 0;
                 }
             }
@@ -37,6 +37,7 @@
 
 #include <pcbnew.h>
 #include <drc_stuff.h>
+#include <drc_spatial_index.h>
 
 #include <class_board.h>
 #include <class_module.h>
@@ -148,13 +149,91 @@ bool trapezoid2pointDRC( wxPoint aTref[4], wxPoint aPcompare, int aDist )
 
 bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
 {
-    TRACK*    track;
+    if( !doTrackSelfDrc( aRefSeg ) )
+        return false;
+
+    /******************************************/
+    /* Phase 1 : test DRC track to pads :     */
+    /******************************************/
+
+    if( testPads )
+    {
+        /* Use a dummy pad to test DRC tracks versus holes, for pads not on all copper layers
+         * but having a hole
+         * This dummy pad has the size and shape of the hole
+         * to test tracks to pad hole DRC, using checkClearanceSegmToPad test function.
+         * Therefore, this dummy pad is a circle or an oval.
+         * A pad must have a parent because some functions expect a non null parent
+         * to find the parent board, and some other data
+         */
+        MODULE  dummymodule( m_pcb );    // Creates a dummy parent
+        D_PAD   dummypad( &dummymodule );
+
+        dummypad.SetLayerSet( LSET::AllCuMask() );     // Ensure the hole is on all layers
+
+        for( unsigned ii = 0;  ii<m_pcb->GetPadCount();  ++ii )
+        {
+            if( !doTrackToPadDrc( aRefSeg, m_pcb->GetPad( ii ), dummypad ) )
+                return false;
+        }
+    }
+
+    /***********************************************/
+    /* Phase 2: test DRC with other track segments */
+    /***********************************************/
+
+    for( TRACK* track = aStart; track; track = track->Next() )
+    {
+        if( !doTrackToTrackDrc( aRefSeg, track ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+bool DRC::doIndexedTrackDrc( const DRC_SPATIAL_INDEX& aIndex, int aRefIndex,
+                             D_PAD& aDummyPad, std::vector<int>& aCandidates )
+{
+    TRACK* refSeg = aIndex.Tracks()[aRefIndex];
+
+    if( !doTrackSelfDrc( refSeg ) )
+        return false;
+
+    // Only the items closer than the biggest clearance can be in conflict with refSeg
+    EDA_RECT area = DRC_SPATIAL_INDEX::TrackBoundingBox( refSeg );
+    area.Inflate( aIndex.GetMaxClearance() + 1 );
+
+    // Candidates are sorted by index, so they are tested in the same order as
+    // doTrackDrc() does, and the same first error is reported.
+    aIndex.QueryPads( area, refSeg->GetLayerSet(), aCandidates );
+
+    for( unsigned ii = 0; ii < aCandidates.size(); ++ii )
+    {
+        if( !doTrackToPadDrc( refSeg, aIndex.Pads()[aCandidates[ii]], aDummyPad ) )
+            return false;
+    }
+
+    aIndex.QueryTracks( area, refSeg->GetLayerSet(), aCandidates );
+
+    for( unsigned ii = 0; ii < aCandidates.size(); ++ii )
+    {
+        // Pairs are tested only once, from the first segment in the board list
+        if( aCandidates[ii] <= aRefIndex )
+            continue;
+
+        if( !doTrackToTrackDrc( refSeg, aIndex.Tracks()[aCandidates[ii]] ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+bool DRC::doTrackSelfDrc( TRACK* aRefSeg )
+{
     wxPoint   delta;           // lenght on X and Y axis of segments
-    LSET layerMask;
-    int       net_code_ref;
-    wxPoint   shape_pos;
 
-    NETCLASSPTR netclass = aRefSeg->GetNetClass();
     BOARD_DESIGN_SETTINGS& dsnSettings = m_pcb->GetDesignSettings();
 
     /* In order to make some calculations more easier or faster,
@@ -165,9 +244,6 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     m_segmEnd   = delta = aRefSeg->GetEnd() - origin;
     m_segmAngle = 0;
 
-    layerMask    = aRefSeg->GetLayerSet();
-    net_code_ref = aRefSeg->GetNetCode();
-
     // Phase 0 : Test vias
     if( aRefSeg->Type() == PCB_VIA_T )
     {
@@ -252,319 +328,302 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
 
     m_segmLength = delta.x;
 
-    /******************************************/
-    /* Phase 1 : test DRC track to pads :     */
-    /******************************************/
+    return true;
+}
 
-    /* Use a dummy pad to test DRC tracks versus holes, for pads not on all copper layers
-     * but having a hole
-     * This dummy pad has the size and shape of the hole
-     * to test tracks to pad hole DRC, using checkClearanceSegmToPad test function.
-     * Therefore, this dummy pad is a circle or an oval.
-     * A pad must have a parent because some functions expect a non null parent
-     * to find the parent board, and some other data
-     */
-    MODULE  dummymodule( m_pcb );    // Creates a dummy parent
-    D_PAD   dummypad( &dummymodule );
 
-    dummypad.SetLayerSet( LSET::AllCuMask() );     // Ensure the hole is on all layers
+bool DRC::doTrackToPadDrc( TRACK* aRefSeg, D_PAD* aPad, D_PAD& aDummyPad )
+{
+    wxPoint origin = aRefSeg->GetStart();
 
-    // Compute the min distance to pads
-    if( testPads )
+    /* No problem if pads are on an other layer,
+     * But if a drill hole exists	(a pad on a single layer can have a hole!)
+     * we must test the hole
+     */
+    if( !( aPad->GetLayerSet() & aRefSeg->GetLayerSet() ).any() )
     {
-        for( unsigned ii = 0;  ii<m_pcb->GetPadCount();  ++ii )
-        {
-            D_PAD* pad = m_pcb->GetPad( ii );
-
-            /* No problem if pads are on an other layer,
-             * But if a drill hole exists	(a pad on a single layer can have a hole!)
-             * we must test the hole
-             */
-            if( !( pad->GetLayerSet() & layerMask ).any() )
-            {
-                /* We must test the pad hole. In order to use the function
-                 * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
-                 * size like the hole
-                 */
-                if( pad->GetDrillSize().x == 0 )
-                    continue;
+        /* We must test the pad hole. In order to use the function
+         * checkClearanceSegmToPad(),a pseudo pad is used, with a shape and a
+         * size like the hole
+         */
+        if( aPad->GetDrillSize().x == 0 )
+            return true;
 
-                dummypad.SetSize( pad->GetDrillSize() );
-                dummypad.SetPosition( pad->GetPosition() );
-                dummypad.SetShape( pad->GetDrillShape()  == PAD_DRILL_SHAPE_OBLONG ?
-                                   PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
-                dummypad.SetOrientation( pad->GetOrientation() );
+        aDummyPad.SetSize( aPad->GetDrillSize() );
+        aDummyPad.SetPosition( aPad->GetPosition() );
+        aDummyPad.SetShape( aPad->GetDrillShape()  == PAD_DRILL_SHAPE_OBLONG ?
+                            PAD_SHAPE_OVAL : PAD_SHAPE_CIRCLE );
+        aDummyPad.SetOrientation( aPad->GetOrientation() );
 
-                m_padToTestPos = dummypad.GetPosition() - origin;
+        m_padToTestPos = aDummyPad.GetPosition() - origin;
 
-                if( !checkClearanceSegmToPad( &dummypad, aRefSeg->GetWidth(),
-                                              netclass->GetClearance() ) )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, pad,
-                                                  DRCE_TRACK_NEAR_THROUGH_HOLE, m_currentMarker );
-                    return false;
-                }
+        if( !checkClearanceSegmToPad( &aDummyPad, aRefSeg->GetWidth(),
+                                      aRefSeg->GetNetClass()->GetClearance() ) )
+        {
+            m_currentMarker = fillMarker( aRefSeg, aPad,
+                                          DRCE_TRACK_NEAR_THROUGH_HOLE, m_currentMarker );
+            return false;
+        }
 
-                continue;
-            }
+        return true;
+    }
 
-            // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
-            // but no problem if the pad netcode is the current netcode (same net)
-            if( pad->GetNetCode()                       // the pad must be connected
-               && net_code_ref == pad->GetNetCode() )   // the pad net is the same as current net -> Ok
-                continue;
+    // The pad must be in a net (i.e pt_pad->GetNet() != 0 )
+    // but no problem if the pad netcode is the current netcode (same net)
+    if( aPad->GetNetCode()                                  // the pad must be connected
+       && aRefSeg->GetNetCode() == aPad->GetNetCode() )     // the pad net is the same as current net -> Ok
+        return true;
 
-            // DRC for the pad
-            shape_pos = pad->ShapePos();
-            m_padToTestPos = shape_pos - origin;
+    // DRC for the pad
+    m_padToTestPos = aPad->ShapePos() - origin;
 
-            if( !checkClearanceSegmToPad( pad, aRefSeg->GetWidth(), aRefSeg->GetClearance( pad ) ) )
-            {
-                m_currentMarker = fillMarker( aRefSeg, pad,
-                                              DRCE_TRACK_NEAR_PAD, m_currentMarker );
-                return false;
-            }
-        }
+    if( !checkClearanceSegmToPad( aPad, aRefSeg->GetWidth(), aRefSeg->GetClearance( aPad ) ) )
+    {
+        m_currentMarker = fillMarker( aRefSeg, aPad,
+                                      DRCE_TRACK_NEAR_PAD, m_currentMarker );
+        return false;
     }
 
-    /***********************************************/
-    /* Phase 2: test DRC with other track segments */
-    /***********************************************/
+    return true;
+}
 
-    // At this point the reference segment is the X axis
 
-    // Test the reference segment with other track segments
+bool DRC::doTrackToTrackDrc( TRACK* aRefSeg, TRACK* aTrack )
+{
+    wxPoint delta;           // lenght on X and Y axis of segments
     wxPoint segStartPoint;
     wxPoint segEndPoint;
-    for( track = aStart; track; track = track->Next() )
-    {
-        // No problem if segments have the same net code:
-        if( net_code_ref == track->GetNetCode() )
-            continue;
-
-        // No problem if segment are on different layers :
-        if( !( layerMask & track->GetLayerSet() ).any() )
-            continue;
-
-        // the minimum distance = clearance plus half the reference track
-        // width plus half the other track's width
-        int w_dist = aRefSeg->GetClearance( track );
-        w_dist += (aRefSeg->GetWidth() + track->GetWidth()) / 2;
 
-        // If the reference segment is a via, we test it here
-        if( aRefSeg->Type() == PCB_VIA_T )
-        {
-            delta = track->GetEnd() - track->GetStart();
-            segStartPoint = aRefSeg->GetStart() - track->GetStart();
+    // At this point the reference segment is the X axis
+    wxPoint origin = aRefSeg->GetStart();
+    TRACK*  track  = aTrack;
 
-            if( track->Type() == PCB_VIA_T )
-            {
-                // Test distance between two vias, i.e. two circles, trivial case
-                if( EuclideanNorm( segStartPoint ) < w_dist )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_VIA_NEAR_VIA, m_currentMarker );
-                    return false;
-                }
-            }
-            else    // test via to segment
-            {
-                // Compute l'angle du segment a tester;
-                double angle = ArcTangente( delta.y, delta.x );
+    // No problem if segments have the same net code:
+    if( aRefSeg->GetNetCode() == track->GetNetCode() )
+        return true;
 
-                // Compute new coordinates ( the segment become horizontal)
-                RotatePoint( &delta, angle );
-                RotatePoint( &segStartPoint, angle );
+    // No problem if segment are on different layers :
+    if( !( aRefSeg->GetLayerSet() & track->GetLayerSet() ).any() )
+        return true;
 
-                if( !checkMarginToCircle( segStartPoint, w_dist, delta.x ) )
-                {
-                    m_currentMarker = fillMarker( track, aRefSeg,
-                                                  DRCE_VIA_NEAR_TRACK, m_currentMarker );
-                    return false;
-                }
-            }
+    // the minimum distance = clearance plus half the reference track
+    // width plus half the other track's width
+    int w_dist = aRefSeg->GetClearance( track );
+    w_dist += (aRefSeg->GetWidth() + track->GetWidth()) / 2;
 
-            continue;
-        }
+    // If the reference segment is a via, we test it here
+    if( aRefSeg->Type() == PCB_VIA_T )
+    {
+        delta = track->GetEnd() - track->GetStart();
+        segStartPoint = aRefSeg->GetStart() - track->GetStart();
 
-        /* We compute segStartPoint, segEndPoint = starting and ending point coordinates for
-         * the segment to test in the new axis : the new X axis is the
-         * reference segment.  We must translate and rotate the segment to test
-         */
-        segStartPoint = track->GetStart() - origin;
-        segEndPoint   = track->GetEnd() - origin;
-        RotatePoint( &segStartPoint, m_segmAngle );
-        RotatePoint( &segEndPoint, m_segmAngle );
         if( track->Type() == PCB_VIA_T )
         {
-            if( checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
-                continue;
-
-            m_currentMarker = fillMarker( aRefSeg, track,
-                                          DRCE_TRACK_NEAR_VIA, m_currentMarker );
-            return false;
+            // Test distance between two vias, i.e. two circles, trivial case
+            if( EuclideanNorm( segStartPoint ) < w_dist )
+            {
+                m_currentMarker = fillMarker( aRefSeg, track,
+                                              DRCE_VIA_NEAR_VIA, m_currentMarker );
+                return false;
+            }
         }
-
-        /*	We have changed axis:
-         *  the reference segment is Horizontal.
-         *  3 cases : the segment to test can be parallel, perpendicular or have an other direction
-         */
-        if( segStartPoint.y == segEndPoint.y ) // parallel segments
+        else    // test via to segment
         {
-            if( abs( segStartPoint.y ) >= w_dist )
-                continue;
+            // Compute l'angle du segment a tester;
+            double angle = ArcTangente( delta.y, delta.x );
 
-            // Ensure segStartPoint.x <= segEndPoint.x
-            if( segStartPoint.x > segEndPoint.x )
-                std::swap( segStartPoint.x, segEndPoint.x );
+            // Compute new coordinates ( the segment become horizontal)
+            RotatePoint( &delta, angle );
+            RotatePoint( &segStartPoint, angle );
 
-            if( segStartPoint.x > (-w_dist) && segStartPoint.x < (m_segmLength + w_dist) )    /* possible error drc */
+            if( !checkMarginToCircle( segStartPoint, w_dist, delta.x ) )
             {
-                // the start point is inside the reference range
-                //      X........
-                //    O--REF--+
+                m_currentMarker = fillMarker( track, aRefSeg,
+                                              DRCE_VIA_NEAR_TRACK, m_currentMarker );
+                return false;
+            }
+        }
 
-                // Fine test : we consider the rounded shape of each end of the track segment:
-                if( segStartPoint.x >= 0 && segStartPoint.x <= m_segmLength )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS1, m_currentMarker );
-                    return false;
-                }
+        return true;
+    }
 
-                if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS2, m_currentMarker );
-                    return false;
-                }
-            }
+    /* We compute segStartPoint, segEndPoint = starting and ending point coordinates for
+     * the segment to test in the new axis : the new X axis is the
+     * reference segment.  We must translate and rotate the segment to test
+     */
+    segStartPoint = track->GetStart() - origin;
+    segEndPoint   = track->GetEnd() - origin;
+    RotatePoint( &segStartPoint, m_segmAngle );
+    RotatePoint( &segEndPoint, m_segmAngle );
+    if( track->Type() == PCB_VIA_T )
+    {
+        if( checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
+            return true;
 
-            if( segEndPoint.x > (-w_dist) && segEndPoint.x < (m_segmLength + w_dist) )
-            {
-                // the end point is inside the reference range
-                //  .....X
-                //    O--REF--+
-                // Fine test : we consider the rounded shape of the ends
-                if( segEndPoint.x >= 0 && segEndPoint.x <= m_segmLength )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS3, m_currentMarker );
-                    return false;
-                }
+        m_currentMarker = fillMarker( aRefSeg, track,
+                                      DRCE_TRACK_NEAR_VIA, m_currentMarker );
+        return false;
+    }
 
-                if( !checkMarginToCircle( segEndPoint, w_dist, m_segmLength ) )
-                {
-                    m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_TRACK_ENDS4, m_currentMarker );
-                    return false;
-                }
-            }
+    /*	We have changed axis:
+     *  the reference segment is Horizontal.
+     *  3 cases : the segment to test can be parallel, perpendicular or have an other direction
+     */
+    if( segStartPoint.y == segEndPoint.y ) // parallel segments
+    {
+        if( abs( segStartPoint.y ) >= w_dist )
+            return true;
 
-            if( segStartPoint.x <=0 && segEndPoint.x >= 0 )
-            {
-            // the segment straddles the reference range (this actually only
-            // checks if it straddles the origin, because the other cases where already
-            // handled)
-            //  X.............X
+        // Ensure segStartPoint.x <= segEndPoint.x
+        if( segStartPoint.x > segEndPoint.x )
+            std::swap( segStartPoint.x, segEndPoint.x );
+
+        if( segStartPoint.x > (-w_dist) && segStartPoint.x < (m_segmLength + w_dist) )    /* possible error drc */
+        {
+            // the start point is inside the reference range
+            //      X........
             //    O--REF--+
+
+            // Fine test : we consider the rounded shape of each end of the track segment:
+            if( segStartPoint.x >= 0 && segStartPoint.x <= m_segmLength )
+            {
                 m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_TRACK_SEGMENTS_TOO_CLOSE, m_currentMarker );
+                                              DRCE_TRACK_ENDS1, m_currentMarker );
                 return false;
             }
-        }
-        else if( segStartPoint.x == segEndPoint.x ) // perpendicular segments
-        {
-            if( ( segStartPoint.x <= (-w_dist) ) || ( segStartPoint.x >= (m_segmLength + w_dist) ) )
-                continue;
-
-            // Test if segments are crossing
-            if( segStartPoint.y > segEndPoint.y )
-                std::swap( segStartPoint.y, segEndPoint.y );
 
-            if( (segStartPoint.y < 0) && (segEndPoint.y > 0) )
+            if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
             {
                 m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_TRACKS_CROSSING, m_currentMarker );
+                                              DRCE_TRACK_ENDS2, m_currentMarker );
                 return false;
             }
+        }
 
-            // At this point the drc error is due to an end near a reference segm end
-            if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
+        if( segEndPoint.x > (-w_dist) && segEndPoint.x < (m_segmLength + w_dist) )
+        {
+            // the end point is inside the reference range
+            //  .....X
+            //    O--REF--+
+            // Fine test : we consider the rounded shape of the ends
+            if( segEndPoint.x >= 0 && segEndPoint.x <= m_segmLength )
             {
                 m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_ENDS_PROBLEM1, m_currentMarker );
+                                              DRCE_TRACK_ENDS3, m_currentMarker );
                 return false;
             }
+
             if( !checkMarginToCircle( segEndPoint, w_dist, m_segmLength ) )
             {
                 m_currentMarker = fillMarker( aRefSeg, track,
-                                              DRCE_ENDS_PROBLEM2, m_currentMarker );
+                                              DRCE_TRACK_ENDS4, m_currentMarker );
                 return false;
             }
         }
-        else    // segments quelconques entre eux
+
+        if( segStartPoint.x <=0 && segEndPoint.x >= 0 )
+        {
+        // the segment straddles the reference range (this actually only
+        // checks if it straddles the origin, because the other cases where already
+        // handled)
+        //  X.............X
+        //    O--REF--+
+            m_currentMarker = fillMarker( aRefSeg, track,
+                                          DRCE_TRACK_SEGMENTS_TOO_CLOSE, m_currentMarker );
+            return false;
+        }
+    }
+    else if( segStartPoint.x == segEndPoint.x ) // perpendicular segments
+    {
+        if( ( segStartPoint.x <= (-w_dist) ) || ( segStartPoint.x >= (m_segmLength + w_dist) ) )
+            return true;
+
+        // Test if segments are crossing
+        if( segStartPoint.y > segEndPoint.y )
+            std::swap( segStartPoint.y, segEndPoint.y );
+
+        if( (segStartPoint.y < 0) && (segEndPoint.y > 0) )
+        {
+            m_currentMarker = fillMarker( aRefSeg, track,
+                                          DRCE_TRACKS_CROSSING, m_currentMarker );
+            return false;
+        }
+
+        // At this point the drc error is due to an end near a reference segm end
+        if( !checkMarginToCircle( segStartPoint, w_dist, m_segmLength ) )
+        {
+            m_currentMarker = fillMarker( aRefSeg, track,
+                                          DRCE_ENDS_PROBLEM1, m_currentMarker );
+            return false;
+        }
+        if( !checkMarginToCircle( segEndPoint, w_dist, m_segmLength ) )
+        {
+            m_currentMarker = fillMarker( aRefSeg, track,
+                                          DRCE_ENDS_PROBLEM2, m_currentMarker );
+            return false;
+        }
+    }
+    else    // segments quelconques entre eux
+    {
+        // calcul de la "surface de securite du segment de reference
+        // First rought 'and fast) test : the track segment is like a rectangle
+
+        m_xcliplo = m_ycliplo = -w_dist;
+        m_xcliphi = m_segmLength + w_dist;
+        m_ycliphi = w_dist;
+
+        // A fine test is needed because a serment is not exactly a
+        // rectangle, it has rounded ends
+        if( !checkLine( segStartPoint, segEndPoint ) )
         {
-            // calcul de la "surface de securite du segment de reference
-            // First rought 'and fast) test : the track segment is like a rectangle
+            /* 2eme passe : the track has rounded ends.
+             * we must a fine test for each rounded end and the
+             * rectangular zone
+             */
 
-            m_xcliplo = m_ycliplo = -w_dist;
-            m_xcliphi = m_segmLength + w_dist;
-            m_ycliphi = w_dist;
+            m_xcliplo = 0;
+            m_xcliphi = m_segmLength;
 
-            // A fine test is needed because a serment is not exactly a
-            // rectangle, it has rounded ends
             if( !checkLine( segStartPoint, segEndPoint ) )
             {
-                /* 2eme passe : the track has rounded ends.
-                 * we must a fine test for each rounded end and the
-                 * rectangular zone
+                m_currentMarker = fillMarker( aRefSeg, track,
+                                              DRCE_ENDS_PROBLEM3, m_currentMarker );
+                return false;
+            }
+            else    // The drc error is due to the starting or the ending point of the reference segment
+            {
+                // Test the starting and the ending point
+                segStartPoint = track->GetStart();
+                segEndPoint   = track->GetEnd();
+                delta = segEndPoint - segStartPoint;
+
+                // Compute the segment orientation (angle) en 0,1 degre
+                double angle = ArcTangente( delta.y, delta.x );
+
+                // Compute the segment lenght: delta.x = lenght after rotation
+                RotatePoint( &delta, angle );
+
+                /* Comute the reference segment coordinates relatives to a
+                 *  X axis = current tested segment
                  */
+                wxPoint relStartPos = aRefSeg->GetStart() - segStartPoint;
+                wxPoint relEndPos   = aRefSeg->GetEnd() - segStartPoint;
 
-                m_xcliplo = 0;
-                m_xcliphi = m_segmLength;
+                RotatePoint( &relStartPos, angle );
+                RotatePoint( &relEndPos, angle );
 
-                if( !checkLine( segStartPoint, segEndPoint ) )
+                if( !checkMarginToCircle( relStartPos, w_dist, delta.x ) )
                 {
                     m_currentMarker = fillMarker( aRefSeg, track,
-                                                  DRCE_ENDS_PROBLEM3, m_currentMarker );
+                                                  DRCE_ENDS_PROBLEM4, m_currentMarker );
                     return false;
                 }
-                else    // The drc error is due to the starting or the ending point of the reference segment
+
+                if( !checkMarginToCircle( relEndPos, w_dist, delta.x ) )
                 {
-                    // Test the starting and the ending point
-                    segStartPoint = track->GetStart();
-                    segEndPoint   = track->GetEnd();
-                    delta = segEndPoint - segStartPoint;
-
-                    // Compute the segment orientation (angle) en 0,1 degre
-                    double angle = ArcTangente( delta.y, delta.x );
-
-                    // Compute the segment lenght: delta.x = lenght after rotation
-                    RotatePoint( &delta, angle );
-
-                    /* Comute the reference segment coordinates relatives to a
-                     *  X axis = current tested segment
-                     */
-                    wxPoint relStartPos = aRefSeg->GetStart() - segStartPoint;
-                    wxPoint relEndPos   = aRefSeg->GetEnd() - segStartPoint;
-
-                    RotatePoint( &relStartPos, angle );
-                    RotatePoint( &relEndPos, angle );
-
-                    if( !checkMarginToCircle( relStartPos, w_dist, delta.x ) )
-                    {
-                        m_currentMarker = fillMarker( aRefSeg, track,
-                                                      DRCE_ENDS_PROBLEM4, m_currentMarker );
-                        return false;
-                    }
-
-                    if( !checkMarginToCircle( relEndPos, w_dist, delta.x ) )
-                    {
-                        m_currentMarker = fillMarker( aRefSeg, track,
-                                                      DRCE_ENDS_PROBLEM5, m_currentMarker );
-                        return false;
-                    }
+                    m_currentMarker = fillMarker( aRefSeg, track,
+                                                  DRCE_ENDS_PROBLEM5, m_currentMarker );
+                    return false;
                 }
             }
         }
@@ -0,0 +1,154 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_online_state.cpp
+ */
+
+#include <fctsys.h>
+#include <class_undoredo_container.h>
+
+#include <class_board_item.h>
+#include <class_module.h>
+#include <class_pad.h>
+
+#include <drc_online_state.h>
+
+
+DRC_ONLINE_STATE::DRC_ONLINE_STATE() :
+    m_enabled( false )
+{
+}
+
+
+void DRC_ONLINE_STATE::MarkDirty( BOARD_ITEM* aItem )
+{
+    if( !m_enabled || aItem == NULL )
+        return;
+
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+        // The pads are the items tested by the DRC, not the module itself
+        for( D_PAD* pad = static_cast<MODULE*>( aItem )->Pads(); pad; pad = pad->Next() )
+        {
+            m_dirtyItems.insert( pad );
+            m_dirtyAreas.push_back( pad->GetBoundingBox() );
+        }
+
+        break;
+
+    case PCB_PAD_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+    case PCB_ZONE_AREA_T:
+        m_dirtyAreas.push_back( aItem->GetBoundingBox() );
+        break;
+
+    default:
+        // Other items are not tested by the online DRC
+        return;
+    }
+
+    m_dirtyItems.insert( aItem );
+}
+
+
+void DRC_ONLINE_STATE::MarkDirty( const PICKED_ITEMS_LIST& aList )
+{
+    if( !m_enabled )
+        return;
+
+    for( unsigned ii = 0; ii < aList.GetCount(); ++ii )
+        MarkDirty( aList, ii );
+}
+
+
+void DRC_ONLINE_STATE::MarkDirty( const PICKED_ITEMS_LIST& aList, unsigned aIndex )
+{
+    if( !m_enabled )
+        return;
+
+    MarkDirty( (BOARD_ITEM*) aList.GetPickedItem( aIndex ) );
+
+    // The saved copy of a changed item gives the area the item covers after an undo
+    BOARD_ITEM* image = (BOARD_ITEM*) aList.GetPickedItemLink( aIndex );
+
+    if( image && aList.GetPickedItemStatus( aIndex ) == UR_CHANGED )
+        m_dirtyAreas.push_back( image->GetBoundingBox() );
+}
+
+
+void DRC_ONLINE_STATE::ClearDirty()
+{
+    m_dirtyItems.clear();
+    m_dirtyAreas.clear();
+}
+
+
+void DRC_ONLINE_STATE::AddMarker( const BOARD_ITEM* aOwner, MARKER_PCB* aMarker )
+{
+    m_markers.insert( std::make_pair( aOwner, aMarker ) );
+}
+
+
+void DRC_ONLINE_STATE::TakeMarkers( const BOARD_ITEM* aOwner, std::vector<MARKER_PCB*>& aMarkers )
+{
+    std::pair<MARKER_MAP::iterator, MARKER_MAP::iterator> range = m_markers.equal_range( aOwner );
+
+    for( MARKER_MAP::iterator it = range.first; it != range.second; ++it )
+        aMarkers.push_back( it->second );
+
+    m_markers.erase( range.first, range.second );
+}
+
+
+void DRC_ONLINE_STATE::TakeDirtyMarkers( std::vector<MARKER_PCB*>& aMarkers )
+{
+    for( boost::unordered_set<const BOARD_ITEM*>::const_iterator it = m_dirtyItems.begin();
+         it != m_dirtyItems.end(); ++it )
+    {
+        TakeMarkers( *it, aMarkers );
+    }
+}
+
+
+void DRC_ONLINE_STATE::ForgetMarker( const MARKER_PCB* aMarker )
+{
+    for( MARKER_MAP::iterator it = m_markers.begin(); it != m_markers.end(); ++it )
+    {
+        if( it->second == aMarker )
+        {
+            m_markers.erase( it );
+            return;
+        }
+    }
+}
+
+
+void DRC_ONLINE_STATE::Reset()
+{
+    m_enabled = false;
+    m_markers.clear();
+    ClearDirty();
+}
@@ -0,0 +1,149 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_online_state.h
+ * @brief Board items modified since the last DRC run, and the markers they own.
+ */
+
+#ifndef DRC_ONLINE_STATE_H
+#define DRC_ONLINE_STATE_H
+
+#include <map>
+#include <vector>
+#include <boost/unordered_set.hpp>
+
+#include <class_eda_rect.h>
+
+class BOARD_ITEM;
+class MARKER_PCB;
+class PICKED_ITEMS_LIST;
+
+
+/**
+ * Class DRC_ONLINE_STATE
+ * is the persistent DRC state of a BOARD, used by DRC::RunIncrementalTests() to re-test
+ * only the items modified since the last test and their neighbours.
+ *
+ * It records:
+ * - the items touched by the edit commands (taken from the undo/redo lists), and the
+ *   areas they covered before being modified,
+ * - which item each DRC marker was created for, so the markers of the re-tested items
+ *   can be replaced while the markers elsewhere on the board are kept.
+ *
+ * Item pointers are only used as keys: a dirty item may have been deleted since it was
+ * recorded, and is never dereferenced.  The markers are owned by the BOARD.
+ */
+class DRC_ONLINE_STATE
+{
+public:
+    DRC_ONLINE_STATE();
+
+    /**
+     * Function Enable
+     * turns the online DRC on or off.  It is turned on by a full DRC run, which provides
+     * the initial set of markers, and off when the markers are deleted.
+     */
+    void Enable( bool aEnable )                     { m_enabled = aEnable; }
+    bool IsEnabled() const                          { return m_enabled; }
+
+    /**
+     * Function MarkDirty
+     * records aItem (and the pads of a module) as modified.  Must be called before the
+     * item is modified, so that the area it covered is also re-tested.
+     */
+    void MarkDirty( BOARD_ITEM* aItem );
+
+    /**
+     * Function MarkDirty
+     * records all the items (and the saved copies) of an undo/redo command as modified.
+     */
+    void MarkDirty( const PICKED_ITEMS_LIST& aList );
+
+    /**
+     * Function MarkDirty
+     * records the item (and the saved copy) of the picker aIndex of aList as modified.
+     * The item must still exist.
+     */
+    void MarkDirty( const PICKED_ITEMS_LIST& aList, unsigned aIndex );
+
+    bool HasDirtyItems() const                      { return !m_dirtyItems.empty(); }
+
+    bool IsDirty( const BOARD_ITEM* aItem ) const
+    {
+        return m_dirtyItems.find( aItem ) != m_dirtyItems.end();
+    }
+
+    /**
+     * Function GetDirtyAreas
+     * @return the areas covered by the dirty items when they were recorded.
+     */
+    const std::vector<EDA_RECT>& GetDirtyAreas() const  { return m_dirtyAreas; }
+
+    /**
+     * Function ClearDirty
+     * forgets the dirty items, once they have been tested.
+     */
+    void ClearDirty();
+
+    /**
+     * Function AddMarker
+     * records aMarker as a DRC error found when testing aOwner.
+     */
+    void AddMarker( const BOARD_ITEM* aOwner, MARKER_PCB* aMarker );
+
+    /**
+     * Function TakeMarkers
+     * appends to aMarkers the markers recorded for aOwner, and forgets them.
+     */
+    void TakeMarkers( const BOARD_ITEM* aOwner, std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * Function TakeDirtyMarkers
+     * appends to aMarkers the markers recorded for all the dirty items, and forgets them.
+     */
+    void TakeDirtyMarkers( std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * Function ForgetMarker
+     * must be called when a marker is removed from the board by something else than
+     * the online DRC.
+     */
+    void ForgetMarker( const MARKER_PCB* aMarker );
+
+    /**
+     * Function Reset
+     * forgets everything, and disables the online DRC.
+     */
+    void Reset();
+
+private:
+    typedef std::multimap<const BOARD_ITEM*, MARKER_PCB*> MARKER_MAP;
+
+    bool                                    m_enabled;
+    boost::unordered_set<const BOARD_ITEM*> m_dirtyItems;
+    std::vector<EDA_RECT>                   m_dirtyAreas;
+    MARKER_MAP                              m_markers;
+};
+
+#endif  // DRC_ONLINE_STATE_H
@@ -0,0 +1,342 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_spatial_index.cpp
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_pad.h>
+
+#include <drc_spatial_index.h>
+#include <drc_online_state.h>
+
+
+/**
+ * Struct INDEX_COLLECTOR
+ * is the RTree visitor used to gather the board order indices of the items found
+ * by a query.
+ */
+struct INDEX_COLLECTOR
+{
+    const std::vector<int>& m_slotIndex;
+    std::vector<int>&       m_result;
+
+    INDEX_COLLECTOR( const std::vector<int>& aSlotIndex, std::vector<int>& aResult ) :
+        m_slotIndex( aSlotIndex ),
+        m_result( aResult )
+    {
+    }
+
+    bool operator()( int aSlot )
+    {
+        m_result.push_back( m_slotIndex[aSlot] );
+        return true;
+    }
+};
+
+
+void DRC_SPATIAL_INDEX::ITEM_SLOTS::Clear()
+{
+    for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+        m_trees[layer].RemoveAll();
+
+    m_slotOf.clear();
+    m_items.clear();
+    m_boxes.clear();
+    m_layers.clear();
+    m_index.clear();
+    m_freeSlots.clear();
+}
+
+
+int DRC_SPATIAL_INDEX::ITEM_SLOTS::Insert( const BOARD_ITEM* aItem, const EDA_RECT& aBox,
+                                           LSET aLayers )
+{
+    int slot;
+
+    if( m_freeSlots.empty() )
+    {
+        slot = m_items.size();
+        m_items.push_back( aItem );
+        m_boxes.push_back( aBox );
+        m_layers.push_back( LSET() );
+        m_index.push_back( -1 );
+    }
+    else
+    {
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+        m_items[slot] = aItem;
+    }
+
+    m_slotOf[aItem] = slot;
+    m_layers[slot]  = LSET();
+    Move( slot, aBox, aLayers );
+
+    return slot;
+}
+
+
+void DRC_SPATIAL_INDEX::ITEM_SLOTS::Move( int aSlot, const EDA_RECT& aBox, LSET aLayers )
+{
+    const EDA_RECT& old = m_boxes[aSlot];
+    const int oldmin[2] = { old.GetX(), old.GetY() };
+    const int oldmax[2] = { old.GetRight(), old.GetBottom() };
+
+    for( LSEQ cu_stack = m_layers[aSlot].CuStack(); cu_stack; ++cu_stack )
+        m_trees[*cu_stack].Remove( oldmin, oldmax, aSlot );
+
+    const int mmin[2] = { aBox.GetX(), aBox.GetY() };
+    const int mmax[2] = { aBox.GetRight(), aBox.GetBottom() };
+
+    for( LSEQ cu_stack = aLayers.CuStack(); cu_stack; ++cu_stack )
+        m_trees[*cu_stack].Insert( mmin, mmax, aSlot );
+
+    m_boxes[aSlot]  = aBox;
+    m_layers[aSlot] = aLayers;
+}
+
+
+void DRC_SPATIAL_INDEX::ITEM_SLOTS::Remove( int aSlot )
+{
+    // The item may have been deleted: only its address is used
+    Move( aSlot, m_boxes[aSlot], LSET() );
+
+    m_slotOf.erase( m_items[aSlot] );
+    m_items[aSlot] = NULL;
+    m_index[aSlot] = -1;
+    m_freeSlots.push_back( aSlot );
+}
+
+
+void DRC_SPATIAL_INDEX::ITEM_SLOTS::RemoveUnused()
+{
+    for( unsigned slot = 0; slot < m_items.size(); ++slot )
+    {
+        if( m_items[slot] && m_index[slot] < 0 )
+            Remove( slot );
+    }
+}
+
+
+DRC_SPATIAL_INDEX::DRC_SPATIAL_INDEX() :
+    m_maxClearance( 0 )
+{
+}
+
+
+void DRC_SPATIAL_INDEX::Clear()
+{
+    m_trackSlots.Clear();
+    m_padSlots.Clear();
+
+    m_tracks.clear();
+    m_pads.clear();
+    m_maxClearance = 0;
+}
+
+
+void DRC_SPATIAL_INDEX::Build( BOARD* aBoard )
+{
+    Clear();
+
+    m_maxClearance = aBoard->GetDesignSettings().GetBiggestClearanceValue();
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        int slot = m_trackSlots.Insert( track, TrackBoundingBox( track ), trackLayers( track ) );
+
+        m_trackSlots.m_index[slot] = m_tracks.size();
+        m_tracks.push_back( track );
+        m_maxClearance = std::max( m_maxClearance, track->GetClearance() );
+    }
+
+    for( unsigned ii = 0; ii < aBoard->GetPadCount(); ++ii )
+    {
+        D_PAD* pad  = aBoard->GetPad( ii );
+        int    slot = m_padSlots.Insert( pad, PadBoundingBox( pad ), padLayers( pad ) );
+
+        m_padSlots.m_index[slot] = m_pads.size();
+        m_pads.push_back( pad );
+        m_maxClearance = std::max( m_maxClearance, pad->GetClearance() );
+    }
+}
+
+
+void DRC_SPATIAL_INDEX::Update( BOARD* aBoard, const DRC_ONLINE_STATE& aState )
+{
+    m_tracks.clear();
+    m_pads.clear();
+    m_maxClearance = aBoard->GetDesignSettings().GetBiggestClearanceValue();
+
+    // Walking the board lists only costs a lookup per item: the R-trees are only
+    // modified for the dirty, new and removed items.
+    std::fill( m_trackSlots.m_index.begin(), m_trackSlots.m_index.end(), -1 );
+
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        boost::unordered_map<const BOARD_ITEM*, int>::const_iterator it =
+                m_trackSlots.m_slotOf.find( track );
+        int slot;
+
+        if( it == m_trackSlots.m_slotOf.end() )
+        {
+            slot = m_trackSlots.Insert( track, TrackBoundingBox( track ), trackLayers( track ) );
+        }
+        else
+        {
+            slot = it->second;
+
+            if( aState.IsDirty( track ) )
+                m_trackSlots.Move( slot, TrackBoundingBox( track ), trackLayers( track ) );
+        }
+
+        m_trackSlots.m_index[slot] = m_tracks.size();
+        m_tracks.push_back( track );
+        m_maxClearance = std::max( m_maxClearance, track->GetClearance() );
+    }
+
+    m_trackSlots.RemoveUnused();
+
+    std::fill( m_padSlots.m_index.begin(), m_padSlots.m_index.end(), -1 );
+
+    for( unsigned ii = 0; ii < aBoard->GetPadCount(); ++ii )
+    {
+        D_PAD* pad = aBoard->GetPad( ii );
+
+        boost::unordered_map<const BOARD_ITEM*, int>::const_iterator it =
+                m_padSlots.m_slotOf.find( pad );
+        int slot;
+
+        if( it == m_padSlots.m_slotOf.end() )
+        {
+            slot = m_padSlots.Insert( pad, PadBoundingBox( pad ), padLayers( pad ) );
+        }
+        else
+        {
+            slot = it->second;
+
+            if( aState.IsDirty( pad ) || aState.IsDirty( pad->GetParent() ) )
+                m_padSlots.Move( slot, PadBoundingBox( pad ), padLayers( pad ) );
+        }
+
+        m_padSlots.m_index[slot] = m_pads.size();
+        m_pads.push_back( pad );
+        m_maxClearance = std::max( m_maxClearance, pad->GetClearance() );
+    }
+
+    m_padSlots.RemoveUnused();
+}
+
+
+void DRC_SPATIAL_INDEX::QueryTracks( const EDA_RECT& aArea, LSET aLayers,
+                                     std::vector<int>& aResult ) const
+{
+    query( m_trackSlots, aArea, aLayers, aResult );
+}
+
+
+void DRC_SPATIAL_INDEX::QueryPads( const EDA_RECT& aArea, LSET aLayers,
+                                   std::vector<int>& aResult ) const
+{
+    query( m_padSlots, aArea, aLayers, aResult );
+}
+
+
+void DRC_SPATIAL_INDEX::query( const ITEM_SLOTS& aSlots, const EDA_RECT& aArea, LSET aLayers,
+                               std::vector<int>& aResult ) const
+{
+    EDA_RECT area( aArea );
+    area.Normalize();
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    INDEX_COLLECTOR collector( aSlots.m_index, aResult );
+    aResult.clear();
+
+    LSET cu_layers = aLayers & LSET::AllCuMask();
+    int  layerCount = 0;
+
+    for( LSEQ cu_stack = cu_layers.CuStack(); cu_stack; ++cu_stack, ++layerCount )
+        aSlots.m_trees[*cu_stack].Search( mmin, mmax, collector );
+
+    // Items spanning several layers are found once per layer
+    std::sort( aResult.begin(), aResult.end() );
+
+    if( layerCount > 1 )
+        aResult.erase( std::unique( aResult.begin(), aResult.end() ), aResult.end() );
+}
+
+
+LSET DRC_SPATIAL_INDEX::trackLayers( const TRACK* aTrack )
+{
+    return aTrack->GetLayerSet() & LSET::AllCuMask();
+}
+
+
+LSET DRC_SPATIAL_INDEX::padLayers( const D_PAD* aPad )
+{
+    // A hole goes through every copper layer, even if the pad itself does not
+    return aPad->GetDrillSize().x ? LSET::AllCuMask() : aPad->GetLayerSet() & LSET::AllCuMask();
+}
+
+
+EDA_RECT DRC_SPATIAL_INDEX::TrackBoundingBox( const TRACK* aTrack )
+{
+    // + 1 to round up odd widths
+    int      radius = ( aTrack->GetWidth() + 1 ) / 2;
+    EDA_RECT bbox( aTrack->GetStart(), wxSize( 0, 0 ) );
+
+    if( aTrack->Type() != PCB_VIA_T )
+        bbox.Merge( aTrack->GetEnd() );
+
+    bbox.Inflate( radius );
+
+    return bbox;
+}
+
+
+EDA_RECT DRC_SPATIAL_INDEX::PadBoundingBox( const D_PAD* aPad )
+{
+    // D_PAD::GetBoundingBox() does not take the shape offset into account,
+    // so use the bounding circle centered on the shape position
+    EDA_RECT bbox( aPad->ShapePos(), wxSize( 0, 0 ) );
+    bbox.Inflate( aPad->GetBoundingRadius() + 1 );
+
+    if( aPad->GetDrillSize().x )
+    {
+        const wxSize& drill = aPad->GetDrillSize();
+        EDA_RECT      hole( aPad->GetPosition(), wxSize( 0, 0 ) );
+
+        hole.Inflate( std::max( drill.x, drill.y ) / 2 + 1 );
+        bbox.Merge( hole );
+    }
+
+    return bbox;
+}
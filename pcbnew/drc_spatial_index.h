@@ -0,0 +1,182 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_spatial_index.h
+ * @brief Per copper layer R-trees of tracks, vias and pads used by the batch DRC.
+ */
+
+#ifndef DRC_SPATIAL_INDEX_H
+#define DRC_SPATIAL_INDEX_H
+
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+#include <class_eda_rect.h>
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+
+class BOARD;
+class BOARD_ITEM;
+class TRACK;
+class D_PAD;
+class DRC_ONLINE_STATE;
+
+
+/**
+ * Class DRC_SPATIAL_INDEX
+ * keeps one R-tree per copper layer for the tracks, vias and pads of a board, so that
+ * clearance tests only have to look at the items near a reference item instead of the
+ * whole board.
+ *
+ * Items are stored as indices into the Tracks() and Pads() arrays, which preserve the
+ * board list order: a query result sorted by index is therefore visited in the same
+ * order the sequential DRC used, and reports the same first error.
+ *
+ * Pads having a hole are indexed on every copper layer, because their hole goes through
+ * all of them.  Vias are indexed on every layer of their span.
+ *
+ * The index is non-owning.  After a full Build(), it can be kept up to date by Update(),
+ * which only re-inserts the items recorded as dirty by the board DRC_ONLINE_STATE, and the
+ * added and removed items.  An item modified in place without being marked dirty keeps
+ * its old bounding box until the next Build().
+ * Queries do not modify the index and can be run from several threads.
+ */
+class DRC_SPATIAL_INDEX
+{
+public:
+    DRC_SPATIAL_INDEX();
+
+    /**
+     * Function Build
+     * (re)creates the index for all tracks, vias and pads of aBoard.
+     */
+    void Build( BOARD* aBoard );
+
+    /**
+     * Function Update
+     * brings the index up to date with aBoard after an edit: the items dirty in aState
+     * and the new items are (re)inserted, the items no longer on the board are removed,
+     * and the Tracks() and Pads() arrays follow the new board list order.
+     * The trees of the unmodified items are not touched.
+     */
+    void Update( BOARD* aBoard, const DRC_ONLINE_STATE& aState );
+
+    /**
+     * Function Clear
+     * removes all the items from the index.
+     */
+    void Clear();
+
+    const std::vector<TRACK*>& Tracks() const       { return m_tracks; }
+    const std::vector<D_PAD*>& Pads() const         { return m_pads; }
+
+    /**
+     * Function GetMaxClearance
+     * @return the biggest clearance value found among the indexed items.  An area inflated
+     * by this value is guaranteed to contain every item that may violate a clearance rule
+     * with the items inside the area.
+     */
+    int GetMaxClearance() const                     { return m_maxClearance; }
+
+    /**
+     * Function QueryTracks
+     * collects the indices of the tracks and vias whose bounding box intersects aArea
+     * on at least one of the copper layers of aLayers.
+     * @param aResult receives the indices, sorted in board list order and without duplicates.
+     */
+    void QueryTracks( const EDA_RECT& aArea, LSET aLayers, std::vector<int>& aResult ) const;
+
+    /**
+     * Function QueryPads
+     * collects the indices of the pads whose shape or hole bounding box intersects aArea
+     * on at least one of the copper layers of aLayers.
+     * @param aResult receives the indices, sorted in board pad order and without duplicates.
+     */
+    void QueryPads( const EDA_RECT& aArea, LSET aLayers, std::vector<int>& aResult ) const;
+
+    /**
+     * Function TrackBoundingBox
+     * @return the area covered by the copper of aTrack (clearance not included).
+     */
+    static EDA_RECT TrackBoundingBox( const TRACK* aTrack );
+
+    /**
+     * Function PadBoundingBox
+     * @return the area covered by the copper and the hole of aPad (clearance not included).
+     */
+    static EDA_RECT PadBoundingBox( const D_PAD* aPad );
+
+private:
+    typedef RTree<int, int, 2, float> ITEM_RTREE;
+
+    /**
+     * Struct ITEM_SLOTS
+     * holds the trees of one kind of item.  The trees store slot numbers, which do not
+     * change while an item stays on the board, so an item can be moved without touching
+     * the others.  m_index maps a slot to the position of its item in the board order.
+     */
+    struct ITEM_SLOTS
+    {
+        // RTree::Search() is not const, but it does not modify the tree
+        mutable ITEM_RTREE  m_trees[MAX_CU_LAYERS];
+
+        boost::unordered_map<const BOARD_ITEM*, int> m_slotOf;
+
+        std::vector<const BOARD_ITEM*> m_items;     ///< slot owner, NULL for a free slot
+        std::vector<EDA_RECT>          m_boxes;     ///< box inserted in the trees
+        std::vector<LSET>              m_layers;    ///< trees the box was inserted in
+        std::vector<int>               m_index;     ///< index in the board order
+        std::vector<int>               m_freeSlots;
+
+        void Clear();
+
+        /// Stores aItem in a new slot, and inserts it in the trees of aLayers.
+        int Insert( const BOARD_ITEM* aItem, const EDA_RECT& aBox, LSET aLayers );
+
+        /// Moves the item of aSlot to aBox and aLayers.
+        void Move( int aSlot, const EDA_RECT& aBox, LSET aLayers );
+
+        /// Removes the item of aSlot from the trees, and frees the slot.
+        void Remove( int aSlot );
+
+        /// Removes the items which were not given an index by the last update.
+        void RemoveUnused();
+    };
+
+    void query( const ITEM_SLOTS& aSlots, const EDA_RECT& aArea, LSET aLayers,
+                std::vector<int>& aResult ) const;
+
+    static LSET trackLayers( const TRACK* aTrack );
+    static LSET padLayers( const D_PAD* aPad );
+
+    std::vector<TRACK*> m_tracks;
+    std::vector<D_PAD*> m_pads;
+
+    ITEM_SLOTS          m_trackSlots;
+    ITEM_SLOTS          m_padSlots;
+
+    int                 m_maxClearance;
+};
+
+#endif  // DRC_SPATIAL_INDEX_H
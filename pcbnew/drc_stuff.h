@@ -91,6 +91,7 @@ class TRACK;
 class MARKER_PCB;
 class DRC_ITEM;
 class NETCLASS;
+class DRC_SPATIAL_INDEX;
 
 
 /**
@@ -199,6 +200,10 @@ private:
 
     DRC_LIST            m_unconnected;  ///< list of unconnected pads, as DRC_ITEMs
 
+    /// Index built by the last full DRC run, kept up to date by RunIncrementalTests()
+    DRC_SPATIAL_INDEX*  m_onlineIndex;
+    BOARD*              m_onlineIndexBoard;     ///< the board m_onlineIndex was built for
+
 
     /**
      * Function updatePointers
@@ -277,6 +282,26 @@ private:
      */
     void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
 
+    /**
+     * Function testIndexedTracks
+     * runs doIndexedTrackDrc() on a range of segments, in parallel when possible.
+     * @param aIndex The spatial index of the board items
+     * @param aRefs Indices in aIndex.Tracks() of the segments to test
+     * @param aFirst First position in aRefs to test
+     * @param aLast Position in aRefs after the last one to test
+     * @param aMarkers receives, for each tested position, the marker created for the
+     *                 first error found, or NULL.  Markers are not added to the board.
+     */
+    void testIndexedTracks( const DRC_SPATIAL_INDEX& aIndex, const std::vector<int>& aRefs,
+                            int aFirst, int aLast, std::vector<MARKER_PCB*>& aMarkers );
+
+    /**
+     * Function addMarkerToPcb
+     * adds aMarker to the board and to the view, and records it as an error
+     * of aOwner, so the online DRC can replace it when aOwner is tested again.
+     */
+    void addMarkerToPcb( MARKER_PCB* aMarker, const BOARD_ITEM* aOwner );
+
     void testPad2Pad();
 
     void testUnconnected();
@@ -313,6 +338,46 @@ private:
      */
     bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
 
+    /**
+     * Function doIndexedTrackDrc
+     * tests a segment like doTrackDrc(), but only against the pads and the segments
+     * found near it in aIndex.  Segments located before aRefIndex in the board list
+     * are not tested, since they already were tested against this one.
+     * @param aIndex The spatial index of the board items
+     * @param aRefIndex The index in aIndex.Tracks() of the segment to test
+     * @param aDummyPad A pad owned by the caller, used to test pad holes
+     * @param aCandidates A buffer owned by the caller, to store the query results
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doIndexedTrackDrc( const DRC_SPATIAL_INDEX& aIndex, int aRefIndex,
+                            D_PAD& aDummyPad, std::vector<int>& aCandidates );
+
+    /**
+     * Function doTrackSelfDrc
+     * tests the reference segment alone (min width, via size and layer pair),
+     * and initializes the m_segmEnd, m_segmAngle and m_segmLength members used by
+     * doTrackToPadDrc() and doTrackToTrackDrc().
+     * @return bool - true if no poblems, else false and m_currentMarker is
+     *          filled in with the problem information.
+     */
+    bool doTrackSelfDrc( TRACK* aRefSeg );
+
+    /**
+     * Function doTrackToPadDrc
+     * tests the clearance between aRefSeg and aPad (or its hole).
+     * doTrackSelfDrc( aRefSeg ) must have been called before.
+     * @param aDummyPad A pad used to test the hole of aPad, on all copper layers
+     */
+    bool doTrackToPadDrc( TRACK* aRefSeg, D_PAD* aPad, D_PAD& aDummyPad );
+
+    /**
+     * Function doTrackToTrackDrc
+     * tests the clearance between aRefSeg and another segment or via.
+     * doTrackSelfDrc( aRefSeg ) must have been called before.
+     */
+    bool doTrackToTrackDrc( TRACK* aRefSeg, TRACK* aTrack );
+
     /**
      * Function doTrackKeepoutDrc
      * tests the current segment or via.
@@ -484,6 +549,15 @@ public:
      */
     void RunTests( wxTextCtrl* aMessages = NULL );
 
+    /**
+     * Function RunIncrementalTests
+     * re-runs the clearance, keepout and zone outline tests only for the items modified
+     * since the last DRC run (as recorded by the board DRC_ONLINE_STATE) and their
+     * neighbours, and replaces their markers.  Markers elsewhere on the board are kept.
+     * Does nothing until a full DRC was run by RunTests().
+     */
+    void RunIncrementalTests();
+
     /**
      * Function ListUnconnectedPad
      * gathers a list of all the unconnected pads and shows them in the
@@ -115,7 +115,7 @@ void PCB_BASE_FRAME::RotateTextModule( TEXTE_MODULE* Text, wxDC* DC )
     if( module && module->GetFlags() == 0 && Text->GetFlags() == 0 ) // prepare undo command
     {
         if( IsType( FRAME_PCB ) )
-            SaveCopyInUndoList( module, UR_CHANGED );
+            SaveCopyInUndoList( Text, UR_CHANGED );
     }
 
     // we expect MoveVector to be (0,0) if there is no move in progress
@@ -241,7 +241,7 @@ void PCB_BASE_FRAME::PlaceTexteModule( TEXTE_MODULE* Text, wxDC* DC )
             Text->SetOrientation( TextInitialOrientation );
 
             if( IsType( FRAME_PCB ) )
-                SaveCopyInUndoList( Module, UR_CHANGED );
+                SaveCopyInUndoList( Text, UR_CHANGED );
             else
                 SaveCopyInUndoList( Module, UR_MODEDIT );
 
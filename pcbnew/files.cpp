@@ -48,6 +48,7 @@
 #include <wildcards_and_files_ext.h>
 
 #include <class_board.h>
+#include <connectivity_graph.h>
 #include <build_version.h>      // LEGACY_BOARD_FILE_VERSION
 #include <module_editor_frame.h>
 #include <modview_frame.h>
@@ -586,6 +587,9 @@ bool PCB_EDIT_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
     // Compile ratsnest and displays net info
     {
         wxBusyCursor dummy;    // Displays an Hourglass while building connectivity
+
+        // Some import plugins fill the board lists without BOARD::Add()
+        GetBoard()->GetConnectivity()->Synchronize();
         Compile_Ratsnest( NULL, true );
     }
 
@@ -420,6 +420,19 @@ public:
      */
     virtual bool IsFootprintLibWritable( const wxString& aLibraryPath );
 
+    /**
+     * Function FootprintLibTimestamp
+     * returns a value which changes whenever the library at @a aLibraryPath is modified,
+     * so that what is learned about the library can be kept across sessions.
+     *
+     * @param aLibraryPath is a locator for the "library", usually a directory, file,
+     *   or URL containing several footprints.
+     *
+     * @return size_t - the timestamp, or 0 if the PLUGIN cannot tell when the library
+     *   is modified, in which case the library must be read again each time.
+     */
+    virtual size_t FootprintLibTimestamp( const wxString& aLibraryPath );
+
     /**
      * Function FootprintLibOptions
      * appends supported PLUGIN options to @a aListToAppenTo along with
@@ -50,6 +50,7 @@
 #include <wx/filename.h>
 #include <wx/wfstream.h>
 #include <boost/ptr_container/ptr_map.hpp>
+#include <boost/functional/hash.hpp>
 #include <memory.h>
 
 using namespace PCB_KEYS_T;
@@ -294,7 +295,7 @@ void FP_CACHE::Load()
             // prepend the libpath into fullPath
             wxFileName fullPath( m_lib_path.GetPath(), fpFileName );
 
-            FILE_LINE_READER    reader( fullPath.GetFullPath() );
+            MAPPED_FILE_LINE_READER reader( fullPath.GetFullPath() );
 
             m_owner->m_parser->SetLineReader( &reader );
 
@@ -1706,7 +1707,7 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    MAPPED_FILE_LINE_READER reader( aFileName );
 
     init( aProperties );
 
@@ -2005,3 +2006,34 @@ bool PCB_IO::IsFootprintLibWritable( const wxString& aLibraryPath )
 
     return m_cache->IsWritable();
 }
+
+
+size_t PCB_IO::FootprintLibTimestamp( const wxString& aLibraryPath )
+{
+    if( !wxDir::Exists( aLibraryPath ) )
+        return 0;
+
+    wxDir       dir( aLibraryPath );
+    wxString    fpFileName;
+    wxString    wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
+    size_t      timestamp = 0;
+
+    if( dir.IsOpened() && dir.GetFirst( &fpFileName, wildcard, wxDIR_FILES ) )
+    {
+        do
+        {
+            wxFileName  fn( aLibraryPath, fpFileName );
+            size_t      fileHash = 0;
+
+            boost::hash_combine( fileHash, std::string( TO_UTF8( fpFileName ) ) );
+            boost::hash_combine( fileHash, (long) fn.GetModificationTime().GetTicks() );
+            boost::hash_combine( fileHash, (unsigned long) fn.GetSize().GetLo() );
+
+            // The directory order is not specified, the sum does not depend on it
+            timestamp += fileHash;
+        } while( dir.GetNext( &fpFileName ) );
+    }
+
+    // 0 means unknown
+    return timestamp ? timestamp : 1;
+}
@@ -124,6 +124,8 @@ public:
 
     bool IsFootprintLibWritable( const wxString& aLibraryPath );
 
+    size_t FootprintLibTimestamp( const wxString& aLibraryPath );
+
     //-----</PLUGIN API>--------------------------------------------------------
 
     PCB_IO( int aControlFlags = CTL_FOR_BOARD );
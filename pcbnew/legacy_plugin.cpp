@@ -4231,6 +4231,7 @@ void LEGACY_PLUGIN::savePCB_TEXT( const TEXTE_PCB* me ) const
 
 
 #include <boost/ptr_container/ptr_map.hpp>
+#include <boost/functional/hash.hpp>
 #include <wx/filename.h>
 
 typedef boost::ptr_map< std::string, MODULE >   MODULE_MAP;
@@ -4772,6 +4773,22 @@ bool LEGACY_PLUGIN::IsFootprintLibWritable( const wxString& aLibraryPath )
 }
 
 
+size_t LEGACY_PLUGIN::FootprintLibTimestamp( const wxString& aLibraryPath )
+{
+    wxFileName  fn( aLibraryPath );
+    size_t      timestamp = 0;
+
+    if( !fn.FileExists() )
+        return 0;
+
+    boost::hash_combine( timestamp, (long) fn.GetModificationTime().GetTicks() );
+    boost::hash_combine( timestamp, (unsigned long) fn.GetSize().GetLo() );
+
+    // 0 means unknown
+    return timestamp ? timestamp : 1;
+}
+
+
 LEGACY_PLUGIN::LEGACY_PLUGIN() :
     m_cu_count( 16 ),               // for FootprintLoad()
     m_board( 0 ),
@@ -98,6 +98,8 @@ public:
 
     bool IsFootprintLibWritable( const wxString& aLibraryPath );
 
+    size_t FootprintLibTimestamp( const wxString& aLibraryPath );
+
     //-----</PLUGIN IMPLEMENTATION>---------------------------------------------
 
     typedef int     BIU;
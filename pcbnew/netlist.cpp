@@ -43,6 +43,7 @@
 #include <fp_lib_table.h>
 
 #include <class_board.h>
+#include <connectivity_graph.h>
 #include <class_module.h>
 #include <ratsnest_data.h>
 #include <pcbnew.h>
@@ -137,7 +138,8 @@ void PCB_EDIT_FRAME::ReadPcbNetlist( const wxString& aNetlistFileName,
         RemoveMisConnectedTracks();
     }
 
-    // Rebuild the board connectivity:
+    // Rebuild the board connectivity.  The nets of the pads were changed in place.
+    board->GetConnectivity()->Synchronize();
     Compile_Ratsnest( NULL, true );
     board->GetRatsnest()->ProcessBoard();
 
@@ -53,6 +53,11 @@
 #include <pcb_parser.h>
 
 #include <boost/make_shared.hpp>
+#include <boost/exception_ptr.hpp>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
 
 using namespace PCB_KEYS_T;
 
@@ -125,11 +130,17 @@ void PCB_PARSER::pushValueIntoMap( int aIndex, int aValue )
 
 double PCB_PARSER::parseDouble() throw( IO_ERROR )
 {
+    double fval;
+
+    // Fast path for the numbers written by Pcbnew, which does not need strtod()
+    if( ParseDecimal( CurText(), &fval ) )
+        return fval;
+
     char* tmp;
 
     errno = 0;
 
-    double fval = strtod( CurText(), &tmp );
+    fval = strtod( CurText(), &tmp );
 
     if( errno )
     {
@@ -414,6 +425,16 @@ BOARD* PCB_PARSER::parseBOARD() throw( IO_ERROR, PARSE_ERROR )
 {
     T token;
 
+    // Modules and zones hold most of the file.  They do not depend on each other,
+    // so they can be parsed in parallel once the rest of the board is known.
+#ifdef USE_OPENMP
+    bool deferItems = omp_get_max_threads() > 1;
+#else
+    bool deferItems = false;
+#endif
+
+    m_deferredItems.clear();
+
     parseHeader();
 
     for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
@@ -470,7 +491,10 @@ BOARD* PCB_PARSER::parseBOARD() throw( IO_ERROR, PARSE_ERROR )
             break;
 
         case T_module:
-            m_board->Add( parseMODULE(), ADD_APPEND );
+            if( deferItems )
+                deferItem();
+            else
+                m_board->Add( parseMODULE(), ADD_APPEND );
             break;
 
         case T_segment:
@@ -482,7 +506,18 @@ BOARD* PCB_PARSER::parseBOARD() throw( IO_ERROR, PARSE_ERROR )
             break;
 
         case T_zone:
-            m_board->Add( parseZONE_CONTAINER(), ADD_APPEND );
+            if( deferItems )
+            {
+                deferItem();
+            }
+            else
+            {
+                wxString netname;
+                ZONE_CONTAINER* zone = parseZONE_CONTAINER( netname );
+
+                checkZoneNetname( zone, netname );
+                m_board->Add( zone, ADD_APPEND );
+            }
             break;
 
         case T_target:
@@ -496,10 +531,163 @@ BOARD* PCB_PARSER::parseBOARD() throw( IO_ERROR, PARSE_ERROR )
         }
     }
 
+    parseDeferredItems();
+
     return m_board;
 }
 
 
+void PCB_PARSER::deferItem() throw( IO_ERROR )
+{
+    m_deferredItems.push_back( DEFERRED_ITEM() );
+
+    DEFERRED_ITEM& item = m_deferredItems.back();
+
+    item.token      = CurTok();
+    item.lineNumber = CurLineNumber() - 1;
+
+    ReadListText( item.text );
+}
+
+
+void PCB_PARSER::parseDeferredItems() throw( IO_ERROR, PARSE_ERROR )
+{
+    int count = m_deferredItems.size();
+
+    if( count == 0 )
+        return;
+
+    std::vector<BOARD_ITEM*>            items( count, (BOARD_ITEM*) NULL );
+    std::vector<wxString>               netnames( count );
+    std::vector<IO_ERROR*>              errors( count, (IO_ERROR*) NULL );
+    std::vector<boost::exception_ptr>   otherErrors( count );
+    const wxString                      source = CurSource();
+    int                                 first = 0;
+
+    // checkZoneNetname() may add a net, which the items after the zone can use: they are
+    // then parsed again with the new net codes
+    while( first < count )
+    {
+#ifdef USE_OPENMP
+        #pragma omp parallel
+#endif /* USE_OPENMP */
+        {
+            // Each thread needs its own lexer, which knows the layers and nets of the board
+            PCB_PARSER parser;
+
+            parser.m_board        = m_board;
+            parser.m_layerIndices = m_layerIndices;
+            parser.m_layerMasks   = m_layerMasks;
+            parser.m_netCodes     = m_netCodes;
+
+#ifdef USE_OPENMP
+            #pragma omp for schedule(dynamic, 1)
+#endif /* USE_OPENMP */
+            for( int ii = first; ii < count; ++ii )
+            {
+                const DEFERRED_ITEM& deferred = m_deferredItems[ii];
+
+                // Nothing may escape the parallel region: errors are kept by item index,
+                // and the first one in file order is rethrown below
+                try
+                {
+                    STRING_LINE_READER reader( deferred.text, source, deferred.lineNumber );
+
+                    parser.PushReader( &reader );
+
+                    try
+                    {
+                        parser.NeedLEFT();
+                        parser.NextTok();
+
+                        if( deferred.token == T_module )
+                            items[ii] = parser.parseMODULE();
+                        else
+                            items[ii] = parser.parseZONE_CONTAINER( netnames[ii] );
+                    }
+                    catch( ... )
+                    {
+                        parser.PopReader();
+                        throw;
+                    }
+
+                    parser.PopReader();
+                }
+                catch( const PARSE_ERROR& pe )
+                {
+                    errors[ii] = new PARSE_ERROR( pe );
+                }
+                catch( const IO_ERROR& ioe )
+                {
+                    errors[ii] = new IO_ERROR( ioe );
+                }
+                catch( ... )
+                {
+                    otherErrors[ii] = boost::current_exception();
+                }
+            }
+        }
+
+        // Add the items as the sequential parser would have, up to the first error
+        int ii;
+
+        for( ii = first; ii < count; ++ii )
+        {
+            if( errors[ii] || otherErrors[ii] )
+            {
+                for( int jj = ii + 1; jj < count; ++jj )
+                {
+                    delete items[jj];
+                    delete errors[jj];
+                }
+
+                m_deferredItems.clear();
+
+                if( otherErrors[ii] )
+                {
+                    delete errors[ii];
+                    boost::rethrow_exception( otherErrors[ii] );
+                }
+
+                std::auto_ptr<IO_ERROR> error( errors[ii] );
+                PARSE_ERROR* parseError = dynamic_cast<PARSE_ERROR*>( error.get() );
+
+                if( parseError )
+                    throw PARSE_ERROR( *parseError );
+
+                throw IO_ERROR( *error );
+            }
+
+            int netCount = m_board->GetNetCount();
+
+            if( items[ii]->Type() == PCB_ZONE_AREA_T )
+                checkZoneNetname( (ZONE_CONTAINER*) items[ii], netnames[ii] );
+
+            m_board->Add( items[ii], ADD_APPEND );
+            items[ii] = NULL;
+
+            if( m_board->GetNetCount() != netCount )
+            {
+                for( int jj = ii + 1; jj < count; ++jj )
+                {
+                    delete items[jj];
+                    items[jj] = NULL;
+                    delete errors[jj];
+                    errors[jj] = NULL;
+                    otherErrors[jj] = boost::exception_ptr();
+                }
+
+                break;
+            }
+        }
+
+        first = ii + 1;
+    }
+
+    m_deferredItems.clear();
+}
+
+
 void PCB_PARSER::parseHeader() throw( IO_ERROR, PARSE_ERROR )
 {
     wxCHECK_RET( CurTok() == T_kicad_pcb,
@@ -2525,7 +2713,8 @@ VIA* PCB_PARSER::parseVIA() throw( IO_ERROR, PARSE_ERROR )
 }
 
 
-ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR )
+ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER( wxString& aNetnameFromFile )
+    throw( IO_ERROR, PARSE_ERROR )
 {
     wxCHECK_MSG( CurTok() == T_zone, NULL,
                  wxT( "Cannot parse " ) + GetTokenString( CurTok() ) +
@@ -2537,7 +2726,6 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR )
     wxPoint pt;
     T       token;
     int     tmp;
-    wxString    netnameFromfile;    // the zone net name find in file
 
     // bigger scope since each filled_polygon is concatenated in here
     SHAPE_POLY_SET pts;
@@ -2573,7 +2761,7 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR )
 
         case T_net_name:
             NeedSYMBOLorNUMBER();
-            netnameFromfile = FromUTF8();
+            aNetnameFromFile = FromUTF8();
             NeedRIGHT();
             break;
 
@@ -2853,38 +3041,44 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR )
     if( !zone_has_net )
         zone->SetNetCode( NETINFO_LIST::UNCONNECTED );
 
+    return zone.release();
+}
+
+
+void PCB_PARSER::checkZoneNetname( ZONE_CONTAINER* aZone, const wxString& aNetnameFromFile )
+{
+    bool zone_has_net = aZone->IsOnCopperLayer() && !aZone->GetIsKeepout();
+
     // Ensure the zone net name is valid, and matches the net code, for copper zones
-    if( zone_has_net && ( zone->GetNet()->GetNetname() != netnameFromfile ) )
+    if( zone_has_net && ( aZone->GetNet()->GetNetname() != aNetnameFromFile ) )
     {
         // Can happens which old boards, with nonexistent nets ...
         // or after being edited by hand
         // We try to fix the mismatch.
-        NETINFO_ITEM* net = m_board->FindNet( netnameFromfile );
+        NETINFO_ITEM* net = m_board->FindNet( aNetnameFromFile );
 
         if( net )   // An existing net has the same net name. use it for the zone
-            zone->SetNetCode( net->GetNet() );
+            aZone->SetNetCode( net->GetNet() );
         else    // Not existing net: add a new net to keep trace of the zone netname
         {
             int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
+            net = new NETINFO_ITEM( m_board, aNetnameFromFile, newnetcode );
             m_board->AppendNet( net );
 
             // Store the new code mapping
             pushValueIntoMap( newnetcode, net->GetNet() );
             // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
+            aZone->SetNetCode( net->GetNet() );
 
             // Prompt the user
             wxString msg;
             msg.Printf( _( "There is a zone that belongs to a not existing net\n"
                            "\"%s\"\n"
                            "you should verify and edit it (run DRC test)." ),
-                           GetChars( netnameFromfile ) );
+                           GetChars( aNetnameFromFile ) );
             DisplayError( NULL, msg );
         }
     }
-
-    return zone.release();
 }
 
 
@@ -29,6 +29,8 @@
 #ifndef _PCBNEW_PARSER_H_
 #define _PCBNEW_PARSER_H_
 
+#include <deque>
+
 #include <pcb_lexer.h>
 #include <hashtables.h>
 #include <layers_id_colors_and_visibility.h>    // LAYER_ID
@@ -69,6 +71,16 @@ class PCB_PARSER : public PCB_LEXER
     LSET_MAP            m_layerMasks;       ///< map layer names to their masks
     std::vector<int>    m_netCodes;         ///< net codes mapping for boards being loaded
 
+    /// The text of a module or zone of a board, whose parsing is deferred
+    struct DEFERRED_ITEM
+    {
+        PCB_KEYS_T::T   token;              ///< T_module or T_zone
+        int             lineNumber;         ///< line number before the first line of text
+        std::string     text;
+    };
+
+    std::deque<DEFERRED_ITEM>   m_deferredItems;    ///< in file order
+
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
     inline int getNetCode( int aNetCode )
@@ -124,10 +136,42 @@ class PCB_PARSER : public PCB_LEXER
     D_PAD*          parseD_PAD( MODULE* aParent = NULL ) throw( IO_ERROR, PARSE_ERROR );
     TRACK*          parseTRACK() throw( IO_ERROR, PARSE_ERROR );
     VIA*            parseVIA() throw( IO_ERROR, PARSE_ERROR );
-    ZONE_CONTAINER* parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function parseZONE_CONTAINER
+     * parses a zone, without checking its net name.
+     * @param aNetnameFromFile receives the net name found in the file, to be given to
+     * checkZoneNetname() once the zone is added to the board.
+     */
+    ZONE_CONTAINER* parseZONE_CONTAINER( wxString& aNetnameFromFile ) throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function checkZoneNetname
+     * fixes the net of a copper zone whose net name in the file does not match its
+     * net code, adding a new net to the board if no net has this name.
+     */
+    void checkZoneNetname( ZONE_CONTAINER* aZone, const wxString& aNetnameFromFile );
+
     PCB_TARGET*     parsePCB_TARGET() throw( IO_ERROR, PARSE_ERROR );
     BOARD*          parseBOARD() throw( IO_ERROR, PARSE_ERROR );
 
+    /**
+     * Function deferItem
+     * stores the text of the current module or zone, to be parsed later by
+     * parseDeferredItems().  Must be called when CurTok() is T_module or T_zone.
+     */
+    void deferItem() throw( IO_ERROR );
+
+    /**
+     * Function parseDeferredItems
+     * parses the deferred modules and zones on all the available threads, and adds
+     * them to the board in file order, so the board is the same as if they had been
+     * parsed one after the other.  The first error in file order is rethrown.
+     * When checkZoneNetname() adds a net, the items after the zone are parsed again
+     * with the new net codes.
+     */
+    void parseDeferredItems() throw( IO_ERROR, PARSE_ERROR );
+
 
     /**
      * Function lookUpLayer
@@ -65,6 +65,7 @@
 #include <worksheet_viewitem.h>
 #include <ratsnest_data.h>
 #include <ratsnest_viewitem.h>
+#include <drc_online_state.h>
 
 #include <tool/tool_manager.h>
 #include <tool/tool_dispatcher.h>
@@ -317,6 +318,7 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
     m_SelViaSizeBox = NULL;
     m_SelLayerBox = NULL;
     m_show_microwave_tools = false;
+    m_undoMemoryBudget = DEFAULT_UNDO_MEMORY_BUDGET_MB;
     m_show_layer_manager_tools = true;
     m_hotkeysDescrList = g_Board_Editor_Hokeys_Descr;
     m_hasAutoSave = true;
@@ -361,6 +363,7 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
 
     SetScreen( new PCB_SCREEN( GetPageSettings().GetSizeIU() ) );
     GetScreen()->SetMaxUndoItems( m_UndoRedoCountMax );
+    GetScreen()->SetUndoMemoryBudget( size_t( m_undoMemoryBudget ) << 20 );
 
     // PCB drawings start in the upper left corner.
     GetScreen()->m_Center = false;
@@ -942,6 +945,11 @@ void PCB_EDIT_FRAME::OnModify( )
 {
     PCB_BASE_FRAME::OnModify();
 
+    // Re-test the modified items once the current command is finished,
+    // if a DRC was run on this board
+    if( GetBoard()->GetDrcState()->IsEnabled() )
+        CallAfter( boost::bind( &DRC::RunIncrementalTests, m_drc ) );
+
     if( m_Draw3DFrame )
         m_Draw3DFrame->ReloadRequest();
 }
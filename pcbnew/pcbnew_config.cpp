@@ -419,6 +419,9 @@ PARAM_CFG_ARRAY& PCB_EDIT_FRAME::GetConfigurationSettings()
         // Miscellaneous:
         m_configSettings.push_back( new PARAM_CFG_INT( true, wxT( "RotationAngle" ), &m_rotationAngle,
                                                        900, 1, 900 ) );
+        m_configSettings.push_back( new PARAM_CFG_INT( true, wxT( "UndoMemoryBudget" ),
+                                                       &m_undoMemoryBudget,
+                                                       DEFAULT_UNDO_MEMORY_BUDGET_MB, 0, 65536 ) );
         m_configSettings.push_back( new PARAM_CFG_INT( true, wxT( "MaxLnkS" ),
                                                        &displ_opts->m_MaxLinksShowed,
                                                        3, 0, 15 ) );
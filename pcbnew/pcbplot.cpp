@@ -43,6 +43,10 @@
 #include <dialog_plot.h>
 #include <macros.h>
 #include <build_version.h>
+#include <gendrill_Excellon_writer.h>
+#include <thread_pool.h>
+
+#include <boost/bind.hpp>
 
 
 const wxString GetGerberExtension( LAYER_NUM aLayer )
@@ -392,6 +396,135 @@ bool PLOT_CONTROLLER::PlotLayer()
 }
 
 
+/// A layer plotted by PLOT_CONTROLLER::PlotLayers()
+struct LAYER_PLOT_JOB
+{
+    LAYER_ID    m_layer;
+    PLOTTER*    m_plotter;      ///< the plotter, already started, for this layer file
+    wxString    m_fileName;
+    bool        m_success;      ///< set when the plot is finished and the file closed
+};
+
+
+static void plotLayerJob( BOARD* aBoard, const PCB_PLOT_PARAMS* aPlotOpts, LAYER_PLOT_JOB* aJob )
+{
+    // The pool swallows the exceptions: m_success stays false and the plotter is
+    // deleted by the calling thread if the plot does not get to the end.
+    PlotOneBoardLayer( aBoard, aJob->m_plotter, aJob->m_layer, *aPlotOpts );
+    aJob->m_success = aJob->m_plotter->EndPlot();
+    delete aJob->m_plotter;
+    aJob->m_plotter = NULL;
+}
+
+
+static void createDrillFiles( BOARD* aBoard, const PCB_PLOT_PARAMS& aPlotOpts,
+                              const wxString& aOutputDir, REPORTER* aReporter )
+{
+    EXCELLON_WRITER excellonWriter( aBoard );
+    wxPoint offset;
+
+    if( aPlotOpts.GetUseAuxOrigin() )
+        offset = aBoard->GetAuxOrigin();
+
+    excellonWriter.SetFormat( true, EXCELLON_WRITER::DECIMAL_FORMAT );
+    excellonWriter.SetOptions( false, false, offset, false );
+    excellonWriter.CreateDrillandMapFilesSet( aOutputDir, true, false, aReporter );
+}
+
+
+bool PLOT_CONTROLLER::PlotLayers( LSET aLayers, bool aGenDrill, REPORTER* aReporter )
+{
+    // Keep the C locale for the whole batch, so the worker threads never switch it
+    LOCALE_IO toggle;
+
+    ClosePlot();
+
+    wxString outputDirName = GetPlotOptions().GetOutputDirectory();
+    wxFileName outputDir = wxFileName::DirName( outputDirName );
+    wxString boardFilename = m_board->GetFileName();
+    wxString msg;
+
+    if( !EnsureFileDirectoryExists( &outputDir, boardFilename, aReporter ) )
+        return false;
+
+    PlotFormat format = GetPlotOptions().GetFormat();
+    std::vector<LAYER_PLOT_JOB> jobs;
+    bool success = true;
+
+    // The files are opened by the calling thread: StartPlotBoard() updates the board
+    // bounding box, and reports the errors.  Only the plot itself is run by the workers.
+    for( LSEQ seq = aLayers.UIOrder();  seq;  ++seq )
+    {
+        LAYER_PLOT_JOB job;
+        wxFileName fn( boardFilename );
+        wxString ext = GetDefaultPlotExtension( format );
+
+        // Use Gerber Extensions based on layer number
+        if( format == PLOT_FORMAT_GERBER && GetPlotOptions().GetUseGerberExtensions() )
+            ext = GetGerberExtension( *seq );
+
+        BuildPlotFileName( &fn, outputDir.GetPath(), m_board->GetStandardLayerName( *seq ), ext );
+
+        job.m_layer = *seq;
+        job.m_fileName = fn.GetFullPath();
+        job.m_success = false;
+        job.m_plotter = StartPlotBoard( m_board, &GetPlotOptions(), *seq, job.m_fileName,
+                                        wxEmptyString );
+
+        if( job.m_plotter )
+        {
+            jobs.push_back( job );
+        }
+        else
+        {
+            success = false;
+
+            if( aReporter )
+            {
+                msg.Printf( _( "Unable to create file '%s'." ), GetChars( job.m_fileName ) );
+                aReporter->Report( msg, REPORTER::RPT_ERROR );
+            }
+        }
+    }
+
+    THREAD_POOL pool;
+
+    for( unsigned ii = 0; ii < jobs.size(); ++ii )
+        pool.Submit( boost::bind( plotLayerJob, m_board, &GetPlotOptions(), &jobs[ii] ) );
+
+    pool.Wait();
+
+    for( unsigned ii = 0; ii < jobs.size(); ++ii )
+    {
+        // Left by a plot which did not complete
+        delete jobs[ii].m_plotter;
+
+        if( jobs[ii].m_success )
+        {
+            msg.Printf( _( "Plot file '%s' created." ), GetChars( jobs[ii].m_fileName ) );
+
+            if( aReporter )
+                aReporter->Report( msg, REPORTER::RPT_ACTION );
+        }
+        else
+        {
+            success = false;
+            msg.Printf( _( "Unable to plot file '%s'." ), GetChars( jobs[ii].m_fileName ) );
+
+            if( aReporter )
+                aReporter->Report( msg, REPORTER::RPT_ERROR );
+        }
+    }
+
+    // The drill files are made by the calling thread, once the layers are plotted:
+    // the drill writer updates the board bounding box.
+    if( aGenDrill )
+        createDrillFiles( m_board, GetPlotOptions(), outputDir.GetPath(), aReporter );
+
+    return success;
+}
+
+
 void PLOT_CONTROLLER::SetColorMode( bool aColorMode )
 {
     if( !m_plotter )
@@ -322,6 +322,10 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
         }
     }
 
+    // Pads are plotted from a copy, resized to the required plot size: the board is
+    // not modified, so several layers can be plotted at the same time
+    D_PAD plotPad( NULL );
+
     // Plot footprint pads
     for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
     {
@@ -365,27 +369,25 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
             if( pad->GetLayerSet()[F_Cu] )
                 color = ColorFromInt( color | aBoard->GetVisibleElementColor( PAD_FR_VISIBLE ) );
 
-            // Temporary set the pad size to the required plot size:
-            wxSize tmppadsize = pad->GetSize();
-            pad->SetSize( padPlotsSize );
-            switch( pad->GetShape() )
+            plotPad.Copy( pad );
+            plotPad.SetSize( padPlotsSize );
+
+            switch( plotPad.GetShape() )
             {
             case PAD_SHAPE_CIRCLE:
             case PAD_SHAPE_OVAL:
                 if( aPlotOpt.GetSkipPlotNPTH_Pads() &&
-                    (pad->GetSize() == pad->GetDrillSize()) &&
-                    (pad->GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED) )
+                    (plotPad.GetSize() == plotPad.GetDrillSize()) &&
+                    (plotPad.GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED) )
                     break;
 
                 // Fall through:
             case PAD_SHAPE_TRAPEZOID:
             case PAD_SHAPE_RECT:
             default:
-                itemplotter.PlotPad( pad, color, plotMode );
+                itemplotter.PlotPad( &plotPad, color, plotMode );
                 break;
             }
-
-            pad->SetSize( tmppadsize );     // Restore the pad size
         }
     }
 
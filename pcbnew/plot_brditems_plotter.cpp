@@ -499,8 +499,7 @@ void BRDITEMS_PLOTTER::PlotFilledAreas( ZONE_CONTAINER* aZone )
         return;
 
     // We need a buffer to store corners coordinates:
-    static std::vector< wxPoint > cornerList;
-    cornerList.clear();
+    std::vector< wxPoint > cornerList;
 
     m_plotter->SetColor( getColor( aZone->GetLayer() ) );
 
@@ -509,7 +508,12 @@ void BRDITEMS_PLOTTER::PlotFilledAreas( ZONE_CONTAINER* aZone )
      * OR a set of segments ) and plot the thick outline itself
      *
      * in non filled mode the outline is plotted, but not the filling items
+     *
+     * The fractured polygons of the zone do not overlap: they can be plotted
+     * as a single region
      */
+    m_plotter->BeginRegion();
+
     for( SHAPE_POLY_SET::CONST_ITERATOR ic =  polysList.CIterate(); ic; ++ic )
     {
         wxPoint pos( ic->x, ic->y );
@@ -564,6 +568,8 @@ void BRDITEMS_PLOTTER::PlotFilledAreas( ZONE_CONTAINER* aZone )
             cornerList.clear();
         }
     }
+
+    m_plotter->EndRegion();
 }
 
 
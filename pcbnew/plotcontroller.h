@@ -35,6 +35,7 @@
 
 class PLOTTER;
 class BOARD;
+class REPORTER;
 
 
 /**
@@ -83,6 +84,20 @@ public:
      */
     bool PlotLayer();
 
+    /** Plot a set of layers, each one in its own plotfile, using the current
+     * plot options and format. The files are named after the board and the
+     * layer names, like the plot dialog does.
+     * The layers are plotted at the same time by worker threads (each one
+     * with its own plotter), the board is only read while plotting.
+     * @param aLayers is the set of layers to plot
+     * @param aGenDrill is true to also create the Excellon drill files
+     * (metric, decimal format) in the output directory, once the layers are plotted
+     * @param aReporter is an optional reporter for the created files and the
+     * errors. It is only used by the calling thread
+     * @return true if all the plot files were created
+     */
+    bool PlotLayers( LSET aLayers, bool aGenDrill = false, REPORTER* aReporter = NULL );
+
     void SetColorMode( bool aColorMode );
     bool GetColorMode();
 
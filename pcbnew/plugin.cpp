@@ -110,6 +110,13 @@ bool PLUGIN::IsFootprintLibWritable( const wxString& aLibraryPath )
 }
 
 
+size_t PLUGIN::FootprintLibTimestamp( const wxString& aLibraryPath )
+{
+    // Not knowing when a library is modified is not an error.
+    return 0;
+}
+
+
 void PLUGIN::FootprintLibOptions( PROPERTIES* aListToAppendTo ) const
 {
     // disable all these in another couple of months, after everyone has seen them:
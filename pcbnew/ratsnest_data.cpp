@@ -27,11 +27,8 @@
  * @brief Class that computes missing connections on a PCB.
  */
 
-#ifdef USE_OPENMP
-#include <omp.h>
-#endif /* USE_OPENMP */
-
 #include <ratsnest_data.h>
+#include <thread_pool.h>
 
 #include <class_board.h>
 #include <class_module.h>
@@ -54,6 +51,36 @@
 #include <profile.h>
 #endif
 
+/**
+ * Function ratsnestThreadPool
+ * @return the pool running the net updates, shared by the boards so that each board does not
+ * start its own set of threads.  It is created on first use, and only used by the GUI thread.
+ */
+static THREAD_POOL& ratsnestThreadPool()
+{
+    static THREAD_POOL pool;
+
+    return pool;
+}
+
+
+/**
+ * Function recomputeNet
+ * updates the ratsnest of a net.  Nets can be recomputed simultaneously by different threads.
+ */
+static void recomputeNet( RN_NET* aNet )
+{
+    aNet->ClearSimple();
+    aNet->Update();
+}
+
+
+static bool sortNodeCount( const RN_NET* aNet1, const RN_NET* aNet2 )
+{
+    return aNet1->GetNodeCount() < aNet2->GetNodeCount();
+}
+
+
 static uint64_t getDistance( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2 )
 {
     // Drop the least significant bits to avoid overflow
@@ -1230,22 +1257,32 @@ void RN_DATA::Recalculate( int aNet )
     prof_start( &totalRealTime );
 #endif
 
-        unsigned int i;
+        std::vector<RN_NET*> dirtyNets;
 
-#ifdef USE_OPENMP
-        #pragma omp parallel shared(netCount) private(i)
+        // Start with net number 1, as 0 stands for not connected
+        for( unsigned int i = 1; i < netCount; ++i )
         {
-            #pragma omp for schedule(guided, 1)
-#else /* USE_OPENMP */
+            if( m_nets[i].IsDirty() )
+                dirtyNets.push_back( &m_nets[i] );
+        }
+
+        if( dirtyNets.size() == 1 )
         {
-#endif
-            // Start with net number 1, as 0 stands for not connected
-            for( i = 1; i < netCount; ++i )
-            {
-                if( m_nets[i].IsDirty() )
-                    updateNet( i );
-            }
-        }  /* end of parallel section */
+            recomputeNet( dirtyNets[0] );
+        }
+        else if( !dirtyNets.empty() )
+        {
+            THREAD_POOL& pool = ratsnestThreadPool();
+
+            // The workers run the most recently queued tasks first, so queue the biggest
+            // nets last: they are started first and do not end up running alone
+            std::sort( dirtyNets.begin(), dirtyNets.end(), sortNodeCount );
+
+            for( unsigned int i = 0; i < dirtyNets.size(); ++i )
+                pool.Submit( boost::bind( recomputeNet, dirtyNets[i] ) );
+
+            pool.Wait();
+        }
 #ifdef PROFILE
     prof_end( &totalRealTime );
 
@@ -1266,6 +1303,5 @@ void RN_DATA::updateNet( int aNetCode )
     if( aNetCode < 1 || aNetCode > (int) m_nets.size() )
         return;
 
-    m_nets[aNetCode].ClearSimple();
-    m_nets[aNetCode].Update();
+    recomputeNet( &m_nets[aNetCode] );
 }
@@ -363,6 +363,15 @@ public:
         return m_dirty;
     }
 
+    /**
+     * Function GetNodeCount()
+     * Returns the number of nodes of the net, which gives an idea of the cost of an update.
+     */
+    unsigned int GetNodeCount() const
+    {
+        return m_links.GetNodes().size();
+    }
+
     /**
      * Function GetUnconnected()
      * Returns pointer to a vector of edges that makes ratsnest for a given net.
@@ -632,6 +641,10 @@ protected:
  * Class RN_DATA
  *
  * Stores information about unconnected items for a board.
+ *
+ * The nets share no data, so the dirty nets are recomputed in parallel by Recalculate().
+ * An RN_NET must not be modified or read while it is being updated: Recalculate() returns
+ * only when all the nets are done, so the ratsnest is drawn once, when it is complete.
  */
 class RN_DATA
 {
@@ -699,6 +712,7 @@ public:
     /**
      * Function Recalculate()
      * Recomputes ratsnest for selected net number or all nets that need updating.
+     * The nets are updated in parallel, by a thread pool shared by all the boards.
      * @param aNet is a net number. If it is negative, all nets that need updating are recomputed.
      */
     void Recalculate( int aNet = -1 );
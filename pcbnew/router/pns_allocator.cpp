@@ -0,0 +1,377 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+#include <algorithm>
+
+#include <boost/thread/tss.hpp>
+
+#include <ki_mutex.h>
+
+#include "pns_allocator.h"
+
+// Block sizes are rounded up to this value, which is also the alignment of the blocks
+static const size_t Granularity = 16;
+static const size_t SizeClasses = PNS_ALLOCATOR::MaxPooledSize / Granularity;
+
+// Size of the chunks the blocks are carved from
+static const size_t ChunkSize = 64 * 1024;
+
+// Number of blocks moved at once between a thread cache and the shared pool
+static const int BatchSize = 32;
+
+struct FREE_BLOCK
+{
+    FREE_BLOCK* m_next;
+};
+
+/**
+ * Struct THREAD_CACHE
+ *
+ * Free lists and counters of a thread, used without locking. A block may be freed by
+ * another thread than the one which allocated it, so the counts of a single cache may
+ * be negative: only their sum over all the caches is meaningful.
+ */
+struct THREAD_CACHE
+{
+    THREAD_CACHE() :
+        m_pooledLive( 0 )
+    {
+        memset( m_freeLists, 0, sizeof( m_freeLists ) );
+        memset( m_freeCounts, 0, sizeof( m_freeCounts ) );
+        memset( &m_stats, 0, sizeof( m_stats ) );
+    }
+
+    FREE_BLOCK*         m_freeLists[SizeClasses];
+    int                 m_freeCounts[SizeClasses];
+    int                 m_pooledLive;
+    PNS_ALLOC_STATS     m_stats;        ///< step counters and m_live only
+};
+
+struct PNS_POOL
+{
+    PNS_POOL() :
+        m_bump( NULL ),
+        m_bumpEnd( NULL ),
+        m_retiredPooledLive( 0 ),
+        m_peakLive( 0 ),
+        m_poolSize( 0 )
+    {
+        memset( m_freeLists, 0, sizeof( m_freeLists ) );
+        memset( &m_retiredStats, 0, sizeof( m_retiredStats ) );
+    }
+
+    MUTEX                       m_lock;
+    FREE_BLOCK*                 m_freeLists[SizeClasses];
+    std::vector<char*>          m_chunks;
+    char*                       m_bump;
+    char*                       m_bumpEnd;
+    std::vector<THREAD_CACHE*>  m_caches;
+    int                         m_retiredPooledLive;    ///< of the threads which have exited
+    PNS_ALLOC_STATS             m_retiredStats;
+    int                         m_peakLive;
+    size_t                      m_poolSize;
+};
+
+static PNS_POOL pool;
+
+static void releaseCache( THREAD_CACHE* aCache );
+
+// Must be destroyed before the pool, as it releases the cache of the main thread
+static boost::thread_specific_ptr<THREAD_CACHE> threadCache( releaseCache );
+
+
+static inline size_t sizeClass( size_t aSize )
+{
+    return aSize ? ( aSize - 1 ) / Granularity : 0;
+}
+
+
+static THREAD_CACHE& getCache()
+{
+    THREAD_CACHE* cache = threadCache.get();
+
+    if( !cache )
+    {
+        cache = new THREAD_CACHE;
+        threadCache.reset( cache );
+
+        MUTLOCK lock( pool.m_lock );
+        pool.m_caches.push_back( cache );
+    }
+
+    return *cache;
+}
+
+
+static void addStats( PNS_ALLOC_STATS& aSum, const PNS_ALLOC_STATS& aStats )
+{
+    aSum.m_stepAllocs += aStats.m_stepAllocs;
+    aSum.m_stepFrees += aStats.m_stepFrees;
+    aSum.m_stepBranches += aStats.m_stepBranches;
+    aSum.m_stepIndexCopies += aStats.m_stepIndexCopies;
+    aSum.m_stepCollisionQueries += aStats.m_stepCollisionQueries;
+    aSum.m_stepShoveIterations += aStats.m_stepShoveIterations;
+    aSum.m_live += aStats.m_live;
+}
+
+
+static void resetStepStats( PNS_ALLOC_STATS& aStats )
+{
+    aStats.m_stepAllocs = 0;
+    aStats.m_stepFrees = 0;
+    aStats.m_stepBranches = 0;
+    aStats.m_stepIndexCopies = 0;
+    aStats.m_stepCollisionQueries = 0;
+    aStats.m_stepShoveIterations = 0;
+}
+
+
+// Moves up to aCount free blocks of a size class from aCache to the shared pool.
+// The pool must be locked.
+static void drainLocked( THREAD_CACHE& aCache, size_t aClass, int aCount )
+{
+    while( aCount-- > 0 && aCache.m_freeLists[aClass] )
+    {
+        FREE_BLOCK* block = aCache.m_freeLists[aClass];
+
+        aCache.m_freeLists[aClass] = block->m_next;
+        aCache.m_freeCounts[aClass]--;
+
+        block->m_next = pool.m_freeLists[aClass];
+        pool.m_freeLists[aClass] = block;
+    }
+}
+
+
+static void releaseCache( THREAD_CACHE* aCache )
+{
+    MUTLOCK lock( pool.m_lock );
+
+    for( size_t cls = 0; cls < SizeClasses; ++cls )
+        drainLocked( *aCache, cls, aCache->m_freeCounts[cls] );
+
+    pool.m_retiredPooledLive += aCache->m_pooledLive;
+    addStats( pool.m_retiredStats, aCache->m_stats );
+
+    pool.m_caches.erase( std::find( pool.m_caches.begin(), pool.m_caches.end(), aCache ) );
+    delete aCache;
+}
+
+
+// Gives aCache up to BatchSize free blocks of a size class, taken from the shared free
+// list or carved from the current chunk.
+static void refill( THREAD_CACHE& aCache, size_t aClass )
+{
+    size_t  blockSize = ( aClass + 1 ) * Granularity;
+    MUTLOCK lock( pool.m_lock );
+
+    for( int i = 0; i < BatchSize; ++i )
+    {
+        FREE_BLOCK* block = pool.m_freeLists[aClass];
+
+        if( block )
+        {
+            pool.m_freeLists[aClass] = block->m_next;
+        }
+        else
+        {
+            // Carve the rest of the batch, but only start a chunk if nothing was found
+            if( pool.m_bump + blockSize > pool.m_bumpEnd )
+            {
+                if( i > 0 )
+                    break;
+
+                // malloc() returns memory aligned for any type, and the blocks keep that
+                // alignment as their sizes are multiples of Granularity.
+                char* chunk = (char*) malloc( ChunkSize );
+
+                if( !chunk )
+                    throw std::bad_alloc();
+
+                pool.m_chunks.push_back( chunk );
+                pool.m_poolSize += ChunkSize;
+                pool.m_bump = chunk;
+                pool.m_bumpEnd = chunk + ChunkSize;
+            }
+
+            block = reinterpret_cast<FREE_BLOCK*>( pool.m_bump );
+            pool.m_bump += blockSize;
+        }
+
+        block->m_next = aCache.m_freeLists[aClass];
+        aCache.m_freeLists[aClass] = block;
+        aCache.m_freeCounts[aClass]++;
+    }
+}
+
+
+void* PNS_ALLOCATOR::Alloc( size_t aSize )
+{
+    THREAD_CACHE& cache = getCache();
+    void*         p;
+
+    if( aSize > MaxPooledSize )
+    {
+        p = ::operator new( aSize );
+    }
+    else
+    {
+        size_t cls = sizeClass( aSize );
+
+        if( !cache.m_freeLists[cls] )
+            refill( cache, cls );
+
+        FREE_BLOCK* block = cache.m_freeLists[cls];
+
+        cache.m_freeLists[cls] = block->m_next;
+        cache.m_freeCounts[cls]--;
+        cache.m_pooledLive++;
+        p = block;
+    }
+
+    cache.m_stats.m_stepAllocs++;
+    cache.m_stats.m_live++;
+
+    return p;
+}
+
+
+void PNS_ALLOCATOR::Free( void* aPtr, size_t aSize )
+{
+    if( !aPtr )
+        return;
+
+    THREAD_CACHE& cache = getCache();
+
+    cache.m_stats.m_stepFrees++;
+    cache.m_stats.m_live--;
+
+    if( aSize > MaxPooledSize )
+    {
+        ::operator delete( aPtr );
+        return;
+    }
+
+    FREE_BLOCK* block = static_cast<FREE_BLOCK*>( aPtr );
+    size_t      cls = sizeClass( aSize );
+
+    block->m_next = cache.m_freeLists[cls];
+    cache.m_freeLists[cls] = block;
+    cache.m_freeCounts[cls]++;
+    cache.m_pooledLive--;
+
+    // Give the surplus back, so that a thread freeing the objects of another one
+    // does not keep growing its cache
+    if( cache.m_freeCounts[cls] > 2 * BatchSize )
+    {
+        MUTLOCK lock( pool.m_lock );
+        drainLocked( cache, cls, BatchSize );
+    }
+}
+
+
+bool PNS_ALLOCATOR::Purge()
+{
+    MUTLOCK lock( pool.m_lock );
+
+    int pooledLive = pool.m_retiredPooledLive;
+
+    for( unsigned i = 0; i < pool.m_caches.size(); ++i )
+        pooledLive += pool.m_caches[i]->m_pooledLive;
+
+    if( pooledLive )
+        return false;
+
+    for( unsigned i = 0; i < pool.m_chunks.size(); ++i )
+        free( pool.m_chunks[i] );
+
+    for( unsigned i = 0; i < pool.m_caches.size(); ++i )
+    {
+        memset( pool.m_caches[i]->m_freeLists, 0, sizeof( pool.m_caches[i]->m_freeLists ) );
+        memset( pool.m_caches[i]->m_freeCounts, 0, sizeof( pool.m_caches[i]->m_freeCounts ) );
+    }
+
+    pool.m_chunks.clear();
+    memset( pool.m_freeLists, 0, sizeof( pool.m_freeLists ) );
+    pool.m_bump = pool.m_bumpEnd = NULL;
+    pool.m_poolSize = 0;
+
+    return true;
+}
+
+
+void PNS_ALLOCATOR::CountBranch()
+{
+    getCache().m_stats.m_stepBranches++;
+}
+
+
+void PNS_ALLOCATOR::CountIndexCopy()
+{
+    getCache().m_stats.m_stepIndexCopies++;
+}
+
+
+void PNS_ALLOCATOR::CountCollisionQuery()
+{
+    getCache().m_stats.m_stepCollisionQueries++;
+}
+
+
+void PNS_ALLOCATOR::CountShoveIteration()
+{
+    getCache().m_stats.m_stepShoveIterations++;
+}
+
+
+void PNS_ALLOCATOR::ResetStepStats()
+{
+    MUTLOCK lock( pool.m_lock );
+
+    resetStepStats( pool.m_retiredStats );
+
+    for( unsigned i = 0; i < pool.m_caches.size(); ++i )
+        resetStepStats( pool.m_caches[i]->m_stats );
+}
+
+
+PNS_ALLOC_STATS PNS_ALLOCATOR::GetStats()
+{
+    MUTLOCK lock( pool.m_lock );
+
+    PNS_ALLOC_STATS stats = pool.m_retiredStats;
+
+    for( unsigned i = 0; i < pool.m_caches.size(); ++i )
+        addStats( stats, pool.m_caches[i]->m_stats );
+
+    pool.m_peakLive = std::max( pool.m_peakLive, stats.m_live );
+
+    stats.m_peakLive = pool.m_peakLive;
+    stats.m_poolSize = pool.m_poolSize;
+
+    return stats;
+}
@@ -0,0 +1,122 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __PNS_ALLOCATOR_H
+#define __PNS_ALLOCATOR_H
+
+#include <cstddef>
+
+/**
+ * Struct PNS_ALLOC_STATS
+ *
+ * Allocation and work counters of the router. The step counters are reset at the
+ * beginning of each routing step (mouse move), the others live as long as the allocator.
+ */
+struct PNS_ALLOC_STATS
+{
+    ///> items and nodes allocated/freed during the current step
+    int m_stepAllocs;
+    int m_stepFrees;
+
+    ///> nodes branched and branch indices copied on write during the current step
+    int m_stepBranches;
+    int m_stepIndexCopies;
+
+    ///> spatial index queries for colliding items, and shove loop iterations
+    int m_stepCollisionQueries;
+    int m_stepShoveIterations;
+
+    ///> allocated objects, now and at most (as seen by the GetStats() calls)
+    int m_live;
+    int m_peakLive;
+
+    ///> memory reserved for the pooled objects, in bytes
+    size_t m_poolSize;
+};
+
+
+/**
+ * Class PNS_ALLOCATOR
+ *
+ * Memory pool for the router items and nodes, used through their class-specific
+ * operator new/delete. Shove and walkaround clone and discard many items per mouse move:
+ * the pool serves them from per-size free lists refilled by bumping a pointer through
+ * big chunks, so that neither allocating nor freeing goes to the system heap.
+ *
+ * Each thread allocates from and frees to its own free lists, without locking, and
+ * exchanges blocks with the shared pool by batches only. The statistics are counted per
+ * thread too, and summed by GetStats().
+ *
+ * The chunks are only given back to the system by Purge(), when the router world is
+ * cleared and no pooled object is alive anymore. Objects bigger than MaxPooledSize
+ * bytes go to the regular heap. All the functions are thread safe, but Purge() and
+ * ResetStepStats() must not run while other threads are routing.
+ */
+class PNS_ALLOCATOR
+{
+public:
+    static const size_t MaxPooledSize = 1024;
+
+    /**
+     * Function Alloc()
+     *
+     * Returns a block of at least aSize bytes, aligned for any object type.
+     */
+    static void* Alloc( size_t aSize );
+
+    /**
+     * Function Free()
+     *
+     * Returns a block obtained from Alloc() to the pool. aSize must be the size
+     * passed to Alloc().
+     */
+    static void Free( void* aPtr, size_t aSize );
+
+    /**
+     * Function Purge()
+     *
+     * Gives the memory of the pool back to the system, if no pooled object is alive.
+     * @return true if the memory was released.
+     */
+    static bool Purge();
+
+    ///> Counts a PNS_NODE::Branch() call in the step statistics
+    static void CountBranch();
+
+    ///> Counts a copy-on-write of a branch index in the step statistics
+    static void CountIndexCopy();
+
+    ///> Counts a PNS_NODE::QueryColliding() call in the step statistics
+    static void CountCollisionQuery();
+
+    ///> Counts an iteration of the shove loop in the step statistics
+    static void CountShoveIteration();
+
+    ///> Resets the step counters, at the beginning of a routing step
+    static void ResetStepStats();
+
+    ///> Returns the counters, summed over all the threads
+    static PNS_ALLOC_STATS GetStats();
+};
+
+#endif
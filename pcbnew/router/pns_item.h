@@ -29,6 +29,7 @@
 #include "trace.h"
 
 #include "pns_layerset.h"
+#include "pns_allocator.h"
 
 class BOARD_CONNECTED_ITEM;
 class PNS_NODE;
@@ -89,6 +90,17 @@ public:
 
     virtual ~PNS_ITEM();
 
+    ///> Items are cloned and discarded at a high rate while routing: take them from the pool
+    static void* operator new( size_t aSize )
+    {
+        return PNS_ALLOCATOR::Alloc( aSize );
+    }
+
+    static void operator delete( void* aPtr, size_t aSize )
+    {
+        PNS_ALLOCATOR::Free( aPtr, aSize );
+    }
+
     /**
      * Function Clone()
      *
@@ -136,6 +136,20 @@ void PNS_LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void PNS_LOGGER::LogEvent( const std::string& aType, const VECTOR2I& aPos, int aArg,
+                           const PNS_ITEM* aItem )
+{
+    m_theLog << "event " << aType << " " << aPos.x << " " << aPos.y << " " << aArg << " ";
+
+    if( aItem )
+        m_theLog << aItem->Kind() << " " << aItem->Net() << " " << aItem->Layers().Start();
+    else
+        m_theLog << "0 -1 -1";
+
+    m_theLog << std::endl;
+}
+
+
 void PNS_LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
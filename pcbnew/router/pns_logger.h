@@ -49,6 +49,17 @@ public:
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string aName = std::string() );
 
+    /**
+     * Function LogEvent()
+     *
+     * Records a router input event (start, move, fix...) as a line:
+     * "event type x y arg item_kind item_net item_layer", so that a routing session can be
+     * replayed outside of the GUI (see tools/pns_router_benchmark.cpp). The item fields
+     * are 0, -1 and -1 when aItem is NULL.
+     */
+    void LogEvent( const std::string& aType, const VECTOR2I& aPos, int aArg = 0,
+                   const PNS_ITEM* aItem = NULL );
+
 private:
     void dumpShape( const SHAPE* aSh );
 
@@ -53,7 +53,7 @@ PNS_NODE::PNS_NODE()
     m_parent = NULL;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_clearanceFunctor = NULL;
-    m_index = new PNS_INDEX;
+    m_index.reset( new PNS_INDEX );
     m_collisionFilter = NULL;
 
 #ifdef DEBUG
@@ -92,8 +92,6 @@ PNS_NODE::~PNS_NODE()
 
     releaseGarbage();
     unlinkParent();
-
-    delete m_index;
 }
 
 int PNS_NODE::GetClearance( const PNS_ITEM* aA, const PNS_ITEM* aB ) const
@@ -111,6 +109,8 @@ PNS_NODE* PNS_NODE::Branch()
 
     TRACE( 0, "PNS_NODE::branch %p (parent %p)", child % this );
 
+    PNS_ALLOCATOR::CountBranch();
+
     m_children.insert( child );
 
     child->m_depth = m_depth + 1;
@@ -120,15 +120,12 @@ PNS_NODE* PNS_NODE::Branch()
     child->m_collisionFilter = m_collisionFilter;
 
     // immmediate offspring of the root branch needs not copy anything.
-    // For the rest, deep-copy joints, overridden item map and pointers
-    // to stored items.
+    // For the rest, deep-copy joints and overridden item map. The index of
+    // stored items is shared until either node modifies it: many branches
+    // are discarded without that ever happening.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-            child->m_index->Add( *i );
-
+        child->m_index = m_index;
         child->m_joints = m_joints;
         child->m_override = m_override;
     }
@@ -140,6 +137,24 @@ PNS_NODE* PNS_NODE::Branch()
 }
 
 
+PNS_INDEX* PNS_NODE::writableIndex()
+{
+    if( !m_index.unique() )
+    {
+        boost::shared_ptr<PNS_INDEX> copy( new PNS_INDEX );
+
+        for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+            copy->Add( *i );
+
+        m_index = copy;
+
+        PNS_ALLOCATOR::CountIndexCopy();
+    }
+
+    return m_index.get();
+}
+
+
 void PNS_NODE::unlinkParent()
 {
     if( isRoot() )
@@ -181,6 +196,10 @@ struct PNS_NODE::OBSTACLE_VISITOR
 
     int m_forceClearance;
 
+    ///> bounding box of m_item (and of the via ending it), for the fast rejection test
+    BOX2I m_itemBBox;
+    bool m_useBBox;
+
     OBSTACLE_VISITOR( PNS_NODE::OBSTACLES& aTab, const PNS_ITEM* aItem, int aKindMask, bool aDifferentNetsOnly ) :
         m_node( NULL ),
         m_override( NULL ),
@@ -195,6 +214,41 @@ struct PNS_NODE::OBSTACLE_VISITOR
     {
        if( aItem->Kind() == PNS_ITEM::LINE )
             m_extraClearance += static_cast<const PNS_LINE*>( aItem )->Width() / 2;
+
+        const SHAPE* shape = aItem->Shape();
+
+        m_useBBox = ( shape != NULL );
+
+        if( m_useBBox )
+        {
+            m_itemBBox = shape->BBox();
+            m_itemBBox.Normalize();
+
+            // PNS_ITEM::Collide() also tests the via at the end of a line
+            if( aItem->Kind() == PNS_ITEM::LINE )
+            {
+                const PNS_LINE* line = static_cast<const PNS_LINE*>( aItem );
+
+                if( line->EndsWithVia() )
+                    m_itemBBox.Merge( line->Via().Shape()->BBox() );
+            }
+        }
+    }
+
+    ///> returns true if aItem is too far from m_item to collide with aClearance
+    bool farApart( const PNS_ITEM* aItem, int aClearance ) const
+    {
+        const SHAPE* shape = aItem->Shape();
+
+        if( !m_useBBox || !shape )
+            return false;
+
+        BOX2I bbox = shape->BBox();
+        bbox.Normalize();
+
+        BOX2I::ecoord_type maxDist = aClearance;
+
+        return m_itemBBox.SquaredDistance( bbox ) > maxDist * maxDist;
     }
 
     void SetCountLimit( int aLimit )
@@ -229,6 +283,12 @@ struct PNS_NODE::OBSTACLE_VISITOR
         if( m_forceClearance >= 0 )
             clearance = m_forceClearance;
 
+        // The index is searched with the worst case clearance of the board, so most of
+        // the items found are farther away than the actual clearance: reject them on their
+        // bounding boxes before the exact shape test.
+        if( farApart( aItem, clearance ) )
+            return true;
+
         if( !aItem->Collide( m_item, clearance, m_differentNetsOnly ) )
             return true;
 
@@ -257,6 +317,8 @@ int PNS_NODE::QueryColliding( const PNS_ITEM* aItem,
     assert( allocNodes.find( this ) != allocNodes.end() );
 #endif
 
+    PNS_ALLOCATOR::CountCollisionQuery();
+
     visitor.SetCountLimit( aLimitCount );
     visitor.SetWorld( this, NULL );
     visitor.m_forceClearance = aForceClearance;
@@ -507,14 +569,14 @@ const PNS_ITEMSET PNS_NODE::HitTest( const VECTOR2I& aPoint ) const
 void PNS_NODE::addSolid( PNS_SOLID* aSolid )
 {
     linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
-    m_index->Add( aSolid );
+    writableIndex()->Add( aSolid );
 }
 
 
 void PNS_NODE::addVia( PNS_VIA* aVia )
 {
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
-    m_index->Add( aVia );
+    writableIndex()->Add( aVia );
 }
 
 
@@ -549,7 +611,7 @@ void PNS_NODE::addLine( PNS_LINE* aLine, bool aAllowRedundant )
 
                 aLine->LinkSegment( pseg );
 
-                m_index->Add( pseg );
+                writableIndex()->Add( pseg );
             }
         }
     }
@@ -572,7 +634,7 @@ void PNS_NODE::addSegment( PNS_SEGMENT* aSeg, bool aAllowRedundant )
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
-    m_index->Add( aSeg );
+    writableIndex()->Add( aSeg );
 }
 
 
@@ -614,7 +676,7 @@ void PNS_NODE::doRemove( PNS_ITEM* aItem )
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
     else if( !aItem->BelongsTo( m_root ) || isRoot() )
-        m_index->Remove( aItem );
+        writableIndex()->Remove( aItem );
 
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
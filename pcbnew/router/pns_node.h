@@ -27,6 +27,7 @@
 #include <boost/unordered_set.hpp>
 #include <boost/unordered_map.hpp>
 #include <boost/optional.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
@@ -141,6 +142,16 @@ public:
     PNS_NODE();
     ~PNS_NODE();
 
+    static void* operator new( size_t aSize )
+    {
+        return PNS_ALLOCATOR::Alloc( aSize );
+    }
+
+    static void operator delete( void* aPtr, size_t aSize )
+    {
+        PNS_ALLOCATOR::Free( aPtr, aSize );
+    }
+
     ///> Returns the expected clearance between items a and b.
     int GetClearance( const PNS_ITEM* aA, const PNS_ITEM* aB ) const;
 
@@ -421,6 +432,7 @@ private:
     void removeVia( PNS_VIA* aVia );
 
     void doRemove( PNS_ITEM* aItem );
+    PNS_INDEX* writableIndex();
     void unlinkParent();
     void releaseChildren();
     void releaseGarbage();
@@ -470,8 +482,9 @@ private:
     ///> Clearance resolution functor
     PNS_CLEARANCE_FUNC* m_clearanceFunctor;
 
-    ///> Geometric/Net index of the items
-    PNS_INDEX* m_index;
+    ///> Geometric/Net index of the items. Branches of non-root nodes share the index of
+    ///> their parent until one of them modifies it (see writableIndex()).
+    boost::shared_ptr<PNS_INDEX> m_index;
 
     ///> depth of the node (number of parent nodes in the inheritance chain)
     int m_depth;
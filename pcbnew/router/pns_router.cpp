@@ -23,6 +23,9 @@
 
 #include <boost/foreach.hpp>
 
+#include <wx/filename.h>
+#include <wx/utils.h>
+
 #include <view/view.h>
 #include <view/view_item.h>
 #include <view/view_group.h>
@@ -36,6 +39,7 @@
 #include <geometry/shape_circle.h>
 
 #include "trace.h"
+#include "pns_allocator.h"
 #include "pns_node.h"
 #include "pns_line_placer.h"
 #include "pns_line.h"
@@ -52,6 +56,7 @@
 
 #include <router/router_preview_item.h>
 
+#include <macros.h>
 #include <class_board.h>
 #include <class_board_connected_item.h>
 #include <class_module.h>
@@ -109,26 +114,28 @@ PNS_PCBNEW_CLEARANCE_FUNC::~PNS_PCBNEW_CLEARANCE_FUNC()
 
 int PNS_PCBNEW_CLEARANCE_FUNC::localPadClearance( const PNS_ITEM* aItem ) const
 {
-    if( !aItem->Parent() || aItem->Parent()->Type() != PCB_PAD_T )
+    // Pads are the only items having a local clearance. It is cached in the solid,
+    // to avoid touching the board item for each of the many clearance requests.
+    if( aItem->Kind() != PNS_ITEM::SOLID )
         return 0;
 
-    const D_PAD* pad = static_cast<D_PAD*>( aItem->Parent() );
-    return pad->GetLocalClearance();
+    return static_cast<const PNS_SOLID*>( aItem )->LocalClearance();
 }
 
 
 int PNS_PCBNEW_CLEARANCE_FUNC::operator()( const PNS_ITEM* aA, const PNS_ITEM* aB )
 {
     int net_a = aA->Net();
-    int cl_a = ( net_a >= 0 ? m_clearanceCache[net_a].clearance : m_defaultClearance );
     int net_b = aB->Net();
-    int cl_b = ( net_b >= 0 ? m_clearanceCache[net_b].clearance : m_defaultClearance );
-
-    bool linesOnly = aA->OfKind( PNS_ITEM::SEGMENT | PNS_ITEM::LINE ) && aB->OfKind( PNS_ITEM::SEGMENT | PNS_ITEM::LINE );
 
     if( net_a == net_b )
         return 0;
 
+    int cl_a = ( net_a >= 0 ? m_clearanceCache[net_a].clearance : m_defaultClearance );
+    int cl_b = ( net_b >= 0 ? m_clearanceCache[net_b].clearance : m_defaultClearance );
+
+    bool linesOnly = aA->OfKind( PNS_ITEM::SEGMENT | PNS_ITEM::LINE ) && aB->OfKind( PNS_ITEM::SEGMENT | PNS_ITEM::LINE );
+
     if( m_useDpGap && linesOnly && net_a >= 0 && net_b >= 0 && m_clearanceCache[net_a].coupledNet == net_b )
     {
         cl_a = cl_b = m_router->Sizes().DiffPairGap() - 2 * PNS_HULL_MARGIN;
@@ -200,6 +207,7 @@ PNS_ITEM* PNS_ROUTER::syncPad( D_PAD* aPad )
     solid->SetLayers( layers );
     solid->SetNet( aPad->GetNetCode() );
     solid->SetParent( aPad );
+    solid->SetLocalClearance( aPad->GetLocalClearance() );
 
     wxPoint wx_c = aPad->ShapePos();
     wxSize  wx_sz = aPad->GetSize();
@@ -401,6 +409,9 @@ void PNS_ROUTER::SyncWorld()
 
     ClearWorld();
 
+    // The recorded events only make sense for the board state they were applied to
+    m_eventLog.Clear();
+
     m_world = new PNS_NODE();
 
     for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
@@ -460,6 +471,8 @@ PNS_ROUTER::PNS_ROUTER()
     m_snappingEnabled  = false;
     m_violation = false;
 
+    if( !wxGetEnv( wxT( "KICAD_PNS_EVENT_LOG" ), &m_eventLogName ) )
+        m_eventLogName.Clear();
 }
 
 
@@ -516,6 +529,9 @@ void PNS_ROUTER::ClearWorld()
     m_world = NULL;
     m_placer = NULL;
     m_previewItems = NULL;
+
+    // Give the pool memory back if no router object remains allocated
+    PNS_ALLOCATOR::Purge();
 }
 
 
@@ -592,6 +608,9 @@ bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
     if( !aStartItem || aStartItem->OfKind( PNS_ITEM::SOLID ) )
         return false;
 
+    logSessionStart();
+    logEvent( "drag", aP, 0, aStartItem );
+
     m_dragger = new PNS_DRAGGER( this );
     m_dragger->SetWorld( m_world );
 
@@ -607,8 +626,36 @@ bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
     return true;
 }
 
+void PNS_ROUTER::logEvent( const std::string& aType, const VECTOR2I& aPos, int aArg,
+                           const PNS_ITEM* aItem )
+{
+    if( m_eventLogName.IsEmpty() )
+        return;
+
+    m_eventLog.LogEvent( aType, aPos, aArg, aItem );
+}
+
+
+void PNS_ROUTER::logSessionStart()
+{
+    if( m_eventLogName.IsEmpty() )
+        return;
+
+    VECTOR2I origin;
+
+    logEvent( "mode", origin, m_mode );
+    logEvent( "rmode", origin, m_settings.Mode() );
+    logEvent( "width", origin, m_sizes.TrackWidth() );
+    logEvent( "via_diameter", origin, m_sizes.ViaDiameter() );
+    logEvent( "via_drill", origin, m_sizes.ViaDrill() );
+}
+
+
 bool PNS_ROUTER::StartRouting( const VECTOR2I& aP, PNS_ITEM* aStartItem, int aLayer )
 {
+    logSessionStart();
+    logEvent( "start", aP, aLayer, aStartItem );
+
     m_clearanceFunc->UseDpGap( false );
 
     switch( m_mode )
@@ -674,6 +721,10 @@ void PNS_ROUTER::eraseView()
 
 void PNS_ROUTER::DisplayItem( const PNS_ITEM* aItem, int aColor, int aClearance )
 {
+    // Headless router (no view attached)
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_previewItems );
 
     if( aColor >= 0 )
@@ -698,6 +749,9 @@ void PNS_ROUTER::DisplayItems( const PNS_ITEMSET& aItems )
 
 void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Line( aLine, aWidth, aType );
@@ -709,6 +763,9 @@ void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int
 
 void PNS_ROUTER::DisplayDebugPoint( const VECTOR2I aPos, int aType )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Point( aPos, aType );
@@ -723,6 +780,10 @@ void PNS_ROUTER::Move( const VECTOR2I& aP, PNS_ITEM* endItem )
     m_currentEnd = aP;
     m_currentEndItem = endItem;
 
+    logEvent( "move", aP, 0, endItem );
+
+    PNS_ALLOCATOR::ResetStepStats();
+
     switch( m_state )
     {
         case ROUTE_TRACK:
@@ -736,6 +797,14 @@ void PNS_ROUTER::Move( const VECTOR2I& aP, PNS_ITEM* endItem )
         default:
             break;
     }
+
+    PNS_ALLOC_STATS stats = PNS_ALLOCATOR::GetStats();
+
+    TRACE( 1, "step: %d allocs, %d frees, %d branches, %d index copies, %d live objects, "
+           "%d collision queries, %d shove iterations",
+           stats.m_stepAllocs % stats.m_stepFrees % stats.m_stepBranches %
+           stats.m_stepIndexCopies % stats.m_live % stats.m_stepCollisionQueries %
+           stats.m_stepShoveIterations );
 }
 
 
@@ -866,7 +935,9 @@ void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
 
         if( parent )
         {
-            m_view->Remove( parent );
+            if( m_view )
+                m_view->Remove( parent );
+
             m_board->Remove( parent );
             m_undoBuffer.PushItem( ITEM_PICKER( parent, UR_DELETED ) );
         }
@@ -916,7 +987,9 @@ void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
         {
             item->SetParent( newBI );
             newBI->ClearFlags();
-            m_view->Add( newBI );
+            if( m_view )
+                m_view->Add( newBI );
+
             m_board->Add( newBI );
             m_undoBuffer.PushItem( ITEM_PICKER( newBI, UR_NEW ) );
             newBI->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
@@ -932,6 +1005,8 @@ bool PNS_ROUTER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
 {
     bool rv = false;
 
+    logEvent( "fix", aP, 0, aEndItem );
+
     switch( m_state )
     {
         case ROUTE_TRACK:
@@ -972,6 +1047,8 @@ void PNS_ROUTER::StopRouting()
     if( !RoutingInProgress() )
         return;
 
+    logEvent( "stop", m_currentEnd );
+
     if( m_placer )
         delete m_placer;
 
@@ -993,6 +1070,7 @@ void PNS_ROUTER::FlipPosture()
 {
     if( m_state == ROUTE_TRACK )
     {
+        logEvent( "posture", m_currentEnd );
         m_placer->FlipPosture();
         movePlacing ( m_currentEnd, m_currentEndItem );
     }
@@ -1004,6 +1082,7 @@ void PNS_ROUTER::SwitchLayer( int aLayer )
     switch( m_state )
     {
         case ROUTE_TRACK:
+            logEvent( "layer", m_currentEnd, aLayer );
             m_placer->SetLayer( aLayer );
             break;
         default:
@@ -1016,6 +1095,8 @@ void PNS_ROUTER::ToggleViaPlacement()
 {
     if( m_state == ROUTE_TRACK )
     {
+        logEvent( "via", m_currentEnd );
+
         bool toggle = !m_placer->IsPlacingVia();
         m_placer->ToggleVia( toggle );
     }
@@ -1058,7 +1139,23 @@ void PNS_ROUTER::DumpLog()
     }
 
     if( logger )
-        logger->Save( "/tmp/shove.log" );
+    {
+        wxFileName fn( wxFileName::GetTempDir(), wxT( "shove.log" ) );
+
+        logger->Save( TO_UTF8( fn.GetFullPath() ) );
+    }
+
+    // the events since the last SyncWorld(), to replay with pns_router_benchmark, only
+    // when asked for: KICAD_PNS_EVENT_LOG is the file name, relative to the temp directory
+    if( !m_eventLogName.IsEmpty() )
+    {
+        wxFileName fn( m_eventLogName );
+
+        if( fn.IsRelative() )
+            fn.MakeAbsolute( wxFileName::GetTempDir() );
+
+        m_eventLog.Save( TO_UTF8( fn.GetFullPath() ) );
+    }
 }
 
 
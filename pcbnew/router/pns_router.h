@@ -34,6 +34,7 @@
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_logger.h"
 
 class BOARD;
 class BOARD_ITEM;
@@ -131,6 +132,13 @@ public:
     int GetCurrentLayer() const;
     const std::vector<int> GetCurrentNets() const;
 
+    /**
+     * Function DumpLog()
+     *
+     * Saves the shove/drag log to shove.log in the temporary directory, and the input
+     * events since the last SyncWorld() to the file named by the KICAD_PNS_EVENT_LOG
+     * environment variable, if it was set when the router was created.
+     */
     void DumpLog();
 
     PNS_CLEARANCE_FUNC* GetClearanceFunc() const
@@ -246,6 +254,13 @@ private:
 
     void highlightCurrent( bool enabled );
 
+    ///> records the router mode and sizes used by a new routing or drag session
+    void logSessionStart();
+
+    ///> records an input event, if the event log is enabled
+    void logEvent( const std::string& aType, const VECTOR2I& aPos, int aArg = 0,
+                   const PNS_ITEM* aItem = NULL );
+
     void markViolations( PNS_NODE* aNode, PNS_ITEMSET& aCurrent, PNS_NODE::ITEM_VECTOR& aRemoved );
 
     VECTOR2I m_currentEnd;
@@ -278,6 +293,13 @@ private:
 
     ///> Stores list of modified items in the current operation
     PICKED_ITEMS_LIST m_undoBuffer;
+
+    ///> input events received since the last SyncWorld()
+    PNS_LOGGER m_eventLog;
+
+    ///> KICAD_PNS_EVENT_LOG, read once: the events are recorded only when it is set
+    wxString m_eventLogName;
+
     PNS_SIZES_SETTINGS m_sizes;
     PNS_ROUTER_MODE m_mode;
 
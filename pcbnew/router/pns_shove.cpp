@@ -1016,6 +1016,7 @@ PNS_SHOVE::SHOVE_STATUS PNS_SHOVE::shoveMainLoop()
         st = shoveIteration( m_iter );
 
         m_iter++;
+        PNS_ALLOCATOR::CountShoveIteration();
 
         if( st == SH_INCOMPLETE || timeLimit.Expired() || m_iter >= iterLimit )
         {
@@ -32,7 +32,7 @@
 class PNS_SOLID : public PNS_ITEM
 {
 public:
-    PNS_SOLID() : PNS_ITEM( SOLID ), m_shape( NULL )
+    PNS_SOLID() : PNS_ITEM( SOLID ), m_shape( NULL ), m_localClearance( 0 )
     {
         m_movable = false;
     }
@@ -47,6 +47,7 @@ public:
     {
         m_shape = aSolid.m_shape->Clone();
         m_pos = aSolid.m_pos;
+        m_localClearance = aSolid.m_localClearance;
     }
 
     static inline bool ClassOf( const PNS_ITEM* aItem )
@@ -98,10 +99,22 @@ public:
         m_offset = aOffset;
     }
 
+    ///> Returns the clearance set on the pad itself, copied from the board when synced.
+    int LocalClearance() const
+    {
+        return m_localClearance;
+    }
+
+    void SetLocalClearance( int aClearance )
+    {
+        m_localClearance = aClearance;
+    }
+
 private:
     VECTOR2I    m_pos;
     SHAPE*      m_shape;
     VECTOR2I    m_offset;
+    int         m_localClearance;
 };
 
 #endif
@@ -140,6 +140,26 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::singleStep( PNS_LINE& aPath,
 }
 
 
+const PNS_LINE& PNS_WALKAROUND::bestPath( const PNS_LINE& aPathCw,
+                                          const PNS_LINE& aPathCcw ) const
+{
+    int len_cw  = aPathCw.CLine().Length();
+    int len_ccw = aPathCcw.CLine().Length();
+
+    if( m_forceLongerPath )
+        return len_cw > len_ccw ? aPathCw : aPathCcw;
+
+    if( len_cw != len_ccw )
+        return len_cw < len_ccw ? aPathCw : aPathCcw;
+
+    // same length: prefer the path with the fewest and most obtuse corners
+    if( PNS_COST_ESTIMATOR::CornerCost( aPathCw ) < PNS_COST_ESTIMATOR::CornerCost( aPathCcw ) )
+        return aPathCw;
+
+    return aPathCcw;
+}
+
+
 PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitialPath,
         PNS_LINE& aWalkPath, bool aOptimize )
 {
@@ -173,6 +193,9 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
         m_forceSingleDirection = false;
     }
 
+    // The two directions are stepped in turn, not walked concurrently: both steps update
+    // the shared m_recursiveBlockageCount, so a step of one direction decides whether the
+    // next step of the other one may recurse into a blocking obstacle.
     while( m_iteration < m_iterationLimit )
     {
         if( s_cw != STUCK )
@@ -183,13 +206,7 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
 
         if( ( s_cw == DONE && s_ccw == DONE ) || ( s_cw == STUCK && s_ccw == STUCK ) )
         {
-            int len_cw  = path_cw.CLine().Length();
-            int len_ccw = path_ccw.CLine().Length();
-
-            if( m_forceLongerPath )
-                aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-            else
-                aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+            aWalkPath = bestPath( path_cw, path_ccw );
 
             break;
         }
@@ -209,13 +226,7 @@ PNS_WALKAROUND::WALKAROUND_STATUS PNS_WALKAROUND::Route( const PNS_LINE& aInitia
 
     if( m_iteration == m_iterationLimit )
     {
-        int len_cw  = path_cw.CLine().Length();
-        int len_ccw = path_ccw.CLine().Length();
-
-        if( m_forceLongerPath )
-            aWalkPath = ( len_cw > len_ccw ? path_cw : path_ccw );
-        else
-            aWalkPath = ( len_cw < len_ccw ? path_cw : path_ccw );
+        aWalkPath = bestPath( path_cw, path_ccw );
     }
 
     if( m_cursorApproachMode )
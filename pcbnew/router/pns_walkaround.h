@@ -129,6 +129,9 @@ private:
     WALKAROUND_STATUS singleStep( PNS_LINE& aPath, bool aWindingDirection );
     PNS_NODE::OPT_OBSTACLE nearestObstacle( const PNS_LINE& aPath );
 
+    ///> chooses between the clockwise and counter-clockwise paths, when both are eligible
+    const PNS_LINE& bestPath( const PNS_LINE& aPathCw, const PNS_LINE& aPathCcw ) const;
+
     PNS_NODE* m_world;
 
     int m_recursiveBlockageCount;
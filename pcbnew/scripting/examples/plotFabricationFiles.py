@@ -0,0 +1,31 @@
+#!/usr/bin/env python
+#
+# Creates the Gerber files of all the enabled layers of a board, and its
+# Excellon drill files, without opening Pcbnew.
+# usage: plotFabricationFiles.py board.kicad_pcb [output directory]
+#
+import sys
+from pcbnew import *
+
+filename=sys.argv[1]
+outdir = "plot"
+
+if len(sys.argv) > 2:
+    outdir = sys.argv[2]
+
+board = LoadBoard(filename)
+
+pctl = PLOT_CONTROLLER(board)
+
+popt = pctl.GetPlotOptions()
+popt.SetOutputDirectory(outdir)
+popt.SetFormat(PLOT_FORMAT_GERBER)
+popt.SetPlotFrameRef(False)
+popt.SetUseGerberAttributes(True)
+popt.SetUseGerberExtensions(True)
+popt.SetExcludeEdgeLayer(True)
+
+# The layers are plotted at the same time, together with the drill files
+if not pctl.PlotLayers(board.GetEnabledLayers(), True):
+    print "Some fabrication files could not be created"
+    sys.exit(1)
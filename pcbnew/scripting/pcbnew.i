@@ -89,6 +89,7 @@
   #include <class_module.h>
   #include <class_track.h>
   #include <class_zone.h>
+  #include <connectivity_graph.h>
   #include <zones.h>
   #include <layers_id_colors_and_visibility.h>
   #include <class_pad.h>
@@ -128,6 +129,7 @@
 %include <class_module.h>
 %include <class_track.h>
 %include <class_zone.h>
+%include <connectivity_graph.h>
 %include <zones.h>
 %include <layers_id_colors_and_visibility.h>
 %include <class_pad.h>
@@ -37,6 +37,7 @@
 #include <kicad_string.h>
 #include <io_mgr.h>
 #include <macros.h>
+#include <zone_filler.h>
 #include <stdlib.h>
 
 static PCB_EDIT_FRAME* PcbEditFrame = NULL;
@@ -107,3 +108,11 @@ bool SaveBoard( wxString& aFileName, BOARD* aBoard,
 #endif
     return true;
 }
+
+
+void FillAllZones( BOARD* aBoard )
+{
+    ZONE_FILLER filler( aBoard );
+
+    filler.FillAllZones();
+}
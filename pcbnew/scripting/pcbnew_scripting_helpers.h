@@ -43,5 +43,11 @@ BOARD*  LoadBoard( wxString& aFileName );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard, IO_MGR::PCB_FILE_T aFormat );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard );
 
+/**
+ * Function FillAllZones
+ * fills all the zones of aBoard, without user interface.
+ */
+void    FillAllZones( BOARD* aBoard );
+
 
 #endif
@@ -39,6 +39,7 @@
 #include <macros.h>
 
 #include <class_board.h>
+#include <connectivity_graph.h>
 #include <class_module.h>
 #include <class_edge_mod.h>
 #include <class_track.h>
@@ -114,6 +115,9 @@ void PCB_EDIT_FRAME::ImportSpecctraSession( wxCommandEvent& event )
         return;
     }
 
+    // The tracks and vias were replaced without BOARD::Remove()
+    GetBoard()->GetConnectivity()->Synchronize();
+
     OnModify();
     GetBoard()->m_Status_Pcb = 0;
 
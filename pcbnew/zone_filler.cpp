@@ -0,0 +1,191 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file zone_filler.cpp
+ */
+
+#include <algorithm>
+#include <wx/progdlg.h>
+
+#include <fctsys.h>
+#include <ratsnest_data.h>
+
+#include <class_board.h>
+#include <connectivity_graph.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_zone.h>
+
+#include <pcbnew.h>
+#include <zone_filler.h>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
+#define FORMAT_STRING _( "Filling zone %d out of %d (net %s)..." )
+
+
+/**
+ * Function sortByFillCost
+ * sorts the zones by decreasing outline area, so that the slowest zones are started
+ * first and the workers end at about the same time.
+ */
+static bool sortByFillCost( const ZONE_CONTAINER* aZoneA, const ZONE_CONTAINER* aZoneB )
+{
+    EDA_RECT bboxA = aZoneA->GetBoundingBox();
+    EDA_RECT bboxB = aZoneB->GetBoundingBox();
+
+    return (double) bboxA.GetWidth() * bboxA.GetHeight() >
+           (double) bboxB.GetWidth() * bboxB.GetHeight();
+}
+
+
+ZONE_FILLER::ZONE_FILLER( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_progressDialog( NULL )
+{
+}
+
+
+ZONE_FILLER::FILL_STATUS ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones )
+{
+    std::vector<ZONE_CONTAINER*> toFill;
+
+    for( unsigned ii = 0; ii < aZones.size(); ++ii )
+    {
+        // Cannot fill keepout zones:
+        if( !aZones[ii]->GetIsKeepout() )
+            toFill.push_back( aZones[ii] );
+    }
+
+    std::stable_sort( toFill.begin(), toFill.end(), sortByFillCost );
+
+    // D_PAD::GetBoundingRadius() computes its value on the first call:
+    // do it now, before the pads are shared by the workers
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            pad->GetBoundingRadius();
+    }
+
+    int  zoneCount = toFill.size();
+    int  batchSize = 1;
+
+#ifdef USE_OPENMP
+    batchSize = 2 * omp_get_max_threads();
+#endif /* USE_OPENMP */
+
+    // The zone dump file cannot be written by several threads
+    bool parallel = !g_DumpZonesWhenFilling;
+
+    // Not a std::vector<bool>: its items cannot be written by several threads
+    std::vector<char> refilled( zoneCount, false );
+    std::vector<char> failed( zoneCount, false );
+
+    FILL_STATUS status = FILL_OK;
+    int  filledCount;
+
+    // The progress dialog is updated between the batches of zones, when no worker
+    // is running, so the events it processes cannot see a zone being filled
+    for( filledCount = 0; filledCount < zoneCount; )
+    {
+        int first = filledCount;
+        int last  = std::min( zoneCount, first + batchSize );
+
+        if( m_progressDialog )
+        {
+            wxString msg;
+            msg.Printf( FORMAT_STRING, first + 1, zoneCount,
+                        GetChars( toFill[first]->GetNetname() ) );
+
+            if( !m_progressDialog->Update( first + 1, msg ) )
+            {
+                status = FILL_ABORTED;     // Aborted by user
+                break;
+            }
+        }
+
+        int ii;
+
+#ifdef USE_OPENMP
+        #pragma omp parallel for private(ii) schedule(dynamic, 1) if( parallel )
+#endif
+        for( ii = first; ii < last; ++ii )
+        {
+            ZONE_CONTAINER* zone = toFill[ii];
+
+            // Each worker only modifies its own zone.  The other zones are only used
+            // through their outlines, which are not modified by the fill
+            size_t hash = zone->BuildFillInputsHash( m_board );
+
+            // Nothing the filled areas depend on has changed: keep them
+            if( zone->IsFilled() && hash == zone->GetFillInputsHash() && !g_DumpZonesWhenFilling )
+                continue;
+
+            zone->ClearFilledPolysList();
+            zone->UnFill();
+            refilled[ii] = true;
+
+            // A zone which could not be filled is filled again next time
+            if( zone->BuildFilledSolidAreasPolygons( m_board ) )
+                zone->SetFillInputsHash( hash );
+            else
+                failed[ii] = true;
+        }
+
+        filledCount = last;
+
+        if( std::find( failed.begin() + first, failed.begin() + last, true ) !=
+            failed.begin() + last )
+            status = FILL_ERROR;
+    }
+
+    // Publish the new filled areas
+    for( int ii = 0; ii < filledCount; ++ii )
+    {
+        if( !refilled[ii] )
+            continue;
+
+        toFill[ii]->ViewUpdate( KIGFX::VIEW_ITEM::ALL );
+        m_board->GetRatsnest()->Update( toFill[ii] );
+        m_board->GetConnectivity()->Update( toFill[ii] );
+    }
+
+    return status;
+}
+
+
+ZONE_FILLER::FILL_STATUS ZONE_FILLER::FillAllZones()
+{
+    std::vector<ZONE_CONTAINER*> zones;
+
+    for( int ii = 0; ii < m_board->GetAreaCount(); ++ii )
+        zones.push_back( m_board->GetArea( ii ) );
+
+    // Remove segment zones
+    m_board->m_Zone.DeleteAll();
+
+    return Fill( zones );
+}
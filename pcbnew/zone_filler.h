@@ -0,0 +1,100 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file zone_filler.h
+ * @brief Fills a set of copper zones, using several threads.
+ */
+
+#ifndef ZONE_FILLER_H
+#define ZONE_FILLER_H
+
+#include <vector>
+
+class BOARD;
+class ZONE_CONTAINER;
+class wxProgressDialog;
+
+
+/**
+ * Class ZONE_FILLER
+ * fills the zones of a board.
+ *
+ * The filled areas of a zone only depend on the board items and on the outlines of the
+ * other zones, not on their filled areas, so the zones are independent jobs which are
+ * run in parallel.  The fill is done in 3 steps:
+ * - the caches lazily computed by the board items are built, so that the workers only
+ *   read the items shared between zones,
+ * - the zones are filled by a pool of threads, the largest zones first; each worker
+ *   only writes the filled areas of the zone it is working on.  A zone whose fill inputs
+ *   hash (see ZONE_CONTAINER::BuildFillInputsHash()) did not change since its last fill
+ *   keeps its filled areas,
+ * - once all the workers are done, the new filled areas are published to the view and
+ *   the ratsnest from the calling thread.
+ *
+ * It does not need a frame, and can be used from scripts or command line tools.
+ */
+class ZONE_FILLER
+{
+public:
+    /// Status of a fill, returned by Fill() and FillAllZones()
+    enum FILL_STATUS
+    {
+        FILL_OK = 0,        ///< all the zones are filled
+        FILL_ERROR,         ///< the filled areas of some zones could not be built
+        FILL_ABORTED        ///< the fill was aborted by the user
+    };
+
+    ZONE_FILLER( BOARD* aBoard );
+
+    /**
+     * Function SetProgressDialog
+     * sets a dialog to display the progress of the fill, and to let the user abort it.
+     * The dialog range must be at least the number of zones to fill.
+     */
+    void SetProgressDialog( wxProgressDialog* aDialog )    { m_progressDialog = aDialog; }
+
+    /**
+     * Function Fill
+     * fills aZones again, if something they depend on was modified since their last
+     * fill.  Keepout zones are skipped.
+     * @return FILL_OK, FILL_ERROR if the filled areas of a zone could not be built, or
+     * FILL_ABORTED if the fill was aborted by the user.  A zone which could not be
+     * filled does not stop the fill.  When the fill is aborted, the zones not yet
+     * reached keep their previous filled areas.
+     */
+    FILL_STATUS Fill( const std::vector<ZONE_CONTAINER*>& aZones );
+
+    /**
+     * Function FillAllZones
+     * removes the obsolete segment zones and fills all the zones of the board.
+     * @return the status of the fill, see Fill().
+     */
+    FILL_STATUS FillAllZones();
+
+private:
+    BOARD*            m_board;
+    wxProgressDialog* m_progressDialog;
+};
+
+#endif  // ZONE_FILLER_H
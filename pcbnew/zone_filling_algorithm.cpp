@@ -28,11 +28,19 @@
 
 
 #include <algorithm> // sort
+#include <boost/functional/hash.hpp>
 
 #include <fctsys.h>
 #include <trigo.h>
 #include <wxPcbStruct.h>
 
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pad.h>
+#include <class_track.h>
+#include <class_drawsegment.h>
+#include <class_edge_mod.h>
+#include <class_pcb_text.h>
 #include <class_zone.h>
 
 #include <pcbnew.h>
@@ -65,31 +73,8 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
         return 0;
 
     // Make a smoothed polygon out of the user-drawn polygon if required
-    if( m_smoothedPoly )
-    {
-        delete m_smoothedPoly;
-        m_smoothedPoly = NULL;
-    }
-
-    switch( m_cornerSmoothingType )
-    {
-    case ZONE_SETTINGS::SMOOTHING_CHAMFER:
-        m_smoothedPoly = m_Poly->Chamfer( m_cornerRadius );
-        break;
-
-    case ZONE_SETTINGS::SMOOTHING_FILLET:
-        m_smoothedPoly = m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
-        break;
-
-    default:
-        // Acute angles between adjacent edges can create issues in calculations,
-        // in inflate/deflate outlines transforms, especially when the angle is very small.
-        // We can avoid issues by creating a very small chamfer which remove acute angles,
-        // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
-        // clearance areas
-        m_smoothedPoly = m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
-        break;
-    }
+    delete m_smoothedPoly;
+    m_smoothedPoly = CreateSmoothedPoly();
 
     if( aOutlineBuffer )
         aOutlineBuffer->Append( ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList ) );
@@ -102,6 +87,7 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
     else
     {
         m_FilledPolysList.RemoveAllContours();
+        m_filledPolysRevision = 0;
 
         if( IsOnCopperLayer() )
         {
@@ -125,6 +111,227 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
 }
 
 
+CPolyLine* ZONE_CONTAINER::CreateSmoothedPoly() const
+{
+    switch( m_cornerSmoothingType )
+    {
+    case ZONE_SETTINGS::SMOOTHING_CHAMFER:
+        return m_Poly->Chamfer( m_cornerRadius );
+
+    case ZONE_SETTINGS::SMOOTHING_FILLET:
+        return m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
+
+    default:
+        // Acute angles between adjacent edges can create issues in calculations,
+        // in inflate/deflate outlines transforms, especially when the angle is very small.
+        // We can avoid issues by creating a very small chamfer which remove acute angles,
+        // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
+        // clearance areas
+        return m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
+    }
+}
+
+
+static void hashPoint( size_t& aSeed, const wxPoint& aPoint )
+{
+    boost::hash_combine( aSeed, aPoint.x );
+    boost::hash_combine( aSeed, aPoint.y );
+}
+
+
+static void hashOutline( size_t& aSeed, const CPolyLine* aOutline )
+{
+    const CPOLYGONS_LIST& corners = aOutline->m_CornersList;
+
+    for( unsigned ic = 0; ic < corners.GetCornersCount(); ic++ )
+    {
+        hashPoint( aSeed, corners.GetPos( ic ) );
+        boost::hash_combine( aSeed, corners.IsEndContour( ic ) );
+    }
+}
+
+
+static void hashDrawSegment( size_t& aSeed, const DRAWSEGMENT* aSegment )
+{
+    boost::hash_combine( aSeed, (int) aSegment->Type() );
+    boost::hash_combine( aSeed, (int) aSegment->GetLayer() );
+    boost::hash_combine( aSeed, (int) aSegment->GetShape() );
+    boost::hash_combine( aSeed, aSegment->GetWidth() );
+    boost::hash_combine( aSeed, aSegment->GetAngle() );
+    hashPoint( aSeed, aSegment->GetStart() );
+    hashPoint( aSeed, aSegment->GetEnd() );
+
+    const std::vector<wxPoint>& polyPoints = aSegment->GetPolyPoints();
+
+    for( unsigned ii = 0; ii < polyPoints.size(); ii++ )
+        hashPoint( aSeed, polyPoints[ii] );
+}
+
+
+size_t ZONE_CONTAINER::BuildFillInputsHash( BOARD* aPcb ) const
+{
+    size_t seed = 0;
+
+    // The zone itself
+    boost::hash_combine( seed, (int) GetLayer() );
+    boost::hash_combine( seed, GetNetCode() );
+    boost::hash_combine( seed, GetClearance() );
+    boost::hash_combine( seed, m_ZoneClearance );
+    boost::hash_combine( seed, m_ZoneMinThickness );
+    boost::hash_combine( seed, m_FillMode );
+    boost::hash_combine( seed, m_ArcToSegmentsCount );
+    boost::hash_combine( seed, (int) m_PadConnection );
+    boost::hash_combine( seed, m_ThermalReliefGap );
+    boost::hash_combine( seed, m_ThermalReliefCopperBridge );
+    boost::hash_combine( seed, m_priority );
+    boost::hash_combine( seed, m_cornerSmoothingType );
+    boost::hash_combine( seed, m_cornerRadius );
+    hashOutline( seed, m_Poly );
+
+    /* The items further than their clearance plus the zone clearance from the zone
+     * outline cannot change the filled areas.  The area used here is larger than the
+     * one used by buildFeatureHoleList(), so that the thermal reliefs are also covered.
+     */
+    int biggest_clearance = aPcb->GetDesignSettings().GetBiggestClearanceValue();
+    boost::hash_combine( seed, biggest_clearance );
+
+    EDA_RECT zone_area = GetBoundingBox();
+    zone_area.Inflate( std::max( biggest_clearance, m_ZoneClearance ) + m_ZoneMinThickness +
+                       GetThermalReliefGap() );
+
+    EDA_RECT item_area;
+
+    for( MODULE* module = aPcb->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+        {
+            bool onLayer = pad->IsOnLayer( GetLayer() );
+
+            if( !onLayer && pad->GetDrillSize().x == 0 && pad->GetDrillSize().y == 0 )
+                continue;
+
+            item_area = pad->GetBoundingBox();
+            item_area.Inflate( std::max( pad->GetClearance(), GetThermalReliefGap( pad ) ) );
+
+            if( !item_area.Intersects( zone_area ) )
+                continue;
+
+            boost::hash_combine( seed, onLayer );
+            boost::hash_combine( seed, pad->GetNetCode() );
+            boost::hash_combine( seed, pad->GetClearance() );
+            boost::hash_combine( seed, (int) pad->GetShape() );
+            boost::hash_combine( seed, (int) pad->GetAttribute() );
+            boost::hash_combine( seed, (int) pad->GetDrillShape() );
+            boost::hash_combine( seed, pad->GetOrientation() );
+            hashPoint( seed, pad->GetPosition() );
+            hashPoint( seed, pad->GetOffset() );
+            boost::hash_combine( seed, pad->GetSize().x );
+            boost::hash_combine( seed, pad->GetSize().y );
+            boost::hash_combine( seed, pad->GetDelta().x );
+            boost::hash_combine( seed, pad->GetDelta().y );
+            boost::hash_combine( seed, pad->GetDrillSize().x );
+            boost::hash_combine( seed, pad->GetDrillSize().y );
+            boost::hash_combine( seed, (int) GetPadConnection( pad ) );
+            boost::hash_combine( seed, GetThermalReliefGap( pad ) );
+            boost::hash_combine( seed, GetThermalReliefCopperBridge( pad ) );
+        }
+
+        for( BOARD_ITEM* item = module->GraphicalItems(); item; item = item->Next() )
+        {
+            if( item->Type() != PCB_MODULE_EDGE_T )
+                continue;
+
+            if( !item->IsOnLayer( GetLayer() ) && !item->IsOnLayer( Edge_Cuts ) )
+                continue;
+
+            if( item->GetBoundingBox().Intersects( zone_area ) )
+                hashDrawSegment( seed, static_cast<EDGE_MODULE*>( item ) );
+        }
+    }
+
+    for( TRACK* track = aPcb->m_Track; track; track = track->Next() )
+    {
+        if( !track->IsOnLayer( GetLayer() ) )
+            continue;
+
+        item_area = track->GetBoundingBox();
+        item_area.Inflate( track->GetClearance() );
+
+        if( !item_area.Intersects( zone_area ) )
+            continue;
+
+        boost::hash_combine( seed, (int) track->Type() );
+        boost::hash_combine( seed, track->GetNetCode() );
+        boost::hash_combine( seed, track->GetClearance() );
+        boost::hash_combine( seed, track->GetWidth() );
+        hashPoint( seed, track->GetStart() );
+        hashPoint( seed, track->GetEnd() );
+    }
+
+    for( BOARD_ITEM* item = aPcb->m_Drawings; item; item = item->Next() )
+    {
+        if( item->GetLayer() != GetLayer() && item->GetLayer() != Edge_Cuts )
+            continue;
+
+        if( !item->GetBoundingBox().Intersects( zone_area ) )
+            continue;
+
+        switch( item->Type() )
+        {
+        case PCB_LINE_T:
+            hashDrawSegment( seed, static_cast<DRAWSEGMENT*>( item ) );
+            break;
+
+        case PCB_TEXT_T:
+        {
+            TEXTE_PCB* text = static_cast<TEXTE_PCB*>( item );
+
+            if( text->GetText().Length() == 0 )
+                break;
+
+            EDA_RECT box = text->GetTextBox( -1 );
+            hashPoint( seed, box.GetOrigin() );
+            hashPoint( seed, box.GetEnd() );
+            boost::hash_combine( seed, text->GetOrientation() );
+            hashPoint( seed, text->GetTextPosition() );
+        }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // The other zones are only used through their outlines
+    for( int ii = 0; ii < aPcb->GetAreaCount(); ii++ )
+    {
+        ZONE_CONTAINER* zone = aPcb->GetArea( ii );
+
+        if( zone == this || zone->GetLayer() != GetLayer() )
+            continue;
+
+        item_area = zone->GetBoundingBox();
+        item_area.Inflate( zone->GetClearance() );
+
+        if( !item_area.Intersects( zone_area ) )
+            continue;
+
+        boost::hash_combine( seed, zone->GetNetCode() );
+        boost::hash_combine( seed, zone->GetClearance() );
+        boost::hash_combine( seed, zone->GetPriority() );
+        boost::hash_combine( seed, zone->GetIsKeepout() );
+        boost::hash_combine( seed, zone->GetDoNotAllowCopperPour() );
+        boost::hash_combine( seed, zone->GetCornerSmoothingType() );
+        boost::hash_combine( seed, zone->GetCornerRadius() );
+        boost::hash_combine( seed, zone->GetArcSegmentCount() );
+        hashOutline( seed, zone->Outline() );
+    }
+
+    // 0 means "no fill inputs hash"
+    return seed ? seed : 1;
+}
+
+
 // Sort function to build filled zones
 static bool SortByXValues( const int& a, const int &b )
 {
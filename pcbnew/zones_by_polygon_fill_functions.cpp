@@ -37,11 +37,13 @@
 #include <macros.h>
 
 #include <class_board.h>
+#include <connectivity_graph.h>
 #include <class_track.h>
 #include <class_zone.h>
 
 #include <pcbnew.h>
 #include <zones.h>
+#include <zone_filler.h>
 
 #define FORMAT_STRING _( "Filling zone %d out of %d (net %s)..." )
 
@@ -115,8 +117,10 @@ int PCB_EDIT_FRAME::Fill_Zone( ZONE_CONTAINER* aZone )
     wxBusyCursor dummy;     // Shows an hourglass cursor (removed by its destructor)
 
     aZone->BuildFilledSolidAreasPolygons( GetBoard() );
+    aZone->SetFillInputsHash( aZone->BuildFillInputsHash( GetBoard() ) );
     aZone->ViewUpdate( KIGFX::VIEW_ITEM::ALL );
     GetBoard()->GetRatsnest()->Update( aZone );
+    GetBoard()->GetConnectivity()->Update( aZone );
 
     OnModify();
 
@@ -145,34 +149,42 @@ int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
     if( progressDialog )
         progressDialog->Update( 0, _( "Starting zone fill..." ) );
 
-    // Remove segment zones
-    GetBoard()->m_Zone.DeleteAll();
+    ZONE_FILLER filler( GetBoard() );
+    filler.SetProgressDialog( progressDialog );
 
-    int ii;
+    if( filler.FillAllZones() == ZONE_FILLER::FILL_ERROR )
+        errorLevel = 1;
 
-    for( ii = 0; ii < areaCount; ii++ )
+    // Show the net of the last zone, as when the zones were filled one by one by Fill_Zone()
+    ZONE_CONTAINER* lastZone = NULL;
+
+    for( int ii = 0; ii < areaCount; ii++ )
     {
-        ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
-        if( zoneContainer->GetIsKeepout() )
-            continue;
+        if( !GetBoard()->GetArea( ii )->GetIsKeepout() )
+            lastZone = GetBoard()->GetArea( ii );
+    }
 
-        msg.Printf( FORMAT_STRING, ii + 1, areaCount, GetChars( zoneContainer->GetNetname() ) );
+    if( lastZone )
+    {
+        ClearMsgPanel();
 
-        if( progressDialog )
-        {
-            if( !progressDialog->Update( ii+1, msg ) )
-                break;  // Aborted by user
-        }
+        ZONE_SETTINGS zoneInfo = GetZoneSettings();
+        zoneInfo.m_NetcodeSelection = lastZone->GetNetCode();
+        SetZoneSettings( zoneInfo );
+
+        msg = lastZone->GetNetname();
 
-        errorLevel = Fill_Zone( zoneContainer );
+        if( msg.IsEmpty() )
+            msg = wxT( "No net" );
 
-        if( errorLevel && !aVerbose )
-            break;
+        AppendMsgPanel( _( "NetName" ), msg, RED );
     }
 
+    OnModify();
+
     if( progressDialog )
     {
-        progressDialog->Update( ii+2, _( "Updating ratsnest..." ) );
+        progressDialog->Update( areaCount+1, _( "Updating ratsnest..." ) );
 #ifdef __WXMAC__
         // Work around a dialog z-order issue on OS X
         aActiveWindow->Raise();
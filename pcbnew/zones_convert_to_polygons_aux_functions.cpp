@@ -49,9 +49,15 @@
 void ZONE_CONTAINER::TransformOutlinesShapeWithClearanceToPolygon(
         SHAPE_POLY_SET& aCornerBuffer, int aMinClearanceValue, bool aUseNetClearance )
 {
-    // Creates the zone outline polygon (with holes if any)
-    SHAPE_POLY_SET polybuffer;
-    BuildFilledSolidAreasPolygons( NULL, &polybuffer );
+    if( GetNumCorners() <= 2 )  // malformed zone. polygon calculations do not like it ...
+        return;
+
+    // Creates the zone outline polygon (with holes if any).
+    // The smoothed outline is not stored in the zone: this function is called
+    // for other zones when filling a zone, possibly from several threads
+    CPolyLine*     smoothedPoly = CreateSmoothedPoly();
+    SHAPE_POLY_SET polybuffer   = ConvertPolyListToPolySet( smoothedPoly->m_CornersList );
+    delete smoothedPoly;
 
     // add clearance to outline
     int clearance = aMinClearanceValue;
@@ -0,0 +1,128 @@
+import code
+import unittest
+import pcbnew
+import pdb
+
+from pcbnew import *
+
+
+class TestConnectivity(unittest.TestCase):
+
+    def setUp(self):
+        self.pcb = BOARD()
+
+        net = NETINFO_ITEM(self.pcb, "N1")
+        self.pcb.AppendNet(net)
+        net.thisown = 0         # the board deletes its nets
+        self.netcode = net.GetNet()
+
+        # two pads of net N1, 10 mm apart, not connected yet
+        self.module = MODULE(self.pcb)
+        self.pad1 = self.add_pad(wxPointMM(0, 0))
+        self.pad2 = self.add_pad(wxPointMM(10, 0))
+        self.pcb.Add(self.module)
+
+        self.graph = self.pcb.GetConnectivity()
+
+    def add_pad(self, pos):
+        pad = D_PAD(self.module)
+        pad.SetPosition(pos)
+        pad.SetNetCode(self.netcode)
+        self.module.Add(pad)
+        return pad
+
+    def add_track(self, start, end):
+        track = TRACK(self.pcb)
+        track.SetStart(start)
+        track.SetEnd(end)
+        track.SetWidth(FromMM(0.25))
+        track.SetNetCode(self.netcode)
+        self.pcb.Add(track)
+        return track
+
+    def test_unconnected_pads(self):
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 2)
+        self.assertFalse(self.graph.AreConnected(self.pad1, self.pad2))
+
+    def test_add_track(self):
+        track = self.add_track(wxPointMM(0, 0), wxPointMM(10, 0))
+
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 1)
+        self.assertTrue(self.graph.AreConnected(self.pad1, self.pad2))
+        self.assertTrue(self.graph.AreConnected(track, self.pad1))
+
+    def test_add_track_chain(self):
+        self.add_track(wxPointMM(0, 0), wxPointMM(5, 0))
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 2)
+
+        self.add_track(wxPointMM(5, 0), wxPointMM(10, 0))
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 1)
+        self.assertTrue(self.graph.AreConnected(self.pad1, self.pad2))
+
+    def test_remove_track(self):
+        first = self.add_track(wxPointMM(0, 0), wxPointMM(5, 0))
+        second = self.add_track(wxPointMM(5, 0), wxPointMM(10, 0))
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 1)
+
+        self.pcb.Remove(second)
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 2)
+        self.assertFalse(self.graph.AreConnected(self.pad1, self.pad2))
+        self.assertTrue(self.graph.AreConnected(first, self.pad1))
+
+    def test_remove_module(self):
+        self.add_track(wxPointMM(0, 0), wxPointMM(10, 0))
+        self.pcb.Remove(self.module)
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 0)
+
+    def test_other_net(self):
+        net = NETINFO_ITEM(self.pcb, "N2")
+        self.pcb.AppendNet(net)
+        net.thisown = 0
+
+        track = self.add_track(wxPointMM(0, 0), wxPointMM(10, 0))
+        track.SetNetCode(net.GetNet())
+        self.graph.Synchronize()
+
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 2)
+        self.assertEqual(self.graph.GetClusterCount(net.GetNet()), 0)
+        self.assertFalse(self.graph.AreConnected(track, self.pad1))
+
+    def test_synchronize_moved_track(self):
+        track = self.add_track(wxPointMM(0, 0), wxPointMM(10, 0))
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 1)
+
+        # edits made in place are only seen by Synchronize()
+        track.SetEnd(wxPointMM(5, 5))
+        self.graph.Synchronize()
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 2)
+
+        track.SetEnd(wxPointMM(10, 0))
+        self.graph.Synchronize()
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 1)
+
+    def test_mark_modified_track(self):
+        track = self.add_track(wxPointMM(0, 0), wxPointMM(10, 0))
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 1)
+
+        # a modified item is put back by the next query
+        self.graph.MarkModified(track)
+        track.SetEnd(wxPointMM(5, 5))
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 2)
+
+        track.SetEnd(wxPointMM(10, 0))
+        self.graph.MarkModified(track)
+        self.assertTrue(self.graph.AreConnected(self.pad1, self.pad2))
+
+    def test_synchronize_added_pad(self):
+        self.add_track(wxPointMM(0, 0), wxPointMM(10, 0))
+
+        # a pad added to a module already on the board
+        self.add_pad(wxPointMM(20, 0))
+        self.graph.Synchronize()
+        self.assertEqual(self.graph.GetClusterCount(self.netcode), 2)
+
+    #def test_interactive(self):
+    # 	code.interact(local=locals())
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,978 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Checks that the indexed net code computation of NETLIST_OBJECT_LIST::BuildNetListInfo()
+ * (eeschema/netlist.cpp) gives the same net codes as the full scans it replaced:
+ *
+ *   netlist_test [set count]
+ *
+ * netlist.cpp cannot be linked without the whole of Eeschema, so both algorithms are
+ * modelled here on a reduced item type: NEW_NETLIST follows the current code (hash map of
+ * the item ends, R-tree of the segments, label index, union-find of the net codes) and
+ * OLD_NETLIST the previous one (scans of the sheet or of the whole list, net codes
+ * rewritten in all the items at each merge).  Both are run on random sets of items, on a
+ * small grid so that many items are connected, and the net and bus net codes of each item
+ * are compared before the final sort.  NEW_NETLIST must be kept in sync with netlist.cpp.
+ *
+ * Prints the failed sets and returns 1 if any, 0 otherwise.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <geometry/rtree.h>
+
+
+static const int DEFAULT_SET_COUNT  = 20000;
+static const int MAX_ITEM_COUNT     = 60;
+static const int GRID_SIZE          = 5;
+static const int SHEET_COUNT        = 3;
+
+#define IS_WIRE false
+#define IS_BUS  true
+
+
+/// The item types of eeschema/class_netlist_object.h
+enum NETLIST_ITEM_T
+{
+    NET_SEGMENT,
+    NET_BUS,
+    NET_JUNCTION,
+    NET_LABEL,
+    NET_GLOBLABEL,
+    NET_HIERLABEL,
+    NET_SHEETLABEL,
+    NET_BUSLABELMEMBER,
+    NET_GLOBBUSLABELMEMBER,
+    NET_HIERBUSLABELMEMBER,
+    NET_SHEETBUSLABELMEMBER,
+    NET_PINLABEL,
+    NET_PIN,
+    NET_NOCONNECT,
+    NET_ITEM_COUNT
+};
+
+
+struct POINT
+{
+    int x, y;
+
+    bool operator==( const POINT& aOther ) const { return x == aOther.x && y == aOther.y; }
+    bool operator!=( const POINT& aOther ) const { return !( *this == aOther ); }
+};
+
+
+static size_t hash_value( const POINT& aPoint )
+{
+    size_t seed = 0;
+
+    boost::hash_combine( seed, aPoint.x );
+    boost::hash_combine( seed, aPoint.y );
+
+    return seed;
+}
+
+
+/**
+ * Struct ITEM
+ * is the part of NETLIST_OBJECT used by the net code computation.  The sheet paths are
+ * sheet numbers, and the labels are already in lower case.
+ */
+struct ITEM
+{
+    NETLIST_ITEM_T  m_Type;
+    int             m_Sheet;
+    int             m_SheetInclude;
+    POINT           m_Start;
+    POINT           m_End;
+    std::string     m_Label;
+    int             m_Member;
+    int             m_Net;
+    int             m_BusNetCode;
+
+    bool IsLabelType() const
+    {
+        return m_Type == NET_LABEL
+            || m_Type == NET_GLOBLABEL || m_Type == NET_HIERLABEL
+            || m_Type == NET_BUSLABELMEMBER || m_Type == NET_GLOBBUSLABELMEMBER
+            || m_Type == NET_HIERBUSLABELMEMBER
+            || m_Type == NET_PINLABEL;
+    }
+
+    bool IsBusLabelMember() const
+    {
+        return m_Type == NET_SHEETBUSLABELMEMBER || m_Type == NET_BUSLABELMEMBER
+            || m_Type == NET_HIERBUSLABELMEMBER;
+    }
+};
+
+typedef std::vector<ITEM*> ITEMS;
+
+
+static bool IsPointOnSegment( const POINT& aSegStart, const POINT& aSegEnd,
+                              const POINT& aTestPoint )
+{
+    long long vx = aSegEnd.x - aSegStart.x, vy = aSegEnd.y - aSegStart.y;
+    long long px = aTestPoint.x - aSegStart.x, py = aTestPoint.y - aSegStart.y;
+
+    if( vx * py - vy * px )
+        return false;
+
+    return vx * px + vy * py >= px * px + py * py;
+}
+
+
+static bool sortBySheet( const ITEM* aItemA, const ITEM* aItemB )
+{
+    return aItemA->m_Sheet < aItemB->m_Sheet;
+}
+
+
+/**
+ * Class NETLIST_MODEL
+ * holds the sheet local pass of BuildNetListInfo(), which is the same in both algorithms
+ * but for the way the connections are searched.
+ */
+class NETLIST_MODEL
+{
+public:
+    NETLIST_MODEL( ITEMS& aItems ) : m_items( aItems ) {}
+    virtual ~NETLIST_MODEL() {}
+
+    virtual void Build() = 0;
+
+protected:
+    virtual void sheetChange( unsigned aStart, unsigned aEnd ) = 0;
+    virtual void pointToPointConnect( ITEM* aRef, bool aIsBus, unsigned aStart ) = 0;
+    virtual void segmentToPointConnect( ITEM* aJonction, bool aIsBus, unsigned aStart ) = 0;
+
+    void buildLocalConnections();
+
+    ITEMS&  m_items;
+    int     m_lastNetCode;
+    int     m_lastBusNetCode;
+};
+
+
+void NETLIST_MODEL::buildLocalConnections()
+{
+    m_lastNetCode = m_lastBusNetCode = 1;
+
+    for( unsigned ii = 0, istart = 0, sheetEnd = 0; ii < m_items.size(); ii++ )
+    {
+        ITEM* net_item = m_items[ii];
+
+        if( ii == sheetEnd )   // Sheet change
+        {
+            istart = ii;
+
+            while( sheetEnd < m_items.size() && m_items[sheetEnd]->m_Sheet == net_item->m_Sheet )
+                sheetEnd++;
+
+            sheetChange( ii, sheetEnd );
+        }
+
+        switch( net_item->m_Type )
+        {
+        case NET_PIN:
+        case NET_PINLABEL:
+        case NET_SHEETLABEL:
+        case NET_NOCONNECT:
+            if( net_item->m_Net != 0 )
+                break;
+
+        case NET_SEGMENT:
+            if( net_item->m_Net == 0 )
+                net_item->m_Net = m_lastNetCode++;
+
+            pointToPointConnect( net_item, IS_WIRE, istart );
+            break;
+
+        case NET_JUNCTION:
+            if( net_item->m_Net == 0 )
+                net_item->m_Net = m_lastNetCode++;
+
+            segmentToPointConnect( net_item, IS_WIRE, istart );
+
+            if( net_item->m_BusNetCode == 0 )
+                net_item->m_BusNetCode = m_lastBusNetCode++;
+
+            segmentToPointConnect( net_item, IS_BUS, istart );
+            break;
+
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+            if( net_item->m_Net == 0 )
+                net_item->m_Net = m_lastNetCode++;
+
+            segmentToPointConnect( net_item, IS_WIRE, istart );
+            break;
+
+        case NET_SHEETBUSLABELMEMBER:
+            if( net_item->m_BusNetCode != 0 )
+                break;
+
+        case NET_BUS:
+            if( net_item->m_BusNetCode == 0 )
+                net_item->m_BusNetCode = m_lastBusNetCode++;
+
+            pointToPointConnect( net_item, IS_BUS, istart );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            if( net_item->m_Net == 0 )
+                net_item->m_BusNetCode = m_lastBusNetCode++;
+
+            segmentToPointConnect( net_item, IS_BUS, istart );
+            break;
+
+        case NET_ITEM_COUNT:
+            break;
+        }
+    }
+}
+
+
+/**
+ * Class OLD_NETLIST
+ * is the previous algorithm: each connection search scans the items of the sheet, or all
+ * the items, and each merge of two net codes rewrites the net code of all the items.
+ */
+class OLD_NETLIST : public NETLIST_MODEL
+{
+public:
+    OLD_NETLIST( ITEMS& aItems ) : NETLIST_MODEL( aItems ) {}
+
+    void Build();
+
+private:
+    void sheetChange( unsigned aStart, unsigned aEnd ) {}
+    void pointToPointConnect( ITEM* aRef, bool aIsBus, unsigned aStart );
+    void segmentToPointConnect( ITEM* aJonction, bool aIsBus, unsigned aStart );
+
+    void propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus );
+    void connectBusLabels();
+    void labelConnect( ITEM* aLabelRef );
+    void sheetLabelConnect( ITEM* aSheetLabel );
+};
+
+
+void OLD_NETLIST::Build()
+{
+    buildLocalConnections();
+    connectBusLabels();
+
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        switch( m_items[ii]->m_Type )
+        {
+        case NET_LABEL:
+        case NET_GLOBLABEL:
+        case NET_PINLABEL:
+        case NET_BUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            labelConnect( m_items[ii] );
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        if( m_items[ii]->m_Type == NET_SHEETLABEL
+            || m_items[ii]->m_Type == NET_SHEETBUSLABELMEMBER )
+            sheetLabelConnect( m_items[ii] );
+    }
+}
+
+
+void OLD_NETLIST::propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus )
+{
+    if( aOldNetCode == aNewNetCode )
+        return;
+
+    for( unsigned jj = 0; jj < m_items.size(); jj++ )
+    {
+        int& code = aIsBus ? m_items[jj]->m_BusNetCode : m_items[jj]->m_Net;
+
+        if( code == aOldNetCode )
+            code = aNewNetCode;
+    }
+}
+
+
+void OLD_NETLIST::pointToPointConnect( ITEM* aRef, bool aIsBus, unsigned aStart )
+{
+    for( unsigned i = aStart; i < m_items.size(); i++ )
+    {
+        ITEM* item = m_items[i];
+
+        if( item->m_Sheet != aRef->m_Sheet )
+            continue;
+
+        bool candidate;
+
+        switch( item->m_Type )
+        {
+        case NET_SEGMENT:
+        case NET_PIN:
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+        case NET_SHEETLABEL:
+        case NET_PINLABEL:
+        case NET_NOCONNECT:
+            candidate = !aIsBus;
+            break;
+
+        case NET_JUNCTION:
+            candidate = true;
+            break;
+
+        default:
+            candidate = aIsBus;
+            break;
+        }
+
+        if( !candidate )
+            continue;
+
+        if( aRef->m_Start == item->m_Start || aRef->m_Start == item->m_End
+            || aRef->m_End == item->m_Start || aRef->m_End == item->m_End )
+        {
+            int& code = aIsBus ? item->m_BusNetCode : item->m_Net;
+            int  netCode = aIsBus ? aRef->m_BusNetCode : aRef->m_Net;
+
+            if( code == 0 )
+                code = netCode;
+            else
+                propageNetCode( code, netCode, aIsBus );
+        }
+    }
+}
+
+
+void OLD_NETLIST::segmentToPointConnect( ITEM* aJonction, bool aIsBus, unsigned aStart )
+{
+    for( unsigned i = aStart; i < m_items.size(); i++ )
+    {
+        ITEM* segment = m_items[i];
+
+        if( segment->m_Sheet != aJonction->m_Sheet )
+            continue;
+
+        if( segment->m_Type != ( aIsBus ? NET_BUS : NET_SEGMENT ) )
+            continue;
+
+        if( IsPointOnSegment( segment->m_Start, segment->m_End, aJonction->m_Start ) )
+        {
+            int& code = aIsBus ? segment->m_BusNetCode : segment->m_Net;
+            int  netCode = aIsBus ? aJonction->m_BusNetCode : aJonction->m_Net;
+
+            if( code )
+                propageNetCode( code, netCode, aIsBus );
+            else
+                code = netCode;
+        }
+    }
+}
+
+
+void OLD_NETLIST::connectBusLabels()
+{
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        ITEM* label = m_items[ii];
+
+        if( !label->IsBusLabelMember() )
+            continue;
+
+        if( label->m_Net == 0 )
+            label->m_Net = m_lastNetCode++;
+
+        for( unsigned jj = ii + 1; jj < m_items.size(); jj++ )
+        {
+            ITEM* labelInTst = m_items[jj];
+
+            if( !labelInTst->IsBusLabelMember()
+                || labelInTst->m_BusNetCode != label->m_BusNetCode
+                || labelInTst->m_Member != label->m_Member )
+                continue;
+
+            if( labelInTst->m_Net == 0 )
+                labelInTst->m_Net = label->m_Net;
+            else
+                propageNetCode( labelInTst->m_Net, label->m_Net, IS_WIRE );
+        }
+    }
+}
+
+
+void OLD_NETLIST::labelConnect( ITEM* aLabelRef )
+{
+    if( aLabelRef->m_Net == 0 )
+        return;
+
+    for( unsigned i = 0; i < m_items.size(); i++ )
+    {
+        ITEM* item = m_items[i];
+
+        if( item->m_Net == aLabelRef->m_Net )
+            continue;
+
+        if( item->m_Sheet != aLabelRef->m_Sheet )
+        {
+            if( item->m_Type != NET_PINLABEL && item->m_Type != NET_GLOBLABEL
+                && item->m_Type != NET_GLOBBUSLABELMEMBER )
+                continue;
+
+            if( ( item->m_Type == NET_GLOBLABEL || item->m_Type == NET_GLOBBUSLABELMEMBER )
+                && item->m_Type != aLabelRef->m_Type )
+                continue;
+        }
+
+        if( item->IsLabelType() && item->m_Label == aLabelRef->m_Label )
+        {
+            if( item->m_Net )
+                propageNetCode( item->m_Net, aLabelRef->m_Net, IS_WIRE );
+            else
+                item->m_Net = aLabelRef->m_Net;
+        }
+    }
+}
+
+
+void OLD_NETLIST::sheetLabelConnect( ITEM* aSheetLabel )
+{
+    if( aSheetLabel->m_Net == 0 )
+        return;
+
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        ITEM* item = m_items[ii];
+
+        if( item->m_Sheet != aSheetLabel->m_SheetInclude )
+            continue;
+
+        if( item->m_Type != NET_HIERLABEL && item->m_Type != NET_HIERBUSLABELMEMBER )
+            continue;
+
+        if( item->m_Net == aSheetLabel->m_Net || item->m_Label != aSheetLabel->m_Label )
+            continue;
+
+        if( item->m_Net )
+            propageNetCode( item->m_Net, aSheetLabel->m_Net, IS_WIRE );
+        else
+            item->m_Net = aSheetLabel->m_Net;
+    }
+}
+
+
+/**
+ * Class NEW_NETLIST
+ * is the current algorithm of eeschema/netlist.cpp: the items of the current sheet are
+ * found from their ends or an R-tree of the segments, the labels from their name, and
+ * the net codes are merged in a union-find resolved at the end of each pass.
+ */
+class NEW_NETLIST : public NETLIST_MODEL
+{
+public:
+    NEW_NETLIST( ITEMS& aItems ) : NETLIST_MODEL( aItems ) {}
+
+    void Build();
+
+private:
+    typedef boost::unordered_map<POINT, ITEMS>  POINT_MAP;
+    typedef RTree<ITEM*, int, 2, float>         SEGMENT_RTREE;
+    typedef std::map<std::string, ITEMS>        LABEL_MAP;
+
+    struct SEGMENT_COLLECTOR
+    {
+        const ITEM* m_ref;
+        ITEMS&      m_result;
+
+        SEGMENT_COLLECTOR( const ITEM* aRef, ITEMS& aResult ) :
+            m_ref( aRef ), m_result( aResult ) {}
+
+        bool operator()( ITEM* aSegment )
+        {
+            if( aSegment->m_Sheet == m_ref->m_Sheet
+                && IsPointOnSegment( aSegment->m_Start, aSegment->m_End, m_ref->m_Start ) )
+                m_result.push_back( aSegment );
+
+            return true;
+        }
+    };
+
+    void sheetChange( unsigned aStart, unsigned aEnd );
+    void pointToPointConnect( ITEM* aRef, bool aIsBus, unsigned aStart );
+    void segmentToPointConnect( ITEM* aJonction, bool aIsBus, unsigned aStart );
+
+    static void addEnds( POINT_MAP& aMap, ITEM* aItem );
+    static void addSegment( SEGMENT_RTREE& aTree, ITEM* aItem );
+
+    int findNetCode( int aNetCode, bool aIsBus );
+    void propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus );
+    void mergeNetCode( ITEM* aItem, int aNetCode, bool aIsBus );
+    void resolveNetCodes();
+
+    void connectBusLabels();
+    void labelConnect( ITEM* aLabelRef );
+    void sheetLabelConnect( ITEM* aSheetLabel );
+
+    POINT_MAP           m_wireEnds;
+    POINT_MAP           m_busEnds;
+    SEGMENT_RTREE       m_wires;
+    SEGMENT_RTREE       m_buses;
+    LABEL_MAP           m_labels;
+    std::vector<int>    m_netCodeParent;
+    std::vector<int>    m_busNetCodeParent;
+};
+
+
+void NEW_NETLIST::Build()
+{
+    m_netCodeParent.clear();
+    m_busNetCodeParent.clear();
+
+    buildLocalConnections();
+    resolveNetCodes();
+
+    connectBusLabels();
+
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        if( m_items[ii]->IsLabelType() )
+            m_labels[m_items[ii]->m_Label].push_back( m_items[ii] );
+    }
+
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        switch( m_items[ii]->m_Type )
+        {
+        case NET_LABEL:
+        case NET_GLOBLABEL:
+        case NET_PINLABEL:
+        case NET_BUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            labelConnect( m_items[ii] );
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        if( m_items[ii]->m_Type == NET_SHEETLABEL
+            || m_items[ii]->m_Type == NET_SHEETBUSLABELMEMBER )
+            sheetLabelConnect( m_items[ii] );
+    }
+
+    resolveNetCodes();
+}
+
+
+void NEW_NETLIST::addEnds( POINT_MAP& aMap, ITEM* aItem )
+{
+    aMap[aItem->m_Start].push_back( aItem );
+
+    if( aItem->m_End != aItem->m_Start )
+        aMap[aItem->m_End].push_back( aItem );
+}
+
+
+void NEW_NETLIST::addSegment( SEGMENT_RTREE& aTree, ITEM* aItem )
+{
+    const int mmin[2] = { std::min( aItem->m_Start.x, aItem->m_End.x ),
+                          std::min( aItem->m_Start.y, aItem->m_End.y ) };
+    const int mmax[2] = { std::max( aItem->m_Start.x, aItem->m_End.x ),
+                          std::max( aItem->m_Start.y, aItem->m_End.y ) };
+
+    aTree.Insert( mmin, mmax, aItem );
+}
+
+
+void NEW_NETLIST::sheetChange( unsigned aStart, unsigned aEnd )
+{
+    m_wireEnds.clear();
+    m_busEnds.clear();
+    m_wires.RemoveAll();
+    m_buses.RemoveAll();
+
+    for( unsigned ii = aStart; ii < aEnd; ii++ )
+    {
+        ITEM* item = m_items[ii];
+
+        switch( item->m_Type )
+        {
+        case NET_SEGMENT:
+            addSegment( m_wires, item );
+            addEnds( m_wireEnds, item );
+            break;
+
+        case NET_PIN:
+        case NET_LABEL:
+        case NET_HIERLABEL:
+        case NET_GLOBLABEL:
+        case NET_SHEETLABEL:
+        case NET_PINLABEL:
+        case NET_NOCONNECT:
+            addEnds( m_wireEnds, item );
+            break;
+
+        case NET_JUNCTION:
+            addEnds( m_wireEnds, item );
+            addEnds( m_busEnds, item );
+            break;
+
+        case NET_BUS:
+            addSegment( m_buses, item );
+            addEnds( m_busEnds, item );
+            break;
+
+        case NET_BUSLABELMEMBER:
+        case NET_SHEETBUSLABELMEMBER:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_GLOBBUSLABELMEMBER:
+            addEnds( m_busEnds, item );
+            break;
+
+        case NET_ITEM_COUNT:
+            break;
+        }
+    }
+}
+
+
+void NEW_NETLIST::pointToPointConnect( ITEM* aRef, bool aIsBus, unsigned aStart )
+{
+    const POINT_MAP& ends = aIsBus ? m_busEnds : m_wireEnds;
+    int netCode = aIsBus ? findNetCode( aRef->m_BusNetCode, IS_BUS )
+                         : findNetCode( aRef->m_Net, IS_WIRE );
+
+    for( int ii = 0; ii < 2; ii++ )
+    {
+        const POINT& pos = ii == 0 ? aRef->m_Start : aRef->m_End;
+
+        if( ii == 1 && pos == aRef->m_Start )
+            break;
+
+        POINT_MAP::const_iterator it = ends.find( pos );
+
+        if( it == ends.end() )
+            continue;
+
+        for( unsigned jj = 0; jj < it->second.size(); jj++ )
+        {
+            if( it->second[jj]->m_Sheet == aRef->m_Sheet )
+                mergeNetCode( it->second[jj], netCode, aIsBus );
+        }
+    }
+}
+
+
+void NEW_NETLIST::segmentToPointConnect( ITEM* aJonction, bool aIsBus, unsigned aStart )
+{
+    ITEMS             segments;
+    SEGMENT_COLLECTOR collector( aJonction, segments );
+
+    const int pos[2] = { aJonction->m_Start.x, aJonction->m_Start.y };
+
+    if( aIsBus == IS_WIRE )
+        m_wires.Search( pos, pos, collector );
+    else
+        m_buses.Search( pos, pos, collector );
+
+    int netCode = aIsBus ? findNetCode( aJonction->m_BusNetCode, IS_BUS )
+                         : findNetCode( aJonction->m_Net, IS_WIRE );
+
+    for( unsigned ii = 0; ii < segments.size(); ii++ )
+        mergeNetCode( segments[ii], netCode, aIsBus );
+}
+
+
+int NEW_NETLIST::findNetCode( int aNetCode, bool aIsBus )
+{
+    std::vector<int>& parent = aIsBus ? m_busNetCodeParent : m_netCodeParent;
+
+    if( aNetCode >= (int) parent.size() )
+        return aNetCode;
+
+    while( parent[aNetCode] != aNetCode )
+    {
+        parent[aNetCode] = parent[ parent[aNetCode] ];
+        aNetCode = parent[aNetCode];
+    }
+
+    return aNetCode;
+}
+
+
+void NEW_NETLIST::propageNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus )
+{
+    aOldNetCode = findNetCode( aOldNetCode, aIsBus );
+    aNewNetCode = findNetCode( aNewNetCode, aIsBus );
+
+    if( aOldNetCode == aNewNetCode )
+        return;
+
+    std::vector<int>& parent = aIsBus ? m_busNetCodeParent : m_netCodeParent;
+    int               needed = std::max( aOldNetCode, aNewNetCode ) + 1;
+
+    for( int code = parent.size(); code < needed; code++ )
+        parent.push_back( code );
+
+    parent[aOldNetCode] = aNewNetCode;
+}
+
+
+void NEW_NETLIST::mergeNetCode( ITEM* aItem, int aNetCode, bool aIsBus )
+{
+    int& code = aIsBus ? aItem->m_BusNetCode : aItem->m_Net;
+
+    if( code == 0 )
+        code = aNetCode;
+    else
+        propageNetCode( code, aNetCode, aIsBus );
+}
+
+
+void NEW_NETLIST::resolveNetCodes()
+{
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        m_items[ii]->m_Net = findNetCode( m_items[ii]->m_Net, IS_WIRE );
+        m_items[ii]->m_BusNetCode = findNetCode( m_items[ii]->m_BusNetCode, IS_BUS );
+    }
+
+    m_netCodeParent.clear();
+    m_busNetCodeParent.clear();
+}
+
+
+void NEW_NETLIST::connectBusLabels()
+{
+    typedef std::map< std::pair<int, int>, ITEMS > BUS_MEMBER_MAP;
+
+    BUS_MEMBER_MAP busMembers;
+
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        ITEM* label = m_items[ii];
+
+        if( label->IsBusLabelMember() )
+            busMembers[ std::make_pair( label->m_BusNetCode, label->m_Member ) ].push_back( label );
+    }
+
+    for( unsigned ii = 0; ii < m_items.size(); ii++ )
+    {
+        ITEM* label = m_items[ii];
+
+        if( !label->IsBusLabelMember() )
+            continue;
+
+        const ITEMS& group = busMembers[ std::make_pair( label->m_BusNetCode, label->m_Member ) ];
+
+        if( group[0] != label )
+            continue;
+
+        if( label->m_Net == 0 )
+            label->m_Net = m_lastNetCode++;
+
+        int netCode = findNetCode( label->m_Net, IS_WIRE );
+
+        for( unsigned jj = 1; jj < group.size(); jj++ )
+            mergeNetCode( group[jj], netCode, IS_WIRE );
+    }
+}
+
+
+void NEW_NETLIST::labelConnect( ITEM* aLabelRef )
+{
+    if( aLabelRef->m_Net == 0 )
+        return;
+
+    LABEL_MAP::const_iterator labels = m_labels.find( aLabelRef->m_Label );
+
+    if( labels == m_labels.end() )
+        return;
+
+    int netCode = findNetCode( aLabelRef->m_Net, IS_WIRE );
+
+    for( unsigned i = 0; i < labels->second.size(); i++ )
+    {
+        ITEM* item = labels->second[i];
+
+        if( item->m_Sheet != aLabelRef->m_Sheet )
+        {
+            if( item->m_Type != NET_PINLABEL && item->m_Type != NET_GLOBLABEL
+                && item->m_Type != NET_GLOBBUSLABELMEMBER )
+                continue;
+
+            if( ( item->m_Type == NET_GLOBLABEL || item->m_Type == NET_GLOBBUSLABELMEMBER )
+                && item->m_Type != aLabelRef->m_Type )
+                continue;
+        }
+
+        mergeNetCode( item, netCode, IS_WIRE );
+    }
+}
+
+
+void NEW_NETLIST::sheetLabelConnect( ITEM* aSheetLabel )
+{
+    if( aSheetLabel->m_Net == 0 )
+        return;
+
+    LABEL_MAP::const_iterator labels = m_labels.find( aSheetLabel->m_Label );
+
+    if( labels == m_labels.end() )
+        return;
+
+    int netCode = findNetCode( aSheetLabel->m_Net, IS_WIRE );
+
+    for( unsigned ii = 0; ii < labels->second.size(); ii++ )
+    {
+        ITEM* item = labels->second[ii];
+
+        if( item->m_Sheet != aSheetLabel->m_SheetInclude )
+            continue;
+
+        if( item->m_Type != NET_HIERLABEL && item->m_Type != NET_HIERBUSLABELMEMBER )
+            continue;
+
+        mergeNetCode( item, netCode, IS_WIRE );
+    }
+}
+
+
+/// A small linear congruential generator, so that the sets are the same everywhere.
+static unsigned random( unsigned& aSeed, unsigned aRange )
+{
+    aSeed = aSeed * 1103515245u + 12345u;
+
+    return ( aSeed >> 16 ) % aRange;
+}
+
+
+/**
+ * Function makeItems
+ * fills aItems with a random set of items, sorted by sheet as BuildNetListInfo() does.
+ * The labels are in lower case: the real code compares them without case.
+ */
+static void makeItems( unsigned aSeed, std::vector<ITEM>& aItems )
+{
+    static const char* labels[] = { "a", "b", "c" };
+
+    aItems.resize( 1 + random( aSeed, MAX_ITEM_COUNT ) );
+
+    for( unsigned ii = 0; ii < aItems.size(); ii++ )
+    {
+        ITEM& item = aItems[ii];
+
+        item.m_Type         = (NETLIST_ITEM_T) random( aSeed, NET_ITEM_COUNT );
+        item.m_Sheet        = random( aSeed, SHEET_COUNT );
+        item.m_SheetInclude = random( aSeed, SHEET_COUNT );
+        item.m_Start.x      = random( aSeed, GRID_SIZE );
+        item.m_Start.y      = random( aSeed, GRID_SIZE );
+        item.m_End          = item.m_Start;
+        item.m_Label        = labels[ random( aSeed, 3 ) ];
+        item.m_Member       = random( aSeed, 2 );
+        item.m_Net          = 0;
+        item.m_BusNetCode   = 0;
+
+        if( item.m_Type == NET_SEGMENT || item.m_Type == NET_BUS )
+        {
+            // Mostly vertical segments, some in any direction
+            if( random( aSeed, 2 ) )
+                item.m_End.x = random( aSeed, GRID_SIZE );
+
+            item.m_End.y = random( aSeed, GRID_SIZE );
+        }
+    }
+}
+
+
+int main( int argc, char* argv[] )
+{
+    int setCount = argc > 1 ? atoi( argv[1] ) : DEFAULT_SET_COUNT;
+    int failures = 0;
+
+    for( int set = 0; set < setCount; ++set )
+    {
+        std::vector<ITEM> oldItems;
+
+        makeItems( set, oldItems );
+
+        std::vector<ITEM> newItems( oldItems );
+        ITEMS             oldList, newList;
+
+        for( unsigned ii = 0; ii < oldItems.size(); ii++ )
+        {
+            oldList.push_back( &oldItems[ii] );
+            newList.push_back( &newItems[ii] );
+        }
+
+        std::stable_sort( oldList.begin(), oldList.end(), sortBySheet );
+        std::stable_sort( newList.begin(), newList.end(), sortBySheet );
+
+        OLD_NETLIST( oldList ).Build();
+        NEW_NETLIST( newList ).Build();
+
+        for( unsigned ii = 0; ii < oldItems.size(); ii++ )
+        {
+            if( oldItems[ii].m_Net != newItems[ii].m_Net
+                || oldItems[ii].m_BusNetCode != newItems[ii].m_BusNetCode )
+            {
+                printf( "FAILED: set %d, item %u: net %d bus %d, was net %d bus %d\n",
+                        set, ii, newItems[ii].m_Net, newItems[ii].m_BusNetCode,
+                        oldItems[ii].m_Net, oldItems[ii].m_BusNetCode );
+                ++failures;
+                break;
+            }
+        }
+    }
+
+    if( failures )
+        printf( "%d of %d set(s) failed\n", failures, setCount );
+    else
+        printf( "all %d sets passed\n", setCount );
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Measures the throughput of the s-expression lexer used to load boards and
+ * footprints, for instance on the demo boards:
+ *
+ *   pcb_lexer_benchmark ../demos/video/video.kicad_pcb
+ *
+ * Each file is lexed with the FILE_LINE_READER and strtod(), then with
+ * the MAPPED_FILE_LINE_READER and DSNLEXER::ParseDecimal(), and the speed of both
+ * is reported in MB/s.  The lines are also read alone with both readers, without
+ * lexing, to show the part of the readers in the difference: both copy each line
+ * into their line buffer, the FILE_LINE_READER one character at a time.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <clocale>
+
+#include <macros.h>
+#include <richio.h>
+#include <profile.h>
+#include <pcb_lexer.h>
+
+
+static void usage()
+{
+    fprintf( stderr, "usage: pcb_lexer_benchmark <file.kicad_pcb | file.kicad_mod>...\n" );
+    exit( 1 );
+}
+
+
+/**
+ * Function lexFile
+ * reads all the tokens from aReader, and converts the numbers to double.
+ * @return the number of tokens read.
+ */
+static unsigned lexFile( LINE_READER* aReader, bool aUseParseDecimal, double* aChecksum )
+{
+    PCB_LEXER   lexer( aReader );
+    unsigned    count = 0;
+    int         tok;
+
+    while( ( tok = lexer.NextTok() ) != DSN_EOF )
+    {
+        ++count;
+
+        if( tok == DSN_NUMBER )
+        {
+            double value;
+
+            if( !aUseParseDecimal || !DSNLEXER::ParseDecimal( lexer.CurText(), &value ) )
+                value = strtod( lexer.CurText(), NULL );
+
+            *aChecksum += value;
+        }
+    }
+
+    return count;
+}
+
+
+/**
+ * Function readFile
+ * reads all the lines from aReader.
+ */
+static void readFile( LINE_READER* aReader )
+{
+    while( aReader->ReadLine() )
+        ;
+}
+
+
+int main( int argc, char** argv )
+{
+    if( argc < 2 )
+        usage();
+
+    // The files are written in the C locale
+    setlocale( LC_NUMERIC, "C" );
+
+    double  totalSize = 0.0;
+    double  copyTime  = 0.0;
+    double  mappedTime = 0.0;
+    double  copyReadTime  = 0.0;
+    double  mappedReadTime = 0.0;
+
+    for( int ii = 1; ii < argc; ++ii )
+    {
+        wxString        filename = FROM_UTF8( argv[ii] );
+        prof_counter    copyCnt;
+        prof_counter    mappedCnt;
+        prof_counter    copyReadCnt;
+        prof_counter    mappedReadCnt;
+        unsigned        copyTokens, mappedTokens;
+        double          copySum = 0.0, mappedSum = 0.0;
+        size_t          size;
+
+        try
+        {
+            {
+                prof_start( &copyCnt );
+                FILE_LINE_READER reader( filename );
+                copyTokens = lexFile( &reader, false, &copySum );
+                prof_end( &copyCnt );
+            }
+
+            {
+                prof_start( &mappedCnt );
+                MAPPED_FILE_LINE_READER reader( filename );
+                size = reader.FileSize();
+                mappedTokens = lexFile( &reader, true, &mappedSum );
+                prof_end( &mappedCnt );
+            }
+
+            {
+                prof_start( &copyReadCnt );
+                FILE_LINE_READER reader( filename );
+                readFile( &reader );
+                prof_end( &copyReadCnt );
+            }
+
+            {
+                prof_start( &mappedReadCnt );
+                MAPPED_FILE_LINE_READER reader( filename );
+                readFile( &reader );
+                prof_end( &mappedReadCnt );
+            }
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            fprintf( stderr, "%s\n", TO_UTF8( ioe.errorText ) );
+            return 1;
+        }
+
+        if( copyTokens != mappedTokens || copySum != mappedSum )
+        {
+            fprintf( stderr, "%s: the two readers disagree\n", argv[ii] );
+            return 1;
+        }
+
+        double mb = size / ( 1024.0 * 1024.0 );
+
+        printf( "%s: %.2f MB, %u tokens, copy %.1f MB/s, mapped %.1f MB/s"
+                " (reading alone: copy %.1f MB/s, mapped %.1f MB/s)\n",
+                argv[ii], mb, copyTokens,
+                mb / ( copyCnt.usecs() * 1e-6 ), mb / ( mappedCnt.usecs() * 1e-6 ),
+                mb / ( copyReadCnt.usecs() * 1e-6 ), mb / ( mappedReadCnt.usecs() * 1e-6 ) );
+
+        totalSize  += mb;
+        copyTime   += copyCnt.usecs() * 1e-6;
+        mappedTime += mappedCnt.usecs() * 1e-6;
+        copyReadTime   += copyReadCnt.usecs() * 1e-6;
+        mappedReadTime += mappedReadCnt.usecs() * 1e-6;
+    }
+
+    printf( "total: %.2f MB, copy %.1f MB/s, mapped %.1f MB/s"
+            " (reading alone: copy %.1f MB/s, mapped %.1f MB/s)\n",
+            totalSize, totalSize / copyTime, totalSize / mappedTime,
+            totalSize / copyReadTime, totalSize / mappedReadTime );
+
+    return 0;
+}
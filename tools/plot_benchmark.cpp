@@ -0,0 +1,216 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Measures the output speed of the plotters:
+ *
+ *   plot_benchmark [item count] [output directory]
+ *
+ * The same synthetic board-like content (tracks, pads, vias and zone outlines with many
+ * corners) is plotted with each plot format, and the time and the output rate in MB/s
+ * are reported.  The number formatting alone is measured too, with PlotPrintf() and
+ * with fprintf() for comparison.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include <fctsys.h>
+#include <macros.h>
+#include <profile.h>
+#include <common.h>
+#include <class_page_info.h>
+#include <plot_common.h>
+#include <plot_printf.h>
+
+#include <wx/init.h>
+#include <wx/filename.h>
+
+
+/// Same internal units as pcbnew (nanometers)
+static const double iuPerDecimil = 2540.0;
+
+
+static void plotContent( PLOTTER* aPlotter, int aCount )
+{
+    // a pseudo random but reproducible content
+    srand( 1 );
+
+    int     span = 200000000;       // 200 mm
+    wxPoint prev( 0, 0 );
+
+    for( int ii = 0; ii < aCount; ii++ )
+    {
+        wxPoint pos( rand() % span, rand() % span );
+
+        aPlotter->ThickSegment( prev, pos, 250000, FILLED );
+        aPlotter->FlashPadCircle( pos, 800000, FILLED );
+        aPlotter->FlashPadRect( pos, wxSize( 1500000, 600000 ), ( ii % 4 ) * 450.0, FILLED );
+
+        prev = pos;
+    }
+
+    // zone outlines: the bulk of the coordinates of real boards
+    std::vector<wxPoint> corners;
+
+    for( int ii = 0; ii < aCount / 10; ii++ )
+    {
+        wxPoint center( rand() % span, rand() % span );
+        int     radius = 1000000 + rand() % 5000000;
+
+        corners.clear();
+
+        for( int jj = 0; jj < 64; jj++ )
+        {
+            double angle = jj * 2 * M_PI / 64;
+            corners.push_back( center + wxPoint( KiROUND( radius * cos( angle ) ),
+                                                 KiROUND( radius * sin( angle ) ) ) );
+        }
+
+        corners.push_back( corners[0] );
+        aPlotter->PlotPoly( corners, FILLED_SHAPE, 0 );
+    }
+}
+
+
+/**
+ * Function benchmarkPlotter
+ * plots the content with aPlotter, and deletes it.
+ */
+static void benchmarkPlotter( PLOTTER* aPlotter, const wxString& aName,
+                              const wxString& aDirectory, int aCount )
+{
+    wxFileName fn( aDirectory, wxT( "plot_benchmark" ), aName.Lower() );
+
+    aPlotter->SetPageSettings( PAGE_INFO( PAGE_INFO::A3 ) );
+    aPlotter->SetViewport( wxPoint( 0, 0 ), iuPerDecimil, 1.0, false );
+    aPlotter->SetGerberCoordinatesFormat( 6 );
+    aPlotter->SetDefaultLineWidth( 100000 );
+    aPlotter->SetCreator( wxT( "plot_benchmark" ) );
+
+    if( !aPlotter->OpenFile( fn.GetFullPath() ) )
+    {
+        fprintf( stderr, "error: cannot create '%s'\n", TO_UTF8( fn.GetFullPath() ) );
+        delete aPlotter;
+        return;
+    }
+
+    prof_counter time;
+
+    prof_start( &time );
+
+    aPlotter->StartPlot();
+    plotContent( aPlotter, aCount );
+    aPlotter->EndPlot();
+
+    prof_end( &time );
+
+    delete aPlotter;
+
+    double size = fn.GetSize().ToDouble() / ( 1024.0 * 1024.0 );
+
+    printf( "%-8s %10.1f ms %10.2f MB %10.2f MB/s\n", TO_UTF8( aName ), time.msecs(),
+            size, size * 1000.0 / std::max( time.msecs(), 0.001f ) );
+
+    wxRemoveFile( fn.GetFullPath() );
+}
+
+
+static void benchmarkFormatter( const wxString& aDirectory, int aCount )
+{
+    wxFileName  fn( aDirectory, wxT( "plot_benchmark" ), wxT( "txt" ) );
+    const char* name[2] = { "PlotPrintf", "fprintf" };
+
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        FILE* file = wxFopen( fn.GetFullPath(), wxT( "wt" ) );
+
+        if( !file )
+            return;
+
+        SetPlotFileBuffer( file );
+
+        prof_counter time;
+
+        prof_start( &time );
+
+        for( int ii = 0; ii < aCount * 20; ii++ )
+        {
+            double x = ii * 0.0254;
+            double y = ii * -0.0127;
+
+            if( pass == 0 )
+                PlotPrintf( file, "%g %g l %.4f %d\n", x, y, x, ii );
+            else
+                fprintf( file, "%g %g l %.4f %d\n", x, y, x, ii );
+        }
+
+        long size = ftell( file );
+
+        fclose( file );
+        prof_end( &time );
+
+        double mb = size / ( 1024.0 * 1024.0 );
+
+        printf( "%-10s %10.1f ms %10.2f MB %10.2f MB/s\n", name[pass], time.msecs(), mb,
+                mb * 1000.0 / std::max( time.msecs(), 0.001f ) );
+    }
+
+    wxRemoveFile( fn.GetFullPath() );
+}
+
+
+int main( int argc, char** argv )
+{
+    int      count = argc > 1 ? atoi( argv[1] ) : 100000;
+    wxString directory = argc > 2 ? FROM_UTF8( argv[2] ) : wxFileName::GetTempDir();
+
+    if( count <= 0 )
+    {
+        fprintf( stderr, "usage: plot_benchmark [item count] [output directory]\n" );
+        return 1;
+    }
+
+    wxInitializer initializer;
+
+    printf( "%d items (%d zone outlines)\n\n", count, count / 10 );
+
+    {
+        LOCALE_IO toggle;
+
+        benchmarkPlotter( new GERBER_PLOTTER, wxT( "Gerber" ), directory, count );
+        benchmarkPlotter( new PDF_PLOTTER, wxT( "PDF" ), directory, count );
+        benchmarkPlotter( new PS_PLOTTER, wxT( "PS" ), directory, count );
+        benchmarkPlotter( new SVG_PLOTTER, wxT( "SVG" ), directory, count );
+        benchmarkPlotter( new HPGL_PLOTTER, wxT( "HPGL" ), directory, count );
+        benchmarkPlotter( new DXF_PLOTTER, wxT( "DXF" ), directory, count );
+    }
+
+    printf( "\n" );
+    benchmarkFormatter( directory, count );
+
+    return 0;
+}
@@ -0,0 +1,333 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Replays a routing session recorded by the interactive router and measures it:
+ *
+ *   pns_router_benchmark board.kicad_pcb pns_events.log [repeat count]
+ *
+ * The router records its input events (start, moves, fix...) since the last world
+ * synchronization, and saves them with the "dump log" hotkey of debug builds to the file
+ * named by the KICAD_PNS_EVENT_LOG environment variable (relative to the temp directory).
+ * The board must be saved in the state it had when the router tool was activated.
+ *
+ * The events are applied to a PNS_ROUTER without any view attached, and the latency of
+ * each routing step (mouse move) is reported with the number of collision queries and
+ * shove iterations it needed.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include <fctsys.h>
+#include <macros.h>
+#include <profile.h>
+#include <class_board.h>
+#include <kicad_plugin.h>
+#include <ratsnest_data.h>
+
+#include <router/pns_router.h>
+#include <router/pns_itemset.h>
+#include <router/pns_allocator.h>
+#include <router/pns_sizes_settings.h>
+
+
+struct EVENT
+{
+    char        m_type[32];
+    VECTOR2I    m_pos;
+    int         m_arg;
+    int         m_itemKind;
+    int         m_itemNet;
+    int         m_itemLayer;
+};
+
+
+struct STEP
+{
+    double  m_msecs;
+    int     m_collisionQueries;
+    int     m_shoveIterations;
+    int     m_allocs;
+};
+
+
+static void usage()
+{
+    fprintf( stderr, "usage: pns_router_benchmark <file.kicad_pcb> <events.log> [repeat count]\n" );
+    exit( 1 );
+}
+
+
+/**
+ * Function readEvents
+ * reads the "event" lines of a router log, and ignores the other ones.
+ */
+static bool readEvents( const char* aFileName, std::vector<EVENT>& aEvents )
+{
+    FILE* fp = fopen( aFileName, "rt" );
+
+    if( !fp )
+        return false;
+
+    char line[256];
+
+    while( fgets( line, sizeof( line ), fp ) )
+    {
+        EVENT ev;
+
+        if( sscanf( line, "event %31s %d %d %d %d %d %d", ev.m_type, &ev.m_pos.x, &ev.m_pos.y,
+                    &ev.m_arg, &ev.m_itemKind, &ev.m_itemNet, &ev.m_itemLayer ) == 7 )
+        {
+            aEvents.push_back( ev );
+        }
+    }
+
+    fclose( fp );
+    return true;
+}
+
+
+/**
+ * Function findItem
+ * finds the router item an event was recorded for, among the items under its position.
+ * @return the item, or NULL if the event had no item or it was not found.
+ */
+static PNS_ITEM* findItem( PNS_ROUTER& aRouter, const EVENT& aEvent )
+{
+    if( !aEvent.m_itemKind )
+        return NULL;
+
+    const PNS_ITEMSET items = aRouter.QueryHoverItems( aEvent.m_pos );
+
+    for( unsigned i = 0; i < items.CItems().size(); ++i )
+    {
+        PNS_ITEM* item = items.CItems()[i];
+
+        if( item->Kind() == aEvent.m_itemKind && item->Net() == aEvent.m_itemNet
+                && item->Layers().Overlaps( aEvent.m_itemLayer ) )
+            return item;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Function replay
+ * applies the events to aRouter, and appends the measurements of each routing step
+ * to aSteps.
+ */
+static void replay( PNS_ROUTER& aRouter, BOARD* aBoard, const std::vector<EVENT>& aEvents,
+                    std::vector<STEP>& aSteps )
+{
+    PNS_SIZES_SETTINGS  recordedSizes;
+    bool                dragging = false;
+    unsigned            failures = 0;
+
+    for( unsigned i = 0; i < aEvents.size(); ++i )
+    {
+        const EVENT&    ev = aEvents[i];
+        const char*     type = ev.m_type;
+
+        if( !strcmp( type, "mode" ) )
+            aRouter.SetMode( (PNS_ROUTER_MODE) ev.m_arg );
+        else if( !strcmp( type, "rmode" ) )
+            aRouter.Settings().SetMode( (PNS_MODE) ev.m_arg );
+        else if( !strcmp( type, "width" ) )
+            recordedSizes.SetTrackWidth( ev.m_arg );
+        else if( !strcmp( type, "via_diameter" ) )
+            recordedSizes.SetViaDiameter( ev.m_arg );
+        else if( !strcmp( type, "via_drill" ) )
+            recordedSizes.SetViaDrill( ev.m_arg );
+        else if( !strcmp( type, "start" ) || !strcmp( type, "drag" ) )
+        {
+            PNS_ITEM*           item = findItem( aRouter, ev );
+            PNS_SIZES_SETTINGS  sizes( aRouter.Sizes() );
+
+            // Same initialization as the router tool, then the sizes the user had chosen
+            sizes.Init( aBoard, item );
+            sizes.SetTrackWidth( recordedSizes.TrackWidth() );
+            sizes.SetViaDiameter( recordedSizes.ViaDiameter() );
+            sizes.SetViaDrill( recordedSizes.ViaDrill() );
+            aRouter.UpdateSizes( sizes );
+
+            dragging = type[0] == 'd';
+
+            bool started = dragging ? aRouter.StartDragging( ev.m_pos, item ) :
+                                      aRouter.StartRouting( ev.m_pos, item, ev.m_arg );
+
+            if( !started )
+                failures++;
+        }
+        else if( !aRouter.RoutingInProgress() )
+        {
+            // the session could not be started, skip its events
+            continue;
+        }
+        else if( !strcmp( type, "move" ) )
+        {
+            // PNS_ROUTER::QueryHoverItems() needs a placer, which a drag session has not
+            PNS_ITEM*       item = dragging ? NULL : findItem( aRouter, ev );
+            prof_counter    time;
+            STEP            step;
+
+            prof_start( &time );
+            aRouter.Move( ev.m_pos, item );
+            prof_end( &time );
+
+            PNS_ALLOC_STATS stats = PNS_ALLOCATOR::GetStats();
+
+            step.m_msecs = time.msecs();
+            step.m_collisionQueries = stats.m_stepCollisionQueries;
+            step.m_shoveIterations = stats.m_stepShoveIterations;
+            step.m_allocs = stats.m_stepAllocs;
+            aSteps.push_back( step );
+        }
+        else if( !strcmp( type, "fix" ) )
+            aRouter.FixRoute( ev.m_pos, dragging ? NULL : findItem( aRouter, ev ) );
+        else if( !strcmp( type, "stop" ) )
+            aRouter.StopRouting();
+        else if( !strcmp( type, "layer" ) )
+            aRouter.SwitchLayer( ev.m_arg );
+        else if( !strcmp( type, "via" ) )
+            aRouter.ToggleViaPlacement();
+        else if( !strcmp( type, "posture" ) )
+            aRouter.FlipPosture();
+    }
+
+    aRouter.StopRouting();
+
+    if( failures )
+        fprintf( stderr, "warning: %u sessions could not be started\n", failures );
+}
+
+
+static bool lessTime( const STEP& aA, const STEP& aB )
+{
+    return aA.m_msecs < aB.m_msecs;
+}
+
+
+static double percentile( const std::vector<STEP>& aSorted, double aFraction )
+{
+    unsigned n = std::min( (unsigned) ( aFraction * aSorted.size() ), (unsigned) aSorted.size() - 1 );
+
+    return aSorted[n].m_msecs;
+}
+
+
+int main( int argc, char** argv )
+{
+    if( argc < 3 )
+        usage();
+
+    int repeat = argc > 3 ? atoi( argv[3] ) : 1;
+
+    if( repeat <= 0 )
+        usage();
+
+    std::vector<EVENT> events;
+
+    if( !readEvents( argv[2], events ) )
+    {
+        fprintf( stderr, "error: cannot read '%s'\n", argv[2] );
+        return 1;
+    }
+
+    std::vector<STEP>   steps;
+    prof_counter        loadTime, syncTime;
+
+    for( int r = 0; r < repeat; ++r )
+    {
+        PCB_IO  io;
+        BOARD*  board;
+
+        prof_start( &loadTime );
+
+        try
+        {
+            // the replay modifies the board, so start each run from the file
+            board = io.Load( FROM_UTF8( argv[1] ), NULL );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            fprintf( stderr, "error: %s\n", TO_UTF8( ioe.errorText ) );
+            return 1;
+        }
+
+        board->GetRatsnest()->ProcessBoard();
+        prof_end( &loadTime );
+
+        PNS_ROUTER router;
+
+        prof_start( &syncTime );
+        router.SetBoard( board );
+        router.SyncWorld();
+        prof_end( &syncTime );
+
+        replay( router, board, events, steps );
+
+        router.ClearWorld();
+        delete board;
+    }
+
+    if( steps.empty() )
+    {
+        fprintf( stderr, "error: no routing step found in '%s'\n", argv[2] );
+        return 1;
+    }
+
+    double  total = 0.0;
+    long    queries = 0, iterations = 0, allocs = 0;
+    int     maxQueries = 0, maxIterations = 0;
+
+    for( unsigned i = 0; i < steps.size(); ++i )
+    {
+        total += steps[i].m_msecs;
+        queries += steps[i].m_collisionQueries;
+        iterations += steps[i].m_shoveIterations;
+        allocs += steps[i].m_allocs;
+        maxQueries = std::max( maxQueries, steps[i].m_collisionQueries );
+        maxIterations = std::max( maxIterations, steps[i].m_shoveIterations );
+    }
+
+    std::sort( steps.begin(), steps.end(), lessTime );
+
+    int n = steps.size();
+
+    printf( "%lu events, %d runs, board load %.1f ms, world sync %.1f ms\n",
+            (unsigned long) events.size(), repeat, loadTime.msecs(), syncTime.msecs() );
+    printf( "%d steps: mean %.2f ms, p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+            n, total / n, percentile( steps, 0.5 ), percentile( steps, 0.9 ),
+            percentile( steps, 0.99 ), steps.back().m_msecs );
+    printf( "per step: %.1f collision queries (max %d), %.1f shove iterations (max %d), "
+            "%.1f allocations\n", (double) queries / n, maxQueries,
+            (double) iterations / n, maxIterations, (double) allocs / n );
+
+    return 0;
+}
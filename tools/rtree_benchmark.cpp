@@ -0,0 +1,155 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Measures the time needed to build the R-tree used by the GAL VIEW to index its
+ * items, by inserting them one by one and by bulk loading them, and the speed of
+ * window queries on both trees:
+ *
+ *   rtree_benchmark 200000
+ *
+ * The items are random boxes, sized like tracks and pads on a board of 30 cm x 30 cm.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <profile.h>
+#include <geometry/rtree.h>
+
+
+typedef RTree<void*, int, 2, float> ITEM_RTREE;
+
+static const int BOARD_SIZE   = 300000000;     // 30 cm in nanometers
+static const int ITEM_SIZE    = 2000000;       // 2 mm
+static const int WINDOW_SIZE  = 20000000;      // 2 cm, a zoomed in view
+static const int QUERY_COUNT  = 100000;
+
+
+/**
+ * Struct HIT_COUNTER
+ * is the RTree visitor counting the items found by a query.
+ */
+struct HIT_COUNTER
+{
+    unsigned m_count;
+
+    HIT_COUNTER() : m_count( 0 ) {}
+
+    bool operator()( void* aItem )
+    {
+        ++m_count;
+        return true;
+    }
+};
+
+
+static int randomCoord( int aRange )
+{
+    return (int) ( (double) rand() / RAND_MAX * aRange );
+}
+
+
+/**
+ * Function runQueries
+ * runs QUERY_COUNT window queries on aTree.
+ * @return the number of items found.
+ */
+static unsigned runQueries( ITEM_RTREE& aTree, prof_counter* aCounter )
+{
+    HIT_COUNTER counter;
+
+    srand( 1 );
+    prof_start( aCounter );
+
+    for( int i = 0; i < QUERY_COUNT; ++i )
+    {
+        int mmin[2] = { randomCoord( BOARD_SIZE ), randomCoord( BOARD_SIZE ) };
+        int mmax[2] = { mmin[0] + WINDOW_SIZE, mmin[1] + WINDOW_SIZE };
+
+        aTree.Search( mmin, mmax, counter );
+    }
+
+    prof_end( aCounter );
+
+    return counter.m_count;
+}
+
+
+int main( int argc, char** argv )
+{
+    int count = argc > 1 ? atoi( argv[1] ) : 100000;
+
+    if( count <= 0 )
+    {
+        fprintf( stderr, "usage: rtree_benchmark [item count]\n" );
+        return 1;
+    }
+
+    std::vector<int>    mmin( count * 2 );
+    std::vector<int>    mmax( count * 2 );
+    std::vector<void*>  data( count );
+
+    for( int i = 0; i < count; ++i )
+    {
+        mmin[2 * i]     = randomCoord( BOARD_SIZE );
+        mmin[2 * i + 1] = randomCoord( BOARD_SIZE );
+        mmax[2 * i]     = mmin[2 * i] + randomCoord( ITEM_SIZE );
+        mmax[2 * i + 1] = mmin[2 * i + 1] + randomCoord( ITEM_SIZE );
+        data[i]         = &data[i];
+    }
+
+    ITEM_RTREE      inserted;
+    ITEM_RTREE      packed;
+    prof_counter    insertTime, loadTime, insertQueryTime, loadQueryTime;
+
+    prof_start( &insertTime );
+
+    for( int i = 0; i < count; ++i )
+        inserted.Insert( &mmin[2 * i], &mmax[2 * i], data[i] );
+
+    prof_end( &insertTime );
+
+    prof_start( &loadTime );
+    packed.BulkLoad( count, &mmin[0], &mmax[0], &data[0] );
+    prof_end( &loadTime );
+
+    unsigned insertHits = runQueries( inserted, &insertQueryTime );
+    unsigned loadHits   = runQueries( packed, &loadQueryTime );
+
+    if( insertHits != loadHits )
+    {
+        fprintf( stderr, "error: the trees found %u and %u items\n", insertHits, loadHits );
+        return 1;
+    }
+
+    printf( "%d items, %d queries finding %u items\n", count, QUERY_COUNT, loadHits );
+    printf( "Insert():   build %8.1f ms, queries %8.1f ms\n",
+            insertTime.msecs(), insertQueryTime.msecs() );
+    printf( "BulkLoad(): build %8.1f ms, queries %8.1f ms\n",
+            loadTime.msecs(), loadQueryTime.msecs() );
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2015 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Checks that the entries of a tree built by RTree::BulkLoad() can be found, removed
+ * and inserted again, with a data type narrower than a pointer (int) and with a
+ * pointer:
+ *
+ *   rtree_test
+ *
+ * Prints the failed checks and returns 1 if any, 0 otherwise.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <geometry/rtree.h>
+
+
+static const int ITEM_COUNT = 5000;
+static const int GRID_SIZE  = 100;
+static const int ITEM_SIZE  = 10;
+
+static int failures = 0;
+
+#define CHECK( cond, ... )                      \
+    if( !( cond ) )                             \
+    {                                           \
+        printf( "FAILED: " __VA_ARGS__ );       \
+        printf( "\n" );                         \
+        ++failures;                             \
+    }
+
+
+/**
+ * Struct DATA_FINDER
+ * is the RTree visitor looking for a given data in the results of a query.
+ */
+template <class DATATYPE>
+struct DATA_FINDER
+{
+    DATATYPE m_data;
+    bool     m_found;
+
+    DATA_FINDER( DATATYPE aData ) : m_data( aData ), m_found( false ) {}
+
+    bool operator()( DATATYPE aData )
+    {
+        if( aData == m_data )
+            m_found = true;
+
+        return !m_found;
+    }
+};
+
+
+/**
+ * Function testBulkLoadRemove
+ * bulk loads ITEM_COUNT entries, whose data are given by aData, checks that each one
+ * is found, removes half of them and inserts them again, then removes them all.
+ */
+template <class DATATYPE>
+static void testBulkLoadRemove( const char* aName, const std::vector<DATATYPE>& aData )
+{
+    typedef RTree<DATATYPE, int, 2, float> TREE;
+
+    TREE             tree;
+    std::vector<int> mmin( ITEM_COUNT * 2 );
+    std::vector<int> mmax( ITEM_COUNT * 2 );
+
+    for( int i = 0; i < ITEM_COUNT; ++i )
+    {
+        mmin[2 * i]     = ( i % GRID_SIZE ) * ITEM_SIZE;
+        mmin[2 * i + 1] = ( i / GRID_SIZE ) * ITEM_SIZE;
+        mmax[2 * i]     = mmin[2 * i] + ITEM_SIZE / 2;
+        mmax[2 * i + 1] = mmin[2 * i + 1] + ITEM_SIZE / 2;
+    }
+
+    tree.BulkLoad( ITEM_COUNT, &mmin[0], &mmax[0], &aData[0] );
+
+    CHECK( tree.Count() == ITEM_COUNT, "%s: %d entries after BulkLoad()", aName, tree.Count() );
+
+    for( int i = 0; i < ITEM_COUNT; ++i )
+    {
+        DATA_FINDER<DATATYPE> finder( aData[i] );
+
+        tree.Search( &mmin[2 * i], &mmax[2 * i], finder );
+        CHECK( finder.m_found, "%s: entry %d not found after BulkLoad()", aName, i );
+    }
+
+    // Remove half of the entries, and insert them again
+    for( int i = 0; i < ITEM_COUNT; i += 2 )
+        tree.Remove( &mmin[2 * i], &mmax[2 * i], aData[i] );
+
+    CHECK( tree.Count() == ITEM_COUNT / 2, "%s: %d entries after Remove()",
+           aName, tree.Count() );
+
+    for( int i = 0; i < ITEM_COUNT; i += 2 )
+        tree.Insert( &mmin[2 * i], &mmax[2 * i], aData[i] );
+
+    CHECK( tree.Count() == ITEM_COUNT, "%s: %d entries after Insert()", aName, tree.Count() );
+
+    // Then remove all of them
+    for( int i = 0; i < ITEM_COUNT; ++i )
+        tree.Remove( &mmin[2 * i], &mmax[2 * i], aData[i] );
+
+    CHECK( tree.Count() == 0, "%s: %d entries left", aName, tree.Count() );
+}
+
+
+int main( int argc, char* argv[] )
+{
+    std::vector<int>    ids( ITEM_COUNT );
+    std::vector<void*>  pointers( ITEM_COUNT );
+    std::vector<char>   objects( ITEM_COUNT );
+
+    for( int i = 0; i < ITEM_COUNT; ++i )
+    {
+        ids[i]      = i + 1;
+        pointers[i] = &objects[i];
+    }
+
+    testBulkLoadRemove( "int", ids );
+    testBulkLoadRemove( "void*", pointers );
+
+    if( failures )
+        printf( "%d check(s) failed\n", failures );
+    else
+        printf( "all checks passed\n" );
+
+    return failures ? 1 : 0;
+}